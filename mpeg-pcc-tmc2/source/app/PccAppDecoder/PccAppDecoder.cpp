@@ -48,6 +48,7 @@
 #include "PCCMetricsParameters.h"
 #include "PCCConformanceParameters.h"
 #include "PCCConformance.h"
+#include "PCCKdTree.h"
 #include <program_options_lite.h>
 #if defined( ENABLE_TBB )
 #include <tbb/tbb.h>
@@ -151,6 +152,19 @@ bool parseParameters( int                       argc,
       decoderParams.nbThread_,
       decoderParams.nbThread_,
     "Number of thread used for parallel processing")
+    ( "spatialIndexType",
+      decoderParams.spatialIndexType_,
+      decoderParams.spatialIndexType_,
+      "Spatial index used for nearest neighbour searches:\n"
+      "  0: kd-tree\n"
+      "  1: voxel grid" )
+    ( "streamingFrameCount",
+      decoderParams.streamingFrameCount_,
+      decoderParams.streamingFrameCount_,
+      "Number of frames reconstructed, output and released together\n"
+      "(0: the frames are output by group of frames). The videos are\n"
+      "decoded picture by picture with the HM and SHM applications\n"
+      "only, the other decoders decode them as a whole first")
     ( "attributeTransferFilterType",
       decoderParams.attrTransferFilterType_,
       decoderParams.attrTransferFilterType_,
@@ -275,6 +289,38 @@ bool parseParameters( int                       argc,
   return !err.is_errored;
 }
 
+int outputFrames( PCCGroupOfFrames&           reconstructs,
+                  size_t&                     frameNumber,
+                  const PCCDecoderParameters& decoderParams,
+                  const PCCMetricsParameters& metricsParams,
+                  PCCMetrics&                 metrics,
+                  PCCChecksum&                checksum ) {
+  if ( metricsParams.computeChecksum_ ) { checksum.computeDecoded( reconstructs ); }
+  if ( metricsParams.computeMetrics_ ) {
+    PCCGroupOfFrames sources;
+    PCCGroupOfFrames normals;
+    if ( !sources.load( metricsParams.uncompressedDataPath_, frameNumber, frameNumber + reconstructs.getFrameCount(),
+                        decoderParams.colorTransform_ ) ) {
+      return -1;
+    }
+    if ( !metricsParams.normalDataPath_.empty() ) {
+      if ( !normals.load( metricsParams.normalDataPath_, frameNumber, frameNumber + reconstructs.getFrameCount(),
+                          COLOR_TRANSFORM_NONE, true ) ) {
+        return -1;
+      }
+    }
+    metrics.compute( sources, reconstructs, normals );
+    sources.clear();
+    normals.clear();
+  }
+  if ( !decoderParams.reconstructedDataPath_.empty() ) {
+    reconstructs.write( decoderParams.reconstructedDataPath_, frameNumber, decoderParams.nbThread_ );
+  } else {
+    frameNumber += reconstructs.getFrameCount();
+  }
+  return 0;
+}
+
 int decompressVideo( PCCDecoderParameters&       decoderParams,
                      const PCCMetricsParameters& metricsParams,
                      PCCConformanceParameters&   conformanceParams,
@@ -300,6 +346,15 @@ int decompressVideo( PCCDecoderParameters&       decoderParams,
   PCCDecoder decoder;
   decoder.setLogger( logger );
   decoder.setParameters( decoderParams );
+  if ( decoderParams.streamingFrameCount_ > 0 ) {
+    // the frames are output as soon as they are reconstructed
+    decoder.setFrameOutput( [&]( PCCGroupOfFrames& frames ) {
+      clock.stop();
+      int ret = outputFrames( frames, frameNumber, decoderParams, metricsParams, metrics, checksum );
+      clock.start();
+      return ret;
+    } );
+  }
 
   SampleStreamV3CUnit ssvu;
   size_t              headerSize = pcc::PCCBitstreamReader::read( bitstream, ssvu );
@@ -334,23 +389,10 @@ int decompressVideo( PCCDecoderParameters&       decoderParams,
       int retDecoding = decoder.decode( context, reconstructs, atlId );
       clock.stop();
       if ( retDecoding != 0 ) { return retDecoding; }
-      if ( metricsParams.computeChecksum_ ) { checksum.computeDecoded( reconstructs ); }
-      if ( metricsParams.computeMetrics_ ) {
-        PCCGroupOfFrames sources;
-        PCCGroupOfFrames normals;
-        if ( !sources.load( metricsParams.uncompressedDataPath_, frameNumber,
-                            frameNumber + reconstructs.getFrameCount(), decoderParams.colorTransform_ ) ) {
-          return -1;
-        }
-        if ( !metricsParams.normalDataPath_.empty() ) {
-          if ( !normals.load( metricsParams.normalDataPath_, frameNumber, frameNumber + reconstructs.getFrameCount(),
-                              COLOR_TRANSFORM_NONE, true ) ) {
-            return -1;
-          }
-        }
-        metrics.compute( sources, reconstructs, normals );
-        sources.clear();
-        normals.clear();
+      // in streaming mode, the frames have already been output by the decoder
+      if ( reconstructs.getFrameCount() > 0 ) {
+        int retOutput = outputFrames( reconstructs, frameNumber, decoderParams, metricsParams, metrics, checksum );
+        if ( retOutput != 0 ) { return retOutput; }
       }
 
 #ifdef CONFORMANCE_TRACE
@@ -359,12 +401,6 @@ int decompressVideo( PCCDecoderParameters&       decoderParams,
         conformance.check( conformanceParams );
       }
 #endif
-
-      if ( !decoderParams.reconstructedDataPath_.empty() ) {
-        reconstructs.write( decoderParams.reconstructedDataPath_, frameNumber, decoderParams.nbThread_ );
-      } else {
-        frameNumber += reconstructs.getFrameCount();
-      }
       bMoreData = ( ssvu.getV3CUnitCount() > 0 );
     }
   }
@@ -385,6 +421,7 @@ int main( int argc, char* argv[] ) {
   PCCMetricsParameters     metricsParams;
   PCCConformanceParameters conformanceParams;
   if ( !parseParameters( argc, argv, decoderParams, metricsParams, conformanceParams ) ) { return -1; }
+  PCCKdTree::setSpatialIndexType( static_cast<PCCSpatialIndexType>( decoderParams.spatialIndexType_ ) );
 #if defined( ENABLE_TBB )
   if ( decoderParams.nbThread_ > 0 ) { tbb::task_scheduler_init init( static_cast<int>( decoderParams.nbThread_ ) ); }
 #endif
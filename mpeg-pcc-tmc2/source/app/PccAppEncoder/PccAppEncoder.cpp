@@ -46,6 +46,7 @@
 #include "PCCEncoderParameters.h"
 #include "PCCBitstreamWriter.h"
 #include "PCCMetricsParameters.h"
+#include "PCCKdTree.h"
 #include <program_options_lite.h>
 #if defined( ENABLE_TBB )
 #include <tbb/tbb.h>
@@ -212,6 +213,10 @@ bool parseParameters( int                   argc,
       encoderParams.normalOrientation_,
       encoderParams.normalOrientation_,
       "Normal orientation: 0: None 1: spanning tree, 2:view point, 3:cubemap projection" )     
+    ( "normalEigenSolver",
+      encoderParams.normalEigenSolver_,
+      encoderParams.normalEigenSolver_,
+      "Normal estimation eigen solver: 0: iterative (reference) 1: closed form" )
     ( "gridBasedRefineSegmentation",
       encoderParams.gridBasedRefineSegmentation_,
       encoderParams.gridBasedRefineSegmentation_,
@@ -594,6 +599,16 @@ bool parseParameters( int                   argc,
       encoderParams.nbThread_,
       encoderParams.nbThread_,
       "Number of thread used for parallel processing" )
+    ( "concurrentGofCount",
+      encoderParams.concurrentGofCount_,
+      encoderParams.concurrentGofCount_,
+      "Number of groups of frames encoded concurrently, their V3C units being written in order" )
+    ( "spatialIndexType",
+      encoderParams.spatialIndexType_,
+      encoderParams.spatialIndexType_,
+      "Spatial index used for nearest neighbour searches:\n"
+      "  0: kd-tree\n"
+      "  1: voxel grid" )
     ( "keepIntermediateFiles",
       encoderParams.keepIntermediateFiles_,
       encoderParams.keepIntermediateFiles_,
@@ -1012,12 +1027,24 @@ bool parseParameters( int                   argc,
   return true;
 }
 
+// Group of frames encoded by compressVideo(): the groups of a batch are encoded concurrently and written in order.
+struct GofEncodingTask {
+  PCCContext       context_;
+  PCCGroupOfFrames sources_;
+  PCCGroupOfFrames reconstructs_;
+  PCCLogger        logger_;
+  size_t           startFrameNumber_ = 0;
+  size_t           endFrameNumber_   = 0;
+  int              ret_              = 0;
+};
+
 int compressVideo( const PCCEncoderParameters& encoderParams,
                    const PCCMetricsParameters& metricsParams,
                    StopwatchUserTime&          clock ) {
   const size_t startFrameNumber0        = encoderParams.startFrameNumber_;
   size_t       endFrameNumber0          = encoderParams.startFrameNumber_ + encoderParams.frameCount_;
   const size_t groupOfFramesSize0       = ( std::max )( size_t( 1 ), encoderParams.groupOfFramesSize_ );
+  const size_t concurrentGofCount       = ( std::max )( size_t( 1 ), encoderParams.concurrentGofCount_ );
   size_t       startFrameNumber         = startFrameNumber0;
   size_t       reconstructedFrameNumber = encoderParams.startFrameNumber_;
 
@@ -1025,70 +1052,98 @@ int compressVideo( const PCCEncoderParameters& encoderParams,
   logger.initilalize( removeFileExtension( encoderParams.compressedStreamPath_ ), true );
   std::unique_ptr<uint8_t> buffer;
   size_t                   contextIndex = 0;
-  PCCEncoder               encoder;
   PCCMetrics               metrics;
   PCCChecksum              checksum;
   PCCBitstreamStat         bitstreamStat;
   SampleStreamV3CUnit      ssvu;
-  encoder.setLogger( logger );
-  encoder.setParameters( encoderParams );
   metrics.setParameters( metricsParams );
   checksum.setParameters( metricsParams );
 
   // Place to get/set default values for gof metadata enabled flags (in sequence level).
   while ( startFrameNumber < endFrameNumber0 ) {
-    size_t     endFrameNumber = min( startFrameNumber + groupOfFramesSize0, endFrameNumber0 );
-    PCCContext context;
-    context.setBitstreamStat( bitstreamStat );
-    context.addV3CParameterSet( contextIndex );
-    context.setActiveVpsId( contextIndex );
-    PCCGroupOfFrames sources;
-    PCCGroupOfFrames reconstructs;
+    std::vector<std::unique_ptr<GofEncodingTask>> tasks;
     clock.start();
-    if ( !sources.load( encoderParams.uncompressedDataPath_, startFrameNumber, endFrameNumber,
-                        encoderParams.colorTransform_, false, encoderParams.nbThread_ ) ) {
-      return -1;
+    while ( tasks.size() < concurrentGofCount && startFrameNumber < endFrameNumber0 ) {
+      size_t endFrameNumber = min( startFrameNumber + groupOfFramesSize0, endFrameNumber0 );
+      tasks.emplace_back( new GofEncodingTask );
+      auto& task = *tasks.back();
+      task.context_.setBitstreamStat( bitstreamStat );
+      task.context_.addV3CParameterSet( contextIndex );
+      task.context_.setActiveVpsId( contextIndex );
+      if ( !task.sources_.load( encoderParams.uncompressedDataPath_, startFrameNumber, endFrameNumber,
+                                encoderParams.colorTransform_, false, encoderParams.nbThread_ ) ) {
+        return -1;
+      }
+      if ( task.sources_.getFrameCount() < endFrameNumber - startFrameNumber ) {
+        endFrameNumber  = startFrameNumber + task.sources_.getFrameCount();
+        endFrameNumber0 = endFrameNumber;
+      }
+      std::cout << "Compressing " << contextIndex << " frames " << startFrameNumber << " -> " << endFrameNumber
+                << "..." << std::endl;
+      task.startFrameNumber_ = startFrameNumber;
+      task.endFrameNumber_   = endFrameNumber;
+      startFrameNumber       = endFrameNumber;
+      contextIndex++;
     }
-    if ( sources.getFrameCount() < endFrameNumber - startFrameNumber ) {
-      endFrameNumber  = startFrameNumber + sources.getFrameCount();
-      endFrameNumber0 = endFrameNumber;
+    // the traces of concurrent groups of frames are buffered and appended to the log files in order
+    const bool concurrent = tasks.size() > 1;
+#if defined( ENABLE_TBB )
+    tbb::task_arena limited( static_cast<int>( tasks.size() ) );
+    limited.execute( [&] {
+      tbb::parallel_for( size_t( 0 ), tasks.size(), [&]( const size_t i ) {
+#else
+    for ( size_t i = 0; i < tasks.size(); i++ ) {
+#endif
+        auto&      task = *tasks[i];
+        PCCEncoder encoder;
+        if ( concurrent ) { task.logger_.setBuffered( true ); }
+        encoder.setLogger( concurrent ? task.logger_ : logger );
+        encoder.setParameters( encoderParams );
+        task.ret_ = encoder.encode( task.sources_, task.context_, task.reconstructs_ );
+#if defined( ENABLE_TBB )
+      } );
+    } );
+#else
     }
-    std::cout << "Compressing " << contextIndex << " frames " << startFrameNumber << " -> " << endFrameNumber << "..."
-              << std::endl;
-    int                ret = encoder.encode( sources, context, reconstructs );
-    PCCBitstreamWriter bitstreamWriter;
+#endif
+    for ( auto& task : tasks ) {
+      logger.append( task->logger_ );
+      PCCBitstreamWriter bitstreamWriter;
 #ifdef BITSTREAM_TRACE
-    bitstreamWriter.setLogger( logger );
+      bitstreamWriter.setLogger( logger );
 #endif
-    ret |= bitstreamWriter.encode( context, ssvu );
+      task->ret_ |= bitstreamWriter.encode( task->context_, ssvu );
+    }
     clock.stop();
-    PCCGroupOfFrames normals;
-    if ( metricsParams.computeMetrics_ ) {
-      bool bRunMetric = true;
-      if ( !metricsParams.normalDataPath_.empty() ) {
-        if ( !normals.load( metricsParams.normalDataPath_, startFrameNumber, endFrameNumber, COLOR_TRANSFORM_NONE,
-                            true ) ) {
-          bRunMetric = false;
+    for ( auto& task : tasks ) {
+      auto&            sources      = task->sources_;
+      auto&            reconstructs = task->reconstructs_;
+      PCCGroupOfFrames normals;
+      if ( metricsParams.computeMetrics_ ) {
+        bool bRunMetric = true;
+        if ( !metricsParams.normalDataPath_.empty() ) {
+          if ( !normals.load( metricsParams.normalDataPath_, task->startFrameNumber_, task->endFrameNumber_,
+                              COLOR_TRANSFORM_NONE, true ) ) {
+            bRunMetric = false;
+          }
         }
+        if ( bRunMetric ) { metrics.compute( sources, reconstructs, normals ); }
       }
-      if ( bRunMetric ) { metrics.compute( sources, reconstructs, normals ); }
-    }
-    if ( metricsParams.computeChecksum_ ) {
-      if ( encoderParams.rawPointsPatch_ && encoderParams.reconstructRawType_ != 0 ) {
-        checksum.computeSource( sources );
-        checksum.computeReordered( reconstructs );
+      if ( metricsParams.computeChecksum_ ) {
+        if ( encoderParams.rawPointsPatch_ && encoderParams.reconstructRawType_ != 0 ) {
+          checksum.computeSource( sources );
+          checksum.computeReordered( reconstructs );
+        }
+        checksum.computeReconstructed( reconstructs );
       }
-      checksum.computeReconstructed( reconstructs );
-    }
-    if ( ret != 0 ) { return ret; }
-    if ( !encoderParams.reconstructedDataPath_.empty() ) {
-      reconstructs.write( encoderParams.reconstructedDataPath_, reconstructedFrameNumber );
+      if ( task->ret_ != 0 ) { return task->ret_; }
+      if ( !encoderParams.reconstructedDataPath_.empty() ) {
+        reconstructs.write( encoderParams.reconstructedDataPath_, reconstructedFrameNumber );
+      }
+      normals.clear();
+      sources.clear();
+      reconstructs.clear();
     }
-    normals.clear();
-    sources.clear();
-    reconstructs.clear();
-    startFrameNumber = endFrameNumber;
-    contextIndex++;
   }
 
   PCCBitstream bitstream;
@@ -1126,6 +1181,7 @@ int main( int argc, char* argv[] ) {
   PCCEncoderParameters encoderParams;
   PCCMetricsParameters metricsParams;
   if ( !parseParameters( argc, argv, encoderParams, metricsParams ) ) { return -1; }
+  PCCKdTree::setSpatialIndexType( static_cast<PCCSpatialIndexType>( encoderParams.spatialIndexType_ ) );
 #if defined( ENABLE_TBB )
   if ( encoderParams.nbThread_ > 0 ) { tbb::task_scheduler_init init( static_cast<int>( encoderParams.nbThread_ ) ); }
 #endif
@@ -0,0 +1,708 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+#include "PCCCommon.h"
+#include "PCCBitstream.h"
+#include "PCCPointSet.h"
+#include "PCCKdTree.h"
+#include "PCCPatch.h"
+#include "PCCPatchSegmenter.h"
+#include "PCCNormalsGenerator.h"
+#include <random>
+#include <set>
+#include <unordered_map>
+
+using namespace std;
+using namespace pcc;
+
+// Equivalence checks of the optimized code paths against straightforward reference implementations (the previous
+// implementations, or exhaustive searches) on random inputs. Each check prints its mismatches and the application
+// returns a non-zero code if one of them fails.
+
+//---------------------------------------------------------------------------
+// :: Bitstream: word-level reads and writes, Exp-Golomb codes by leading zero count
+
+// bit by bit writer and reader of the previous PCCBitstream
+class ReferenceBitWriter {
+ public:
+  void write( uint32_t value, uint8_t bits ) {
+    for ( size_t i = 0; i < bits; i++ ) {
+      if ( ( bitCount_ & 7 ) == 0 ) { data_.push_back( 0 ); }
+      data_.back() |= ( ( value >> ( bits - 1 - i ) ) & 1 ) << ( 7 - ( bitCount_ & 7 ) );
+      bitCount_++;
+    }
+  }
+  void writeUvlc( uint32_t value ) {
+    uint32_t length = 1, temp = ++value;
+    while ( 1 != temp ) {
+      temp >>= 1;
+      length += 2;
+    }
+    write( 0, length >> 1 );
+    write( value, ( length + 1 ) >> 1 );
+  }
+  void writeSvlc( int32_t value ) { writeUvlc( ( uint32_t )( value <= 0 ? -value << 1 : ( value << 1 ) - 1 ) ); }
+  void writeString( const std::string& str ) {
+    while ( ( bitCount_ & 7 ) != 0 ) { write( 0, 1 ); }
+    for ( auto& element : str ) { write( element, 8 ); }
+    write( 0, 8 );
+  }
+  std::vector<uint8_t>& data() { return data_; }
+
+ private:
+  std::vector<uint8_t> data_;
+  size_t               bitCount_ = 0;
+};
+
+bool checkBitstream() {
+  std::mt19937 gen( 1 );
+  for ( size_t iter = 0; iter < 200; iter++ ) {
+    // random sequence of fixed length codes (with bits above the length set), uvlc, svlc and strings
+    struct Element {
+      int         type;
+      uint32_t    value;
+      uint8_t     bits;
+      std::string str;
+    };
+    std::vector<Element> elements( 1 + gen() % 2000 );
+    for ( auto& element : elements ) {
+      element.type = gen() % 8 == 0 ? 3 : gen() % 3;
+      element.bits = 1 + gen() % 32;
+      if ( element.type == 0 ) {
+        element.value = gen();
+      } else if ( element.type == 1 ) {
+        element.value = ( std::min )( uint32_t( 0xFFFFFFFE ), uint32_t( uint64_t( gen() ) >> ( 32 - element.bits ) ) );
+      } else if ( element.type == 2 ) {
+        element.value = uint32_t( int32_t( gen() ) >> ( 32 - ( std::min )( element.bits, uint8_t( 31 ) ) ) );
+      } else {
+        for ( size_t i = 0, n = gen() % 5; i < n; i++ ) { element.str.push_back( char( 'a' + gen() % 26 ) ); }
+      }
+    }
+    ReferenceBitWriter reference;
+    PCCBitstream       bitstream;
+    for ( auto& element : elements ) {
+      switch ( element.type ) {
+        case 0:
+          reference.write( element.value, element.bits );
+          bitstream.write( element.value, element.bits );
+          break;
+        case 1:
+          reference.writeUvlc( element.value );
+          bitstream.writeUvlc( element.value );
+          break;
+        case 2:
+          reference.writeSvlc( int32_t( element.value ) );
+          bitstream.writeSvlc( int32_t( element.value ) );
+          break;
+        default:
+          reference.writeString( element.str );
+          bitstream.writeString( element.str );
+          break;
+      }
+    }
+    auto&  expected = reference.data();
+    size_t size     = bitstream.size() + ( bitstream.byteAligned() ? 0 : 1 );
+    if ( size != expected.size() || !std::equal( expected.begin(), expected.end(), bitstream.buffer() ) ) {
+      printf( "  bitstream: sequence %zu: written bytes differ ( %zu / %zu bytes ) \n", iter, size,
+              expected.size() );
+      return false;
+    }
+    PCCBitstream reader;
+    reader.initialize( expected );
+    for ( size_t i = 0; i < elements.size(); i++ ) {
+      auto&    element = elements[i];
+      uint32_t value = 0, read = 0;
+      bool     equal = true;
+      switch ( element.type ) {
+        case 0:
+          value = element.bits < 32 ? element.value & ( ( 1U << element.bits ) - 1 ) : element.value;
+          read  = reader.read( element.bits );
+          equal = read == value;
+          break;
+        case 1:
+          value = element.value;
+          read  = reader.readUvlc();
+          equal = read == value;
+          break;
+        case 2:
+          value = element.value;
+          read  = uint32_t( reader.readSvlc() );
+          equal = read == value;
+          break;
+        default: equal = reader.readString() == element.str; break;
+      }
+      if ( !equal ) {
+        printf( "  bitstream: sequence %zu: element %zu of type %d read %u instead of %u \n", iter, i, element.type,
+                read, value );
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+// :: Point sets: duplicate removal and reordering by radix sort
+
+// point indices grouped by position in the std::map order of the previous implementations
+using PositionMap = std::map<float, std::map<float, std::map<float, std::vector<size_t>>>>;
+
+static PositionMap buildPositionMap( const PCCPointSet3& pointCloud ) {
+  PositionMap map;
+  for ( size_t i = 0; i < pointCloud.getPointCount(); ++i ) {
+    const auto& position = pointCloud[i];
+    map[position[0]][position[1]][position[2]].push_back( i );
+  }
+  return map;
+}
+
+static PCCColor3B averageColor( const PCCPointSet3& pointCloud, const std::vector<size_t>& listIndex ) {
+  size_t r = 0, g = 0, b = 0;
+  for ( auto& index : listIndex ) {
+    r += pointCloud.getColor( index )[0];
+    g += pointCloud.getColor( index )[1];
+    b += pointCloud.getColor( index )[2];
+  }
+  PCCColor3B average;
+  average[0] = r / listIndex.size();
+  average[1] = g / listIndex.size();
+  average[2] = b / listIndex.size();
+  return average;
+}
+
+// previous removeDuplicate(): first point of each position, in the input order
+static void referenceRemoveDuplicate( const PCCPointSet3& pointCloud, PCCPointSet3& newPointcloud ) {
+  if ( pointCloud.hasReflectances() ) { newPointcloud.addReflectances(); }
+  std::map<float, std::map<float, std::map<float, size_t>>> map;
+  for ( size_t i = 0; i < pointCloud.getPointCount(); ++i ) {
+    const auto& position = pointCloud[i];
+    auto&       itY      = map[position[0]][position[1]];
+    if ( itY.find( position[2] ) != itY.end() ) { continue; }
+    itY[position[2]] = i;
+    if ( pointCloud.hasColors() ) {
+      newPointcloud.addPoint( position, pointCloud.getColor( i ) );
+    } else {
+      newPointcloud.addPoint( position );
+    }
+  }
+}
+
+// previous removeDuplicate( newPointcloud, dropDuplicates )
+static void referenceRemoveDuplicate( const PCCPointSet3& pointCloud,
+                                      PCCPointSet3&       newPointcloud,
+                                      size_t              dropDuplicates ) {
+  if ( pointCloud.hasReflectances() ) { newPointcloud.addReflectances(); }
+  for ( auto& itX : buildPositionMap( pointCloud ) ) {
+    for ( auto& itY : itX.second ) {
+      for ( auto& itZ : itY.second ) {
+        auto& listIndex = itZ.second;
+        if ( !pointCloud.hasColors() ) {
+          newPointcloud.addPoint( pointCloud[listIndex[0]] );
+        } else if ( listIndex.size() == 1 || dropDuplicates == 1 ) {
+          newPointcloud.addPoint( pointCloud[listIndex[0]], pointCloud.getColor( listIndex[0] ) );
+        } else {
+          newPointcloud.addPoint( pointCloud[listIndex[0]], averageColor( pointCloud, listIndex ) );
+        }
+      }
+    }
+  }
+}
+
+// previous reorder( newPointcloud, dropDuplicates ): the points of a position are sorted by color
+static void referenceReorder( const PCCPointSet3& pointCloud, PCCPointSet3& newPointcloud, bool dropDuplicates ) {
+  for ( auto& itX : buildPositionMap( pointCloud ) ) {
+    for ( auto& itY : itX.second ) {
+      for ( auto& itZ : itY.second ) {
+        auto& listIndex = itZ.second;
+        if ( !pointCloud.hasColors() ) {
+          for ( auto& index : listIndex ) { newPointcloud.addPoint( pointCloud[index] ); }
+          continue;
+        }
+        for ( size_t i = 0; i < listIndex.size(); ++i ) {
+          size_t indexMin = i;
+          for ( size_t j = i + 1; j < listIndex.size(); ++j ) {
+            if ( pointCloud.getColor( listIndex[j] ) < pointCloud.getColor( listIndex[indexMin] ) ) { indexMin = j; }
+          }
+          std::swap( listIndex[i], listIndex[indexMin] );
+        }
+        if ( dropDuplicates ) {
+          newPointcloud.addPoint( pointCloud[listIndex[0]], averageColor( pointCloud, listIndex ) );
+        } else {
+          for ( auto& index : listIndex ) { newPointcloud.addPoint( pointCloud[index], pointCloud.getColor( index ) ); }
+        }
+      }
+    }
+  }
+}
+
+static bool equalPointSets( const std::string& name, size_t iter, PCCPointSet3& lhs, PCCPointSet3& rhs ) {
+  if ( lhs.getPositions() != rhs.getPositions() || lhs.getColors() != rhs.getColors() ||
+       lhs.getReflectances() != rhs.getReflectances() ) {
+    printf( "  %s: cloud %zu: %zu / %zu points differ \n", name.c_str(), iter, lhs.getPointCount(),
+            rhs.getPointCount() );
+    return false;
+  }
+  return true;
+}
+
+bool checkPointSetSort() {
+  std::mt19937 gen( 2 );
+  for ( size_t iter = 0; iter < 200; iter++ ) {
+    // small ranges give many duplicates, the full range covers the negative coordinates
+    PCCPointSet3  pointCloud;
+    const int32_t range = iter % 2 == 0 ? 8 : 65536;
+    const int32_t base  = iter % 2 == 0 ? int32_t( gen() % 64 ) - 32 : -32768;
+    if ( gen() % 2 == 0 ) { pointCloud.addColors(); }
+    if ( gen() % 2 == 0 ) { pointCloud.addReflectances(); }
+    for ( size_t i = 0, n = gen() % 3000; i < n; i++ ) {
+      PCCPoint3D position;
+      for ( size_t k = 0; k < 3; k++ ) { position[k] = int16_t( base + int32_t( gen() % range ) ); }
+      PCCColor3B color( uint8_t( gen() % 4 ), uint8_t( gen() ), uint8_t( gen() ) );
+      const auto index =
+          pointCloud.hasColors() ? pointCloud.addPoint( position, color ) : pointCloud.addPoint( position );
+      if ( pointCloud.hasReflectances() ) { pointCloud.setReflectance( index, uint16_t( gen() ) ); }
+    }
+    PCCPointSet3 output = pointCloud, expected;
+    output.removeDuplicate();
+    referenceRemoveDuplicate( pointCloud, expected );
+    if ( !equalPointSets( "removeDuplicate()", iter, output, expected ) ) { return false; }
+    for ( size_t dropDuplicates = 0; dropDuplicates < 3; dropDuplicates++ ) {
+      PCCPointSet3 output, expected;
+      pointCloud.removeDuplicate( output, dropDuplicates );
+      referenceRemoveDuplicate( pointCloud, expected, dropDuplicates );
+      if ( !equalPointSets( "removeDuplicate( dropDuplicates )", iter, output, expected ) ) { return false; }
+    }
+    for ( bool dropDuplicates : {false, true} ) {
+      PCCPointSet3 output, expected;
+      pointCloud.reorder( output, dropDuplicates );
+      referenceReorder( pointCloud, expected, dropDuplicates );
+      if ( !equalPointSets( "reorder( dropDuplicates )", iter, output, expected ) ) { return false; }
+    }
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+// :: Grid-based segmentation: cells grouped by radix sort in compressed sparse row form
+
+bool checkGridCells() {
+  std::mt19937_64 gen( 3 );
+  for ( size_t iter = 0; iter < 200; iter++ ) {
+    // few keys give crowded cells, full 64-bit keys exercise every radix pass
+    std::vector<uint64_t> keys( gen() % 5000 );
+    const uint64_t        keyCount = iter % 3 == 0 ? 1 + gen() % 16 : iter % 3 == 1 ? 1 + gen() % 4096 : 0;
+    for ( auto& key : keys ) { key = keyCount != 0 ? ( gen() % keyCount ) << ( iter % 48 ) : gen(); }
+    std::unordered_map<uint64_t, size_t> cellOfKey;
+    std::vector<std::vector<uint32_t>>   expected;
+    for ( size_t i = 0; i < keys.size(); i++ ) {
+      auto it = cellOfKey.find( keys[i] );
+      if ( it == cellOfKey.end() ) {
+        it = cellOfKey.insert( std::make_pair( keys[i], expected.size() ) ).first;
+        expected.resize( expected.size() + 1 );
+      }
+      expected[it->second].push_back( uint32_t( i ) );
+    }
+    PCCGridCells cells;
+    cells.init( keys );
+    bool equal = cells.size() == expected.size();
+    for ( size_t i = 0; i < expected.size() && equal; i++ ) {
+      equal = cells.getPointCount( i ) == expected[i].size() && cells.getFirstPoint( i ) == expected[i][0] &&
+              std::equal( expected[i].begin(), expected[i].end(), cells.begin( i ) );
+    }
+    if ( !equal ) {
+      printf( "  grid cells: key set %zu: %zu / %zu cells differ \n", iter, cells.size(), expected.size() );
+      return false;
+    }
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+// :: Spatial indices: voxel grid against kd-tree
+
+// random clouds: uniform in a cube, on the faces of a box ( surface-like, as the captured frames ), with duplicates
+static void generatePointCloud( std::mt19937& gen, const size_t pointCount, const int32_t size, PCCPointSet3& cloud ) {
+  const size_t type = gen() % 3;
+  for ( size_t i = 0; i < pointCount; i++ ) {
+    PCCPoint3D point;
+    for ( size_t k = 0; k < 3; k++ ) { point[k] = int16_t( gen() % size ); }
+    if ( type == 1 ) {
+      point[gen() % 3] = int16_t( gen() % 2 == 0 ? 0 : size - 1 );
+    } else if ( type == 2 && i > 0 && gen() % 4 == 0 ) {
+      point = cloud[gen() % i];
+    }
+    cloud.addPoint( point );
+  }
+}
+
+static double squaredDistance( const PCCPoint3D& lhs, const PCCPoint3D& rhs ) {
+  double dist = 0;
+  for ( size_t k = 0; k < 3; k++ ) { dist += double( lhs[k] - rhs[k] ) * double( lhs[k] - rhs[k] ); }
+  return dist;
+}
+
+// same squared distances in the same order, distinct indices at these distances: the results only differ in the
+// order of the equidistant neighbours
+template <typename Index, typename Dist>
+static bool equivalentNeighbors( const PCCPointSet3& cloud,
+                                 const PCCPoint3D&   point,
+                                 const size_t        count,
+                                 const Index*        indices,
+                                 const Dist*         dist,
+                                 const size_t        expectedCount,
+                                 const Index*        expectedIndices,
+                                 const Dist*         expectedDist ) {
+  if ( count != expectedCount ) { return false; }
+  std::set<size_t> found;
+  for ( size_t n = 0; n < count; n++ ) {
+    if ( dist[n] != expectedDist[n] || indices[n] >= cloud.getPointCount() ||
+         Dist( squaredDistance( cloud[indices[n]], point ) ) != dist[n] || !found.insert( indices[n] ).second ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool checkVoxelGrid() {
+  std::mt19937 gen( 4 );
+  for ( size_t iter = 0; iter < 40; iter++ ) {
+    PCCPointSet3  cloud;
+    const int32_t size = 1 << ( 2 + gen() % 9 );
+    generatePointCloud( gen, 1 + gen() % 20000, size, cloud );
+    PCCKdTree kdtree( cloud ), grid;
+    PCCKdTree::setSpatialIndexType( SPATIAL_INDEX_VOXEL_GRID );
+    grid.init( cloud );
+    PCCKdTree::setSpatialIndexType( SPATIAL_INDEX_KDTREE );
+    PCCNNResult expected, result;
+    for ( size_t q = 0; q < 500; q++ ) {
+      // points of the cloud and points around or outside its bounding box
+      PCCPoint3D point = cloud[gen() % cloud.getPointCount()];
+      if ( q % 2 == 1 ) {
+        for ( size_t k = 0; k < 3; k++ ) { point[k] = int16_t( int32_t( gen() % ( 2 * size ) ) - size / 2 ); }
+      }
+      const size_t num_results = 1 + gen() % 64;
+      kdtree.search( point, num_results, expected );
+      grid.search( point, num_results, result );
+      bool equal = equivalentNeighbors( cloud, point, result.size(), result.indices(), result.dist(),
+                                        expected.size(), expected.indices(), expected.dist() );
+      if ( equal ) {
+        // all the neighbours within the radius, then the closest of them
+        const double radius = double( 1 + gen() % ( 4 * size ) );
+        for ( const size_t count : {cloud.getPointCount(), num_results} ) {
+          PCCNNResult expected, result;
+          kdtree.searchRadius( point, count, radius, expected );
+          grid.searchRadius( point, count, radius, result );
+          equal = equal && equivalentNeighbors( cloud, point, result.size(), result.indices(), result.dist(),
+                                                expected.size(), expected.indices(), expected.dist() );
+        }
+      }
+      if ( !equal ) {
+        printf( "  voxel grid: cloud %zu of %zu points, query %zu ( %d, %d, %d ): neighbours differ \n", iter,
+                cloud.getPointCount(), q, point[0], point[1], point[2] );
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+// :: Batched kNN and radius queries against single queries
+
+bool checkBatchedSearch() {
+  std::mt19937 gen( 5 );
+  for ( size_t iter = 0; iter < 16; iter++ ) {
+    PCCPointSet3 cloud;
+    generatePointCloud( gen, 1 + gen() % 20000, 1 << ( 5 + gen() % 6 ), cloud );
+    std::vector<PCCPoint3D> points( gen() % 3000 );
+    for ( auto& point : points ) { point = cloud[gen() % cloud.getPointCount()]; }
+    PCCKdTree::setSpatialIndexType( iter % 2 == 0 ? SPATIAL_INDEX_KDTREE : SPATIAL_INDEX_VOXEL_GRID );
+    PCCKdTree kdtree( cloud );
+    PCCKdTree::setSpatialIndexType( SPATIAL_INDEX_KDTREE );
+    const size_t     num_results = 1 + gen() % 64;
+    const double     radius      = double( 1 + gen() % 256 );
+    PCCNNBatchResult results;
+    for ( const size_t nbThread : {1, 4} ) {
+      for ( const bool radiusSearch : {false, true} ) {
+        if ( radiusSearch ) {
+          kdtree.searchRadius( points.data(), points.size(), num_results, radius, results, nbThread );
+        } else {
+          kdtree.search( points.data(), points.size(), num_results, results, nbThread );
+        }
+        bool equal = results.size() == points.size();
+        for ( size_t q = 0; q < points.size() && equal; q++ ) {
+          PCCNNResult result;
+          if ( radiusSearch ) {
+            kdtree.searchRadius( points[q], num_results, radius, result );
+          } else {
+            kdtree.search( points[q], num_results, result );
+          }
+          equal = results.count( q ) == result.size();
+          for ( size_t n = 0; n < result.size() && equal; n++ ) {
+            equal = results.indices( q )[n] == result.indices( n ) &&
+                    results.dist( q )[n] == static_cast<float>( result.dist( n ) );
+          }
+        }
+        if ( !equal ) {
+          printf( "  batched %s: cloud %zu, %zu threads: neighbours differ \n", radiusSearch ? "radius" : "kNN",
+                  iter, nbThread );
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+// :: Normals: closed-form eigen solver against the iterative (Jacobi) solver
+
+bool checkEigenSolver() {
+  std::mt19937                   gen( 6 );
+  PCCNormalsGenerator3Parameters params = {PCCVector3D( 0.0 ),
+                                           ( std::numeric_limits<double>::max )(),
+                                           ( std::numeric_limits<double>::max )(),
+                                           ( std::numeric_limits<double>::max )(),
+                                           ( std::numeric_limits<double>::max )(),
+                                           16,
+                                           16,
+                                           16,
+                                           0,
+                                           PCC_NORMALS_GENERATOR_ORIENTATION_NONE,
+                                           true,
+                                           false,
+                                           false,
+                                           PCC_NORMALS_GENERATOR_EIGEN_SOLVER_ITERATIVE};
+  for ( size_t iter = 0; iter < 16; iter++ ) {
+    PCCPointSet3 cloud;
+    generatePointCloud( gen, 1 + gen() % 20000, 1 << ( 3 + gen() % 8 ), cloud );
+    PCCKdTree kdtree( cloud );
+    params.numberOfNearestNeighborsInNormalEstimation_ = 3 + gen() % 30;
+    PCCNormalsGenerator3 iterative, closedForm;
+    params.eigenSolver_ = PCC_NORMALS_GENERATOR_EIGEN_SOLVER_ITERATIVE;
+    iterative.compute( cloud, kdtree, params, 1 );
+    params.eigenSolver_ = PCC_NORMALS_GENERATOR_EIGEN_SOLVER_CLOSED_FORM;
+    closedForm.compute( cloud, kdtree, params, 1 );
+    for ( size_t i = 0; i < cloud.getPointCount(); i++ ) {
+      // same eigenvalues up to rounding, same normals up to their sign ( about 0.1 degree )
+      const PCCVector3D expectedNormal = iterative.getNormal( i ), normal = closedForm.getNormal( i );
+      const PCCVector3D expectedValues = iterative.getEigenvalues( i ), values = closedForm.getEigenvalues( i );
+      const double      tolerance      = 1e-9 * ( 1.0 + expectedValues[2] );
+      const double      cosine         = std::fabs( expectedNormal * normal );
+      bool              equal          = std::fabs( cosine - expectedNormal.getNorm2() ) < 1e-6;
+      for ( size_t k = 0; k < 3; k++ ) { equal = equal && std::fabs( values[k] - expectedValues[k] ) < tolerance; }
+      if ( !equal ) {
+        printf( "  eigen solver: cloud %zu point %zu: normal %f %f %f / %f %f %f eigenvalues %f %f %f / %f %f %f \n",
+                iter, i, normal[0], normal[1], normal[2], expectedNormal[0], expectedNormal[1], expectedNormal[2],
+                values[0], values[1], values[2], expectedValues[0], expectedValues[1], expectedValues[2] );
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+// :: Patch packing: fit tests on the bitset occupancy canvas
+
+// previous checkFitPatchCanvas() on a std::vector<bool> canvas: the neighbourhood of every block of the patch
+static bool referenceCheckFitPatchCanvas( const PCCPatch&          patch,
+                                          const std::vector<bool>& canvas,
+                                          size_t                   canvasStrideBlk,
+                                          size_t                   canvasHeightBlk,
+                                          bool                     bPrecedence,
+                                          int                      safeguard,
+                                          const Tile               tile ) {
+  for ( size_t v0 = 0; v0 < patch.getSizeV0(); ++v0 ) {
+    for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
+      for ( int deltaY = -safeguard; deltaY < safeguard + 1; deltaY++ ) {
+        for ( int deltaX = -safeguard; deltaX < safeguard + 1; deltaX++ ) {
+          int pos = patch.patchBlock2CanvasBlock( u0 + deltaX, v0 + deltaY, canvasStrideBlk, canvasHeightBlk, tile );
+          if ( pos < 0 ) { return false; }
+          if ( bPrecedence ) {
+            if ( canvas[pos] && patch.getOccupancy( u0 + patch.getSizeU0() * v0 ) ) { return false; }
+          } else {
+            if ( canvas[pos] ) { return false; }
+          }
+        }
+      }
+    }
+  }
+  return true;
+}
+
+// random patch of blocks, random canvas with the same content in both forms, random tile ( or none )
+static void generatePacking( std::mt19937&       gen,
+                             PCCPatch&           patch,
+                             PCCOccupancyCanvas& canvas,
+                             std::vector<bool>&  expectedCanvas,
+                             size_t&             canvasStrideBlk,
+                             size_t&             canvasHeightBlk,
+                             Tile&               tile ) {
+  patch.setSizeU0( 1 + gen() % 12 );
+  patch.setSizeV0( 1 + gen() % 12 );
+  std::vector<bool> occupancy( patch.getSizeU0() * patch.getSizeV0() );
+  const size_t      patchDensity = 1 + gen() % 4;
+  for ( size_t i = 0; i < occupancy.size(); i++ ) { occupancy[i] = gen() % 4 < patchDensity; }
+  patch.setOccupancy( occupancy );
+  // strides around the 64-bit words, sparse canvases so that the patches fit
+  canvasStrideBlk = 1 + gen() % 200;
+  canvasHeightBlk = 1 + gen() % 80;
+  canvas.resize( canvasStrideBlk * canvasHeightBlk );
+  expectedCanvas.assign( canvasStrideBlk * canvasHeightBlk, false );
+  const size_t canvasDensity = gen() % 64;
+  for ( size_t pos = 0; pos < expectedCanvas.size(); pos++ ) {
+    if ( gen() % 1024 < canvasDensity ) {
+      canvas.set( pos );
+      expectedCanvas[pos] = true;
+    }
+  }
+  tile = Tile();
+  if ( gen() % 2 == 0 ) {
+    tile.minU = int( gen() % canvasStrideBlk );
+    tile.maxU = tile.minU + int( gen() % ( canvasStrideBlk - tile.minU ) );
+    tile.minV = int( gen() % canvasHeightBlk );
+    tile.maxV = tile.minV + int( gen() % ( canvasHeightBlk - tile.minV ) );
+  }
+}
+
+bool checkFitPatchCanvas() {
+  std::mt19937 gen( 7 );
+  for ( size_t iter = 0; iter < 2000; iter++ ) {
+    PCCPatch           patch;
+    PCCOccupancyCanvas canvas;
+    std::vector<bool>  expectedCanvas;
+    size_t             canvasStrideBlk, canvasHeightBlk;
+    Tile               tile;
+    generatePacking( gen, patch, canvas, expectedCanvas, canvasStrideBlk, canvasHeightBlk, tile );
+    for ( size_t q = 0; q < 100; q++ ) {
+      patch.setU0( gen() % canvasStrideBlk );
+      patch.setV0( gen() % canvasHeightBlk );
+      patch.setPatchOrientation( gen() % 8 );
+      const bool bPrecedence = gen() % 2 == 0;
+      const int  safeguard   = int( gen() % 4 );
+      const bool fit = patch.checkFitPatchCanvas( canvas, canvasStrideBlk, canvasHeightBlk, bPrecedence, safeguard,
+                                                  tile );
+      const bool expected = referenceCheckFitPatchCanvas( patch, expectedCanvas, canvasStrideBlk, canvasHeightBlk,
+                                                          bPrecedence, safeguard, tile );
+      if ( fit != expected ) {
+        printf( "  fit patch canvas: canvas %zu query %zu: fit %d / %d \n", iter, q, fit, expected );
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// previous placement search: raster scan of the positions ( v, then u, then the orientations in their order )
+static bool referenceFindFitPatchCanvas( PCCPatch&                  patch,
+                                         const std::vector<bool>&   canvas,
+                                         size_t                     canvasStrideBlk,
+                                         size_t                     canvasHeightBlk,
+                                         bool                       bPrecedence,
+                                         const std::vector<size_t>& orientations,
+                                         int                        safeguard,
+                                         const Tile                 tile ) {
+  for ( size_t v = 0; v < canvasHeightBlk; v++ ) {
+    for ( size_t u = 0; u < canvasStrideBlk; u++ ) {
+      for ( const auto orientation : orientations ) {
+        patch.setU0( u );
+        patch.setV0( v );
+        patch.setPatchOrientation( orientation );
+        if ( referenceCheckFitPatchCanvas( patch, canvas, canvasStrideBlk, canvasHeightBlk, bPrecedence, safeguard,
+                                           tile ) ) {
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+bool checkFindFitPatchCanvas() {
+  std::mt19937 gen( 8 );
+  for ( size_t iter = 0; iter < 200; iter++ ) {
+    PCCPatch           patch;
+    PCCOccupancyCanvas canvas;
+    std::vector<bool>  expectedCanvas;
+    size_t             canvasStrideBlk, canvasHeightBlk;
+    Tile               tile;
+    generatePacking( gen, patch, canvas, expectedCanvas, canvasStrideBlk, canvasHeightBlk, tile );
+    std::vector<size_t> orientations = {0, 1, 2, 3, 4, 5, 6, 7};
+    std::shuffle( orientations.begin(), orientations.end(), gen );
+    orientations.resize( 1 + gen() % orientations.size() );
+    const bool bPrecedence = gen() % 2 == 0;
+    const int  safeguard   = int( gen() % 3 );
+    PCCPatch   expected    = patch;
+    const bool expectedFit = referenceFindFitPatchCanvas( expected, expectedCanvas, canvasStrideBlk, canvasHeightBlk,
+                                                          bPrecedence, orientations, safeguard, tile );
+    for ( size_t nbThread : {1, 4} ) {
+      const bool fit = patch.findFitPatchCanvas( canvas, canvasStrideBlk, canvasHeightBlk, bPrecedence, orientations,
+                                                 safeguard, tile, nbThread );
+      if ( fit != expectedFit ||
+           ( fit && ( patch.getU0() != expected.getU0() || patch.getV0() != expected.getV0() ||
+                      patch.getPatchOrientation() != expected.getPatchOrientation() ) ) ) {
+        printf( "  find fit patch canvas: canvas %zu nbThread %zu: fit %d ( %zu, %zu, %zu ) / %d ( %zu, %zu, %zu ) \n",
+                iter, nbThread, fit, patch.getU0(), patch.getV0(), patch.getPatchOrientation(), expectedFit,
+                expected.getU0(), expected.getV0(), expected.getPatchOrientation() );
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+// :: Checks
+
+int main( int argc, char* argv[] ) {
+  std::cout << "PccAppEquivalence v" << TMC2_VERSION_MAJOR << "." << TMC2_VERSION_MINOR << std::endl << std::endl;
+  const std::vector<std::pair<std::string, bool ( * )()>> checks = {
+      {"bitstream reads, writes and Exp-Golomb codes", checkBitstream},
+      {"point set duplicate removal and reordering", checkPointSetSort},
+      {"grid-based segmentation cells", checkGridCells},
+      {"voxel grid against kd-tree", checkVoxelGrid},
+      {"batched kNN and radius queries", checkBatchedSearch},
+      {"closed-form eigen solver", checkEigenSolver},
+      {"patch fit tests on the occupancy canvas", checkFitPatchCanvas},
+      {"patch placement search on the occupancy canvas", checkFindFitPatchCanvas}};
+  int ret = 0;
+  for ( const auto& check : checks ) {
+    const bool pass = check.second();
+    printf( "%s: %s \n", pass ? "PASS" : "FAIL", check.first.c_str() );
+    if ( !pass ) { ret = -1; }
+  }
+  return ret;
+}
@@ -56,6 +56,12 @@ static std::istream& operator>>( std::istream& in, PCCNormalsGeneratorOrientatio
   val = PCCNormalsGeneratorOrientation( tmp );
   return in;
 }
+static std::istream& operator>>( std::istream& in, PCCNormalsGeneratorEigenSolver& val ) {
+  unsigned int tmp;
+  in >> tmp;
+  val = PCCNormalsGeneratorEigenSolver( tmp );
+  return in;
+}
 }  // namespace pcc
 
 //---------------------------------------------------------------------------
@@ -196,6 +202,10 @@ bool parseParameters( int                             argc,
       normalParams.orientationStrategy_,
       normalParams.orientationStrategy_,
       "(0)NONE, (1)SPANNING TREE, (2)VIEWPOINT, (3)CUBEMAP PROJECTION" )
+    ( "eigenSolver",
+      normalParams.eigenSolver_,
+      normalParams.eigenSolver_,
+      "(0)ITERATIVE (reference), (1)CLOSED FORM" )
     ( "storeEigenvalues",normalParams.storeEigenvalues_,
       normalParams.storeEigenvalues_,
       "Store Eigenvalues (0)false/(1)true" )
@@ -224,6 +234,10 @@ bool parseParameters( int                             argc,
   if ( dstPlyPath.empty() ) {
     dstPlyPath = uncompressedDataFolder + uncompressedDataPath.substr( 0, uncompressedDataPath.size() - 4 ) + "_n.ply";
   }
+  if ( normalParams.eigenSolver_ > PCC_NORMALS_GENERATOR_EIGEN_SOLVER_CLOSED_FORM ) {
+    std::cerr << "WARNING: the normal eigen solver is out of the possible range [0;1]\n";
+    normalParams.eigenSolver_ = PCC_NORMALS_GENERATOR_EIGEN_SOLVER_ITERATIVE;
+  }
 
   printf( "parseParameters : \n" );
   printf( "  srcPlyPath   = %s \n", srcPlyPath.c_str() );
@@ -247,6 +261,7 @@ bool parseParameters( int                             argc,
   printf( "    numberOfIterationsInNormalSmoothing             = %zu \n",
           normalParams.numberOfIterationsInNormalSmoothing_ );
   printf( "    orientationStrategy                             = %u \n", normalParams.orientationStrategy_ );
+  printf( "    eigenSolver                                     = %u \n", normalParams.eigenSolver_ );
   printf( "    storeEigenvalues                                = %u \n", normalParams.storeEigenvalues_ );
   printf( "    storeNumberOfNearestNeighborsInNormalEstimation = %u \n",
           normalParams.storeNumberOfNearestNeighborsInNormalEstimation_ );
@@ -313,7 +328,8 @@ int main( int argc, char* argv[] ) {
                                                  PCC_NORMALS_GENERATOR_ORIENTATION_SPANNING_TREE,
                                                  false,
                                                  false,
-                                                 false};  // default values
+                                                 false,
+                                                 PCC_NORMALS_GENERATOR_EIGEN_SOLVER_ITERATIVE};  // default values
   if ( !parseParameters( argc, argv, uncompressedDataPath, reconstructedDataPath, startFrameNumber, frameCount,
                          nbThread, normalParams ) ) {
     return -1;
@@ -35,6 +35,7 @@
 #define PCC_BITSTREAM_BITSTREAM_H
 
 #include "PCCBitstreamCommon.h"
+#include "PCCMappedFile.h"
 
 namespace pcc {
 
@@ -161,9 +162,15 @@ class PCCBitstream {
   bool initialize( std::vector<uint8_t>& data );
   bool initialize( const PCCBitstream& bitstream );
   bool initialize( const std::string& compressedStreamPath );
-  void initialize( uint64_t capacity ) { data_.resize( capacity, 0 ); }
+  void initialize( uint64_t capacity ) {
+    materialize();
+    data_.resize( capacity, 0 );
+  }
   void clear() {
     data_.clear();
+    mapping_.reset();
+    view_     = nullptr;
+    viewSize_ = 0;
     position_.bits_  = 0;
     position_.bytes_ = 0;
   }
@@ -172,10 +179,16 @@ class PCCBitstream {
     position_.bytes_ = 0;
   }
   bool                  write( const std::string& compressedStreamPath );
-  uint8_t*              buffer() { return data_.data(); }
-  std::vector<uint8_t>& vector() { return data_; }
+  uint8_t*              buffer() {
+    materialize();
+    return data_.data();
+  }
+  std::vector<uint8_t>& vector() {
+    materialize();
+    return data_;
+  }
   uint64_t&             size() { return position_.bytes_; }
-  uint64_t              capacity() { return data_.size(); }
+  uint64_t              capacity() { return dataSize(); }
   PCCBistreamPosition   getPosition() { return position_; }
   void                  setPosition( PCCBistreamPosition& val ) { position_ = val; }
   PCCBitstream&         operator+=( const uint64_t size ) {
@@ -187,7 +200,7 @@ class PCCBitstream {
   void writeVideoStream( PCCVideoBitstream& videoBitstream );
   void readVideoStream( PCCVideoBitstream& videoBitstream, size_t videoStreamSize );
   bool byteAligned() { return ( position_.bits_ == 0 ); }
-  bool moreData() { return position_.bytes_ < data_.size(); }
+  bool moreData() { return position_.bytes_ < dataSize(); }
   void computeMD5();
 
   inline std::string readString() {
@@ -207,7 +220,7 @@ class PCCBitstream {
     write( 0, 8 );
   }
 
-  inline uint32_t peekByteAt( uint64_t peekPos ) { return data_[peekPos]; }
+  inline uint32_t peekByteAt( uint64_t peekPos ) { return data()[peekPos]; }
   inline uint32_t read( uint8_t bits, bool bFullStream = false ) {
     uint32_t code = read( bits, position_ );
 #ifdef BITSTREAM_TRACE
@@ -268,13 +281,14 @@ class PCCBitstream {
     bool     traceStartingValue = trace_;
     trace_                      = false;
 #endif
-    uint32_t length = 1, temp = ++code;
-    while ( 1 != temp ) {
-      temp >>= 1;
-      length += 2;
+    // the prefix zeros are the leading bits of the code written on 2 * length + 1 bits
+    uint32_t length = static_cast<uint32_t>( floorLog2( ++code ) );
+    if ( 2 * length + 1 <= 32 ) {
+      write( code, 2 * length + 1 );
+    } else {
+      write( 0, length );
+      write( code, length + 1 );
     }
-    write( 0, length >> 1 );
-    write( code, ( length + 1 ) >> 1 );
 #ifdef BITSTREAM_TRACE
     trace_ = traceStartingValue;
     trace( "  CodeUvlc: %4zu \n", orgCode );
@@ -286,16 +300,21 @@ class PCCBitstream {
     bool traceStartingValue = trace_;
     trace_                  = false;
 #endif
-    uint32_t value = 0, code = 0, length = 0;
-    code = read( 1 );
-    if ( 0 == code ) {
-      length = 0;
-      while ( !( code & 1 ) ) {
-        code = read( 1 );
-        length++;
-      }
-      value = read( length );
-      value += ( 1 << length ) - 1;
+    // the prefix length is the leading zero count of the next 32 bits: the code of a 32-bit value has at most 31
+    // leading zeros, more zeros only come from a truncated or corrupted stream (reads past the end return 0)
+    uint32_t value = 0, length = 0, word = peek( 32 );
+    if ( word == 0 ) {
+      fprintf( stderr, "ERROR: uvlc code with more than 31 leading zeros at byte %zu \n",
+               static_cast<size_t>( position_.bytes_ ) );
+      assert( 0 );
+      exit( -1 );
+    }
+    length = 31 - static_cast<uint32_t>( floorLog2( word ) );
+    if ( 2 * length + 1 <= 32 ) {
+      value = read( 2 * length + 1 ) - 1;
+    } else {
+      read( length + 1 );
+      value = read( length ) + ( 1 << length ) - 1;
     }
 #ifdef BITSTREAM_TRACE
     trace_ = traceStartingValue;
@@ -348,36 +367,53 @@ class PCCBitstream {
   void setLogger( PCCLogger& logger ) { logger_ = &logger; }
 #endif
  private:
+  // a mapped bitstream reads the bytes of its file mapping in place and is copied to data_ before any write
+  inline const uint8_t* data() const { return view_ != nullptr ? view_ : data_.data(); }
+  inline uint64_t       dataSize() const { return view_ != nullptr ? viewSize_ : data_.size(); }
+  inline void           materialize() {
+    if ( view_ != nullptr ) {
+      data_.assign( view_, view_ + viewSize_ );
+      mapping_.reset();
+      view_     = nullptr;
+      viewSize_ = 0;
+    }
+  }
   inline void realloc( const size_t size = 4096 ) { data_.resize( data_.size() + ( ( ( size / 4096 ) + 1 ) * 4096 ) ); }
+  // reads and writes operate on the 1 to 5 bytes covered by the bits, gathered MSB first in a 64-bit word
   inline uint32_t read( uint8_t bits, PCCBistreamPosition& pos ) {
-    uint32_t value = 0;
-    for ( size_t i = 0; i < bits; i++ ) {
-      value |= ( ( data_[pos.bytes_] >> ( 7 - pos.bits_ ) ) & 1 ) << ( bits - 1 - i );
-      if ( pos.bits_ == 7 ) {
-        pos.bytes_++;
-        pos.bits_ = 0;
-      } else {
-        pos.bits_++;
-      }
-    }
+    if ( bits == 0 ) { return 0; }
+    const size_t   count = ( pos.bits_ + bits + 7 ) >> 3;
+    const uint8_t* data  = this->data();
+    const size_t   end   = ( std::min )( pos.bytes_ + count, dataSize() );
+    uint64_t       word  = 0;
+    for ( size_t i = pos.bytes_, shift = 56; i < end; i++, shift -= 8 ) { word |= uint64_t( data[i] ) << shift; }
+    const uint32_t value = static_cast<uint32_t>( ( word << pos.bits_ ) >> ( 64 - bits ) );
+    pos.bytes_ += ( pos.bits_ + bits ) >> 3;
+    pos.bits_ = ( pos.bits_ + bits ) & 7;
     return value;
   }
 
+  inline uint32_t peek( uint8_t bits ) {
+    PCCBistreamPosition pos = position_;
+    return read( bits, pos );
+  }
+
   inline void write( uint32_t value, uint8_t bits, PCCBistreamPosition& pos ) {
+    materialize();
     if ( pos.bytes_ + bits + 16 >= data_.size() ) { realloc(); }
-    for ( size_t i = 0; i < bits; i++ ) {
-      data_[pos.bytes_] |= ( ( value >> ( bits - 1 - i ) ) & 1 ) << ( 7 - pos.bits_ );
-      if ( pos.bits_ == 7 ) {
-        pos.bytes_++;
-        pos.bits_ = 0;
-      } else {
-        pos.bits_++;
-      }
-    }
+    if ( bits == 0 ) { return; }
+    const size_t   count = ( pos.bits_ + bits + 7 ) >> 3;
+    const uint64_t word  = ( uint64_t( value ) & ( ( uint64_t( 1 ) << bits ) - 1 ) ) << ( 64 - pos.bits_ - bits );
+    for ( size_t i = 0; i < count; i++ ) { data_[pos.bytes_ + i] |= uint8_t( word >> ( 56 - 8 * i ) ); }
+    pos.bytes_ += ( pos.bits_ + bits ) >> 3;
+    pos.bits_ = ( pos.bits_ + bits ) & 7;
   }
 
-  std::vector<uint8_t> data_;
-  PCCBistreamPosition  position_;
+  std::vector<uint8_t>           data_;
+  PCCBistreamPosition            position_;
+  std::shared_ptr<PCCMappedFile> mapping_;
+  const uint8_t*                 view_     = nullptr;
+  uint64_t                       viewSize_ = 0;
 
 #if defined(CONFORMANCE_TRACE) || defined(BITSTREAM_TRACE)
   bool       trace_;
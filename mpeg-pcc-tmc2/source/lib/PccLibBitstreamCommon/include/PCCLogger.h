@@ -90,7 +90,7 @@ static const std::string get( PCCLoggerType type ) {
 
 class PCCVirtualLogger {
  public:
-  PCCVirtualLogger() : file_( NULL ), disable_( false ) {}
+  PCCVirtualLogger() : file_( NULL ), disable_( false ), buffered_( false ) {}
   ~PCCVirtualLogger() { close(); }
   bool initialize( PCCLoggerType type, std::string& filename, bool encoder, size_t atlasId = 0 ) {
     std::string str = get( type );
@@ -101,12 +101,26 @@ class PCCVirtualLogger {
   inline bool isInitialized() { return file_ != NULL; }
   inline void disable() { disable_ = true; }
   inline void enable() { disable_ = false; }
+  inline void setBuffered( bool buffered ) { buffered_ = buffered; }
+  inline bool isBuffered() { return buffered_; }
+  inline std::string& getBuffer() { return buffer_; }
   template <typename... Args>
   inline void trace( const char* format, Args... eArgs ) {
-    if ( file_ && !disable_ ) { fprintf( file_, format, eArgs... ); }
+    if ( disable_ ) { return; }
+    if ( buffered_ ) {
+      int size = snprintf( nullptr, 0, format, eArgs... );
+      if ( size > 0 ) {
+        size_t pos = buffer_.size();
+        buffer_.resize( pos + size + 1 );
+        snprintf( &buffer_[pos], size + 1, format, eArgs... );
+        buffer_.resize( pos + size );
+      }
+    } else if ( file_ ) {
+      fprintf( file_, format, eArgs... );
+    }
   }
   inline void flush() {
-    if ( !disable_ ) { fflush( file_ ); }
+    if ( file_ && !disable_ ) { fflush( file_ ); }
   }
 
  private:
@@ -118,8 +132,10 @@ class PCCVirtualLogger {
     close();
     return ( ( file_ = fopen( name.c_str(), "w+" ) ) != NULL );
   }
-  FILE* file_;
-  bool  disable_;
+  FILE*       file_;
+  bool        disable_;
+  bool        buffered_;
+  std::string buffer_;
 };
 
 class PCCLogger {
@@ -134,8 +150,25 @@ class PCCLogger {
   void         disable( PCCLoggerType type ) { logger_[type].disable(); }
   std::string& getLoggerBaseFileName() { return filename_; }
 
+  // A buffered logger keeps the traces in memory, so that the traces of concurrent tasks can be appended in order
+  // to the logger writing the files.
+  void setBuffered( bool buffered ) {
+    for ( auto& logger : logger_ ) { logger.setBuffered( buffered ); }
+  }
+  void append( PCCLogger& logger ) {
+    for ( size_t type = 0; type < logger.logger_.size(); type++ ) {
+      auto& buffer = logger.logger_[type].getBuffer();
+      if ( !buffer.empty() ) { trace( static_cast<PCCLoggerType>( type ), "%s", buffer.c_str() ); }
+      buffer.clear();
+    }
+  }
+
   template <typename... Args>
   inline void trace( PCCLoggerType type, const char* format, Args... args ) {
+    if ( logger_[type].isBuffered() ) {
+      logger_[type].trace( format, args... );
+      return;
+    }
     if ( !logger_[type].isInitialized() ) { logger_[type].initialize( type, filename_, encoder_ ); }
     if ( logger_[type].isInitialized() ) {
       logger_[type].trace( format, args... );
@@ -47,7 +47,7 @@ typedef struct PointLocalReconstructionMode {
 // 8.3.6.1.2 Point local reconstruction information syntax
 class PLRInformation {
  public:
-  PLRInformation() : numberOfModesMinus1_( 0 ), blockThresholdPerPatchMinus1_( 0 ) {
+  PLRInformation() : mapEnabledFlag_( false ), numberOfModesMinus1_( 0 ), blockThresholdPerPatchMinus1_( 0 ) {
     minimumDepth_.clear();
     neighbourMinus1_.clear();
     interpolateFlag_.clear();
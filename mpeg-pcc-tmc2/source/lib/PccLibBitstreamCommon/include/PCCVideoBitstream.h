@@ -35,6 +35,7 @@
 #define PCC_BITSTREAM_VIDEOBITSTREAM_H
 
 #include "PCCBitstreamCommon.h"
+#include "PCCMappedFile.h"
 namespace pcc {
 
 class PCCVideoBitstream {
@@ -43,11 +44,28 @@ class PCCVideoBitstream {
   ~PCCVideoBitstream() { data_.clear(); }
 
   PCCVideoBitstream&    operator=( const PCCVideoBitstream& ) = default;
-  void                  resize( size_t size ) { data_.resize( size ); }
-  std::vector<uint8_t>& vector() { return data_; }
-  uint8_t*              buffer() { return data_.data(); }
-  size_t                size() { return data_.size(); }
-  PCCVideoType          type() { return type_; }
+  void                  resize( size_t size ) {
+    materialize();
+    data_.resize( size );
+  }
+  std::vector<uint8_t>& vector() {
+    materialize();
+    return data_;
+  }
+  uint8_t* buffer() {
+    materialize();
+    return data_.data();
+  }
+  size_t       size() { return view_ != nullptr ? viewSize_ : data_.size(); }
+  PCCVideoType type() { return type_; }
+
+  // references the bytes of a mapped V3C bitstream until the sub-stream is converted or modified
+  void setView( const std::shared_ptr<PCCMappedFile>& mapping, const uint8_t* data, size_t size ) {
+    data_.clear();
+    mapping_  = mapping;
+    view_     = data;
+    viewSize_ = size;
+  }
 
   void trace() { std::cout << "      " << toString( type_ ) << " ->" << size() << " B " << std::endl; }
 
@@ -68,9 +86,24 @@ class PCCVideoBitstream {
                                  bool   changeStartCodeSize      = true );
 
  private:
-  size_t               getEndOfNaluPosition( size_t startIndex );
-  std::vector<uint8_t> data_;
-  PCCVideoType         type_;
+  size_t         getEndOfNaluPosition( size_t startIndex );
+  const uint8_t* data() const { return view_ != nullptr ? view_ : data_.data(); }
+  void           materialize() {
+    if ( view_ != nullptr ) {
+      data_.assign( view_, view_ + viewSize_ );
+      release();
+    }
+  }
+  void release() {
+    mapping_.reset();
+    view_     = nullptr;
+    viewSize_ = 0;
+  }
+  std::vector<uint8_t>           data_;
+  PCCVideoType                   type_;
+  std::shared_ptr<PCCMappedFile> mapping_;
+  const uint8_t*                 view_     = nullptr;
+  size_t                         viewSize_ = 0;
 };
 
 }  // namespace pcc
@@ -49,22 +49,35 @@ PCCBitstream::PCCBitstream() {
 PCCBitstream::~PCCBitstream() { data_.clear(); }
 
 bool PCCBitstream::initialize( const PCCBitstream& bitstream ) {
-  position_.bytes_ = 0;
-  position_.bits_  = 0;
+  clear();
+  if ( bitstream.view_ != nullptr ) {
+    mapping_  = bitstream.mapping_;
+    view_     = bitstream.view_;
+    viewSize_ = bitstream.viewSize_;
+    return true;
+  }
   data_.resize( bitstream.data_.size(), 0 );
   memcpy( data_.data(), bitstream.data_.data(), bitstream.data_.size() );
   return true;
 }
 
 bool PCCBitstream::initialize( std::vector<uint8_t>& data ) {
-  position_.bytes_ = 0;
-  position_.bits_  = 0;
+  clear();
   data_.resize( data.size(), 0 );
   memcpy( data_.data(), data.data(), data.size() );
   return true;
 }
 
 bool PCCBitstream::initialize( const std::string& compressedStreamPath ) {
+  clear();
+  // the file is mapped when possible and read in memory otherwise
+  auto mapping = std::make_shared<PCCMappedFile>();
+  if ( mapping->open( compressedStreamPath ) ) {
+    mapping_  = mapping;
+    view_     = mapping->data();
+    viewSize_ = mapping->size();
+    return true;
+  }
   std::ifstream fin( compressedStreamPath, std::ios::binary );
   if ( !fin.is_open() ) { return false; }
   fin.seekg( 0, std::ios::end );
@@ -80,7 +93,7 @@ bool PCCBitstream::initialize( const std::string& compressedStreamPath ) {
 bool PCCBitstream::write( const std::string& compressedStreamPath ) {
   std::ofstream fout( compressedStreamPath, std::ios::binary );
   if ( !fout.is_open() ) { return false; }
-  fout.write( reinterpret_cast<const char*>( data_.data() ), size() );
+  fout.write( reinterpret_cast<const char*>( data() ), size() );
   fout.close();
   return true;
 }
@@ -90,8 +103,12 @@ void PCCBitstream::readVideoStream( PCCVideoBitstream& videoBitstream, size_t vi
   trace( "%s \n", "Code: PCCVideoBitstream" );
   trace( "Code: size = %zu \n", videoStreamSize );
 #endif
-  videoBitstream.resize( videoStreamSize );
-  memcpy( videoBitstream.buffer(), data_.data() + position_.bytes_, videoStreamSize );
+  if ( view_ != nullptr ) {
+    videoBitstream.setView( mapping_, view_ + position_.bytes_, videoStreamSize );
+  } else {
+    videoBitstream.resize( videoStreamSize );
+    memcpy( videoBitstream.buffer(), data_.data() + position_.bytes_, videoStreamSize );
+  }
   videoBitstream.trace();
   position_.bytes_ += videoStreamSize;
 }
@@ -102,6 +119,7 @@ void PCCBitstream::writeVideoStream( PCCVideoBitstream& videoBitstream ) {
 #endif
   uint8_t* data = videoBitstream.buffer();
   size_t   size = videoBitstream.size();
+  materialize();
   realloc( size );
 #ifdef BITSTREAM_TRACE
   trace( "Code: size = %zu \n", size );
@@ -111,8 +129,16 @@ void PCCBitstream::writeVideoStream( PCCVideoBitstream& videoBitstream ) {
   videoBitstream.trace();
 }
 void PCCBitstream::copyFrom( PCCBitstream& srcBitstream, const size_t position, const size_t size ) {
-  if ( data_.size() < position_.bytes_ + size ) { data_.resize( position_.bytes_ + size ); }
-  memcpy( data_.data() + position_.bytes_, srcBitstream.buffer() + position, size ); 
+  if ( srcBitstream.view_ != nullptr && view_ == nullptr && data_.empty() && position_.bytes_ == 0 ) {
+    // an empty bitstream references the bytes of a mapped source instead of copying them
+    mapping_  = srcBitstream.mapping_;
+    view_     = srcBitstream.view_ + position;
+    viewSize_ = size;
+  } else {
+    materialize();
+    if ( data_.size() < position_.bytes_ + size ) { data_.resize( position_.bytes_ + size ); }
+    memcpy( data_.data() + position_.bytes_, srcBitstream.data() + position, size );
+  }
   position_.bytes_ += size; 
   auto pos = srcBitstream.getPosition();
   pos.bytes_ += size; 
@@ -120,8 +146,15 @@ void PCCBitstream::copyFrom( PCCBitstream& srcBitstream, const size_t position,
 }
 
 void PCCBitstream::copyTo( PCCBitstream& dstBitstream, const size_t size ) {
-  dstBitstream.initialize( dstBitstream.position_.bytes_ + size );
-  memcpy( dstBitstream.buffer() + dstBitstream.position_.bytes_, data_.data() + position_.bytes_, size );
+  if ( view_ != nullptr && dstBitstream.view_ == nullptr && dstBitstream.data_.empty() &&
+       dstBitstream.position_.bytes_ == 0 ) {
+    dstBitstream.mapping_  = mapping_;
+    dstBitstream.view_     = view_ + position_.bytes_;
+    dstBitstream.viewSize_ = size;
+  } else {
+    dstBitstream.initialize( dstBitstream.position_.bytes_ + size );
+    memcpy( dstBitstream.buffer() + dstBitstream.position_.bytes_, data() + position_.bytes_, size );
+  }
   position_.bytes_ += size;
 }
 
@@ -129,9 +162,9 @@ void PCCBitstream::computeMD5() {
   MD5                  md5Hash;
   std::vector<uint8_t> tmp_digest;
   tmp_digest.resize( 16 );
-  size_t dataSize = size() == 0 ? data_.size() : size();
+  size_t dataSize = size() == 0 ? this->dataSize() : size();
   TRACE_BITSTRMD5( "%s", "BITSTRMD5 = " )
-  md5Hash.update( data_.data(), dataSize );
+  md5Hash.update( const_cast<uint8_t*>( data() ), dataSize );
   md5Hash.finalize( tmp_digest.data() );
   for ( auto& bitStr : tmp_digest ) TRACE_BITSTRMD5( "%02x", bitStr );
   std::cout << std::endl;
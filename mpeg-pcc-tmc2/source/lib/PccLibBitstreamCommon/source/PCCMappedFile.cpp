@@ -0,0 +1,100 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "PCCBitstreamCommon.h"
+#include "PCCMappedFile.h"
+#if !defined( WIN32 ) && HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace pcc;
+
+bool PCCMappedFile::open( const std::string& filename ) {
+  close();
+#if defined( WIN32 )
+  file_ = CreateFileA( filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                       FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+  if ( file_ == INVALID_HANDLE_VALUE ) { return false; }
+  LARGE_INTEGER fileSize;
+  if ( GetFileSizeEx( file_, &fileSize ) == 0 || fileSize.QuadPart == 0 ) {
+    close();
+    return false;
+  }
+  mapping_ = CreateFileMappingA( file_, nullptr, PAGE_READONLY, 0, 0, nullptr );
+  if ( mapping_ == nullptr ) {
+    close();
+    return false;
+  }
+  data_ = static_cast<const uint8_t*>( MapViewOfFile( mapping_, FILE_MAP_READ, 0, 0, 0 ) );
+  if ( data_ == nullptr ) {
+    close();
+    return false;
+  }
+  size_ = static_cast<size_t>( fileSize.QuadPart );
+  return true;
+#elif HAVE_MMAP
+  int fd = ::open( filename.c_str(), O_RDONLY );
+  if ( fd < 0 ) { return false; }
+  struct stat fileStat;
+  if ( fstat( fd, &fileStat ) != 0 || fileStat.st_size <= 0 ) {
+    ::close( fd );
+    return false;
+  }
+  void* data = mmap( nullptr, static_cast<size_t>( fileStat.st_size ), PROT_READ, MAP_PRIVATE, fd, 0 );
+  ::close( fd );
+  if ( data == MAP_FAILED ) { return false; }
+  // the bitstreams are parsed from the beginning to the end
+  madvise( data, static_cast<size_t>( fileStat.st_size ), MADV_SEQUENTIAL );
+  data_ = static_cast<const uint8_t*>( data );
+  size_ = static_cast<size_t>( fileStat.st_size );
+  return true;
+#else
+  return false;
+#endif
+}
+
+void PCCMappedFile::close() {
+#if defined( WIN32 )
+  if ( data_ != nullptr ) { UnmapViewOfFile( data_ ); }
+  if ( mapping_ != nullptr ) { CloseHandle( mapping_ ); }
+  if ( file_ != INVALID_HANDLE_VALUE ) { CloseHandle( file_ ); }
+  mapping_ = nullptr;
+  file_    = INVALID_HANDLE_VALUE;
+#elif HAVE_MMAP
+  if ( data_ != nullptr ) { munmap( const_cast<uint8_t*>( data_ ), size_ ); }
+#endif
+  data_ = nullptr;
+  size_ = 0;
+}
@@ -60,19 +60,28 @@ std::string PCCVideoBitstream::getExtension() {
 bool PCCVideoBitstream::write( const std::string& filename ) {
   std::ofstream file( filename, std::ios::binary );
   if ( !file.good() ) { return false; }
-  file.write( reinterpret_cast<char*>( data_.data() ), data_.size() );
+  file.write( reinterpret_cast<const char*>( data() ), size() );
   file.close();
   return true;
 }
 
 bool PCCVideoBitstream::read( const std::string& filename ) {
-  std::ifstream file( filename, std::ios::binary | std::ios::ate );
+  std::ifstream file( filename, std::ios::binary );
   if ( !file.good() ) { return false; }
-  const uint64_t fileSize = file.tellg();
-  resize( (size_t)fileSize );
-  file.clear();
-  file.seekg( 0 );
-  file.read( reinterpret_cast<char*>( data_.data() ), data_.size() );
+  if ( file.seekg( 0, std::ios::end ) ) {
+    const uint64_t fileSize = file.tellg();
+    resize( (size_t)fileSize );
+    file.seekg( 0 );
+    file.read( reinterpret_cast<char*>( data_.data() ), data_.size() );
+  } else {
+    // non-seekable input (pipe): read until the end of the stream
+    file.clear();
+    resize( 0 );
+    char buffer[65536];
+    while ( file.read( buffer, sizeof( buffer ) ) || file.gcount() > 0 ) {
+      data_.insert( data_.end(), buffer, buffer + file.gcount() );
+    }
+  }
   file.close();
   return true;
 }
@@ -85,30 +94,33 @@ bool PCCVideoBitstream::_write( const std::string& filename ) { return write( fi
 void PCCVideoBitstream::byteStreamToSampleStream( size_t precision, bool emulationPreventionBytes ) {
   size_t               startIndex = 0, endIndex = 0;
   std::vector<uint8_t> data;
+  const uint8_t*       src     = this->data();
+  const size_t         srcSize = size();
   do {
-    size_t sizeStartCode = data_[startIndex + 2] == 0x00 ? 4 : 3;
+    size_t sizeStartCode = src[startIndex + 2] == 0x00 ? 4 : 3;
     endIndex             = getEndOfNaluPosition( startIndex + sizeStartCode );
     size_t headerIndex   = data.size();
     for ( size_t i = 0; i < precision; i++ ) { data.push_back( 0 ); }  // reserve nalu size
     if ( emulationPreventionBytes ) {
       for ( size_t i = startIndex + sizeStartCode, zeroCount = 0; i < endIndex; i++ ) {
-        if ( ( zeroCount == 3 ) && ( data_[i] <= 3 ) ) {
+        if ( ( zeroCount == 3 ) && ( src[i] <= 3 ) ) {
           zeroCount = 0;
         } else {
-          zeroCount = ( data_[i] == 0 ) ? zeroCount + 1 : 0;
-          data.push_back( data_[i] );
+          zeroCount = ( src[i] == 0 ) ? zeroCount + 1 : 0;
+          data.push_back( src[i] );
         }
       }
     } else {
-      for ( size_t i = startIndex + sizeStartCode; i < endIndex; i++ ) { data.push_back( data_[i] ); }
+      for ( size_t i = startIndex + sizeStartCode; i < endIndex; i++ ) { data.push_back( src[i] ); }
     }
     size_t naluSize = data.size() - ( headerIndex + precision );
     for ( size_t i = 0; i < precision; i++ ) {
       data[headerIndex + i] = ( naluSize >> ( 8 * ( precision - ( i + 1 ) ) ) ) & 0xff;
     }
     startIndex = endIndex;
-  } while ( endIndex < data_.size() );
+  } while ( endIndex < srcSize );
   data_.swap( data );
+  release();
 }
 
 void PCCVideoBitstream::sampleStreamToByteStream( bool   isAvc,
@@ -118,28 +130,30 @@ void PCCVideoBitstream::sampleStreamToByteStream( bool   isAvc,
                                                   bool   changeStartCodeSize ) {
   size_t               sizeStartCode = 4, startIndex = 0, endIndex = 0;
   std::vector<uint8_t> data;
+  const uint8_t*       src      = this->data();
+  const size_t         srcSize  = size();
   bool                 newFrame = true;
   printf( "isAvc = %d isVvc = %d \n", isAvc, isVvc );
   do {
     int32_t naluSize = 0;
-    for ( size_t i = 0; i < precision; i++ ) { naluSize = ( naluSize << 8 ) + data_[startIndex + i]; }
+    for ( size_t i = 0; i < precision; i++ ) { naluSize = ( naluSize << 8 ) + src[startIndex + i]; }
     endIndex = startIndex + precision + naluSize;
     for ( size_t i = 0; i < sizeStartCode - 1; i++ ) { data.push_back( 0 ); }
     data.push_back( 1 );
     if ( emulationPreventionBytes ) {
       for ( size_t i = startIndex + precision, zeroCount = 0; i < endIndex; i++ ) {
-        if ( zeroCount == 3 && data_[i] <= 0x03 ) {
+        if ( zeroCount == 3 && src[i] <= 0x03 ) {
           data.push_back( 0x03 );
           zeroCount = 0;
         }
-        zeroCount = ( data_[i] == 0x00 ) ? zeroCount + 1 : 0;
-        data.push_back( data_[i] );
+        zeroCount = ( src[i] == 0x00 ) ? zeroCount + 1 : 0;
+        data.push_back( src[i] );
       }
     } else {
-      for ( size_t i = startIndex + precision; i < endIndex; i++ ) { data.push_back( data_[i] ); }
+      for ( size_t i = startIndex + precision; i < endIndex; i++ ) { data.push_back( src[i] ); }
     }
     startIndex = endIndex;
-    if ( ( startIndex + precision ) < data_.size() ) {
+    if ( ( startIndex + precision ) < srcSize ) {
       int  naluType         = 0;
       bool useLongStartCode = false;
       newFrame              = false;
@@ -157,26 +171,28 @@ void PCCVideoBitstream::sampleStreamToByteStream( bool   isAvc,
       if ( isAvc ) {
         useLongStartCode = true;
       } else if ( isVvc ) {
-        naluType         = ( ( ( data_[startIndex + precision + 1] ) & 248 ) >> 3 );
+        naluType         = ( ( ( src[startIndex + precision + 1] ) & 248 ) >> 3 );
         useLongStartCode = newFrame || ( naluType >= 12 && naluType < 20 );
         if ( naluType < 12 ) { newFrame = true; }
       } else {
-        naluType         = ( ( ( data_[startIndex + precision] ) & 126 ) >> 1 );
+        naluType         = ( ( ( src[startIndex + precision] ) & 126 ) >> 1 );
         useLongStartCode = newFrame || ( naluType >= 32 && naluType < 41 );
         if ( naluType < 12 ) { newFrame = true; }
       }
       sizeStartCode = useLongStartCode ? 4 : 3;
     }
-  } while ( endIndex < data_.size() );
+  } while ( endIndex < srcSize );
   data_.swap( data );
+  release();
 }
 
 size_t PCCVideoBitstream::getEndOfNaluPosition( size_t startIndex ) {
-  const size_t size = data_.size();
+  const uint8_t* src  = data();
+  const size_t   size = this->size();
   if ( size < startIndex + 4 ) { return size; }
   for ( size_t i = startIndex; i < size - 4; i++ ) {
-    if ( ( data_[i + 0] == 0x00 ) && ( data_[i + 1] == 0x00 ) &&
-         ( ( data_[i + 2] == 0x01 ) || ( ( data_[i + 2] == 0x00 ) && ( data_[i + 3] == 0x01 ) ) ) ) {
+    if ( ( src[i + 0] == 0x00 ) && ( src[i + 1] == 0x00 ) &&
+         ( ( src[i + 2] == 0x01 ) || ( ( src[i + 2] == 0x00 ) && ( src[i + 3] == 0x01 ) ) ) ) {
       return i;
     }
   }
@@ -1408,7 +1408,7 @@ void PCCBitstreamReader::sampleStreamV3CUnit( PCCBitstream& bitstream, SampleStr
   v3cUnit.setSize( bitstream.read( 8 * ( ssvu.getSsvhUnitSizePrecisionBytesMinus1() + 1 ) ) );  // u(v)
   auto pos = bitstream.getPosition();
   v3cUnit.getBitstream().copyFrom( bitstream, (size_t)pos.bytes_, v3cUnit.getSize() );
-  uint8_t v3cUnitType8 = v3cUnit.getBitstream().buffer()[0];
+  uint8_t v3cUnitType8 = v3cUnit.getBitstream().peekByteAt( 0 );
   auto    v3cUnitType  = static_cast<V3CUnitType>( v3cUnitType8 >>= 3 );
   v3cUnit.setType( v3cUnitType );
   TRACE_BITSTREAM( "V3CUnitType: %hhu V3CUnitSize: %zu\n", v3cUnitType, v3cUnit.getSize() );
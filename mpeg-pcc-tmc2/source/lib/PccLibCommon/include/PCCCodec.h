@@ -186,6 +186,7 @@ class PCCCodec {
   void generateRawPointsAttributefromVideo( PCCContext& context, PCCFrameContext& tile, size_t frameIndex );
 
   void generateRawPointsGeometryfromVideo( PCCContext& context, size_t frameIndex );
+  // the raw points attribute video must already hold context.size() frames: the frames are processed concurrently
   void generateRawPointsAttributefromVideo( PCCContext& context, size_t frameIndex );
 
   void setLogger( PCCLogger& logger ) { logger_ = &logger; }
@@ -347,6 +348,9 @@ class PCCCodec {
   void smoothPointCloudGrid( PCCPointSet3&                       reconstruct,
                              const std::vector<uint32_t>&        partition,
                              const GeneratePointCloudParameters& params,
+                             std::vector<uint16_t>&              gridCount,
+                             std::vector<PCCVector3<float>>&     center,
+                             std::vector<bool>&                  doSmooth,
                              uint16_t                            gridWidth,
                              std::vector<int>&                   cellIndex );
 
@@ -379,12 +383,17 @@ class PCCCodec {
                            std::vector<PCCVector3<float>>&     colorCenterGrid,
                            std::vector<bool>&                  colorDoSmooth,
                            uint8_t                             gridSize,
+                           std::vector<std::vector<uint16_t>>& colorLum,
                            PCCVector3D&                        curPosColor,
                            const GeneratePointCloudParameters& params,
                            std::vector<int>&                   cellIndex );
 
   void smoothPointCloudColorLC( PCCPointSet3&                       reconstruct,
                                 const GeneratePointCloudParameters& params,
+                                std::vector<uint16_t>&              colorGridCount,
+                                std::vector<PCCVector3<float>>&     colorCenter,
+                                std::vector<bool>&                  colorDoSmooth,
+                                std::vector<std::vector<uint16_t>>& colorLum,
                                 std::vector<int>&                   cellIndex );
 
   bool gridFiltering( const std::vector<uint32_t>&    partition,
@@ -411,15 +420,6 @@ class PCCCodec {
 #ifdef CODEC_TRACE
   void printChecksum( PCCPointSet3& ePointcloud, std::string eString );
 #endif
-  std::vector<uint16_t>                  geoSmoothingCount_;
-  std::vector<PCCVector3<float>>         geoSmoothingCenter_;
-  std::vector<bool>                      geoSmoothingDoSmooth_;
-  std::vector<uint32_t>                  geoSmoothingPartition_;
-  std::vector<uint16_t>                  colorSmoothingCount_;
-  std::vector<PCCVector3<float>>         colorSmoothingCenter_;
-  std::vector<bool>                      colorSmoothingDoSmooth_;
-  std::vector<std::pair<size_t, size_t>> colorSmoothingPartition_;
-  std::vector<std::vector<uint16_t>>     colorSmoothingLum_;
 };
 
 };  // namespace pcc
@@ -90,6 +90,7 @@ enum PCCColorTransform { COLOR_TRANSFORM_NONE = 0, COLOR_TRANSFORM_RGB_TO_YCBCR
 enum PCCPointType { POINT_UNSET = 0, POINT_D0, POINT_D1, POINT_DF, POINT_SMOOTH, POINT_EOM, POINT_RAW };
 enum { COLOURFORMAT420 = 0, COLOURFORMAT444 = 1 };
 enum PCCCOLORFORMAT { UNKNOWN = 0, RGB444, YUV444, YUV420 };
+enum PCCSpatialIndexType { SPATIAL_INDEX_KDTREE = 0, SPATIAL_INDEX_VOXEL_GRID = 1 };
 enum PCCCodecId {
 #ifdef USE_JMAPP_VIDEO_CODEC
   JMAPP = 0,
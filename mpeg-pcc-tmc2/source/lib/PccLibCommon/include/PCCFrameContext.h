@@ -36,6 +36,7 @@
 #include "PCCCommon.h"
 
 #include "PCCPointSet.h"
+#include "PCCKdTree.h"
 #include "PCCPatch.h"
 #include "PCCContext.h"
 
@@ -560,6 +561,12 @@ class PCCAtlasFrameContext {
 
   std::vector<int>& getPartitionToTileMap() { return partitionToTileMap_; }
 
+  // spatial indices of the source and reconstructed point clouds of the frame, reused by the encoder stages. The
+  // source tree is kept from the segmentation to its last search (attribute transfer, or geometry padding without
+  // attributes), so a group of frames holds one tree per frame in between.
+  PCCSharedKdTree& getSourceKdTree() { return sourceKdTree_; }
+  PCCSharedKdTree& getReconstructKdTree() { return reconstructKdTree_; }
+
  private:
   size_t                       atlasFrameIndex_;
   size_t                       atlasFrameWidth_;
@@ -581,6 +588,8 @@ class PCCAtlasFrameContext {
   std::vector<PCCFrameContext> tileContexts_;
   std::vector<int>             partitionToTileMap_;
   PCCFrameContext              titleFrameContext_;
+  PCCSharedKdTree              sourceKdTree_;
+  PCCSharedKdTree              reconstructKdTree_;
 };
 
 };  // namespace pcc
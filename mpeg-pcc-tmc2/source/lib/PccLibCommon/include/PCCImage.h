@@ -65,6 +65,10 @@ class PCCImage {
   void clear() {
     for ( auto& channel : channels_ ) { channel.clear(); }
   }
+  // frees the samples, the size and the format of the image are kept
+  void release() {
+    for ( auto& channel : channels_ ) { std::vector<T>().swap( channel ); }
+  }
   size_t                getWidth() const { return width_; }
   size_t                getHeight() const { return height_; }
   PCCCOLORFORMAT        getColorFormat() const { return format_; }
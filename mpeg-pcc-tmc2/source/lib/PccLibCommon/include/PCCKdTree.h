@@ -1,103 +1,176 @@
-/* The copyright in this software is being made available under the BSD
- * License, included below. This software may be subject to other third party
- * and contributor rights, including patent rights, and no such rights are
- * granted under this license.
- *
- * Copyright (c) 2010-2017, ISO/IEC
- * All rights reserved.
- *
- * Redistribution and use in source and binary forms, with or without
- * modification, are permitted provided that the following conditions are met:
- *
- *  * Redistributions of source code must retain the above copyright notice,
- *    this list of conditions and the following disclaimer.
- *  * Redistributions in binary form must reproduce the above copyright notice,
- *    this list of conditions and the following disclaimer in the documentation
- *    and/or other materials provided with the distribution.
- *  * Neither the name of the ISO/IEC nor the names of its contributors may
- *    be used to endorse or promote products derived from this software without
- *    specific prior written permission.
- *
- * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
- * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
- * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
- * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
- * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
- * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
- * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
- * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
- * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
- * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
- * THE POSSIBILITY OF SUCH DAMAGE.
- */
-#ifndef PCCKdTree_h
-#define PCCKdTree_h
-
-#include "PCCCommon.h"
-#include "PCCPointSet.h"
-
-namespace pcc {
-
-struct PCCNNQuery3 {
-  PCCPoint3D point;
-  double     radius;
-  size_t     nearestNeighborCount;
-};
-
-class PCCNNResult {
- public:
-  PCCNNResult() = default;
-  ~PCCNNResult() {
-    indices_.clear();
-    dist_.clear();
-  }
-  inline void resize( const size_t size ) {
-    indices_.resize( size );
-    dist_.resize( size );
-  }
-  inline void reserve( const size_t size ) {
-    indices_.reserve( size );
-    dist_.reserve( size );
-  }
-  inline size_t size() const {
-    assert( indices_.size() == dist_.size() );
-    return indices_.size();
-  }
-  inline size_t  count() const { return size(); }
-  inline size_t& indices( size_t index ) { return indices_[index]; }
-  inline double& dist( size_t index ) { return dist_[index]; }
-  inline size_t* indices() { return indices_.data(); }
-  inline double* dist() { return dist_.data(); }
-  inline void    pushBack( const std::pair<size_t, double>& value ) {
-    indices_.push_back( value.first );
-    dist_.push_back( value.second );
-  }
-  inline void popBack() {
-    indices_.pop_back();
-    dist_.pop_back();
-  }
-
- private:
-  std::vector<size_t> indices_;
-  std::vector<double> dist_;
-};
-
-class PCCKdTree {
- public:
-  PCCKdTree();
-  PCCKdTree( const PCCPointSet3& pointCloud );
-  ~PCCKdTree();
-  void init( const PCCPointSet3& pointCloud );
-  void search( const PCCPoint3D& point, const size_t num_results, PCCNNResult& results ) const;
-  void searchRadius( const PCCPoint3D& point,
-                     const size_t      num_results,
-                     const double      radius,
-                     PCCNNResult&      results ) const;
-
- private:
-  void  clear();
-  void* kdtree_;
-};
-
-}  // namespace pcc
-#endif /* PCCKdTree_h */
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCCKdTree_h
+#define PCCKdTree_h
+
+#include "PCCCommon.h"
+#include "PCCPointSet.h"
+
+namespace pcc {
+
+struct PCCNNQuery3 {
+  PCCPoint3D point;
+  double     radius;
+  size_t     nearestNeighborCount;
+};
+
+class PCCNNResult {
+ public:
+  PCCNNResult() = default;
+  ~PCCNNResult() {
+    indices_.clear();
+    dist_.clear();
+  }
+  inline void resize( const size_t size ) {
+    indices_.resize( size );
+    dist_.resize( size );
+  }
+  inline void reserve( const size_t size ) {
+    indices_.reserve( size );
+    dist_.reserve( size );
+  }
+  inline size_t size() const {
+    assert( indices_.size() == dist_.size() );
+    return indices_.size();
+  }
+  inline size_t  count() const { return size(); }
+  inline size_t& indices( size_t index ) { return indices_[index]; }
+  inline double& dist( size_t index ) { return dist_[index]; }
+  inline size_t* indices() { return indices_.data(); }
+  inline double* dist() { return dist_.data(); }
+  inline void    pushBack( const std::pair<size_t, double>& value ) {
+    indices_.push_back( value.first );
+    dist_.push_back( value.second );
+  }
+  inline void popBack() {
+    indices_.pop_back();
+    dist_.pop_back();
+  }
+
+ private:
+  std::vector<size_t> indices_;
+  std::vector<double> dist_;
+};
+
+// neighbours of a batch of queries in flat buffers reused from one batch to the next: query q owns the slot of
+// capacity() entries starting at q * capacity(), whose first count( q ) entries are sorted by increasing distance
+class PCCNNBatchResult {
+ public:
+  PCCNNBatchResult() : capacity_( 0 ) {}
+  ~PCCNNBatchResult() = default;
+  inline void resize( const size_t queryCount, const size_t capacity ) {
+    capacity_ = capacity;
+    counts_.resize( queryCount );
+    indices_.resize( queryCount * capacity );
+    dist_.resize( queryCount * capacity );
+  }
+  inline size_t          size() const { return counts_.size(); }
+  inline size_t          capacity() const { return capacity_; }
+  inline size_t          count( const size_t query ) const { return counts_[query]; }
+  inline void            setCount( const size_t query, const size_t count ) { counts_[query] = uint32_t( count ); }
+  inline const uint32_t* indices( const size_t query ) const { return indices_.data() + query * capacity_; }
+  inline const float*    dist( const size_t query ) const { return dist_.data() + query * capacity_; }
+  inline uint32_t*       indices( const size_t query ) { return indices_.data() + query * capacity_; }
+  inline float*          dist( const size_t query ) { return dist_.data() + query * capacity_; }
+
+ private:
+  size_t                capacity_;
+  std::vector<uint32_t> counts_;
+  std::vector<uint32_t> indices_;
+  std::vector<float>    dist_;
+};
+
+class PCCVoxelGrid;
+
+class PCCKdTree {
+ public:
+  PCCKdTree();
+  PCCKdTree( const PCCPointSet3& pointCloud );
+  ~PCCKdTree();
+  void init( const PCCPointSet3& pointCloud );
+  void search( const PCCPoint3D& point, const size_t num_results, PCCNNResult& results ) const;
+  void searchRadius( const PCCPoint3D& point,
+                     const size_t      num_results,
+                     const double      radius,
+                     PCCNNResult&      results ) const;
+
+  // batched queries of pointCount contiguous points, searched concurrently on nbThread threads (0: all cores)
+  void search( const PCCPoint3D* points,
+               const size_t      pointCount,
+               const size_t      num_results,
+               PCCNNBatchResult& results,
+               const size_t      nbThread = 0 ) const;
+  void searchRadius( const PCCPoint3D* points,
+                     const size_t      pointCount,
+                     const size_t      num_results,
+                     const double      radius,
+                     PCCNNBatchResult& results,
+                     const size_t      nbThread = 0 ) const;
+
+  // index built by the following init() calls; the kd-tree stays the default since the voxel grid may order
+  // equidistant neighbours differently
+  static void                setSpatialIndexType( PCCSpatialIndexType type ) { spatialIndexType_ = type; }
+  static PCCSpatialIndexType getSpatialIndexType() { return spatialIndexType_; }
+
+ private:
+  void                       clear();
+  void*                      kdtree_;
+  PCCVoxelGrid*              grid_;
+  static PCCSpatialIndexType spatialIndexType_;
+};
+
+// kd-tree of a point cloud shared by the encoder stages that search the same cloud: the tree is built by the
+// first get() and rebuilt only when get() is called with another cloud or the positions of the cloud changed.
+class PCCSharedKdTree {
+ public:
+  PCCSharedKdTree();
+  // the frame contexts are copied with their caches: a copy starts empty and builds its own tree on demand
+  PCCSharedKdTree( const PCCSharedKdTree& ) : PCCSharedKdTree() {}
+  PCCSharedKdTree& operator=( const PCCSharedKdTree& ) {
+    clear();
+    return *this;
+  }
+  const PCCKdTree& get( const PCCPointSet3& pointCloud );
+  void             clear();
+
+ private:
+  static uint64_t            computePositionHash( const PCCPointSet3& pointCloud );
+  std::unique_ptr<PCCKdTree> kdtree_;
+  const PCCPointSet3*        pointCloud_;
+  size_t                     pointCount_;
+  uint64_t                   positionHash_;
+  PCCSpatialIndexType        spatialIndexType_;
+};
+
+}  // namespace pcc
+#endif /* PCCKdTree_h */
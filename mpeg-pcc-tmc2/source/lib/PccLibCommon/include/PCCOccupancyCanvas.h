@@ -0,0 +1,86 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCCOccupancyCanvas_h
+#define PCCOccupancyCanvas_h
+
+#include "PCCCommon.h"
+
+namespace pcc {
+
+// Block occupancy canvas of the patch packers, stored as a packed bitset. Blocks keep the raster indexing of the
+// std::vector<bool> canvas it replaces ( u + stride * v ), so a run of blocks of a canvas row is a run of bits and
+// the fit tests check it a 64-bit word at a time.
+class PCCOccupancyCanvas {
+ public:
+  PCCOccupancyCanvas() = default;
+  ~PCCOccupancyCanvas() = default;
+  size_t size() const { return size_; }
+  void   resize( const size_t size ) {
+    // the bits dropped by a shrink are cleared so that a later growth only adds free blocks
+    if ( size < size_ && ( size & 63 ) != 0 ) { words_[size >> 6] &= ~( ~uint64_t( 0 ) << ( size & 63 ) ); }
+    words_.resize( ( size + 63 ) >> 6, 0 );
+    size_ = size;
+  }
+  bool operator[]( const size_t pos ) const { return ( ( words_[pos >> 6] >> ( pos & 63 ) ) & 1 ) != 0; }
+  void set( const size_t pos ) { words_[pos >> 6] |= uint64_t( 1 ) << ( pos & 63 ); }
+
+  // the count ( <= 64 ) blocks from pos, block pos in the lowest bit
+  uint64_t bits( const size_t pos, const size_t count ) const {
+    const size_t shift = pos & 63;
+    uint64_t     value = words_[pos >> 6] >> shift;
+    if ( shift != 0 && shift + count > 64 ) { value |= words_[( pos >> 6 ) + 1] << ( 64 - shift ); }
+    return count < 64 ? value & ( ( uint64_t( 1 ) << count ) - 1 ) : value;
+  }
+
+  // true if one of the blocks [begin, end) is occupied
+  bool any( const size_t begin, const size_t end ) const {
+    if ( begin >= end ) { return false; }
+    const size_t   first     = begin >> 6;
+    const size_t   last      = ( end - 1 ) >> 6;
+    const uint64_t firstMask = ~uint64_t( 0 ) << ( begin & 63 );
+    const uint64_t lastMask  = ~uint64_t( 0 ) >> ( 63 - ( ( end - 1 ) & 63 ) );
+    if ( first == last ) { return ( words_[first] & firstMask & lastMask ) != 0; }
+    if ( ( words_[first] & firstMask ) != 0 ) { return true; }
+    for ( size_t i = first + 1; i < last; i++ ) {
+      if ( words_[i] != 0 ) { return true; }
+    }
+    return ( words_[last] & lastMask ) != 0;
+  }
+
+ private:
+  std::vector<uint64_t> words_;
+  size_t                size_ = 0;
+};
+
+}  // namespace pcc
+#endif /* PCCOccupancyCanvas_h */
@@ -36,6 +36,7 @@
 
 #include "PCCCommon.h"
 #include "PCCPointSet.h"
+#include "PCCOccupancyCanvas.h"
 
 namespace pcc {
 
@@ -216,12 +217,23 @@ class PCCPatch {
                                  size_t       canvasHeightBlk,
                                  const Tile   tile = Tile() ) const;
 
-  bool checkFitPatchCanvas( std::vector<bool> canvas,
-                            size_t            canvasStrideBlk,
-                            size_t            canvasHeightBlk,
-                            bool              bPrecedence,
-                            int               safeguard = 0,
-                            const Tile        tile      = Tile() );
+  bool checkFitPatchCanvas( const PCCOccupancyCanvas& canvas,
+                            size_t                    canvasStrideBlk,
+                            size_t                    canvasHeightBlk,
+                            bool                      bPrecedence,
+                            int                       safeguard = 0,
+                            const Tile                tile      = Tile() );
+
+  // sets the first placement of the raster order ( v, then u, then the orientations in their order ) that
+  // checkFitPatchCanvas() accepts, skipping the positions where a run of the patch blocks meets an occupied block
+  bool findFitPatchCanvas( const PCCOccupancyCanvas&  canvas,
+                           size_t                     canvasStrideBlk,
+                           size_t                     canvasHeightBlk,
+                           bool                       bPrecedence,
+                           const std::vector<size_t>& orientations,
+                           int                        safeguard = 0,
+                           const Tile                 tile      = Tile(),
+                           size_t                     nbThread  = 1 );
 
   bool        smallerRefFirst( const PCCPatch& rhs );
   bool        gt( const PCCPatch& rhs );
@@ -271,11 +283,11 @@ class PCCPatch {
                                     size_t       canvasStrideBlk,
                                     size_t       canvasHeightBlk ) const;
 
-  bool checkFitPatchCanvasForGPA( std::vector<bool> canvas,
-                                  size_t            canvasStrideBlk,
-                                  size_t            canvasHeightBlk,
-                                  bool              bPrecedence,
-                                  int               safeguard = 0 );
+  bool checkFitPatchCanvasForGPA( const PCCOccupancyCanvas& canvas,
+                                  size_t                    canvasStrideBlk,
+                                  size_t                    canvasHeightBlk,
+                                  bool                      bPrecedence,
+                                  int                       safeguard = 0 );
 
   void     allocOneLayerData();
   uint8_t& getPointLocalReconstructionLevel() { return pointLocalReconstructionLevel_; }
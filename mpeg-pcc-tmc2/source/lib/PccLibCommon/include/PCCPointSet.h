@@ -39,6 +39,8 @@
 
 namespace pcc {
 
+class PCCSharedKdTree;
+
 class PCCPointSet3 {
  public:
   PCCPointSet3() : withNormals_( false ), withColors_( false ), withReflectances_( false ) {}
@@ -209,11 +211,12 @@ class PCCPointSet3 {
     assert( index < reflectances_.size() && withReflectances_ );
     reflectances_[index] = reflectance;
   }
-  std::vector<PCCPoint3D>&    getPositions() { return positions_; }
-  std::vector<PCCColor3B>&    getColors() { return colors_; }
-  std::vector<PCCColor16bit>& getColors16bit() { return colors16bit_; }
-  std::vector<uint16_t>&      getReflectances() { return reflectances_; }
-  std::vector<uint8_t>&       getTypes() { return types_; }
+  std::vector<PCCPoint3D>&       getPositions() { return positions_; }
+  const std::vector<PCCPoint3D>& getPositions() const { return positions_; }
+  std::vector<PCCColor3B>&       getColors() { return colors_; }
+  std::vector<PCCColor16bit>&    getColors16bit() { return colors16bit_; }
+  std::vector<uint16_t>&         getReflectances() { return reflectances_; }
+  std::vector<uint8_t>&          getTypes() { return types_; }
 
   bool hasReflectances() const { return withReflectances_; }
   void addReflectances() {
@@ -285,23 +288,25 @@ class PCCPointSet3 {
     fflush( stdout );
   }
 
-  bool transferColors( PCCPointSet3& target,
-                       const int32_t searchRange,
-                       const bool    losslessAttribute                       = false,
-                       const int     numNeighborsColorTransferFwd            = 1,
-                       const int     numNeighborsColorTransferBwd            = 1,
-                       const bool    useDistWeightedAverageFwd               = true,
-                       const bool    useDistWeightedAverageBwd               = true,
-                       const bool    skipAvgIfIdenticalSourcePointPresentFwd = true,
-                       const bool    skipAvgIfIdenticalSourcePointPresentBwd = true,
-                       const double  distOffsetFwd                           = 0.0001,
-                       const double  distOffsetBwd                           = 0.0001,
-                       double        maxGeometryDist2Fwd                     = 10000.0,
-                       double        maxGeometryDist2Bwd                     = 10000.0,
-                       double        maxColorDist2Fwd                        = 10000.0,
-                       double        maxColorDist2Bwd                        = 10000.0,
-                       const bool    excludeColorOutlier                     = false,
-                       const double  thresholdColorOutlierDist               = 10.0 ) const;
+  bool transferColors( PCCPointSet3&    target,
+                       const int32_t    searchRange,
+                       const bool       losslessAttribute                       = false,
+                       const int        numNeighborsColorTransferFwd            = 1,
+                       const int        numNeighborsColorTransferBwd            = 1,
+                       const bool       useDistWeightedAverageFwd               = true,
+                       const bool       useDistWeightedAverageBwd               = true,
+                       const bool       skipAvgIfIdenticalSourcePointPresentFwd = true,
+                       const bool       skipAvgIfIdenticalSourcePointPresentBwd = true,
+                       const double     distOffsetFwd                           = 0.0001,
+                       const double     distOffsetBwd                           = 0.0001,
+                       double           maxGeometryDist2Fwd                     = 10000.0,
+                       double           maxGeometryDist2Bwd                     = 10000.0,
+                       double           maxColorDist2Fwd                        = 10000.0,
+                       double           maxColorDist2Bwd                        = 10000.0,
+                       const bool       excludeColorOutlier                     = false,
+                       const double     thresholdColorOutlierDist               = 10.0,
+                       PCCSharedKdTree* sourceKdTree                            = nullptr,
+                       PCCSharedKdTree* targetKdTree                            = nullptr ) const;
 
   bool transferColors16bitBP( PCCPointSet3& target,
                               const int     filterType,
@@ -386,6 +391,7 @@ class PCCPointSet3 {
     }
     if ( hasReflectances() ) { reflectances_.reserve( size ); }
     if ( PCC_SAVE_POINT_TYPE ) { types_.reserve( size ); }
+    if ( hasNormals() ) { normals_.reserve( size ); }
     boundaryPointTypes_.reserve( size );
     pointPatchIndexes_.reserve( size );
     parentPointIndex_.reserve( size );
@@ -435,6 +441,37 @@ class PCCPointSet3 {
     colors_[index]       = color;
     return index;
   }
+  // appends count points to be filled in place and returns the index of the first one
+  size_t appendPoints( const size_t count ) {
+    const size_t index = getPointCount();
+    if ( index + count > positions_.capacity() ) { reserve( ( std::max )( index + count, 2 * index ) ); }
+    resize( index + count );
+    return index;
+  }
+  size_t appendPoints( const std::vector<PCCPoint3D>& positions ) {
+    const size_t index = appendPoints( positions.size() );
+    std::copy( positions.begin(), positions.end(), positions_.begin() + index );
+    return index;
+  }
+  // appends the points of source listed in indices with the attributes held by both point sets
+  size_t appendPoints( const PCCPointSet3& source, const std::vector<size_t>& indices ) {
+    const size_t index = appendPoints( indices.size() );
+    for ( size_t i = 0; i < indices.size(); i++ ) {
+      const size_t j                 = indices[i];
+      positions_[index + i]          = source.positions_[j];
+      boundaryPointTypes_[index + i] = source.boundaryPointTypes_[j];
+      pointPatchIndexes_[index + i]  = source.pointPatchIndexes_[j];
+      parentPointIndex_[index + i]   = source.parentPointIndex_[j];
+      if ( hasColors() && source.hasColors() ) {
+        colors_[index + i]      = source.colors_[j];
+        colors16bit_[index + i] = source.colors16bit_[j];
+      }
+      if ( hasReflectances() && source.hasReflectances() ) { reflectances_[index + i] = source.reflectances_[j]; }
+      if ( PCC_SAVE_POINT_TYPE ) { types_[index + i] = source.types_[j]; }
+      if ( hasNormals() && source.hasNormals() ) { normals_[index + i] = source.normals_[j]; }
+    }
+    return index;
+  }
 
   void swapPoints( const size_t index1, const size_t index2 ) {
     assert( index1 < getPointCount() );
@@ -516,6 +553,7 @@ class PCCPointSet3 {
   void distance( const PCCPointSet3& pointcloud, float& distP, float& distY, float& distU, float& distV ) const;
   void distance( const PCCPointSet3& pointcloud, float& distP ) const;
   std::vector<uint8_t> computeMd5();
+  void                 sortByPosition( std::vector<size_t>& order ) const;
 
   std::vector<PCCPoint3D>                positions_;
   std::vector<PCCColor3B>                colors_;
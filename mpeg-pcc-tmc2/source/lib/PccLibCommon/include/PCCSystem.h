@@ -33,6 +33,9 @@
 #pragma once
 
 #include "PCCCommon.h"
+#include <functional>
+#include <string>
+#include <vector>
 #ifndef _WIN32
 #include <cstdlib>
 #endif
@@ -48,6 +51,26 @@ int system( const char* command ) noexcept;
 #else
 static inline int system( const char* command ) { return ::system( command ); }
 #endif
+
+/**
+ * raw data exchanged with a child process through a path given on its command
+ * line: transfer_ writes the path if input_ is set, and reads it otherwise.
+ */
+struct PCCSystemStream {
+  std::string                               path_;
+  bool                                      input_;
+  std::function<void( const std::string& )> transfer_;
+};
+
+/**
+ * runs command while streaming its inputs and outputs.
+ *
+ * Where named pipes are supported, each stream path is created as a FIFO and
+ * its transfer runs concurrently with the command, so that the data never
+ * reach the disk. Otherwise, the inputs are written before the command and
+ * the outputs read after it. The stream paths are removed on return.
+ */
+int system( const char* command, const std::vector<PCCSystemStream>& streams );
 }  // namespace pcc
 
 //===========================================================================
@@ -0,0 +1,97 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PCCVoxelGrid_h
+#define PCCVoxelGrid_h
+
+#include "PCCCommon.h"
+#include "PCCPointSet.h"
+
+namespace pcc {
+
+// Uniform hashed voxel grid answering the same exact k-nearest and radius queries as the kd-tree. Points are
+// bucketed in cubic cells of side 2^shift and stored cell by cell; queries visit rings of cells around the query
+// point and stop as soon as the cells left unvisited can no longer hold a closer point.
+class PCCVoxelGrid {
+ public:
+  PCCVoxelGrid() = default;
+  ~PCCVoxelGrid() = default;
+  void   init( const PCCPointSet3& pointCloud );
+  size_t search( const PCCPoint3D& point, const size_t num_results, size_t* indices, double* dist ) const;
+  void   searchRadius( const PCCPoint3D&                        point,
+                       const double                             radius,
+                       std::vector<std::pair<size_t, double>>& ret ) const;
+
+ private:
+  struct Cell {
+    int32_t  x_, y_, z_;
+    uint32_t start_, end_;
+  };
+  struct Candidates {
+    size_t*  indices_;
+    double*  dist_;
+    size_t   capacity_;
+    size_t   count_;
+    int64_t  worst_;
+  };
+  static inline uint64_t key( const int32_t x, const int32_t y, const int32_t z ) {
+    return ( static_cast<uint64_t>( x + ( 1 << 20 ) ) << 42 ) | ( static_cast<uint64_t>( y + ( 1 << 20 ) ) << 21 ) |
+           static_cast<uint64_t>( z + ( 1 << 20 ) );
+  }
+  inline size_t hash( const uint64_t cellKey ) const {
+    return static_cast<size_t>( ( cellKey * 0x9E3779B97F4A7C15ULL ) >> ( 64 - tableBits_ ) );
+  }
+  const Cell* find( const int32_t x, const int32_t y, const int32_t z ) const;
+  int64_t     lowerBound( const PCCPoint3D& point, const int32_t* center, const int32_t ring ) const;
+  int64_t     boxDistance( const PCCPoint3D& point, const Cell& cell ) const;
+  int32_t     ringOf( const int32_t* center, const Cell& cell ) const;
+  void        addCell( const PCCPoint3D& point, const Cell& cell, Candidates& candidates ) const;
+  void        addCell( const PCCPoint3D&                        point,
+                       const Cell&                              cell,
+                       const int64_t                            radius,
+                       std::vector<std::pair<size_t, double>>& ret ) const;
+  template <typename Visitor>
+  void visitRing( const int32_t* center, const int32_t ring, Visitor visitor ) const;
+
+  int32_t                 shift_     = 0;
+  size_t                  tableBits_ = 0;
+  int32_t                 min_[3]    = {0, 0, 0};
+  int32_t                 max_[3]    = {-1, -1, -1};
+  std::vector<PCCPoint3D> positions_;
+  std::vector<uint32_t>   indices_;
+  std::vector<Cell>       cells_;
+  std::vector<int32_t>    table_;
+};
+
+}  // namespace pcc
+#endif /* PCCVoxelGrid_h */
@@ -112,13 +112,11 @@ void PCCCodec::smoothPointCloudPostprocess( PCCPointSet3&
           }
         }
       }
-      geoSmoothingCenter_.resize( numBoundaryCells );
-      geoSmoothingCount_.resize( numBoundaryCells );
-      geoSmoothingPartition_.resize( numBoundaryCells );
-      geoSmoothingDoSmooth_.resize( numBoundaryCells );
-      int size = static_cast<int>( geoSmoothingCount_.size() );
-      geoSmoothingCount_.resize( 0 );
-      geoSmoothingCount_.resize( size, 0 );
+      // grid buffers are local to the call: frames can be post-processed concurrently
+      std::vector<uint16_t>          gridCount( numBoundaryCells, 0 );
+      std::vector<PCCVector3<float>> center( numBoundaryCells );
+      std::vector<uint32_t>          gridPartition( numBoundaryCells );
+      std::vector<bool>              doSmooth( numBoundaryCells );
       for ( int j = 0; j < reconstruct.getPointCount(); j++ ) {
         PCCPoint3D      point = reconstruct[j];
         PCCVector3<int> P     = point;
@@ -129,15 +127,14 @@ void PCCCodec::smoothPointCloudPostprocess( PCCPointSet3&
         PCCVector3<int> P2     = point / params.gridSize_;
         int             cellId = P2[0] + P2[1] * w + P2[2] * w * w;
         if ( cellIndex[cellId] != -1 ) {
-          addGridCentroid( reconstruct[j], partition[j] + 1, geoSmoothingCount_, geoSmoothingCenter_,
-                           geoSmoothingPartition_, geoSmoothingDoSmooth_, static_cast<int>( params.gridSize_ ), w,
-                           cellIndex[cellId] );
+          addGridCentroid( reconstruct[j], partition[j] + 1, gridCount, center, gridPartition, doSmooth,
+                           static_cast<int>( params.gridSize_ ), w, cellIndex[cellId] );
         }
       }
-      for ( int i = 0; i < geoSmoothingCount_.size(); i++ ) {
-        if ( geoSmoothingCount_[i] != 0U ) { geoSmoothingCenter_[i] /= geoSmoothingCount_[i]; }
+      for ( int i = 0; i < gridCount.size(); i++ ) {
+        if ( gridCount[i] != 0U ) { center[i] /= gridCount[i]; }
       }
-      smoothPointCloudGrid( reconstruct, partition, params, w, cellIndex );
+      smoothPointCloudGrid( reconstruct, partition, params, gridCount, center, doSmooth, w, cellIndex );
       cellIndex.clear();
     } else {
       if ( !params.pbfEnableFlag_ ) { smoothPointCloud( reconstruct, partition, params ); }
@@ -195,18 +192,12 @@ void PCCCodec::colorSmoothing( PCCPointSet3&                       reconstruct,
       }
     }
   }
-  colorSmoothingCenter_.resize( numBoundaryCells );
-  colorSmoothingCount_.resize( numBoundaryCells );
-  colorSmoothingPartition_.resize( numBoundaryCells );
-  colorSmoothingDoSmooth_.resize( numBoundaryCells );
-  std::fill( colorSmoothingCenter_.begin(), colorSmoothingCenter_.end(), 0.f );
-  std::fill( colorSmoothingCount_.begin(), colorSmoothingCount_.end(), 0 );
-  std::pair<size_t, size_t> initPair;
-  initPair.first = initPair.second = 0;
-  std::fill( colorSmoothingPartition_.begin(), colorSmoothingPartition_.end(), initPair );
-  std::fill( colorSmoothingDoSmooth_.begin(), colorSmoothingDoSmooth_.end(), false );
-  colorSmoothingLum_.clear();
-  colorSmoothingLum_.resize( numBoundaryCells );
+  // grid buffers are local to the call: frames can be post-processed concurrently
+  std::vector<uint16_t>                  colorGridCount( numBoundaryCells, 0 );
+  std::vector<PCCVector3<float>>         colorCenter( numBoundaryCells, 0.f );
+  std::vector<std::pair<size_t, size_t>> colorPartition( numBoundaryCells, std::make_pair( 0, 0 ) );
+  std::vector<bool>                      colorDoSmooth( numBoundaryCells, false );
+  std::vector<std::vector<uint16_t>>     colorLum( numBoundaryCells );
   for ( int k = 0; k < reconstruct.getPointCount(); k++ ) {
     PCCPoint3D      point  = reconstruct[k];
     PCCVector3<int> P2     = reconstruct[k] / gridSize;
@@ -218,23 +209,12 @@ void PCCCodec::colorSmoothing( PCCPointSet3&                       reconstruct,
         PCCVector3D clr                   = reconstruct.getColor16bit( k );
         auto        tilePatchIndexPlusOne = reconstruct.getPointPatchIndex( k );
         tilePatchIndexPlusOne.second      = tilePatchIndexPlusOne.second + 1;
-        addGridColorCentroid( reconstruct[k], clr, tilePatchIndexPlusOne, colorSmoothingCount_, colorSmoothingCenter_,
-                              colorSmoothingPartition_, colorSmoothingDoSmooth_, gridSize, colorSmoothingLum_, params,
-                              cellIndex[cellId] );
+        addGridColorCentroid( reconstruct[k], clr, tilePatchIndexPlusOne, colorGridCount, colorCenter,
+                              colorPartition, colorDoSmooth, gridSize, colorLum, params, cellIndex[cellId] );
       }
     }
   }
-  smoothPointCloudColorLC( reconstruct, params, cellIndex );
-  colorSmoothingCenter_.resize( 0 );
-  colorSmoothingCenter_.shrink_to_fit();
-  colorSmoothingCount_.resize( 0 );
-  colorSmoothingCount_.shrink_to_fit();
-  colorSmoothingPartition_.resize( 0 );
-  colorSmoothingPartition_.shrink_to_fit();
-  colorSmoothingDoSmooth_.resize( 0 );
-  colorSmoothingDoSmooth_.shrink_to_fit();
-  colorSmoothingLum_.resize( 0 );
-  colorSmoothingLum_.shrink_to_fit();
+  smoothPointCloudColorLC( reconstruct, params, colorGridCount, colorCenter, colorDoSmooth, colorLum, cellIndex );
 }
 
 int PCCCodec::getDeltaNeighbors( const PCCImageGeometry& frame,
@@ -600,6 +580,16 @@ void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstru
   // partition.resize( 0 );
   pointToPixel.resize( 0 );
   reconstruct.clear();
+  // size the outputs once: up to mapCount points per occupied pixel, then the EOM and raw points
+  size_t pointCountEstimate =
+      mapCount * std::count_if( occupancyMap.begin(), occupancyMap.end(), []( uint32_t o ) { return o != 0; } );
+  for ( auto& eomPatch : tile.getEomPatches() ) { pointCountEstimate += eomPatch.eomCount_; }
+  for ( size_t i = 0; i < tile.getNumberOfRawPointsPatches(); i++ ) {
+    pointCountEstimate += tile.getRawPointsPatch( i ).getNumberOfRawPoints();
+  }
+  reconstruct.reserve( pointCountEstimate );
+  partition.reserve( partition.size() + pointCountEstimate );
+  pointToPixel.reserve( pointCountEstimate );
 
   TRACE_CODEC( " Frame %zu in generatePointCloud \n", tile.getFrameIndex() );
   TRACE_CODEC( " params.useAdditionalPointsPatch = %d \n", params.useAdditionalPointsPatch_ );
@@ -860,6 +850,8 @@ void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstru
                                     ? ( totalPatchCount - eomPatch.memberPatches_[patchIdxInEom] - 1 )
                                     : eomPatch.memberPatches_[patchIdxInEom];
         size_t numberOfEOMPointsPerPatch = eomPointsPerPatch[memberPatchIdx].size();
+        size_t firstEOMPointIndex        = reconstruct.appendPoints( eomPointsPerPatch[memberPatchIdx] );
+        eomSavedPoints.appendPoints( eomPointsPerPatch[memberPatchIdx] );
         for ( size_t pointCount = 0; pointCount < numberOfEOMPointsPerPatch; pointCount++ ) {
           size_t currBlock                 = totalPointCount / blockSize;
           size_t nPixelInCurrentBlockCount = totalPointCount - currBlock * blockSize;
@@ -869,10 +861,8 @@ void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstru
               uBlock * params.occupancyResolution_ + nPixelInCurrentBlockCount % params.occupancyResolution_ + u0Eom;
           size_t vv =
               vBlock * params.occupancyResolution_ + nPixelInCurrentBlockCount / params.occupancyResolution_ + v0Eom;
-          PCCPoint3D point1      = eomPointsPerPatch[memberPatchIdx][pointCount];
-          size_t     pointIndex1 = reconstruct.addPoint( point1 );
+          size_t pointIndex1 = firstEOMPointIndex + pointCount;
           reconstruct.setPointPatchIndex( pointIndex1, tileIndex, patchIndex );
-          eomSavedPoints.addPoint( point1 );
 
           // reconstruct.setColor( pointIndex1, color );
           if ( PCC_SAVE_POINT_TYPE == 1 ) { reconstruct.setType( pointIndex1, POINT_EOM ); }
@@ -928,11 +918,12 @@ void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstru
           numRawPointsAdded++;
         }  // u
       }    // v
-      size_t counter = 0;
+      size_t       counter            = 0;
+      const size_t firstRawPointIndex = reconstruct.appendPoints( rawPoints );
       for ( size_t v = 0; v < rawPointsPatch.sizeV_; ++v ) {
         for ( size_t u = 0; u < rawPointsPatch.sizeU_; ++u ) {
           if ( counter < numRawPoints ) {
-            const size_t pointIndex = reconstruct.addPoint( rawPoints[counter] );
+            const size_t pointIndex = firstRawPointIndex + counter;
             reconstruct.setPointPatchIndex( pointIndex, tileIndex, patchIndex );
             reconstruct.setColor( pointIndex, rawPointsColor );
             partition.push_back( uint32_t( patchIndex ) );
@@ -1067,6 +1058,9 @@ bool PCCCodec::gridFiltering( const std::vector<uint32_t>&    partition,
 void PCCCodec::smoothPointCloudGrid( PCCPointSet3&                       reconstruct,
                                      const std::vector<uint32_t>&        partition,
                                      const GeneratePointCloudParameters& params,
+                                     std::vector<uint16_t>&              gridCount,
+                                     std::vector<PCCVector3<float>>&     center,
+                                     std::vector<bool>&                  doSmooth,
                                      uint16_t                            gridWidth,
                                      std::vector<int>&                   cellIndex ) {
   TRACE_CODEC( "%s \n", "smoothPointCloudGrid start" );
@@ -1088,8 +1082,8 @@ void PCCCodec::smoothPointCloudGrid( PCCPointSet3&                       reconst
     PCCVector3D color( 0, 0, 0 );
     if ( reconstruct.getBoundaryPointType( c ) == 1 ) {
       otherClusterPointCount =
-          gridFiltering( partition, reconstruct, curPoint, centroid, count, geoSmoothingCount_, geoSmoothingCenter_,
-                         geoSmoothingDoSmooth_, gridSize, gridWidth, cellIndex );
+          gridFiltering( partition, reconstruct, curPoint, centroid, count, gridCount, center, doSmooth, gridSize,
+                         gridWidth, cellIndex );
     }
     if ( otherClusterPointCount ) {
       double dist2 = ( ( curVector * count - centroid ).getNorm2() ) / static_cast<double>( count ) + 0.5;
@@ -1113,55 +1107,67 @@ void PCCCodec::smoothPointCloud( PCCPointSet3&                      reconstruct,
   PCCKdTree    kdtree( reconstruct );
   PCCPointSet3 temp;
   temp.resize( pointCount );
+  // the neighbourhoods are searched by blocks of points into buffers reused from one block to the next
+  const size_t     blockSize = 65536;
+  PCCNNBatchResult result;
 #if defined( ENABLE_TBB )
   tbb::task_arena limited( static_cast<int>( params.nbThread_ ) );
-  limited.execute( [&] {
-    tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
+#endif
+  for ( size_t start = 0; start < pointCount; start += blockSize ) {
+    const size_t end = ( std::min )( pointCount, start + blockSize );
+    kdtree.searchRadius( &reconstruct.getPositions()[start], end - start, params.neighborCountSmoothing_,
+                         params.radius2Smoothing_, result, params.nbThread_ );
+#if defined( ENABLE_TBB )
+    limited.execute( [&] {
+      tbb::parallel_for( start, end, [&]( const size_t i ) {
 #else
-  for ( size_t i = 0; i < pointCount; i++ ) {
+    for ( size_t i = start; i < end; i++ ) {
 #endif
-      const size_t clusterindex_ = partition[i];
-      PCCNNResult  result;
-      kdtree.searchRadius( reconstruct[i], params.neighborCountSmoothing_, params.radius2Smoothing_, result );
-      PCCVector3D centroid( 0.0 );
-      bool        otherClusterPointCount = false;
-      size_t      neighborCount          = 0;
-      for ( size_t r = 0; r < result.count(); ++r ) {
-        const double& dist2 = result.dist( r );
-        ++neighborCount;
-        const size_t pointindex_ = result.indices( r );
-        centroid += reconstruct[pointindex_];
-        otherClusterPointCount |=
-            ( dist2 <= params.radius2BoundaryDetection_ ) && ( partition[pointindex_] != clusterindex_ );
-      }
-      if ( otherClusterPointCount ) {
-        if ( reconstruct.getBoundaryPointType( i ) == 1 ) {
-          reconstruct.setBoundaryPointType( i, static_cast<uint16_t>( 2 ) );
+        const size_t    clusterindex_          = partition[i];
+        const size_t    neighborCount          = result.count( i - start );
+        const uint32_t* neighbors              = result.indices( i - start );
+        const float*    dist                   = result.dist( i - start );
+        PCCVector3D     centroid( 0.0 );
+        bool            otherClusterPointCount = false;
+        for ( size_t r = 0; r < neighborCount; ++r ) {
+          const double dist2       = dist[r];
+          const size_t pointindex_ = neighbors[r];
+          centroid += reconstruct[pointindex_];
+          otherClusterPointCount |=
+              ( dist2 <= params.radius2BoundaryDetection_ ) && ( partition[pointindex_] != clusterindex_ );
         }
-        const PCCVector3D scaledPoint =
-            double( neighborCount ) * PCCVector3D( reconstruct[i][0], reconstruct[i][1], reconstruct[i][2] );
-        const double distToCentroid2 =
-            int64_t( ( centroid - scaledPoint ).getNorm2() + ( neighborCount / 2.0 ) ) / double( neighborCount );
-        for ( size_t k = 0; k < 3; ++k ) {
-          centroid[k] = double( int64_t( ( centroid[k] + ( neighborCount / 2 ) ) / neighborCount ) );
-        }
-        if ( distToCentroid2 >= params.thresholdSmoothing_ ) {
-          temp[i] = centroid;
-          reconstruct.setColor( i, PCCColor3B( 255, 0, 0 ) );
-          if ( PCC_SAVE_POINT_TYPE == 1 ) { reconstruct.setType( i, POINT_SMOOTH ); }
+        if ( otherClusterPointCount ) {
+          if ( reconstruct.getBoundaryPointType( i ) == 1 ) {
+            reconstruct.setBoundaryPointType( i, static_cast<uint16_t>( 2 ) );
+          }
+          const PCCVector3D scaledPoint =
+              double( neighborCount ) * PCCVector3D( reconstruct[i][0], reconstruct[i][1], reconstruct[i][2] );
+          const double distToCentroid2 =
+              int64_t( ( centroid - scaledPoint ).getNorm2() + ( neighborCount / 2.0 ) ) / double( neighborCount );
+          for ( size_t k = 0; k < 3; ++k ) {
+            centroid[k] = double( int64_t( ( centroid[k] + ( neighborCount / 2 ) ) / neighborCount ) );
+          }
+          if ( distToCentroid2 >= params.thresholdSmoothing_ ) {
+            temp[i] = centroid;
+            reconstruct.setColor( i, PCCColor3B( 255, 0, 0 ) );
+            if ( PCC_SAVE_POINT_TYPE == 1 ) { reconstruct.setType( i, POINT_SMOOTH ); }
+          } else {
+            temp[i] = reconstruct[i];
+          }
         } else {
           temp[i] = reconstruct[i];
         }
-      } else {
-        temp[i] = reconstruct[i];
-      }
 #if defined( ENABLE_TBB )
+      } );
     } );
-  } );
+#else
+    }
+#endif
+  }
+#if defined( ENABLE_TBB )
   limited.execute(
       [&] { tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) { reconstruct[i] = temp[i]; } ); } );
 #else
-  }
   for ( size_t i = 0; i < pointCount; i++ ) { reconstruct[i] = temp[i]; }
 #endif
   TRACE_CODEC( "%s \n", "smoothPointCloud done" );
@@ -1197,6 +1203,7 @@ bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
                                    std::vector<PCCVector3<float>>&     colorCenter,
                                    std::vector<bool>&                  colorDoSmooth,
                                    uint8_t                             gridSize,
+                                   std::vector<std::vector<uint16_t>>& colorLum,
                                    PCCVector3D&                        curPosColor,
                                    const GeneratePointCloudParameters& params,
                                    std::vector<int>&                   cellIndex ) {
@@ -1237,8 +1244,8 @@ bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
           }
           if ( dx == 0 && dy == 0 && dz == 0 ) {
             if ( colorGridCount[index] > 1 ) {
-              double meanY   = mean( colorSmoothingLum_[index], int( colorGridCount[index] ) );
-              double medianY = median( colorSmoothingLum_[index], int( colorGridCount[index] ) );
+              double meanY   = mean( colorLum[index], int( colorGridCount[index] ) );
+              double medianY = median( colorLum[index], int( colorGridCount[index] ) );
               if ( abs( meanY - medianY ) > mmThresh ) {
                 colorCentroid = curPosColor;
                 colorCount    = 1;
@@ -1248,8 +1255,8 @@ bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
           } else {
             if ( abs( Y0 - dst[0] ) > yThresh ) { dst = curPosColor; }
             if ( colorGridCount[index] > 1 ) {
-              double meanY   = mean( colorSmoothingLum_[index], int( colorGridCount[index] ) );
-              double medianY = median( colorSmoothingLum_[index], int( colorGridCount[index] ) );
+              double meanY   = mean( colorLum[index], int( colorGridCount[index] ) );
+              double medianY = median( colorLum[index], int( colorGridCount[index] ) );
               if ( abs( meanY - medianY ) > mmThresh ) { dst = curPosColor; }
             }
           }
@@ -1278,6 +1285,10 @@ bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
 
 void PCCCodec::smoothPointCloudColorLC( PCCPointSet3&                       reconstruct,
                                         const GeneratePointCloudParameters& params,
+                                        std::vector<uint16_t>&              colorGridCount,
+                                        std::vector<PCCVector3<float>>&     colorCenter,
+                                        std::vector<bool>&                  colorDoSmooth,
+                                        std::vector<std::vector<uint16_t>>& colorLum,
                                         std::vector<int>&                   cellIndex ) {
   const size_t pointCount = reconstruct.getPointCount();
   const int    gridSize   = params.occupancyPrecision_;
@@ -1298,8 +1309,8 @@ void PCCCodec::smoothPointCloudColorLC( PCCPointSet3&                       reco
     PCCVector3D curPosColor            = reconstruct.getColor16bit( i );
     if ( reconstruct.getBoundaryPointType( i ) == 1 ) {
       otherClusterPointCount =
-          gridFilteringColor( curPos, colorCentroid, colorCount, colorSmoothingCount_, colorSmoothingCenter_,
-                              colorSmoothingDoSmooth_, gridSize, curPosColor, params, cellIndex );
+          gridFilteringColor( curPos, colorCentroid, colorCount, colorGridCount, colorCenter, colorDoSmooth, gridSize,
+                              colorLum, curPosColor, params, cellIndex );
     }
     if ( otherClusterPointCount ) {
       colorCentroid = ( colorCentroid + static_cast<double>( colorCount ) / 2.0 ) / static_cast<double>( colorCount );
@@ -1505,8 +1516,6 @@ void PCCCodec::generateRawPointsGeometryfromVideo( PCCContext& context, PCCFrame
 }
 
 void PCCCodec::generateRawPointsAttributefromVideo( PCCContext& context, size_t frameIndex ) {
-  auto& videoRawPointsAttribute = context.getVideoRawPointsAttribute();
-  videoRawPointsAttribute.resize( context.size() );
   TRACE_CODEC( "%s \n", "generateRawPointsAttributefromVideo" );
   for ( size_t tileIdx = 0; tileIdx < context.getFrame( frameIndex ).getNumTilesInAtlasFrame(); tileIdx++ ) {
     auto& tile = context.getFrame( frameIndex ).getTile( tileIdx );
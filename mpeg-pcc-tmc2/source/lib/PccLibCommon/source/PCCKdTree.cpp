@@ -1,79 +1,213 @@
-/* The copyright in this software is being made available under the BSD
- * License, included below. This software may be subject to other third party
- * and contributor rights, including patent rights, and no such rights are
- * granted under this license.
- *
- * Copyright (c) 2010-2017, ISO/IEC
- * All rights reserved.
- *
- * Redistribution and use in source and binary forms, with or without
- * modification, are permitted provided that the following conditions are met:
- *
- *  * Redistributions of source code must retain the above copyright notice,
- *    this list of conditions and the following disclaimer.
- *  * Redistributions in binary form must reproduce the above copyright notice,
- *    this list of conditions and the following disclaimer in the documentation
- *    and/or other materials provided with the distribution.
- *  * Neither the name of the ISO/IEC nor the names of its contributors may
- *    be used to endorse or promote products derived from this software without
- *    specific prior written permission.
- *
- * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
- * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
- * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
- * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
- * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
- * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
- * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
- * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
- * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
- * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
- * THE POSSIBILITY OF SUCH DAMAGE.
- */
-#include "PCCCommon.h"
-
-#include "PCCPointSet.h"
-#include "PCCKdTree.h"
-
-#include "KDTreeVectorOfVectorsAdaptor.h"
-
-using namespace pcc;
-
-typedef KDTreeVectorOfVectorsAdaptor<PCCPointSet3, PCCType, float, 3, metric_L2_Simple_2, size_t> KdTreeAdaptor;
-
-PCCKdTree::PCCKdTree() : kdtree_( nullptr ) {}
-
-PCCKdTree::PCCKdTree( const PCCPointSet3& pointCloud ) : kdtree_( nullptr ) { init( pointCloud ); }
-
-PCCKdTree::~PCCKdTree() { clear(); }
-void PCCKdTree::clear() {
-  if ( kdtree_ != nullptr ) {
-    delete ( static_cast<KdTreeAdaptor*>( kdtree_ ) );
-    kdtree_ = nullptr;
-  }
-}
-
-void PCCKdTree::init( const PCCPointSet3& pointCloud ) {
-  clear();
-  kdtree_ = new KdTreeAdaptor( 3, pointCloud, 10 );
-}
-
-void PCCKdTree::search( const PCCPoint3D& point, const size_t num_results, PCCNNResult& results ) const {
-  if ( num_results != results.size() ) { results.resize( num_results ); }
-  auto retSize = ( static_cast<KdTreeAdaptor*>( kdtree_ ) )
-                     ->index->knnSearch( &point[0], num_results, results.indices(), results.dist() );
-  assert( retSize == results.size() );
-}
-
-void PCCKdTree::searchRadius( const PCCPoint3D& point,
-                              const size_t      num_results,
-                              const double      radius,
-                              PCCNNResult&      results ) const {
-  std::vector<std::pair<size_t, double> > ret;
-  nanoflann::SearchParams                 params;
-  size_t retSize = ( static_cast<KdTreeAdaptor*>( kdtree_ ) )->index->radiusSearch( &point[0], radius, ret, params );
-  if ( retSize > num_results ) { retSize = num_results; }
-  ret.resize( retSize );
-  results.reserve( retSize );
-  for ( const auto& result : ret ) { results.pushBack( result ); }
-}
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "PCCCommon.h"
+
+#include "PCCPointSet.h"
+#include "PCCKdTree.h"
+#include "PCCVoxelGrid.h"
+
+#include "KDTreeVectorOfVectorsAdaptor.h"
+#if defined( ENABLE_TBB )
+#include <tbb/tbb.h>
+#endif
+
+using namespace pcc;
+
+typedef KDTreeVectorOfVectorsAdaptor<PCCPointSet3, PCCType, float, 3, metric_L2_Simple_2, size_t> KdTreeAdaptor;
+
+// runs function( start, end ) on consecutive batches of the queries, concurrently when TBB is enabled
+template <typename Function>
+static void searchBatches( const size_t pointCount, const size_t nbThread, Function function ) {
+  const size_t batchSize  = 256;
+  const size_t batchCount = ( pointCount + batchSize - 1 ) / batchSize;
+#if defined( ENABLE_TBB )
+  tbb::task_arena limited( nbThread > 0 ? static_cast<int>( nbThread ) : tbb::task_arena::automatic );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), batchCount, [&]( const size_t batch ) {
+#else
+  for ( size_t batch = 0; batch < batchCount; batch++ ) {
+#endif
+      function( batch * batchSize, ( std::min )( pointCount, ( batch + 1 ) * batchSize ) );
+#if defined( ENABLE_TBB )
+    } );
+  } );
+#else
+  }
+#endif
+}
+
+PCCSpatialIndexType PCCKdTree::spatialIndexType_ = SPATIAL_INDEX_KDTREE;
+
+PCCKdTree::PCCKdTree() : kdtree_( nullptr ), grid_( nullptr ) {}
+
+PCCKdTree::PCCKdTree( const PCCPointSet3& pointCloud ) : kdtree_( nullptr ), grid_( nullptr ) { init( pointCloud ); }
+
+PCCKdTree::~PCCKdTree() { clear(); }
+void PCCKdTree::clear() {
+  if ( kdtree_ != nullptr ) {
+    delete ( static_cast<KdTreeAdaptor*>( kdtree_ ) );
+    kdtree_ = nullptr;
+  }
+  if ( grid_ != nullptr ) {
+    delete grid_;
+    grid_ = nullptr;
+  }
+}
+
+void PCCKdTree::init( const PCCPointSet3& pointCloud ) {
+  clear();
+  if ( spatialIndexType_ == SPATIAL_INDEX_VOXEL_GRID ) {
+    grid_ = new PCCVoxelGrid;
+    grid_->init( pointCloud );
+  } else {
+    kdtree_ = new KdTreeAdaptor( 3, pointCloud, 10 );
+  }
+}
+
+void PCCKdTree::search( const PCCPoint3D& point, const size_t num_results, PCCNNResult& results ) const {
+  if ( num_results != results.size() ) { results.resize( num_results ); }
+  if ( grid_ != nullptr ) {
+    const size_t retSize = grid_->search( point, num_results, results.indices(), results.dist() );
+    if ( retSize != num_results ) { results.resize( retSize ); }
+    return;
+  }
+  auto retSize = ( static_cast<KdTreeAdaptor*>( kdtree_ ) )
+                     ->index->knnSearch( &point[0], num_results, results.indices(), results.dist() );
+  assert( retSize == results.size() );
+}
+
+void PCCKdTree::searchRadius( const PCCPoint3D& point,
+                              const size_t      num_results,
+                              const double      radius,
+                              PCCNNResult&      results ) const {
+  std::vector<std::pair<size_t, double> > ret;
+  nanoflann::SearchParams                 params;
+  if ( grid_ != nullptr ) {
+    grid_->searchRadius( point, radius, ret );
+  } else {
+    ( static_cast<KdTreeAdaptor*>( kdtree_ ) )->index->radiusSearch( &point[0], radius, ret, params );
+  }
+  size_t retSize = ret.size();
+  if ( retSize > num_results ) { retSize = num_results; }
+  ret.resize( retSize );
+  results.reserve( retSize );
+  for ( const auto& result : ret ) { results.pushBack( result ); }
+}
+
+void PCCKdTree::search( const PCCPoint3D* points,
+                        const size_t      pointCount,
+                        const size_t      num_results,
+                        PCCNNBatchResult& results,
+                        const size_t      nbThread ) const {
+  results.resize( pointCount, num_results );
+  searchBatches( pointCount, nbThread, [&]( const size_t start, const size_t end ) {
+    // the search works on size_t indices and double distances, narrowed once per query
+    std::vector<size_t> indices( num_results );
+    std::vector<double> dist( num_results );
+    for ( size_t query = start; query < end; query++ ) {
+      const size_t count =
+          grid_ != nullptr
+              ? grid_->search( points[query], num_results, indices.data(), dist.data() )
+              : ( static_cast<KdTreeAdaptor*>( kdtree_ ) )
+                    ->index->knnSearch( &points[query][0], num_results, indices.data(), dist.data() );
+      auto* queryIndices = results.indices( query );
+      auto* queryDist    = results.dist( query );
+      for ( size_t n = 0; n < count; n++ ) {
+        queryIndices[n] = static_cast<uint32_t>( indices[n] );
+        queryDist[n]    = static_cast<float>( dist[n] );
+      }
+      results.setCount( query, count );
+    }
+  } );
+}
+
+void PCCKdTree::searchRadius( const PCCPoint3D* points,
+                              const size_t      pointCount,
+                              const size_t      num_results,
+                              const double      radius,
+                              PCCNNBatchResult& results,
+                              const size_t      nbThread ) const {
+  results.resize( pointCount, num_results );
+  searchBatches( pointCount, nbThread, [&]( const size_t start, const size_t end ) {
+    std::vector<std::pair<size_t, double> > ret;
+    nanoflann::SearchParams                 params;
+    for ( size_t query = start; query < end; query++ ) {
+      if ( grid_ != nullptr ) {
+        grid_->searchRadius( points[query], radius, ret );
+      } else {
+        ( static_cast<KdTreeAdaptor*>( kdtree_ ) )->index->radiusSearch( &points[query][0], radius, ret, params );
+      }
+      const size_t count        = ( std::min )( ret.size(), num_results );
+      auto*        queryIndices = results.indices( query );
+      auto*        queryDist    = results.dist( query );
+      for ( size_t n = 0; n < count; n++ ) {
+        queryIndices[n] = static_cast<uint32_t>( ret[n].first );
+        queryDist[n]    = static_cast<float>( ret[n].second );
+      }
+      results.setCount( query, count );
+    }
+  } );
+}
+
+PCCSharedKdTree::PCCSharedKdTree() :
+    pointCloud_( nullptr ), pointCount_( 0 ), positionHash_( 0 ), spatialIndexType_( SPATIAL_INDEX_KDTREE ) {}
+
+void PCCSharedKdTree::clear() {
+  kdtree_.reset();
+  pointCloud_   = nullptr;
+  pointCount_   = 0;
+  positionHash_ = 0;
+}
+
+uint64_t PCCSharedKdTree::computePositionHash( const PCCPointSet3& pointCloud ) {
+  // FNV-1a over the coordinates, far cheaper than a rebuild of the index
+  uint64_t hash = 14695981039346656037ULL;
+  for ( size_t i = 0; i < pointCloud.getPointCount(); i++ ) {
+    const auto point = pointCloud[i];
+    for ( size_t c = 0; c < 3; c++ ) { hash = ( hash ^ static_cast<uint64_t>( point[c] ) ) * 1099511628211ULL; }
+  }
+  return hash;
+}
+
+const PCCKdTree& PCCSharedKdTree::get( const PCCPointSet3& pointCloud ) {
+  const uint64_t positionHash = computePositionHash( pointCloud );
+  if ( !kdtree_ || pointCloud_ != &pointCloud || pointCount_ != pointCloud.getPointCount() ||
+       positionHash_ != positionHash || spatialIndexType_ != PCCKdTree::getSpatialIndexType() ) {
+    kdtree_.reset( new PCCKdTree( pointCloud ) );
+    pointCloud_       = &pointCloud;
+    pointCount_       = pointCloud.getPointCount();
+    positionHash_     = positionHash;
+    spatialIndexType_ = PCCKdTree::getSpatialIndexType();
+  }
+  return *kdtree_;
+}
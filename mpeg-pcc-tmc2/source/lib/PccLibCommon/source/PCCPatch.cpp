@@ -34,6 +34,9 @@
 #include "PCCCommon.h"
 #include "PCCPointSet.h"
 #include "PCCPatch.h"
+#if defined( ENABLE_TBB )
+#include <tbb/tbb.h>
+#endif
 
 using namespace pcc;
 
@@ -307,33 +310,265 @@ int PCCPatch::patchBlock2CanvasBlock( const size_t uBlk,
   return int( x + canvasStrideBlk * y );
 }
 
-bool PCCPatch::checkFitPatchCanvas( std::vector<bool> canvas,
-                                    size_t            canvasStrideBlk,
-                                    size_t            canvasHeightBlk,
-                                    bool              bPrecedence,
-                                    int               safeguard,
-                                    const Tile        tile ) {
-  for ( size_t v0 = 0; v0 < sizeV0_; ++v0 ) {
-    for ( size_t u0 = 0; u0 < sizeU0_; ++u0 ) {
-      for ( int deltaY = -safeguard; deltaY < safeguard + 1; deltaY++ ) {
-        for ( int deltaX = -safeguard; deltaX < safeguard + 1; deltaX++ ) {
-          int pos = patchBlock2CanvasBlock( u0 + deltaX, v0 + deltaY, canvasStrideBlk, canvasHeightBlk, tile );
-          if ( pos < 0 ) {
-            return false;
-          } else {
-            if ( bPrecedence ) {
-              if ( canvas[pos] && occupancy_[u0 + sizeU0_ * v0] ) { return false; }
-            } else {
-              if ( canvas[pos] ) { return false; }
-            }
-          }
-        }
+// The blocks of a patch dilated by the safeguard cover a rectangle of the canvas: the fit fails as soon as this
+// rectangle leaves the canvas or the tile. Its rows are then tested a word at a time, or with precedence only the
+// neighbourhoods of the occupied patch blocks.
+template <typename Block2Canvas>
+static bool checkFitBlocksCanvas( const PCCOccupancyCanvas& canvas,
+                                  size_t                    canvasStrideBlk,
+                                  size_t                    canvasHeightBlk,
+                                  bool                      bPrecedence,
+                                  int                       safeguard,
+                                  const Tile&               tile,
+                                  size_t                    u0,
+                                  size_t                    v0,
+                                  size_t                    sizeU0,
+                                  size_t                    sizeV0,
+                                  bool                      switched,
+                                  const std::vector<bool>&  occupancy,
+                                  size_t                    occupancyStride,
+                                  Block2Canvas              block2Canvas ) {
+  if ( sizeU0 == 0 || sizeV0 == 0 || safeguard < 0 ) { return true; }
+  const int64_t stride = canvasStrideBlk;
+  const int64_t minU   = int64_t( u0 ) - safeguard;
+  const int64_t minV   = int64_t( v0 ) - safeguard;
+  const int64_t maxU   = int64_t( u0 ) + int64_t( switched ? sizeV0 : sizeU0 ) - 1 + safeguard;
+  const int64_t maxV   = int64_t( v0 ) + int64_t( switched ? sizeU0 : sizeV0 ) - 1 + safeguard;
+  if ( minU < 0 || minV < 0 || maxU >= stride || maxV >= int64_t( canvasHeightBlk ) ) { return false; }
+  if ( tile.minU != -1 && ( minU < tile.minU || minV < tile.minV || maxU > tile.maxU || maxV > tile.maxV ) ) {
+    return false;
+  }
+  if ( block2Canvas( 0, 0 ) < 0 ) { return false; }
+  if ( !bPrecedence ) {
+    for ( int64_t v = minV; v <= maxV; v++ ) {
+      if ( canvas.any( v * stride + minU, v * stride + maxU + 1 ) ) { return false; }
+    }
+    return true;
+  }
+  for ( size_t v = 0; v < sizeV0; ++v ) {
+    for ( size_t u = 0; u < sizeU0; ++u ) {
+      if ( !occupancy[u + occupancyStride * v] ) { continue; }
+      const int64_t pos = block2Canvas( u, v );
+      for ( int64_t row = pos - safeguard * stride; row <= pos + safeguard * stride; row += stride ) {
+        if ( canvas.any( row - safeguard, row + safeguard + 1 ) ) { return false; }
       }
     }
   }
   return true;
 }
 
+bool PCCPatch::checkFitPatchCanvas( const PCCOccupancyCanvas& canvas,
+                                    size_t                    canvasStrideBlk,
+                                    size_t                    canvasHeightBlk,
+                                    bool                      bPrecedence,
+                                    int                       safeguard,
+                                    const Tile                tile ) {
+  return checkFitBlocksCanvas( canvas, canvasStrideBlk, canvasHeightBlk, bPrecedence, safeguard, tile, u0_, v0_,
+                               sizeU0_, sizeV0_, isPatchDimensionSwitched(), occupancy_, sizeU0_,
+                               [&]( size_t uBlk, size_t vBlk ) {
+                                 return patchBlock2CanvasBlock( uBlk, vBlk, canvasStrideBlk, canvasHeightBlk, tile );
+                               } );
+}
+
+// dst = src >> shift over the words of a canvas row: bit u of dst is bit u + shift of src
+static void shiftRowDown( const uint64_t* src, const size_t shift, const size_t rowWords, uint64_t* dst ) {
+  const size_t words = shift >> 6, bits = shift & 63;
+  for ( size_t i = 0; i < rowWords; i++ ) {
+    const size_t j     = i + words;
+    uint64_t     value = j < rowWords ? src[j] >> bits : 0;
+    if ( bits != 0 && j + 1 < rowWords ) { value |= src[j + 1] << ( 64 - bits ); }
+    dst[i] = value;
+  }
+}
+
+// dst = src << shift over the words of a canvas row: bit u of dst is bit u - shift of src
+static void shiftRowUp( const uint64_t* src, const size_t shift, const size_t rowWords, uint64_t* dst ) {
+  const size_t words = shift >> 6, bits = shift & 63;
+  for ( size_t i = rowWords; i-- > 0; ) {
+    uint64_t value = i >= words ? src[i - words] << bits : 0;
+    if ( bits != 0 && i >= words + 1 ) { value |= src[i - words - 1] >> ( 64 - bits ); }
+    dst[i] = value;
+  }
+}
+
+bool PCCPatch::findFitPatchCanvas( const PCCOccupancyCanvas&  canvas,
+                                   size_t                     canvasStrideBlk,
+                                   size_t                     canvasHeightBlk,
+                                   bool                       bPrecedence,
+                                   const std::vector<size_t>& orientations,
+                                   int                        safeguard,
+                                   const Tile                 tile,
+                                   size_t                     nbThread ) {
+  if ( orientations.empty() || canvasStrideBlk == 0 || canvasHeightBlk == 0 ) { return false; }
+  if ( sizeU0_ == 0 || sizeV0_ == 0 || safeguard < 0 ) {
+    u0_               = 0;
+    v0_               = 0;
+    patchOrientation_ = orientations[0];
+    return true;
+  }
+  // footprint of each orientation: the runs ( row, column, length ) of the tested blocks relative to ( u0, v0 ) and
+  // the range of the positions keeping the footprint dilated by the safeguard in the canvas and in the tile
+  struct Footprint {
+    std::vector<std::array<size_t, 3>>         runs;
+    std::vector<const std::vector<uint64_t>*> erodedRows;
+    int64_t                                    minU, maxU, minV, maxV;
+  };
+  const int64_t          s = safeguard;
+  std::vector<Footprint> footprints( orientations.size() );
+  const size_t           u0 = u0_, v0 = v0_, patchOrientation = patchOrientation_;
+  u0_ = v0_ = 0;
+  for ( size_t k = 0; k < orientations.size(); k++ ) {
+    auto& footprint   = footprints[k];
+    patchOrientation_ = orientations[k];
+    const size_t width  = isPatchDimensionSwitched() ? sizeV0_ : sizeU0_;
+    const size_t height = isPatchDimensionSwitched() ? sizeU0_ : sizeV0_;
+    footprint.minU      = s + ( tile.minU != -1 ? tile.minU : 0 );
+    footprint.minV      = s + ( tile.minU != -1 ? tile.minV : 0 );
+    footprint.maxU      = ( tile.minU != -1 ? tile.maxU + 1 : int64_t( canvasStrideBlk ) ) - int64_t( width ) - s;
+    footprint.maxV      = ( tile.minU != -1 ? tile.maxV + 1 : int64_t( canvasHeightBlk ) ) - int64_t( height ) - s;
+    footprint.maxU      = ( std::min )( footprint.maxU, int64_t( canvasStrideBlk ) - int64_t( width ) - s );
+    footprint.maxV      = ( std::min )( footprint.maxV, int64_t( canvasHeightBlk ) - int64_t( height ) - s );
+    std::vector<bool> tested( width * height, false );
+    for ( size_t v = 0; v < sizeV0_ && footprint.minU <= footprint.maxU; ++v ) {
+      for ( size_t u = 0; u < sizeU0_; ++u ) {
+        const int pos = patchBlock2CanvasBlock( u, v, width, height );
+        if ( pos < 0 ) {
+          footprint.maxU = footprint.minU - 1;
+          break;
+        }
+        if ( !bPrecedence || occupancy_[u + sizeU0_ * v] ) { tested[pos] = true; }
+      }
+    }
+    for ( size_t y = 0; y < height; y++ ) {
+      for ( size_t x = 0; x < width; x++ ) {
+        if ( !tested[x + width * y] ) { continue; }
+        size_t length = 1;
+        while ( x + length < width && tested[x + length + width * y] ) { length++; }
+        footprint.runs.push_back( {y, x, length} );
+        x += length;
+      }
+    }
+  }
+  u0_               = u0;
+  v0_               = v0;
+  patchOrientation_ = patchOrientation;
+
+  // free rows: the canvas blocks a tested block can cover, i.e. the complement of the canvas dilated by the
+  // safeguard; eroded rows: the blocks starting a run of free blocks of a given length
+  const size_t          rowWords = ( canvasStrideBlk + 63 ) >> 6;
+  std::vector<uint64_t> dilated( rowWords * canvasHeightBlk, 0 ), freeRows( rowWords * canvasHeightBlk, 0 );
+  std::vector<uint64_t> row( rowWords ), shifted( rowWords );
+  for ( size_t y = 0; y < canvasHeightBlk; y++ ) {
+    for ( size_t i = 0; i < rowWords; i++ ) {
+      row[i] = canvas.bits( y * canvasStrideBlk + 64 * i, ( std::min )( size_t( 64 ), canvasStrideBlk - 64 * i ) );
+    }
+    auto* dilatedRow = dilated.data() + rowWords * y;
+    for ( size_t i = 0; i < rowWords; i++ ) { dilatedRow[i] = row[i]; }
+    for ( size_t d = 1; d <= size_t( s ); d++ ) {
+      shiftRowDown( row.data(), d, rowWords, shifted.data() );
+      for ( size_t i = 0; i < rowWords; i++ ) { dilatedRow[i] |= shifted[i]; }
+      shiftRowUp( row.data(), d, rowWords, shifted.data() );
+      for ( size_t i = 0; i < rowWords; i++ ) { dilatedRow[i] |= shifted[i]; }
+    }
+  }
+  for ( size_t y = 0; y < canvasHeightBlk; y++ ) {
+    auto*        freeRow = freeRows.data() + rowWords * y;
+    const size_t y0 = y >= size_t( s ) ? y - s : 0, y1 = ( std::min )( canvasHeightBlk - 1, y + s );
+    for ( size_t i = 0; i < rowWords; i++ ) {
+      uint64_t value = 0;
+      for ( size_t yy = y0; yy <= y1; yy++ ) { value |= dilated[rowWords * yy + i]; }
+      freeRow[i] = ~value;
+    }
+  }
+  std::map<size_t, std::vector<uint64_t>> erodedRows;
+  for ( auto& footprint : footprints ) {
+    if ( footprint.minU > footprint.maxU || footprint.minV > footprint.maxV ) { continue; }
+    for ( const auto& run : footprint.runs ) {
+      auto& eroded = erodedRows[run[2]];
+      footprint.erodedRows.push_back( &eroded );
+      if ( !eroded.empty() ) { continue; }
+      eroded = freeRows;
+      for ( size_t y = 0; y < canvasHeightBlk; y++ ) {
+        auto* erodedRow = eroded.data() + rowWords * y;
+        for ( size_t length = 1, step = 1; length < run[2]; length += step ) {
+          step = ( std::min )( length, run[2] - length );
+          shiftRowDown( erodedRow, step, rowWords, shifted.data() );
+          for ( size_t i = 0; i < rowWords; i++ ) { erodedRow[i] &= shifted[i]; }
+        }
+      }
+    }
+  }
+
+  // first position of the rows [vStart, vEnd] where all the runs of footprint k start in free runs
+  const int64_t noFit     = ( std::numeric_limits<int64_t>::max )();
+  auto          searchRows = [&]( const size_t k, const int64_t vStart, const int64_t vEnd ) {
+    const auto&           footprint = footprints[k];
+    std::vector<uint64_t> candidates( rowWords ), shiftedRun( rowWords );
+    for ( int64_t v = ( std::max )( vStart, footprint.minV ); v <= ( std::min )( vEnd, footprint.maxV ); v++ ) {
+      for ( size_t i = 0; i < rowWords; i++ ) {
+        const int64_t first = ( std::max )( footprint.minU - int64_t( 64 * i ), int64_t( 0 ) );
+        const int64_t last  = ( std::min )( footprint.maxU - int64_t( 64 * i ), int64_t( 63 ) );
+        candidates[i]       = first > last ? 0 : ( ~uint64_t( 0 ) >> ( 63 - last ) ) & ( ~uint64_t( 0 ) << first );
+      }
+      bool any = true;
+      for ( size_t r = 0; r < footprint.runs.size() && any; r++ ) {
+        const auto& run = footprint.runs[r];
+        shiftRowDown( footprint.erodedRows[r]->data() + rowWords * ( v + run[0] ), run[1], rowWords,
+                      shiftedRun.data() );
+        any = false;
+        for ( size_t i = 0; i < rowWords; i++ ) {
+          candidates[i] &= shiftedRun[i];
+          any = any || candidates[i] != 0;
+        }
+      }
+      for ( size_t i = 0; i < rowWords && any; i++ ) {
+        if ( candidates[i] != 0 ) {
+          size_t bit = 0;
+          while ( ( ( candidates[i] >> bit ) & 1 ) == 0 ) { bit++; }
+          return std::make_pair( v, int64_t( 64 * i + bit ) );
+        }
+      }
+    }
+    return std::make_pair( noFit, noFit );
+  };
+
+  // the orientations are searched concurrently on bands of rows, the first band holding a fit gives the placement
+  // of the raster order: smallest v, then smallest u, then first orientation
+  int64_t minV = noFit, maxV = -1;
+  for ( const auto& footprint : footprints ) {
+    if ( footprint.minU > footprint.maxU || footprint.minV > footprint.maxV ) { continue; }
+    minV = ( std::min )( minV, footprint.minV );
+    maxV = ( std::max )( maxV, footprint.maxV );
+  }
+  const int64_t                             bandRows = 16;
+  std::vector<std::pair<int64_t, int64_t>> fits( footprints.size() );
+#if defined( ENABLE_TBB )
+  tbb::task_arena limited( nbThread > 0 ? static_cast<int>( nbThread ) : tbb::task_arena::automatic );
+#endif
+  for ( int64_t vStart = minV; vStart <= maxV; vStart += bandRows ) {
+    const int64_t vEnd = ( std::min )( maxV, vStart + bandRows - 1 );
+#if defined( ENABLE_TBB )
+    if ( nbThread != 1 && footprints.size() > 1 ) {
+      limited.execute( [&] {
+        tbb::parallel_for( size_t( 0 ), footprints.size(),
+                           [&]( const size_t k ) { fits[k] = searchRows( k, vStart, vEnd ); } );
+      } );
+    } else
+#endif
+    {
+      for ( size_t k = 0; k < footprints.size(); k++ ) { fits[k] = searchRows( k, vStart, vEnd ); }
+    }
+    const auto best = std::min_element( fits.begin(), fits.end() );
+    if ( best->first != noFit ) {
+      u0_               = best->second;
+      v0_               = best->first;
+      patchOrientation_ = orientations[best - fits.begin()];
+      return true;
+    }
+  }
+  return false;
+}
+
 bool PCCPatch::smallerRefFirst( const PCCPatch& rhs ) {
   if ( bestMatchIdx_ == -1 && rhs.getBestMatchIdx() == -1 ) {
     return gt( rhs );
@@ -664,31 +899,17 @@ int PCCPatch::patchBlock2CanvasBlockForGPA( const size_t uBlk,
   return int( x + canvasStrideBlk * y );
 }
 
-bool PCCPatch::checkFitPatchCanvasForGPA( std::vector<bool> canvas,
-                                          size_t            canvasStrideBlk,
-                                          size_t            canvasHeightBlk,
-                                          bool              bPrecedence,
-                                          int               safeguard ) {
-  for ( size_t v0 = 0; v0 < curGPAPatchData_.sizeV0_; ++v0 ) {
-    for ( size_t u0 = 0; u0 < curGPAPatchData_.sizeU0_; ++u0 ) {
-      for ( int deltaY = -safeguard; deltaY < safeguard + 1; deltaY++ ) {
-        for ( int deltaX = -safeguard; deltaX < safeguard + 1; deltaX++ ) {
-          int pos = patchBlock2CanvasBlockForGPA( u0 + deltaX, v0 + deltaY, canvasStrideBlk, canvasHeightBlk );
-          if ( pos < 0 ) {
-            return false;
-          } else {
-            if ( bPrecedence ) {
-              if ( canvas[pos] && occupancy_[u0 + sizeU0_ * v0] ) { return false; }
-            } else {
-              if ( canvas[pos] ) { return false; }
-            }
-          }
-        }
-      }
-    }
-  }
-
-  return true;
+bool PCCPatch::checkFitPatchCanvasForGPA( const PCCOccupancyCanvas& canvas,
+                                          size_t                    canvasStrideBlk,
+                                          size_t                    canvasHeightBlk,
+                                          bool                      bPrecedence,
+                                          int                       safeguard ) {
+  return checkFitBlocksCanvas( canvas, canvasStrideBlk, canvasHeightBlk, bPrecedence, safeguard, Tile(),
+                               curGPAPatchData_.u0_, curGPAPatchData_.v0_, curGPAPatchData_.sizeU0_,
+                               curGPAPatchData_.sizeV0_, curGPAPatchData_.isPatchDimensionSwitched(), occupancy_,
+                               sizeU0_, [&]( size_t uBlk, size_t vBlk ) {
+                                 return patchBlock2CanvasBlockForGPA( uBlk, vBlk, canvasStrideBlk, canvasHeightBlk );
+                               } );
 }
 
 void PCCPatch::allocOneLayerData() {
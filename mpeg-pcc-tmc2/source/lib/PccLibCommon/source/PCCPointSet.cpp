@@ -37,37 +37,141 @@
 #include "KDTreeVectorOfVectorsAdaptor.h"
 #include "PCCKdTree.h"
 #include <numeric>
+#if defined( ENABLE_TBB )
+#include <tbb/tbb.h>
+#endif
 
 using namespace pcc;
 
+// runs function( start, end ) on consecutive chunks of [0, count), concurrently in the task arena of the caller which
+// bounds the thread count; the chunks write disjoint outputs, so the transfers do not depend on the thread count
+template <typename Function>
+static void transferParallelFor( const size_t count, Function function ) {
+  const size_t chunkSize  = 256;
+  const size_t chunkCount = ( count + chunkSize - 1 ) / chunkSize;
+#if defined( ENABLE_TBB )
+  tbb::parallel_for( size_t( 0 ), chunkCount, [&]( const size_t chunk ) {
+#else
+  for ( size_t chunk = 0; chunk < chunkCount; chunk++ ) {
+#endif
+    function( chunk * chunkSize, ( std::min )( count, ( chunk + 1 ) * chunkSize ) );
+#if defined( ENABLE_TBB )
+  } );
+#else
+  }
+#endif
+}
+
+// candidates of the target points found from the source points, in compressed sparse row form: the candidates of
+// target point t are values_[offsets_[t]] up to values_[offsets_[t + 1]], in the order of the source points
+template <typename T>
+class PCCTransferCandidates {
+ public:
+  // candidates of one target point, which the transfers may drop from the back
+  class List {
+   public:
+    List( T* begin, T* end ) : begin_( begin ), end_( end ) {}
+    T*     begin() const { return begin_; }
+    T*     end() const { return end_; }
+    size_t size() const { return end_ - begin_; }
+    bool   empty() const { return begin_ == end_; }
+    T&     operator[]( const size_t index ) const { return begin_[index]; }
+    void   pop_back() { --end_; }
+    void   resize( const size_t size ) { end_ = begin_ + ( std::min )( size, this->size() ); }
+
+   private:
+    T* begin_;
+    T* end_;
+  };
+
+  // find( sourceIndex, result, targets, values ) writes at most maxCandidateCount candidates of a source point and
+  // returns their count; the source points are searched concurrently, then the candidates are grouped by target
+  template <typename Find>
+  void init( const size_t targetCount, const size_t sourceCount, const size_t maxCandidateCount, Find find ) {
+    std::vector<uint32_t> counts( sourceCount );
+    std::vector<uint32_t> targets( sourceCount * maxCandidateCount );
+    std::vector<T>        found( sourceCount * maxCandidateCount );
+    transferParallelFor( sourceCount, [&]( const size_t start, const size_t end ) {
+      PCCNNResult result;
+      for ( size_t index = start; index < end; ++index ) {
+        const size_t shift = index * maxCandidateCount;
+        counts[index]      = uint32_t( find( index, result, targets.data() + shift, found.data() + shift ) );
+      }
+    } );
+    offsets_.assign( targetCount + 1, 0 );
+    for ( size_t index = 0; index < sourceCount; ++index ) {
+      for ( size_t i = 0; i < counts[index]; ++i ) { offsets_[targets[index * maxCandidateCount + i] + 1]++; }
+    }
+    for ( size_t index = 0; index < targetCount; ++index ) { offsets_[index + 1] += offsets_[index]; }
+    std::vector<uint32_t> positions( offsets_.begin(), offsets_.end() - 1 );
+    values_.resize( offsets_[targetCount] );
+    for ( size_t index = 0; index < sourceCount; ++index ) {
+      for ( size_t i = 0; i < counts[index]; ++i ) {
+        const size_t shift                   = index * maxCandidateCount + i;
+        values_[positions[targets[shift]]++] = found[shift];
+      }
+    }
+  }
+
+  // sorts the candidates of each target point by distance, the way std::sort ordered the former vectors
+  void sortByDistance() {
+    transferParallelFor( offsets_.size() - 1, [&]( const size_t start, const size_t end ) {
+      for ( size_t index = start; index < end; ++index ) {
+        std::sort( values_.data() + offsets_[index], values_.data() + offsets_[index + 1],
+                   []( const T& dc1, const T& dc2 ) { return dc1.dist < dc2.dist; } );
+      }
+    } );
+  }
+
+  List operator[]( const size_t index ) {
+    return List( values_.data() + offsets_[index], values_.data() + offsets_[index + 1] );
+  }
+
+ private:
+  std::vector<uint32_t> offsets_;
+  std::vector<T>        values_;
+};
+
+void PCCPointSet3::sortByPosition( std::vector<size_t>& order ) const {
+  // stable LSD radix sort on the bytes of z, y then x (sign bit flipped): the points are ordered by position as a
+  // std::map on x, y and z would and the points sharing a position keep their index order.
+  const size_t        pointCount = positions_.size();
+  std::vector<size_t> sorted( pointCount );
+  std::vector<size_t> count( 257 );
+  order.resize( pointCount );
+  std::iota( order.begin(), order.end(), 0 );
+  if ( pointCount == 0 ) { return; }
+  for ( int pass = 0; pass < 6; pass++ ) {
+    const size_t k     = 2 - pass / 2;
+    const size_t shift = 8 * ( pass % 2 );
+    auto         digit = [&]( size_t i ) { return ( ( uint16_t( positions_[i][k] ) ^ 0x8000 ) >> shift ) & 0xFF; };
+    std::fill( count.begin(), count.end(), 0 );
+    for ( size_t i = 0; i < pointCount; ++i ) { count[digit( i ) + 1]++; }
+    if ( count[digit( 0 ) + 1] == pointCount ) { continue; }
+    for ( size_t d = 1; d < 257; ++d ) { count[d] += count[d - 1]; }
+    for ( const auto i : order ) { sorted[count[digit( i )]++] = i; }
+    order.swap( sorted );
+  }
+}
+
 void PCCPointSet3::removeDuplicate() {
   PCCPointSet3 newPointcloud;
   if ( withColors_ ) { newPointcloud.hasColors(); }
   if ( withReflectances_ ) { newPointcloud.addReflectances(); }
-  std::map<float, std::map<float, std::map<float, size_t>>> eMapA;
-  if ( withColors_ ) {
-    for ( size_t i = 0; i < positions_.size(); ++i ) {
-      float x = positions_[i][0];
-      float y = positions_[i][1];
-      float z = positions_[i][2];
-      if ( eMapA.find( x ) != eMapA.end() && eMapA[x].find( y ) != eMapA[x].end() &&
-           eMapA[x][y].find( z ) != eMapA[x][y].end() ) {
-      } else {
-        eMapA[x][y][z] = i;
-        newPointcloud.addPoint( positions_[i], colors_[i] );
-      }
-    }
-  } else {
-    for ( size_t i = 0; i < positions_.size(); ++i ) {
-      float x = positions_[i][0];
-      float y = positions_[i][1];
-      float z = positions_[i][2];
-      if ( eMapA.find( x ) != eMapA.end() && eMapA[x].find( y ) != eMapA[x].end() &&
-           eMapA[x][y].find( z ) != eMapA[x][y].end() ) {
-      } else {
-        eMapA[x][y][z] = i;
-        newPointcloud.addPoint( positions_[i] );
-      }
+  // keep the first point of each position, in the input order
+  std::vector<size_t> order;
+  std::vector<bool>   first( positions_.size(), false );
+  sortByPosition( order );
+  for ( size_t i = 0; i < order.size(); ++i ) {
+    first[order[i]] = i == 0 || positions_[order[i]] != positions_[order[i - 1]];
+  }
+  newPointcloud.reserve( positions_.size() );
+  for ( size_t i = 0; i < positions_.size(); ++i ) {
+    if ( !first[i] ) { continue; }
+    if ( withColors_ ) {
+      newPointcloud.addPoint( positions_[i], colors_[i] );
+    } else {
+      newPointcloud.addPoint( positions_[i] );
     }
   }
   positions_.swap( newPointcloud.positions_ );
@@ -173,46 +277,35 @@ void PCCPointSet3::removeDuplicate( PCCPointSet3& newPointcloud, size_t dropDupl
     std::cerr << "Normaled objects can't be modified or reordered \n" << std::endl;
     exit( -1 );
   }
-  std::map<float, std::map<float, std::map<float, std::vector<size_t>>>> map;
-  for ( size_t i = 0; i < positions_.size(); ++i ) {
-    float x = positions_[i][0];
-    float y = positions_[i][1];
-    float z = positions_[i][2];
-    map[x][y][z].push_back( i );
-  }
-  if ( withColors_ ) {
-    for ( auto& itX : map ) {
-      for ( auto& itY : itX.second ) {
-        for ( auto& itZ : itY.second ) {
-          auto& listIndex = itZ.second;
-          if ( listIndex.size() == 1 || dropDuplicates == 1 ) {
-            newPointcloud.addPoint( positions_[listIndex[0]], colors_[listIndex[0]] );
-          } else {
-            PCCColor3B average;
-            size_t     r = 0;
-            size_t     g = 0;
-            size_t     b = 0;
-            for ( auto& index : listIndex ) {
-              r += colors_[index][0];
-              g += colors_[index][1];
-              b += colors_[index][2];
-            }
-            average[0] = r / listIndex.size();
-            average[1] = g / listIndex.size();
-            average[2] = b / listIndex.size();
-            newPointcloud.addPoint( positions_[listIndex[0]], average );
-          }
-        }
-      }
+  std::vector<size_t> order;
+  std::vector<size_t> listIndex;
+  sortByPosition( order );
+  newPointcloud.reserve( order.size() );
+  for ( size_t i = 0; i < order.size(); ) {
+    listIndex.clear();
+    for ( const auto& position = positions_[order[i]]; i < order.size() && positions_[order[i]] == position; ++i ) {
+      listIndex.push_back( order[i] );
     }
-  } else {
-    for ( auto& itX : map ) {
-      for ( auto& itY : itX.second ) {
-        for ( auto& itZ : itY.second ) {
-          auto& listIndex = itZ.second;
-          newPointcloud.addPoint( positions_[listIndex[0]] );
+    if ( withColors_ ) {
+      if ( listIndex.size() == 1 || dropDuplicates == 1 ) {
+        newPointcloud.addPoint( positions_[listIndex[0]], colors_[listIndex[0]] );
+      } else {
+        PCCColor3B average;
+        size_t     r = 0;
+        size_t     g = 0;
+        size_t     b = 0;
+        for ( auto& index : listIndex ) {
+          r += colors_[index][0];
+          g += colors_[index][1];
+          b += colors_[index][2];
         }
+        average[0] = r / listIndex.size();
+        average[1] = g / listIndex.size();
+        average[2] = b / listIndex.size();
+        newPointcloud.addPoint( positions_[listIndex[0]], average );
       }
+    } else {
+      newPointcloud.addPoint( positions_[listIndex[0]] );
     }
   }
 }
@@ -259,47 +352,36 @@ void PCCPointSet3::sortColor( std::vector<size_t>& list ) {
 }
 
 void PCCPointSet3::reorder( PCCPointSet3& newPointcloud, bool dropDuplicates ) {
-  std::map<float, std::map<float, std::map<float, std::vector<size_t>>>> map;
-  for ( size_t i = 0; i < positions_.size(); ++i ) {
-    float x = positions_[i][0];
-    float y = positions_[i][1];
-    float z = positions_[i][2];
-    map[x][y][z].push_back( i );
-  }
-  if ( withColors_ ) {
-    for ( auto& itX : map ) {
-      for ( auto& itY : itX.second ) {
-        for ( auto& itZ : itY.second ) {
-          auto& listIndex = itZ.second;
-          if ( listIndex.size() > 1 ) { sortColor( listIndex ); }
-          if ( dropDuplicates ) {
-            PCCColor3B average;
-            size_t     r = 0;
-            size_t     g = 0;
-            size_t     b = 0;
-            for ( auto& index : listIndex ) {
-              r += colors_[index][0];
-              g += colors_[index][1];
-              b += colors_[index][2];
-            }
-            average[0] = r / listIndex.size();
-            average[1] = g / listIndex.size();
-            average[2] = b / listIndex.size();
-            newPointcloud.addPoint( positions_[listIndex[0]], average );
-          } else {
-            for ( auto& index : listIndex ) { newPointcloud.addPoint( positions_[index], colors_[index] ); }
-          }
-        }
-      }
+  std::vector<size_t> order;
+  std::vector<size_t> listIndex;
+  sortByPosition( order );
+  newPointcloud.reserve( order.size() );
+  for ( size_t i = 0; i < order.size(); ) {
+    listIndex.clear();
+    for ( const auto& position = positions_[order[i]]; i < order.size() && positions_[order[i]] == position; ++i ) {
+      listIndex.push_back( order[i] );
     }
-  } else {
-    for ( auto& itX : map ) {
-      for ( auto& itY : itX.second ) {
-        for ( auto& itZ : itY.second ) {
-          auto& listIndex = itZ.second;
-          for ( auto& index : listIndex ) { newPointcloud.addPoint( positions_[index] ); }
+    if ( withColors_ ) {
+      if ( listIndex.size() > 1 ) { sortColor( listIndex ); }
+      if ( dropDuplicates ) {
+        PCCColor3B average;
+        size_t     r = 0;
+        size_t     g = 0;
+        size_t     b = 0;
+        for ( auto& index : listIndex ) {
+          r += colors_[index][0];
+          g += colors_[index][1];
+          b += colors_[index][2];
         }
+        average[0] = r / listIndex.size();
+        average[1] = g / listIndex.size();
+        average[2] = b / listIndex.size();
+        newPointcloud.addPoint( positions_[listIndex[0]], average );
+      } else {
+        for ( auto& index : listIndex ) { newPointcloud.addPoint( positions_[index], colors_[index] ); }
       }
+    } else {
+      for ( auto& index : listIndex ) { newPointcloud.addPoint( positions_[index] ); }
     }
   }
 }
@@ -804,30 +886,35 @@ void PCCPointSet3::convertYUVToRGB() {  // BT709
   }
 }
 
-bool PCCPointSet3::transferColors( PCCPointSet3& target,
-                                   const int32_t searchRange,
-                                   const bool    losslessAttribute,
-                                   const int     numNeighborsColorTransferFwd,
-                                   const int     numNeighborsColorTransferBwd,
-                                   const bool    useDistWeightedAverageFwd,
-                                   const bool    useDistWeightedAverageBwd,
-                                   const bool    skipAvgIfIdenticalSourcePointPresentFwd,
-                                   const bool    skipAvgIfIdenticalSourcePointPresentBwd,
-                                   const double  distOffsetFwd,
-                                   const double  distOffsetBwd,
-                                   double        maxGeometryDist2Fwd,
-                                   double        maxGeometryDist2Bwd,
-                                   double        maxColorDist2Fwd,
-                                   double        maxColorDist2Bwd,
-                                   const bool    excludeColorOutlier,
-                                   const double  thresholdColorOutlierDist ) const {
+bool PCCPointSet3::transferColors( PCCPointSet3&    target,
+                                   const int32_t    searchRange,
+                                   const bool       losslessAttribute,
+                                   const int        numNeighborsColorTransferFwd,
+                                   const int        numNeighborsColorTransferBwd,
+                                   const bool       useDistWeightedAverageFwd,
+                                   const bool       useDistWeightedAverageBwd,
+                                   const bool       skipAvgIfIdenticalSourcePointPresentFwd,
+                                   const bool       skipAvgIfIdenticalSourcePointPresentBwd,
+                                   const double     distOffsetFwd,
+                                   const double     distOffsetBwd,
+                                   double           maxGeometryDist2Fwd,
+                                   double           maxGeometryDist2Bwd,
+                                   double           maxColorDist2Fwd,
+                                   double           maxColorDist2Bwd,
+                                   const bool       excludeColorOutlier,
+                                   const double     thresholdColorOutlierDist,
+                                   PCCSharedKdTree* sourceKdTree,
+                                   PCCSharedKdTree* targetKdTree ) const {
   printf( "transferColors \n" );
   const auto&  source           = *this;
   const size_t pointCountSource = source.getPointCount();
   const size_t pointCountTarget = target.getPointCount();
   if ( ( pointCountSource == 0u ) || ( pointCountTarget == 0u ) || !source.hasColors() ) { return false; }
-  PCCKdTree kdtreeTarget( target );
-  PCCKdTree kdtreeSource( source );
+  // the indices of the caller are reused when given, otherwise they are built for this call only
+  PCCSharedKdTree  localKdTreeTarget;
+  PCCSharedKdTree  localKdTreeSource;
+  const PCCKdTree& kdtreeTarget = ( targetKdTree != nullptr ? *targetKdTree : localKdTreeTarget ).get( target );
+  const PCCKdTree& kdtreeSource = ( sourceKdTree != nullptr ? *sourceKdTree : localKdTreeSource ).get( source );
   target.addColors();
   std::vector<PCCColor3B> refinedColors1;
   refinedColors1.resize( pointCountTarget );
@@ -841,94 +928,98 @@ bool PCCPointSet3::transferColors( PCCPointSet3& target,
   // ==========================================================================================
   // for each target point indexed by index, derive the refined color as
   // refinedColors1[index]
-  PCCNNResult result;
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
-    // keep the points that satisfy geometry dist threshold
-    while ( true ) {
-      if ( result.size() == 1 ) { break; }
-      if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
-      result.popBack();
-    }
-    bool isDone = false;
-    if ( skipAvgIfIdenticalSourcePointPresentFwd ) {
-      if ( result.dist( 0 ) < 0.0001 ) {
-        refinedColors1[index] = source.getColor( result.indices( 0 ) );
-        isDone                = true;
+  transferParallelFor( pointCountTarget, [&]( const size_t start, const size_t end ) {
+    PCCNNResult result;
+    for ( size_t index = start; index < end; ++index ) {
+      kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
+      // keep the points that satisfy geometry dist threshold
+      while ( true ) {
+        if ( result.size() == 1 ) { break; }
+        if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
+        result.popBack();
       }
-    }
-    if ( !isDone ) {
-      int nNN = static_cast<int>( result.size() );
-      while ( nNN > 0 && !isDone ) {
-        if ( nNN == 1 ) {
+      bool isDone = false;
+      if ( skipAvgIfIdenticalSourcePointPresentFwd ) {
+        if ( result.dist( 0 ) < 0.0001 ) {
           refinedColors1[index] = source.getColor( result.indices( 0 ) );
           isDone                = true;
         }
-        if ( !isDone ) {
-          std::vector<PCCVector3D> colors;
-          colors.resize( 0 );
-          colors.resize( nNN );
-          for ( int i = 0; i < nNN; ++i ) {
-            for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( source.getColor( result.indices( i ) )[k] ); }
+      }
+      if ( !isDone ) {
+        int nNN = static_cast<int>( result.size() );
+        while ( nNN > 0 && !isDone ) {
+          if ( nNN == 1 ) {
+            refinedColors1[index] = source.getColor( result.indices( 0 ) );
+            isDone                = true;
           }
-          double maxColorDist2 = std::numeric_limits<double>::min();
-          for ( int i = 0; i < nNN; ++i ) {
-            for ( int j = i + 1; j < nNN; ++j ) {
-              const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-              if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+          if ( !isDone ) {
+            std::vector<PCCVector3D> colors;
+            colors.resize( 0 );
+            colors.resize( nNN );
+            for ( int i = 0; i < nNN; ++i ) {
+              for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( source.getColor( result.indices( i ) )[k] ); }
             }
-          }
-          if ( maxColorDist2 <= maxColorDist2Fwd ) {
-            PCCVector3D refinedColor( 0.0 );
-            if ( useDistWeightedAverageFwd ) {
-              double sumWeights{0.0};
-              for ( int i = 0; i < nNN; ++i ) {
-                const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
-                for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor( result.indices( i ) )[k] * weight; }
-                sumWeights += weight;
+            double maxColorDist2 = std::numeric_limits<double>::min();
+            for ( int i = 0; i < nNN; ++i ) {
+              for ( int j = i + 1; j < nNN; ++j ) {
+                const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
               }
-              refinedColor /= sumWeights;
-              if ( excludeColorOutlier ) {
-                PCCVector3D excludeOutlierRefinedColor( 0.0 );
-                size_t      excludeCount = 0;
-                sumWeights               = 0.0;
+            }
+            if ( maxColorDist2 <= maxColorDist2Fwd ) {
+              PCCVector3D refinedColor( 0.0 );
+              if ( useDistWeightedAverageFwd ) {
+                double sumWeights{0.0};
                 for ( int i = 0; i < nNN; ++i ) {
-                  double      dist     = 0.0;
-                  PCCColor3B  tmpColor = source.getColor( result.indices( i ) );
-                  PCCVector3D sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
-                  dist = ( sourceColor - refinedColor ).getNorm2();
-                  if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist ) {
-                    excludeCount += 1;
-                    continue;
-                  }
                   const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
                   for ( int k = 0; k < 3; ++k ) {
-                    excludeOutlierRefinedColor[k] += source.getColor( result.indices( i ) )[k] * weight;
+                    refinedColor[k] += source.getColor( result.indices( i ) )[k] * weight;
                   }
                   sumWeights += weight;
                 }
+                refinedColor /= sumWeights;
+                if ( excludeColorOutlier ) {
+                  PCCVector3D excludeOutlierRefinedColor( 0.0 );
+                  size_t      excludeCount = 0;
+                  sumWeights               = 0.0;
+                  for ( int i = 0; i < nNN; ++i ) {
+                    double      dist     = 0.0;
+                    PCCColor3B  tmpColor = source.getColor( result.indices( i ) );
+                    PCCVector3D sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
+                    dist = ( sourceColor - refinedColor ).getNorm2();
+                    if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist ) {
+                      excludeCount += 1;
+                      continue;
+                    }
+                    const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
+                    for ( int k = 0; k < 3; ++k ) {
+                      excludeOutlierRefinedColor[k] += source.getColor( result.indices( i ) )[k] * weight;
+                    }
+                    sumWeights += weight;
+                  }
 
-                if ( excludeCount != nNN && excludeCount != 0 ) {
-                  refinedColor = excludeOutlierRefinedColor / sumWeights;
+                  if ( excludeCount != nNN && excludeCount != 0 ) {
+                    refinedColor = excludeOutlierRefinedColor / sumWeights;
+                  }
+                }
+              } else {
+                for ( int i = 0; i < nNN; ++i ) {
+                  for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor( result.indices( i ) )[k]; }
                 }
+                refinedColor /= nNN;
               }
-            } else {
-              for ( int i = 0; i < nNN; ++i ) {
-                for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor( result.indices( i ) )[k]; }
+              for ( int k = 0; k < 3; ++k ) {
+                refinedColors1[index][k] = uint8_t( PCCClip( round( refinedColor[k] ), 0.0, 255.0 ) );
               }
-              refinedColor /= nNN;
-            }
-            for ( int k = 0; k < 3; ++k ) {
-              refinedColors1[index][k] = uint8_t( PCCClip( round( refinedColor[k] ), 0.0, 255.0 ) );
+              isDone = true;
+            } else {
+              --nNN;
             }
-            isDone = true;
-          } else {
-            --nNN;
           }
         }
       }
     }
-  }
+  } );
   // ==========================================================================================
   //                                  Backward direction
   // ==========================================================================================
@@ -937,189 +1028,189 @@ bool PCCPointSet3::transferColors( PCCPointSet3& target,
   // colorsDists2 is iteratively refined (by removing the farthest points) until
   // the
   // std of remaining colors in it is smaller than a threshold.
-  std::vector<std::vector<DistColor8Bit>> refinedColorsDists2;
-  refinedColorsDists2.resize( pointCountTarget );
+  PCCTransferCandidates<DistColor8Bit> refinedColorsDists2;
   // populate refinedColorsDists2
-  for ( size_t index = 0; index < pointCountSource; ++index ) {
-    const PCCColor3B color = source.getColor( index );
-    kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
-    // keep the points that satisfy geometry dist threshold
-    for ( int i = 0; i < result.size(); ++i ) {
-      if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
-        refinedColorsDists2[result.indices( i )].push_back( DistColor8Bit{result.dist( i ), color} );
-      }
-    }
-  }
+  refinedColorsDists2.init( pointCountTarget, pointCountSource, numNeighborsColorTransferBwd,
+                            [&]( const size_t index, PCCNNResult& result, uint32_t* targets, DistColor8Bit* values ) {
+                              const PCCColor3B color = source.getColor( index );
+                              kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
+                              // keep the points that satisfy geometry dist threshold
+                              size_t count = 0;
+                              for ( int i = 0; i < result.size(); ++i ) {
+                                if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
+                                  targets[count]  = uint32_t( result.indices( i ) );
+                                  values[count++] = DistColor8Bit{result.dist( i ), color};
+                                }
+                              }
+                              return count;
+                            } );
   // sort refinedColorsDists2 according to distance
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
-               []( DistColor8Bit& dc1, DistColor8Bit& dc2 ) { return dc1.dist < dc2.dist; } );
-  }
+  refinedColorsDists2.sortByDistance();
   // compute centroid2
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    const PCCColor3B color1       = refinedColors1[index];       // refined color derived in forward direction
-    auto&            colorsDists2 = refinedColorsDists2[index];  // set of candidate points
-                                                                 // derived in backward
-                                                                 // direction
-    if ( colorsDists2.empty() || losslessAttribute ) {
-      target.setColor( index, color1 );
-    } else {
-      bool              isDone = false;
-      const PCCVector3D centroid1( color1[0], color1[1], color1[2] );
-      PCCVector3D       centroid2( 0.0 );
-      if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
-        if ( colorsDists2[0].dist < 0.0001 ) {
-          auto temp = colorsDists2[0];
-          colorsDists2.clear();
-          colorsDists2.push_back( temp );
-          for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
-          isDone = true;
-        }
-      }
-      if ( !isDone ) {
-        int nNN = static_cast<int>( colorsDists2.size() );
-        while ( nNN > 0 && !isDone ) {
-          nNN = static_cast<int>( colorsDists2.size() );
-          if ( nNN == 1 ) {
-            auto temp = colorsDists2[0];
-            colorsDists2.clear();
-            colorsDists2.push_back( temp );
+  transferParallelFor( pointCountTarget, [&]( const size_t start, const size_t end ) {
+    for ( size_t index = start; index < end; ++index ) {
+      const PCCColor3B color1       = refinedColors1[index];       // refined color derived in forward direction
+      auto             colorsDists2 = refinedColorsDists2[index];  // set of candidate points
+                                                                   // derived in backward
+                                                                   // direction
+      if ( colorsDists2.empty() || losslessAttribute ) {
+        target.setColor( index, color1 );
+      } else {
+        bool              isDone = false;
+        const PCCVector3D centroid1( color1[0], color1[1], color1[2] );
+        PCCVector3D       centroid2( 0.0 );
+        if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
+          if ( colorsDists2[0].dist < 0.0001 ) {
+            colorsDists2.resize( 1 );
             for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
             isDone = true;
           }
-          if ( !isDone ) {
-            std::vector<PCCVector3D> colors;
-            colors.resize( 0 );
-            colors.resize( nNN );
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
+        }
+        if ( !isDone ) {
+          int nNN = static_cast<int>( colorsDists2.size() );
+          while ( nNN > 0 && !isDone ) {
+            nNN = static_cast<int>( colorsDists2.size() );
+            if ( nNN == 1 ) {
+              colorsDists2.resize( 1 );
+              for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
+              isDone = true;
             }
-            double maxColorDist2 = std::numeric_limits<double>::min();
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int j = i + 1; j < nNN; ++j ) {
-                const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-                if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+            if ( !isDone ) {
+              std::vector<PCCVector3D> colors;
+              colors.resize( 0 );
+              colors.resize( nNN );
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
               }
-            }
-            if ( maxColorDist2 <= maxColorDist2Bwd ) {
-              for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
-              if ( useDistWeightedAverageBwd ) {
-                double sumWeights{0.0};
-                for ( auto& i : colorsDists2 ) {
-                  const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                  for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( i.color[k] * weight ); }
-                  sumWeights += weight;
+              double maxColorDist2 = std::numeric_limits<double>::min();
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int j = i + 1; j < nNN; ++j ) {
+                  const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                  if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
                 }
-                centroid2 /= sumWeights;
-                if ( excludeColorOutlier ) {
-                  PCCVector3D excludeOutlierCentroid2( 0.0 );
-                  size_t      excludeCount = 0;
-                  sumWeights               = 0.0;
+              }
+              if ( maxColorDist2 <= maxColorDist2Bwd ) {
+                for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
+                if ( useDistWeightedAverageBwd ) {
+                  double sumWeights{0.0};
                   for ( auto& i : colorsDists2 ) {
-                    PCCVector3D sourceColor( i.color[0], i.color[1], i.color[2] );
-                    double      dist = ( sourceColor - centroid2 ).getNorm2();
-                    if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist ) {
-                      excludeCount += 1;
-                      continue;
-                    }
                     const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                    for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( i.color[k] * weight ); }
+                    for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( i.color[k] * weight ); }
                     sumWeights += weight;
                   }
+                  centroid2 /= sumWeights;
+                  if ( excludeColorOutlier ) {
+                    PCCVector3D excludeOutlierCentroid2( 0.0 );
+                    size_t      excludeCount = 0;
+                    sumWeights               = 0.0;
+                    for ( auto& i : colorsDists2 ) {
+                      PCCVector3D sourceColor( i.color[0], i.color[1], i.color[2] );
+                      double      dist = ( sourceColor - centroid2 ).getNorm2();
+                      if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist ) {
+                        excludeCount += 1;
+                        continue;
+                      }
+                      const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
+                      for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( i.color[k] * weight ); }
+                      sumWeights += weight;
+                    }
 
-                  if ( excludeCount != nNN && excludeCount != 0 ) { centroid2 = excludeOutlierCentroid2 / sumWeights; }
+                    if ( excludeCount != nNN && excludeCount != 0 ) {
+                      centroid2 = excludeOutlierCentroid2 / sumWeights;
+                    }
+                  }
+                } else {
+                  for ( auto& coldist : colorsDists2 ) {
+                    for ( int k = 0; k < 3; ++k ) { centroid2[k] += coldist.color[k]; }
+                  }
+                  centroid2 /= colorsDists2.size();
                 }
+                isDone = true;
               } else {
-                for ( auto& coldist : colorsDists2 ) {
-                  for ( int k = 0; k < 3; ++k ) { centroid2[k] += coldist.color[k]; }
-                }
-                centroid2 /= colorsDists2.size();
+                colorsDists2.pop_back();
               }
-              isDone = true;
-            } else {
-              colorsDists2.pop_back();
             }
           }
         }
-      }
-      auto   H  = double( colorsDists2.size() );
-      double D2 = 0.0;
-      for ( const auto& color2dist : colorsDists2 ) {
-        auto color2 = color2dist.color;
-        for ( size_t k = 0; k < 3; ++k ) {
-          const double d2 = centroid2[k] - color2[k];
-          D2 += d2 * d2;
-        }
-      }
-      const double r      = double( pointCountTarget ) / double( pointCountSource );
-      const double delta2 = ( centroid2 - centroid1 ).getNorm2();
-      const double eps    = 0.000001;
-
-      const bool fixWeight = true;        // m42538
-      if ( fixWeight || delta2 > eps ) {  // centroid2 != centroid1
-        double w = 0.0;
-
-        if ( !fixWeight ) {
-          const double alpha = D2 / delta2;
-          const double a     = H * r - 1.0;
-          const double c     = alpha * r - 1.0;
-          if ( fabs( a ) < eps ) {
-            w = -0.5 * c;
-          } else {
-            const double delta = 1.0 - a * c;
-            if ( delta >= 0.0 ) { w = ( -1.0 + sqrt( delta ) ) / a; }
+        auto   H  = double( colorsDists2.size() );
+        double D2 = 0.0;
+        for ( const auto& color2dist : colorsDists2 ) {
+          auto color2 = color2dist.color;
+          for ( size_t k = 0; k < 3; ++k ) {
+            const double d2 = centroid2[k] - color2[k];
+            D2 += d2 * d2;
           }
         }
-        const double oneMinusW = 1.0 - w;
-        PCCVector3D  color0;
-        for ( size_t k = 0; k < 3; ++k ) {
-          color0[k] = PCCClip( round( w * centroid1[k] + oneMinusW * centroid2[k] ), 0.0, 255.0 );
-        }
-        const double rSource  = 1.0 / double( pointCountSource );
-        const double rTarget  = 1.0 / double( pointCountTarget );
-        const double maxValue = std::numeric_limits<uint8_t>::max();
-        double       minError = std::numeric_limits<double>::max();
-        PCCVector3D  bestColor( color0 );
-        PCCVector3D  color;
-        for ( int32_t s1 = -searchRange; s1 <= searchRange; ++s1 ) {
-          color[0] = PCCClip( color0[0] + s1, 0.0, maxValue );
-          for ( int32_t s2 = -searchRange; s2 <= searchRange; ++s2 ) {
-            color[1] = PCCClip( color0[1] + s2, 0.0, maxValue );
-            for ( int32_t s3 = -searchRange; s3 <= searchRange; ++s3 ) {
-              color[2] = PCCClip( color0[2] + s3, 0.0, maxValue );
-
-              double e1 = 0.0;
-              for ( size_t k = 0; k < 3; ++k ) {
-                const double d = color[k] - color1[k];
-                e1 += d * d;
-              }
-              e1 *= rTarget;
-
-              double e2 = 0.0;
-              for ( const auto& color2dist : colorsDists2 ) {
-                auto color2 = color2dist.color;
+        const double r      = double( pointCountTarget ) / double( pointCountSource );
+        const double delta2 = ( centroid2 - centroid1 ).getNorm2();
+        const double eps    = 0.000001;
+
+        const bool fixWeight = true;        // m42538
+        if ( fixWeight || delta2 > eps ) {  // centroid2 != centroid1
+          double w = 0.0;
+
+          if ( !fixWeight ) {
+            const double alpha = D2 / delta2;
+            const double a     = H * r - 1.0;
+            const double c     = alpha * r - 1.0;
+            if ( fabs( a ) < eps ) {
+              w = -0.5 * c;
+            } else {
+              const double delta = 1.0 - a * c;
+              if ( delta >= 0.0 ) { w = ( -1.0 + sqrt( delta ) ) / a; }
+            }
+          }
+          const double oneMinusW = 1.0 - w;
+          PCCVector3D  color0;
+          for ( size_t k = 0; k < 3; ++k ) {
+            color0[k] = PCCClip( round( w * centroid1[k] + oneMinusW * centroid2[k] ), 0.0, 255.0 );
+          }
+          const double rSource  = 1.0 / double( pointCountSource );
+          const double rTarget  = 1.0 / double( pointCountTarget );
+          const double maxValue = std::numeric_limits<uint8_t>::max();
+          double       minError = std::numeric_limits<double>::max();
+          PCCVector3D  bestColor( color0 );
+          PCCVector3D  color;
+          for ( int32_t s1 = -searchRange; s1 <= searchRange; ++s1 ) {
+            color[0] = PCCClip( color0[0] + s1, 0.0, maxValue );
+            for ( int32_t s2 = -searchRange; s2 <= searchRange; ++s2 ) {
+              color[1] = PCCClip( color0[1] + s2, 0.0, maxValue );
+              for ( int32_t s3 = -searchRange; s3 <= searchRange; ++s3 ) {
+                color[2] = PCCClip( color0[2] + s3, 0.0, maxValue );
+
+                double e1 = 0.0;
                 for ( size_t k = 0; k < 3; ++k ) {
-                  const double d = color[k] - color2[k];
-                  e2 += d * d;
+                  const double d = color[k] - color1[k];
+                  e1 += d * d;
                 }
-              }
-              e2 *= rSource;
+                e1 *= rTarget;
+
+                double e2 = 0.0;
+                for ( const auto& color2dist : colorsDists2 ) {
+                  auto color2 = color2dist.color;
+                  for ( size_t k = 0; k < 3; ++k ) {
+                    const double d = color[k] - color2[k];
+                    e2 += d * d;
+                  }
+                }
+                e2 *= rSource;
 
-              const double error = std::max( e1, e2 );
-              if ( error < minError ) {
-                minError  = error;
-                bestColor = color;
+                const double error = std::max( e1, e2 );
+                if ( error < minError ) {
+                  minError  = error;
+                  bestColor = color;
+                }
               }
             }
           }
+          target.setColor( index,
+                           PCCColor3B( uint8_t( bestColor[0] ), uint8_t( bestColor[1] ), uint8_t( bestColor[2] ) ) );
+        } else {  // centroid2 == centroid1
+          target.setColor( index, color1 );
         }
-        target.setColor( index,
-                         PCCColor3B( uint8_t( bestColor[0] ), uint8_t( bestColor[1] ), uint8_t( bestColor[2] ) ) );
-      } else {  // centroid2 == centroid1
-        target.setColor( index, color1 );
       }
     }
-  }
+  } );
   return true;
 }
 
@@ -1156,113 +1247,118 @@ bool PCCPointSet3::transferColors16bitBP( PCCPointSet3& target,
   maxColorDist2Bwd    = ( maxColorDist2Bwd < 131072 ) ? maxColorDist2Bwd : std::numeric_limits<double>::max();
   PCCPointSet3 partSource;
   partSource.addColors();
+  // source neighbours of the boundary target points, gathered in partSource in the order of the target points
+  const size_t          neighborCount = size_t( numNeighborsColorTransferFwd );
+  std::vector<uint32_t> forwardNeighborCounts( filterType == 1 ? pointCountTarget : 0, 0 );
+  std::vector<uint32_t> forwardNeighbors( forwardNeighborCounts.size() * neighborCount );
   // ==========================================================================================
   //                                     Forward direction
   // ==========================================================================================
   // for each target point indexed by index, derive the refined color as
   // refinedColors1[index]
-  PCCNNResult result;
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    PCCColor16bit colorT16bit = target.getColor16bit( index );
-    for ( int k = 0; k < 3; ++k ) { refinedColors1[index][k] = colorT16bit[k]; }
-    if ( target.getBoundaryPointType( index ) == 3 ) {
-      kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
-      if ( filterType == 1 ) {
-        for ( size_t rI = 0; rI < result.size(); ++rI ) {
-          auto indexInSource = result.indices( rI );
-          auto partIndex2    = partSource.addPoint( source[indexInSource] );
-          partSource.setColor( partIndex2, source.getColor( indexInSource ) );
-          partSource.setColor16bit( partIndex2, source.getColor16bit( indexInSource ) );
-          partSource.setParentPointIndex( partIndex2, indexInSource );
+  transferParallelFor( pointCountTarget, [&]( const size_t start, const size_t end ) {
+    PCCNNResult result;
+    for ( size_t index = start; index < end; ++index ) {
+      PCCColor16bit colorT16bit = target.getColor16bit( index );
+      for ( int k = 0; k < 3; ++k ) { refinedColors1[index][k] = colorT16bit[k]; }
+      if ( target.getBoundaryPointType( index ) == 3 ) {
+        kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
+        if ( filterType == 1 ) {
+          for ( size_t rI = 0; rI < result.size(); ++rI ) {
+            forwardNeighbors[index * neighborCount + rI] = uint32_t( result.indices( rI ) );
+          }
+          forwardNeighborCounts[index] = uint32_t( result.size() );
         }
-      }
-      // keep the points that satisfy geometry dist threshold
-      while ( true ) {
-        if ( result.size() == 1 ) { break; }
-        if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
-        result.popBack();
-      }
-      bool isDone = false;
-      if ( skipAvgIfIdenticalSourcePointPresentFwd ) {
-        if ( result.dist( 0 ) < 0.0001 ) {
-          refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
-          isDone                = true;
+        // keep the points that satisfy geometry dist threshold
+        while ( true ) {
+          if ( result.size() == 1 ) { break; }
+          if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
+          result.popBack();
         }
-      }
-      if ( !isDone ) {
-        int nNN = static_cast<int>( result.count() );
-        while ( nNN > 0 && !isDone ) {
-          if ( nNN == 1 ) {
+        bool isDone = false;
+        if ( skipAvgIfIdenticalSourcePointPresentFwd ) {
+          if ( result.dist( 0 ) < 0.0001 ) {
             refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
             isDone                = true;
           }
-          if ( !isDone ) {
-            std::vector<PCCVector3D> colors;
-            colors.resize( 0 );
-            colors.resize( nNN );
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( source.getColor16bit( result.indices( i ) )[k] ); }
-            }
-            double maxColorDist2 = std::numeric_limits<double>::min();
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int j = i + 1; j < nNN; ++j ) {
-                const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-                if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
-              }
+        }
+        if ( !isDone ) {
+          int nNN = static_cast<int>( result.count() );
+          while ( nNN > 0 && !isDone ) {
+            if ( nNN == 1 ) {
+              refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
+              isDone                = true;
             }
-            if ( maxColorDist2 <= maxColorDist2Fwd ) {
-              PCCVector3D refinedColor( 0.0 );
-              if ( useDistWeightedAverageFwd ) {
-                double sumWeights{0.0};
-                for ( int i = 0; i < nNN; ++i ) {
-                  const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
-                  for ( int k = 0; k < 3; ++k ) {
-                    refinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
-                  }
-                  sumWeights += weight;
+            if ( !isDone ) {
+              std::vector<PCCVector3D> colors;
+              colors.resize( 0 );
+              colors.resize( nNN );
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int k = 0; k < 3; ++k ) {
+                  colors[i][k] = double( source.getColor16bit( result.indices( i ) )[k] );
                 }
-                refinedColor /= sumWeights;
-                if ( excludeColorOutlier ) {
-                  PCCVector3D excludeOutlierRefinedColor( 0.0 );
-                  size_t      excludeCount = 0;
-                  sumWeights               = 0.0;
+              }
+              double maxColorDist2 = std::numeric_limits<double>::min();
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int j = i + 1; j < nNN; ++j ) {
+                  const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                  if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+                }
+              }
+              if ( maxColorDist2 <= maxColorDist2Fwd ) {
+                PCCVector3D refinedColor( 0.0 );
+                if ( useDistWeightedAverageFwd ) {
+                  double sumWeights{0.0};
                   for ( int i = 0; i < nNN; ++i ) {
-                    PCCColor16bit tmpColor = source.getColor16bit( result.indices( i ) );
-                    PCCVector3D   sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
-                    double        dist = ( sourceColor - refinedColor ).getNorm2();
-                    if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
-                      excludeCount += 1;
-                      continue;
-                    }
                     const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
                     for ( int k = 0; k < 3; ++k ) {
-                      excludeOutlierRefinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
+                      refinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
                     }
                     sumWeights += weight;
                   }
+                  refinedColor /= sumWeights;
+                  if ( excludeColorOutlier ) {
+                    PCCVector3D excludeOutlierRefinedColor( 0.0 );
+                    size_t      excludeCount = 0;
+                    sumWeights               = 0.0;
+                    for ( int i = 0; i < nNN; ++i ) {
+                      PCCColor16bit tmpColor = source.getColor16bit( result.indices( i ) );
+                      PCCVector3D   sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
+                      double        dist = ( sourceColor - refinedColor ).getNorm2();
+                      if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
+                        excludeCount += 1;
+                        continue;
+                      }
+                      const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
+                      for ( int k = 0; k < 3; ++k ) {
+                        excludeOutlierRefinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
+                      }
+                      sumWeights += weight;
+                    }
 
-                  if ( excludeCount != nNN && excludeCount != 0 ) {
-                    refinedColor = excludeOutlierRefinedColor / sumWeights;
+                    if ( excludeCount != nNN && excludeCount != 0 ) {
+                      refinedColor = excludeOutlierRefinedColor / sumWeights;
+                    }
                   }
+                } else {
+                  for ( int i = 0; i < nNN; ++i ) {
+                    for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor16bit( result.indices( i ) )[k]; }
+                  }
+                  refinedColor /= nNN;
                 }
-              } else {
-                for ( int i = 0; i < nNN; ++i ) {
-                  for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor16bit( result.indices( i ) )[k]; }
+                for ( int k = 0; k < 3; ++k ) {
+                  refinedColors1[index][k] = uint16_t( PCCClip( round( refinedColor[k] ), 0.0, 65535.0 ) );
                 }
-                refinedColor /= nNN;
-              }
-              for ( int k = 0; k < 3; ++k ) {
-                refinedColors1[index][k] = uint16_t( PCCClip( round( refinedColor[k] ), 0.0, 65535.0 ) );
+                isDone = true;
+              } else {
+                --nNN;
               }
-              isDone = true;
-            } else {
-              --nNN;
             }
           }
         }
       }
     }
-  }
+  } );
   // ==========================================================================================
   //                                  Backward direction
   // ==========================================================================================
@@ -1271,216 +1367,224 @@ bool PCCPointSet3::transferColors16bitBP( PCCPointSet3& target,
   // colorsDists2 is iteratively refined (by removing the farthest points) until
   // the
   // std of remaining colors in it is smaller than a threshold.
-  std::vector<std::vector<DistColor>> refinedColorsDists2;
+  PCCTransferCandidates<DistColor> refinedColorsDists2;
   if ( filterType == 1 ) {
-    refinedColorsDists2.resize( pointCountTarget );
-    // populate refinedColorsDists2
-    auto sampleSetPointCount = partSource.getPointCount();
-    for ( size_t index = 0; index < sampleSetPointCount; ++index ) {
-      const PCCColor16bit color = partSource.getColor16bit( index );
-      kdtreeTarget.search( partSource[index], numNeighborsColorTransferBwd, result );
-      // keep the points that satisfy geometry dist threshold
-      for ( int i = 0; i < result.size(); ++i ) {
-        if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
-          if ( std::abs( color[0] - target.getColor16bit()[result.indices( i )][0] ) < 40 &&
-               std::abs( color[1] - target.getColor16bit()[result.indices( i )][1] ) < 40 &&
-               std::abs( color[2] - target.getColor16bit()[result.indices( i )][2] ) < 40 )
-            refinedColorsDists2[result.indices( i )].push_back( DistColor{
-                result.dist( i ), color, target[result.indices( i )], partSource.getParentPointIndex( index ), index} );
-        }
+    for ( size_t index = 0; index < forwardNeighborCounts.size(); ++index ) {
+      for ( size_t rI = 0; rI < forwardNeighborCounts[index]; ++rI ) {
+        auto indexInSource = forwardNeighbors[index * neighborCount + rI];
+        auto partIndex2    = partSource.addPoint( source[indexInSource] );
+        partSource.setColor( partIndex2, source.getColor( indexInSource ) );
+        partSource.setColor16bit( partIndex2, source.getColor16bit( indexInSource ) );
+        partSource.setParentPointIndex( partIndex2, indexInSource );
       }
     }
-
-    // sort refinedColorsDists2 according to distance
-    for ( size_t index = 0; index < pointCountTarget; ++index ) {
-      std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
-                 []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
-    }
+    // populate refinedColorsDists2
+    auto sampleSetPointCount = partSource.getPointCount();
+    refinedColorsDists2.init(
+        pointCountTarget, sampleSetPointCount, numNeighborsColorTransferBwd,
+        [&]( const size_t index, PCCNNResult& result, uint32_t* targets, DistColor* values ) {
+          const PCCColor16bit color = partSource.getColor16bit( index );
+          kdtreeTarget.search( partSource[index], numNeighborsColorTransferBwd, result );
+          // keep the points that satisfy geometry dist threshold
+          size_t count = 0;
+          for ( int i = 0; i < result.size(); ++i ) {
+            if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
+              if ( std::abs( color[0] - target.getColor16bit()[result.indices( i )][0] ) < 40 &&
+                   std::abs( color[1] - target.getColor16bit()[result.indices( i )][1] ) < 40 &&
+                   std::abs( color[2] - target.getColor16bit()[result.indices( i )][2] ) < 40 ) {
+                targets[count]  = uint32_t( result.indices( i ) );
+                values[count++] = DistColor{result.dist( i ), color, target[result.indices( i )],
+                                            partSource.getParentPointIndex( index ), index};
+              }
+            }
+          }
+          return count;
+        } );
   } else {
     // populate refinedColorsDists2
-    refinedColorsDists2.resize( pointCountTarget );
-    for ( size_t index = 0; index < pointCountSource; ++index ) {
-      const PCCColor16bit color = source.getColor16bit( index );
-      kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
-      // keep the points that satisfy geometry dist threshold
-      for ( int i = 0; i < result.size(); ++i ) {
-        if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
-          refinedColorsDists2[result.indices( i )].push_back( DistColor{result.dist( i ), color} );
-        }
-      }
-    }
-    // sort refinedColorsDists2 according to distance
-    for ( size_t index = 0; index < pointCountTarget; ++index ) {
-      std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
-                 []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
-    }
+    refinedColorsDists2.init( pointCountTarget, pointCountSource, numNeighborsColorTransferBwd,
+                              [&]( const size_t index, PCCNNResult& result, uint32_t* targets, DistColor* values ) {
+                                const PCCColor16bit color = source.getColor16bit( index );
+                                kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
+                                // keep the points that satisfy geometry dist threshold
+                                size_t count = 0;
+                                for ( int i = 0; i < result.size(); ++i ) {
+                                  if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
+                                    targets[count]  = uint32_t( result.indices( i ) );
+                                    values[count++] = DistColor{result.dist( i ), color};
+                                  }
+                                }
+                                return count;
+                              } );
   }
+  // sort refinedColorsDists2 according to distance
+  refinedColorsDists2.sortByDistance();
   // compute centroid2
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    if ( filterType == 1 && target.getBoundaryPointType( index ) != 3 ) continue;
-    const PCCColor16bit color1       = refinedColors1[index];       // refined color derived in forward direction
-    auto&               colorsDists2 = refinedColorsDists2[index];  // set of candidate points
-                                                                    // derived in backward
-                                                                    // direction
-    if ( colorsDists2.empty() || losslessAttribute ) {
-      target.setColor16bit( index, color1 );
-    } else {
-      bool              isDone = false;
-      const PCCVector3D centroid1( color1[0], color1[1], color1[2] );
-      PCCVector3D       centroid2( 0.0 );
-      if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
-        if ( colorsDists2[0].dist < 0.0001 ) {
-          auto temp = colorsDists2[0];
-          colorsDists2.clear();
-          colorsDists2.push_back( temp );
-          for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
-          isDone = true;
-        }
-      }
-      if ( !isDone ) {
-        int nNN = static_cast<int>( colorsDists2.size() );
-        while ( nNN > 0 && !isDone ) {
-          nNN = static_cast<int>( colorsDists2.size() );
-          if ( nNN == 1 ) {
-            auto temp = colorsDists2[0];
-            colorsDists2.clear();
-            colorsDists2.push_back( temp );
+  transferParallelFor( pointCountTarget, [&]( const size_t start, const size_t end ) {
+    for ( size_t index = start; index < end; ++index ) {
+      if ( filterType == 1 && target.getBoundaryPointType( index ) != 3 ) continue;
+      const PCCColor16bit color1       = refinedColors1[index];       // refined color derived in forward direction
+      auto                colorsDists2 = refinedColorsDists2[index];  // set of candidate points
+                                                                      // derived in backward
+                                                                      // direction
+      if ( colorsDists2.empty() || losslessAttribute ) {
+        target.setColor16bit( index, color1 );
+      } else {
+        bool              isDone = false;
+        const PCCVector3D centroid1( color1[0], color1[1], color1[2] );
+        PCCVector3D       centroid2( 0.0 );
+        if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
+          if ( colorsDists2[0].dist < 0.0001 ) {
+            colorsDists2.resize( 1 );
             for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
             isDone = true;
           }
-          if ( !isDone ) {
-            std::vector<PCCVector3D> colors;
-            colors.resize( 0 );
-            colors.resize( nNN );
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
+        }
+        if ( !isDone ) {
+          int nNN = static_cast<int>( colorsDists2.size() );
+          while ( nNN > 0 && !isDone ) {
+            nNN = static_cast<int>( colorsDists2.size() );
+            if ( nNN == 1 ) {
+              colorsDists2.resize( 1 );
+              for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
+              isDone = true;
             }
-            double maxColorDist2 = std::numeric_limits<double>::min();
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int j = i + 1; j < nNN; ++j ) {
-                const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-                if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+            if ( !isDone ) {
+              std::vector<PCCVector3D> colors;
+              colors.resize( 0 );
+              colors.resize( nNN );
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
               }
-            }
-            if ( maxColorDist2 <= maxColorDist2Bwd ) {
-              for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
-              if ( useDistWeightedAverageBwd ) {
-                double sumWeights{0.0};
-                for ( auto& i : colorsDists2 ) {
-                  const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                  for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( i.color[k] * weight ); }
-                  sumWeights += weight;
+              double maxColorDist2 = std::numeric_limits<double>::min();
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int j = i + 1; j < nNN; ++j ) {
+                  const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                  if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
                 }
-                centroid2 /= sumWeights;
-                if ( excludeColorOutlier ) {
-                  PCCVector3D excludeOutlierCentroid2( 0.0 );
-                  size_t      excludeCount = 0;
-                  sumWeights               = 0.0;
+              }
+              if ( maxColorDist2 <= maxColorDist2Bwd ) {
+                for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
+                if ( useDistWeightedAverageBwd ) {
+                  double sumWeights{0.0};
                   for ( auto& i : colorsDists2 ) {
-                    PCCVector3D sourceColor( i.color[0], i.color[1], i.color[2] );
-                    double      dist = ( sourceColor - centroid2 ).getNorm2();
-                    if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
-                      excludeCount += 1;
-                      continue;
-                    }
                     const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                    for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( i.color[k] * weight ); }
+                    for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( i.color[k] * weight ); }
                     sumWeights += weight;
                   }
+                  centroid2 /= sumWeights;
+                  if ( excludeColorOutlier ) {
+                    PCCVector3D excludeOutlierCentroid2( 0.0 );
+                    size_t      excludeCount = 0;
+                    sumWeights               = 0.0;
+                    for ( auto& i : colorsDists2 ) {
+                      PCCVector3D sourceColor( i.color[0], i.color[1], i.color[2] );
+                      double      dist = ( sourceColor - centroid2 ).getNorm2();
+                      if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
+                        excludeCount += 1;
+                        continue;
+                      }
+                      const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
+                      for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( i.color[k] * weight ); }
+                      sumWeights += weight;
+                    }
 
-                  if ( excludeCount != nNN && excludeCount != 0 ) { centroid2 = excludeOutlierCentroid2 / sumWeights; }
+                    if ( excludeCount != nNN && excludeCount != 0 ) {
+                      centroid2 = excludeOutlierCentroid2 / sumWeights;
+                    }
+                  }
+                } else {
+                  for ( auto& coldist : colorsDists2 ) {
+                    for ( int k = 0; k < 3; ++k ) { centroid2[k] += coldist.color[k]; }
+                  }
+                  centroid2 /= colorsDists2.size();
                 }
+                isDone = true;
               } else {
-                for ( auto& coldist : colorsDists2 ) {
-                  for ( int k = 0; k < 3; ++k ) { centroid2[k] += coldist.color[k]; }
-                }
-                centroid2 /= colorsDists2.size();
+                colorsDists2.pop_back();
               }
-              isDone = true;
-            } else {
-              colorsDists2.pop_back();
             }
           }
         }
-      }
-      auto   H  = double( colorsDists2.size() );
-      double D2 = 0.0;
-      for ( const auto& color2dist : colorsDists2 ) {
-        auto color2 = color2dist.color;
-        for ( size_t k = 0; k < 3; ++k ) {
-          const double d2 = centroid2[k] - color2[k];
-          D2 += d2 * d2;
-        }
-      }
-      const double r      = double( pointCountTarget ) / double( pointCountSource );
-      const double delta2 = ( centroid2 - centroid1 ).getNorm2();
-      const double eps    = 0.000001;
-
-      const bool fixWeight = true;        // m42538
-      if ( fixWeight || delta2 > eps ) {  // centroid2 != centroid1
-        double w = 0.0;
-
-        if ( !fixWeight ) {
-          const double alpha = D2 / delta2;
-          const double a     = H * r - 1.0;
-          const double c     = alpha * r - 1.0;
-          if ( fabs( a ) < eps ) {
-            w = -0.5 * c;
-          } else {
-            const double delta = 1.0 - a * c;
-            if ( delta >= 0.0 ) { w = ( -1.0 + sqrt( delta ) ) / a; }
+        auto   H  = double( colorsDists2.size() );
+        double D2 = 0.0;
+        for ( const auto& color2dist : colorsDists2 ) {
+          auto color2 = color2dist.color;
+          for ( size_t k = 0; k < 3; ++k ) {
+            const double d2 = centroid2[k] - color2[k];
+            D2 += d2 * d2;
           }
         }
-        const double oneMinusW = 1.0 - w;
-        PCCVector3D  color0;
-        for ( size_t k = 0; k < 3; ++k ) {
-          color0[k] = PCCClip( round( w * centroid1[k] + oneMinusW * centroid2[k] ), 0.0, 65535.0 );
-        }
-        const double rSource  = 1.0 / double( pointCountSource );
-        const double rTarget  = 1.0 / double( pointCountTarget );
-        const double maxValue = std::numeric_limits<uint16_t>::max();
-        double       minError = std::numeric_limits<double>::max();
-        PCCVector3D  bestColor( color0 );
-        PCCVector3D  color;
-        for ( int32_t s1 = -searchRange; s1 <= searchRange; ++s1 ) {
-          color[0] = PCCClip( color0[0] + s1, 0.0, maxValue );
-          for ( int32_t s2 = -searchRange; s2 <= searchRange; ++s2 ) {
-            color[1] = PCCClip( color0[1] + s2, 0.0, maxValue );
-            for ( int32_t s3 = -searchRange; s3 <= searchRange; ++s3 ) {
-              color[2] = PCCClip( color0[2] + s3, 0.0, maxValue );
-
-              double e1 = 0.0;
-              for ( size_t k = 0; k < 3; ++k ) {
-                const double d = color[k] - color1[k];
-                e1 += d * d;
-              }
-              e1 *= rTarget;
-
-              double e2 = 0.0;
-              for ( const auto& color2dist : colorsDists2 ) {
-                auto color2 = color2dist.color;
+        const double r      = double( pointCountTarget ) / double( pointCountSource );
+        const double delta2 = ( centroid2 - centroid1 ).getNorm2();
+        const double eps    = 0.000001;
+
+        const bool fixWeight = true;        // m42538
+        if ( fixWeight || delta2 > eps ) {  // centroid2 != centroid1
+          double w = 0.0;
+
+          if ( !fixWeight ) {
+            const double alpha = D2 / delta2;
+            const double a     = H * r - 1.0;
+            const double c     = alpha * r - 1.0;
+            if ( fabs( a ) < eps ) {
+              w = -0.5 * c;
+            } else {
+              const double delta = 1.0 - a * c;
+              if ( delta >= 0.0 ) { w = ( -1.0 + sqrt( delta ) ) / a; }
+            }
+          }
+          const double oneMinusW = 1.0 - w;
+          PCCVector3D  color0;
+          for ( size_t k = 0; k < 3; ++k ) {
+            color0[k] = PCCClip( round( w * centroid1[k] + oneMinusW * centroid2[k] ), 0.0, 65535.0 );
+          }
+          const double rSource  = 1.0 / double( pointCountSource );
+          const double rTarget  = 1.0 / double( pointCountTarget );
+          const double maxValue = std::numeric_limits<uint16_t>::max();
+          double       minError = std::numeric_limits<double>::max();
+          PCCVector3D  bestColor( color0 );
+          PCCVector3D  color;
+          for ( int32_t s1 = -searchRange; s1 <= searchRange; ++s1 ) {
+            color[0] = PCCClip( color0[0] + s1, 0.0, maxValue );
+            for ( int32_t s2 = -searchRange; s2 <= searchRange; ++s2 ) {
+              color[1] = PCCClip( color0[1] + s2, 0.0, maxValue );
+              for ( int32_t s3 = -searchRange; s3 <= searchRange; ++s3 ) {
+                color[2] = PCCClip( color0[2] + s3, 0.0, maxValue );
+
+                double e1 = 0.0;
                 for ( size_t k = 0; k < 3; ++k ) {
-                  const double d = color[k] - color2[k];
-                  e2 += d * d;
+                  const double d = color[k] - color1[k];
+                  e1 += d * d;
                 }
-              }
-              e2 *= rSource;
+                e1 *= rTarget;
+
+                double e2 = 0.0;
+                for ( const auto& color2dist : colorsDists2 ) {
+                  auto color2 = color2dist.color;
+                  for ( size_t k = 0; k < 3; ++k ) {
+                    const double d = color[k] - color2[k];
+                    e2 += d * d;
+                  }
+                }
+                e2 *= rSource;
 
-              const double error = std::max( e1, e2 );
-              if ( error < minError ) {
-                minError  = error;
-                bestColor = color;
+                const double error = std::max( e1, e2 );
+                if ( error < minError ) {
+                  minError  = error;
+                  bestColor = color;
+                }
               }
             }
           }
+          target.setColor16bit(
+              index, PCCColor16bit( uint16_t( bestColor[0] ), uint16_t( bestColor[1] ), uint16_t( bestColor[2] ) ) );
+        } else {  // centroid2 == centroid1
+          target.setColor16bit( index, color1 );
         }
-        target.setColor16bit(
-            index, PCCColor16bit( uint16_t( bestColor[0] ), uint16_t( bestColor[1] ), uint16_t( bestColor[2] ) ) );
-      } else {  // centroid2 == centroid1
-        target.setColor16bit( index, color1 );
       }
     }
-  }
+  } );
   return true;
 }
 
@@ -1517,8 +1621,8 @@ bool PCCPointSet3::transferColorsBackward16bitBP( PCCPointSet3& target,
   // ==========================================================================================
   // backward search first
   // ==========================================================================================
-  PCCNNResult       result;
-  std::vector<bool> newValueDecided;
+  // bytes rather than bits since the target points are decided concurrently
+  std::vector<uint8_t> newValueDecided;
   newValueDecided.resize( pointCountTarget, false );
   std::vector<PCCColor16bit> refinedColors1;
   refinedColors1.resize( pointCountTarget );
@@ -1539,151 +1643,291 @@ bool PCCPointSet3::transferColorsBackward16bitBP( PCCPointSet3& target,
   PCCKdTree kdtreePartTarget( partTarget );
 
   //////
-  std::vector<std::vector<DistColor>> refinedColorsDists2;
+  PCCTransferCandidates<DistColor> refinedColorsDists2;
   // populate refinedColorsDists2
-  refinedColorsDists2.resize( pointCountTarget );
-  for ( size_t index = 0; index < pointCountSource; ++index ) {
-    const PCCColor16bit color = source.getColor16bit( index );
-    if ( target.getBoundaryPointType( index ) != 3 ) continue;
-    if ( filterType == 9 ) {
-      kdtreePartTarget.search( source[index], numNeighborsColorTransferBwd, result );
-      for ( int i = 0; i < result.count(); ++i ) {
-        if ( result.dist( i ) <= maxGeometryDist2Bwd &&
-             ( std::abs( color[0] - partTarget.getColor16bit()[result.indices( i )][0] ) < 40 &&
-               std::abs( color[1] - partTarget.getColor16bit()[result.indices( i )][1] ) < 40 &&
-               std::abs( color[2] - partTarget.getColor16bit()[result.indices( i )][2] ) < 40 ) ) {
-          auto indexInTarget = partTarget.getParentPointIndex( result.indices( i ) );
-          if ( target.getBoundaryPointType( indexInTarget ) != 3 ) {
-            printf( "something wrong!!\n" );
-            assert( 0 );
-            exit( 0 );
+  refinedColorsDists2.init(
+      pointCountTarget, pointCountSource, numNeighborsColorTransferBwd,
+      [&]( const size_t index, PCCNNResult& result, uint32_t* targets, DistColor* values ) {
+        const PCCColor16bit color = source.getColor16bit( index );
+        size_t              count = 0;
+        if ( target.getBoundaryPointType( index ) != 3 ) { return count; }
+        if ( filterType == 9 ) {
+          kdtreePartTarget.search( source[index], numNeighborsColorTransferBwd, result );
+          for ( int i = 0; i < result.count(); ++i ) {
+            if ( result.dist( i ) <= maxGeometryDist2Bwd &&
+                 ( std::abs( color[0] - partTarget.getColor16bit()[result.indices( i )][0] ) < 40 &&
+                   std::abs( color[1] - partTarget.getColor16bit()[result.indices( i )][1] ) < 40 &&
+                   std::abs( color[2] - partTarget.getColor16bit()[result.indices( i )][2] ) < 40 ) ) {
+              auto indexInTarget = partTarget.getParentPointIndex( result.indices( i ) );
+              if ( target.getBoundaryPointType( indexInTarget ) != 3 ) {
+                printf( "something wrong!!\n" );
+                assert( 0 );
+                exit( 0 );
+              }
+              targets[count]  = uint32_t( indexInTarget );
+              values[count++] = DistColor{result.dist( i ), color, partTarget[result.indices( i )], indexInTarget,
+                                          result.indices( i )};
+            }
+          }
+        } else {
+          kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
+          // keep the points that satisfy geometry dist threshold
+          for ( int i = 0; i < result.count(); ++i ) {
+            if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
+              targets[count]  = uint32_t( result.indices( i ) );
+              values[count++] = DistColor{result.dist( i ), color};
+            }
           }
-          refinedColorsDists2[indexInTarget].push_back(
-              DistColor{result.dist( i ), color, partTarget[result.indices( i )], indexInTarget, result.indices( i )} );
-        }
-      }
-    } else {
-      kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
-      // keep the points that satisfy geometry dist threshold
-      for ( int i = 0; i < result.count(); ++i ) {
-        if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
-          refinedColorsDists2[result.indices( i )].push_back( DistColor{result.dist( i ), color} );
         }
-      }
-    }
-  }
-
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
-               []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
-  }
+        return count;
+      } );
+  refinedColorsDists2.sortByDistance();
 
   // compute centroid2
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    if ( target.getBoundaryPointType( index ) != 3 ) {
-      newValueDecided[index] = true;
-      continue;
-    }
-    if ( refinedColorsDists2[index].empty() ) { continue; }
-    auto&       colorsDists2 = refinedColorsDists2[index];
-    bool        isDone       = false;
-    PCCVector3D centroid2( 0.0 );
-    if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
-      if ( colorsDists2[0].dist < 0.0001 ) {
-        auto temp = colorsDists2[0];
-        colorsDists2.clear();
-        colorsDists2.push_back( temp );
-        for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
-        isDone = true;
+  transferParallelFor( pointCountTarget, [&]( const size_t start, const size_t end ) {
+    for ( size_t index = start; index < end; ++index ) {
+      if ( target.getBoundaryPointType( index ) != 3 ) {
+        newValueDecided[index] = true;
+        continue;
       }
-    }
-    if ( !isDone ) {
-      int nNN = static_cast<int>( colorsDists2.size() );
-      while ( nNN > 0 && !isDone ) {
-        nNN = static_cast<int>( colorsDists2.size() );
-        if ( nNN == 1 ) {
-          auto temp = colorsDists2[0];
-          colorsDists2.clear();
-          colorsDists2.push_back( temp );
+      if ( refinedColorsDists2[index].empty() ) { continue; }
+      auto        colorsDists2 = refinedColorsDists2[index];
+      bool        isDone       = false;
+      PCCVector3D centroid2( 0.0 );
+      if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
+        if ( colorsDists2[0].dist < 0.0001 ) {
+          colorsDists2.resize( 1 );
           for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
           isDone = true;
         }
-        if ( !isDone ) {
-          std::vector<PCCVector3D> colors;
-          colors.resize( 0 );
-          colors.resize( nNN );
-          for ( int i = 0; i < nNN; ++i ) {
-            for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
+      }
+      if ( !isDone ) {
+        int nNN = static_cast<int>( colorsDists2.size() );
+        while ( nNN > 0 && !isDone ) {
+          nNN = static_cast<int>( colorsDists2.size() );
+          if ( nNN == 1 ) {
+            colorsDists2.resize( 1 );
+            for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
+            isDone = true;
           }
-          double maxColorDist2 = std::numeric_limits<double>::min();
-          for ( int i = 0; i < nNN; ++i ) {
-            for ( int j = i + 1; j < nNN; ++j ) {
-              const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-              if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+          if ( !isDone ) {
+            std::vector<PCCVector3D> colors;
+            colors.resize( 0 );
+            colors.resize( nNN );
+            for ( int i = 0; i < nNN; ++i ) {
+              for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
             }
-          }
-          if ( maxColorDist2 <= maxColorDist2Bwd ) {
-            for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
-            if ( useDistWeightedAverageBwd ) {
-              double sumWeights{0.0};
-              for ( auto& i : colorsDists2 ) {
-                const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( i.color[k] * weight ); }
-                sumWeights += weight;
+            double maxColorDist2 = std::numeric_limits<double>::min();
+            for ( int i = 0; i < nNN; ++i ) {
+              for ( int j = i + 1; j < nNN; ++j ) {
+                const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
               }
-              centroid2 /= sumWeights;
-              if ( excludeColorOutlier ) {
-                PCCVector3D excludeOutlierCentroid2( 0.0 );
-                size_t      excludeCount = 0;
-                sumWeights               = 0.0;
+            }
+            if ( maxColorDist2 <= maxColorDist2Bwd ) {
+              for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
+              if ( useDistWeightedAverageBwd ) {
+                double sumWeights{0.0};
                 for ( auto& i : colorsDists2 ) {
-                  PCCVector3D sourceColor( i.color[0], i.color[1], i.color[2] );
-                  double      dist = ( sourceColor - centroid2 ).getNorm2();
-                  if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
-                    excludeCount += 1;
-                    continue;
-                  }
                   const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                  for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( i.color[k] * weight ); }
+                  for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( i.color[k] * weight ); }
                   sumWeights += weight;
                 }
+                centroid2 /= sumWeights;
+                if ( excludeColorOutlier ) {
+                  PCCVector3D excludeOutlierCentroid2( 0.0 );
+                  size_t      excludeCount = 0;
+                  sumWeights               = 0.0;
+                  for ( auto& i : colorsDists2 ) {
+                    PCCVector3D sourceColor( i.color[0], i.color[1], i.color[2] );
+                    double      dist = ( sourceColor - centroid2 ).getNorm2();
+                    if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
+                      excludeCount += 1;
+                      continue;
+                    }
+                    const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
+                    for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( i.color[k] * weight ); }
+                    sumWeights += weight;
+                  }
 
-                if ( excludeCount != nNN && excludeCount != 0 ) { centroid2 = excludeOutlierCentroid2 / sumWeights; }
+                  if ( excludeCount != nNN && excludeCount != 0 ) { centroid2 = excludeOutlierCentroid2 / sumWeights; }
+                }
+              } else {
+                for ( auto& coldist : colorsDists2 ) {
+                  for ( int k = 0; k < 3; ++k ) { centroid2[k] += coldist.color[k]; }
+                }
+                centroid2 /= colorsDists2.size();
               }
+              isDone = true;
             } else {
-              for ( auto& coldist : colorsDists2 ) {
-                for ( int k = 0; k < 3; ++k ) { centroid2[k] += coldist.color[k]; }
-              }
-              centroid2 /= colorsDists2.size();
+              colorsDists2.pop_back();
             }
-            isDone = true;
-          } else {
-            colorsDists2.pop_back();
           }
         }
       }
+
+      PCCVector3D color0;
+      for ( size_t k = 0; k < 3; ++k ) { color0[k] = PCCClip( round( centroid2[k] ), 0.0, 65535.0 ); }
+      target.setColor16bit( index,
+                            PCCColor16bit( uint16_t( color0[0] ), uint16_t( color0[1] ), uint16_t( color0[2] ) ) );
+      newValueDecided[index] = true;
     }
+  } );
+
+  // ==========================================================================================
+  //                                     Forward direction
+  // ==========================================================================================
+  // for each target point indexed by index, derive the refined color as
+  // refinedColors1[index]
+
+  transferParallelFor( pointCountTarget, [&]( const size_t start, const size_t end ) {
+    PCCNNResult result;
+    for ( size_t index = start; index < end; ++index ) {
+      PCCColor16bit colorT16bit = target.getColor16bit( index );
+      for ( int k = 0; k < 3; ++k ) { refinedColors1[index][k] = colorT16bit[k]; }
+      if ( target.getBoundaryPointType( index ) == 3 && newValueDecided[index] == false ) {
+        kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
+        // keep the points that satisfy geometry dist threshold
+        while ( true ) {
+          if ( result.count() == 1 ) { break; }
+          if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
+          result.popBack();
+        }
+        bool isDone = false;
+        if ( skipAvgIfIdenticalSourcePointPresentFwd ) {
+          if ( result.dist( 0 ) < 0.0001 ) {
+            refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
+            isDone                = true;
+          }
+        }
+        if ( !isDone ) {
+          int nNN = static_cast<int>( result.count() );
+          while ( nNN > 0 && !isDone ) {
+            if ( nNN == 1 ) {
+              refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
+              isDone                = true;
+            }
+            if ( !isDone ) {
+              std::vector<PCCVector3D> colors;
+              colors.resize( 0 );
+              colors.resize( nNN );
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int k = 0; k < 3; ++k ) {
+                  colors[i][k] = double( source.getColor16bit( result.indices( i ) )[k] );
+                }
+              }
+              double maxColorDist2 = std::numeric_limits<double>::min();
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int j = i + 1; j < nNN; ++j ) {
+                  const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                  if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+                }
+              }
+              if ( maxColorDist2 <= maxColorDist2Fwd ) {
+                PCCVector3D refinedColor( 0.0 );
+                if ( useDistWeightedAverageFwd ) {
+                  double sumWeights{0.0};
+                  for ( int i = 0; i < nNN; ++i ) {
+                    const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
+                    for ( int k = 0; k < 3; ++k ) {
+                      refinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
+                    }
+                    sumWeights += weight;
+                  }
+                  refinedColor /= sumWeights;
+                  if ( excludeColorOutlier ) {
+                    PCCVector3D excludeOutlierRefinedColor( 0.0 );
+                    size_t      excludeCount = 0;
+                    sumWeights               = 0.0;
+                    for ( int i = 0; i < nNN; ++i ) {
+                      PCCColor16bit tmpColor = source.getColor16bit( result.indices( i ) );
+                      PCCVector3D   sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
+                      double        dist = ( sourceColor - refinedColor ).getNorm2();
+                      if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
+                        excludeCount += 1;
+                        continue;
+                      }
+                      const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
+                      for ( int k = 0; k < 3; ++k ) {
+                        excludeOutlierRefinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
+                      }
+                      sumWeights += weight;
+                    }
+
+                    if ( excludeCount != nNN && excludeCount != 0 ) {
+                      refinedColor = excludeOutlierRefinedColor / sumWeights;
+                    }
+                  }
+                } else {
+                  for ( int i = 0; i < nNN; ++i ) {
+                    for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor16bit( result.indices( i ) )[k]; }
+                  }
+                  refinedColor /= nNN;
+                }
+                for ( int k = 0; k < 3; ++k ) {
+                  refinedColors1[index][k] = uint16_t( PCCClip( round( refinedColor[k] ), 0.0, 65535.0 ) );
+                }
+                isDone = true;
+              } else {
+                --nNN;
+              }
+            }
+          }  // while
+        }    //! isDone
 
-    PCCVector3D color0;
-    for ( size_t k = 0; k < 3; ++k ) { color0[k] = PCCClip( round( centroid2[k] ), 0.0, 65535.0 ); }
-    target.setColor16bit( index, PCCColor16bit( uint16_t( color0[0] ), uint16_t( color0[1] ), uint16_t( color0[2] ) ) );
-    newValueDecided[index] = true;
-  }
+        target.setColor16bit( index,
+                              PCCColor16bit( uint16_t( refinedColors1[index][0] ), uint16_t( refinedColors1[index][1] ),
+                                             uint16_t( refinedColors1[index][2] ) ) );
+      }  // if ( target.getBoundaryPointType( index ) == 3 && newValueDecided[ index ] == false )
+    }    // index
+  } );
+
+  return true;
+}
+bool PCCPointSet3::transferColors16bit( PCCPointSet3& target,
+                                        const int32_t searchRange,
+                                        const bool    losslessAttribute,
+                                        const int     numNeighborsColorTransferFwd,
+                                        const int     numNeighborsColorTransferBwd,
+                                        const bool    useDistWeightedAverageFwd,
+                                        const bool    useDistWeightedAverageBwd,
+                                        const bool    skipAvgIfIdenticalSourcePointPresentFwd,
+                                        const bool    skipAvgIfIdenticalSourcePointPresentBwd,
+                                        const double  distOffsetFwd,
+                                        const double  distOffsetBwd,
+                                        double        maxGeometryDist2Fwd,
+                                        double        maxGeometryDist2Bwd,
+                                        double        maxColorDist2Fwd,
+                                        double        maxColorDist2Bwd,
+                                        const bool    excludeColorOutlier,
+                                        const double  thresholdColorOutlierDist ) const {
+  printf( "transferColors16bit \n" );
+  const auto&  source           = *this;
+  const size_t pointCountSource = source.getPointCount();
+  const size_t pointCountTarget = target.getPointCount();
+  if ( ( pointCountSource == 0u ) || ( pointCountTarget == 0u ) || !source.hasColors() ) { return false; }
+  PCCKdTree kdtreeTarget( target );
+  PCCKdTree kdtreeSource( source );
+  target.addColors16bit();
+  std::vector<PCCColor16bit> refinedColors1;
+  refinedColors1.resize( pointCountTarget );
+  maxGeometryDist2Fwd = ( maxGeometryDist2Fwd < 512 ) ? maxGeometryDist2Fwd : std::numeric_limits<double>::max();
+  maxGeometryDist2Bwd = ( maxGeometryDist2Bwd < 512 ) ? maxGeometryDist2Bwd : std::numeric_limits<double>::max();
+  maxColorDist2Fwd    = ( maxColorDist2Fwd < 131072 ) ? maxColorDist2Fwd : std::numeric_limits<double>::max();
+  maxColorDist2Bwd    = ( maxColorDist2Bwd < 131072 ) ? maxColorDist2Bwd : std::numeric_limits<double>::max();
 
   // ==========================================================================================
   //                                     Forward direction
   // ==========================================================================================
   // for each target point indexed by index, derive the refined color as
   // refinedColors1[index]
-
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    PCCColor16bit colorT16bit = target.getColor16bit( index );
-    for ( int k = 0; k < 3; ++k ) { refinedColors1[index][k] = colorT16bit[k]; }
-    if ( target.getBoundaryPointType( index ) == 3 && newValueDecided[index] == false ) {
+  transferParallelFor( pointCountTarget, [&]( const size_t start, const size_t end ) {
+    PCCNNResult result;
+    for ( size_t index = start; index < end; ++index ) {
       kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
       // keep the points that satisfy geometry dist threshold
       while ( true ) {
-        if ( result.count() == 1 ) { break; }
+        if ( result.size() == 1 ) { break; }
         if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
         result.popBack();
       }
@@ -1695,7 +1939,7 @@ bool PCCPointSet3::transferColorsBackward16bitBP( PCCPointSet3& target,
         }
       }
       if ( !isDone ) {
-        int nNN = static_cast<int>( result.count() );
+        int nNN = static_cast<int>( result.size() );
         while ( nNN > 0 && !isDone ) {
           if ( nNN == 1 ) {
             refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
@@ -1764,143 +2008,10 @@ bool PCCPointSet3::transferColorsBackward16bitBP( PCCPointSet3& target,
               --nNN;
             }
           }
-        }  // while
-      }    //! isDone
-
-      target.setColor16bit( index,
-                            PCCColor16bit( uint16_t( refinedColors1[index][0] ), uint16_t( refinedColors1[index][1] ),
-                                           uint16_t( refinedColors1[index][2] ) ) );
-    }  // if ( target.getBoundaryPointType( index ) == 3 && newValueDecided[ index ] == false )
-  }    // index
-
-  return true;
-}
-bool PCCPointSet3::transferColors16bit( PCCPointSet3& target,
-                                        const int32_t searchRange,
-                                        const bool    losslessAttribute,
-                                        const int     numNeighborsColorTransferFwd,
-                                        const int     numNeighborsColorTransferBwd,
-                                        const bool    useDistWeightedAverageFwd,
-                                        const bool    useDistWeightedAverageBwd,
-                                        const bool    skipAvgIfIdenticalSourcePointPresentFwd,
-                                        const bool    skipAvgIfIdenticalSourcePointPresentBwd,
-                                        const double  distOffsetFwd,
-                                        const double  distOffsetBwd,
-                                        double        maxGeometryDist2Fwd,
-                                        double        maxGeometryDist2Bwd,
-                                        double        maxColorDist2Fwd,
-                                        double        maxColorDist2Bwd,
-                                        const bool    excludeColorOutlier,
-                                        const double  thresholdColorOutlierDist ) const {
-  printf( "transferColors16bit \n" );
-  const auto&  source           = *this;
-  const size_t pointCountSource = source.getPointCount();
-  const size_t pointCountTarget = target.getPointCount();
-  if ( ( pointCountSource == 0u ) || ( pointCountTarget == 0u ) || !source.hasColors() ) { return false; }
-  PCCKdTree kdtreeTarget( target );
-  PCCKdTree kdtreeSource( source );
-  target.addColors16bit();
-  std::vector<PCCColor16bit> refinedColors1;
-  refinedColors1.resize( pointCountTarget );
-  maxGeometryDist2Fwd = ( maxGeometryDist2Fwd < 512 ) ? maxGeometryDist2Fwd : std::numeric_limits<double>::max();
-  maxGeometryDist2Bwd = ( maxGeometryDist2Bwd < 512 ) ? maxGeometryDist2Bwd : std::numeric_limits<double>::max();
-  maxColorDist2Fwd    = ( maxColorDist2Fwd < 131072 ) ? maxColorDist2Fwd : std::numeric_limits<double>::max();
-  maxColorDist2Bwd    = ( maxColorDist2Bwd < 131072 ) ? maxColorDist2Bwd : std::numeric_limits<double>::max();
-
-  // ==========================================================================================
-  //                                     Forward direction
-  // ==========================================================================================
-  // for each target point indexed by index, derive the refined color as
-  // refinedColors1[index]
-  PCCNNResult result;
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
-    // keep the points that satisfy geometry dist threshold
-    while ( true ) {
-      if ( result.size() == 1 ) { break; }
-      if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
-      result.popBack();
-    }
-    bool isDone = false;
-    if ( skipAvgIfIdenticalSourcePointPresentFwd ) {
-      if ( result.dist( 0 ) < 0.0001 ) {
-        refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
-        isDone                = true;
-      }
-    }
-    if ( !isDone ) {
-      int nNN = static_cast<int>( result.size() );
-      while ( nNN > 0 && !isDone ) {
-        if ( nNN == 1 ) {
-          refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
-          isDone                = true;
-        }
-        if ( !isDone ) {
-          std::vector<PCCVector3D> colors;
-          colors.resize( 0 );
-          colors.resize( nNN );
-          for ( int i = 0; i < nNN; ++i ) {
-            for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( source.getColor16bit( result.indices( i ) )[k] ); }
-          }
-          double maxColorDist2 = std::numeric_limits<double>::min();
-          for ( int i = 0; i < nNN; ++i ) {
-            for ( int j = i + 1; j < nNN; ++j ) {
-              const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-              if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
-            }
-          }
-          if ( maxColorDist2 <= maxColorDist2Fwd ) {
-            PCCVector3D refinedColor( 0.0 );
-            if ( useDistWeightedAverageFwd ) {
-              double sumWeights{0.0};
-              for ( int i = 0; i < nNN; ++i ) {
-                const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
-                for ( int k = 0; k < 3; ++k ) {
-                  refinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
-                }
-                sumWeights += weight;
-              }
-              refinedColor /= sumWeights;
-              if ( excludeColorOutlier ) {
-                PCCVector3D excludeOutlierRefinedColor( 0.0 );
-                size_t      excludeCount = 0;
-                sumWeights               = 0.0;
-                for ( int i = 0; i < nNN; ++i ) {
-                  PCCColor16bit tmpColor = source.getColor16bit( result.indices( i ) );
-                  PCCVector3D   sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
-                  double        dist = ( sourceColor - refinedColor ).getNorm2();
-                  if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
-                    excludeCount += 1;
-                    continue;
-                  }
-                  const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
-                  for ( int k = 0; k < 3; ++k ) {
-                    excludeOutlierRefinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
-                  }
-                  sumWeights += weight;
-                }
-
-                if ( excludeCount != nNN && excludeCount != 0 ) {
-                  refinedColor = excludeOutlierRefinedColor / sumWeights;
-                }
-              }
-            } else {
-              for ( int i = 0; i < nNN; ++i ) {
-                for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor16bit( result.indices( i ) )[k]; }
-              }
-              refinedColor /= nNN;
-            }
-            for ( int k = 0; k < 3; ++k ) {
-              refinedColors1[index][k] = uint16_t( PCCClip( round( refinedColor[k] ), 0.0, 65535.0 ) );
-            }
-            isDone = true;
-          } else {
-            --nNN;
-          }
         }
       }
     }
-  }
+  } );
   // ==========================================================================================
   //                                  Backward direction
   // ==========================================================================================
@@ -1909,189 +2020,189 @@ bool PCCPointSet3::transferColors16bit( PCCPointSet3& target,
   // colorsDists2 is iteratively refined (by removing the farthest points) until
   // the
   // std of remaining colors in it is smaller than a threshold.
-  std::vector<std::vector<DistColor>> refinedColorsDists2;
-  refinedColorsDists2.resize( pointCountTarget );
+  PCCTransferCandidates<DistColor> refinedColorsDists2;
   // populate refinedColorsDists2
-  for ( size_t index = 0; index < pointCountSource; ++index ) {
-    const PCCColor16bit color = source.getColor16bit( index );
-    kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
-    // keep the points that satisfy geometry dist threshold
-    for ( int i = 0; i < result.size(); ++i ) {
-      if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
-        refinedColorsDists2[result.indices( i )].push_back( DistColor{result.dist( i ), color} );
-      }
-    }
-  }
+  refinedColorsDists2.init( pointCountTarget, pointCountSource, numNeighborsColorTransferBwd,
+                            [&]( const size_t index, PCCNNResult& result, uint32_t* targets, DistColor* values ) {
+                              const PCCColor16bit color = source.getColor16bit( index );
+                              kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
+                              // keep the points that satisfy geometry dist threshold
+                              size_t count = 0;
+                              for ( int i = 0; i < result.size(); ++i ) {
+                                if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
+                                  targets[count]  = uint32_t( result.indices( i ) );
+                                  values[count++] = DistColor{result.dist( i ), color};
+                                }
+                              }
+                              return count;
+                            } );
   // sort refinedColorsDists2 according to distance
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
-               []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
-  }
+  refinedColorsDists2.sortByDistance();
   // compute centroid2
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    const PCCColor16bit color1       = refinedColors1[index];       // refined color derived in forward direction
-    auto&               colorsDists2 = refinedColorsDists2[index];  // set of candidate points
-                                                                    // derived in backward
-                                                                    // direction
-    if ( colorsDists2.empty() || losslessAttribute ) {
-      target.setColor16bit( index, color1 );
-    } else {
-      bool              isDone = false;
-      const PCCVector3D centroid1( color1[0], color1[1], color1[2] );
-      PCCVector3D       centroid2( 0.0 );
-      if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
-        if ( colorsDists2[0].dist < 0.0001 ) {
-          auto temp = colorsDists2[0];
-          colorsDists2.clear();
-          colorsDists2.push_back( temp );
-          for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
-          isDone = true;
-        }
-      }
-      if ( !isDone ) {
-        int nNN = static_cast<int>( colorsDists2.size() );
-        while ( nNN > 0 && !isDone ) {
-          nNN = static_cast<int>( colorsDists2.size() );
-          if ( nNN == 1 ) {
-            auto temp = colorsDists2[0];
-            colorsDists2.clear();
-            colorsDists2.push_back( temp );
+  transferParallelFor( pointCountTarget, [&]( const size_t start, const size_t end ) {
+    for ( size_t index = start; index < end; ++index ) {
+      const PCCColor16bit color1       = refinedColors1[index];       // refined color derived in forward direction
+      auto                colorsDists2 = refinedColorsDists2[index];  // set of candidate points
+                                                                      // derived in backward
+                                                                      // direction
+      if ( colorsDists2.empty() || losslessAttribute ) {
+        target.setColor16bit( index, color1 );
+      } else {
+        bool              isDone = false;
+        const PCCVector3D centroid1( color1[0], color1[1], color1[2] );
+        PCCVector3D       centroid2( 0.0 );
+        if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
+          if ( colorsDists2[0].dist < 0.0001 ) {
+            colorsDists2.resize( 1 );
             for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
             isDone = true;
           }
-          if ( !isDone ) {
-            std::vector<PCCVector3D> colors;
-            colors.resize( 0 );
-            colors.resize( nNN );
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
+        }
+        if ( !isDone ) {
+          int nNN = static_cast<int>( colorsDists2.size() );
+          while ( nNN > 0 && !isDone ) {
+            nNN = static_cast<int>( colorsDists2.size() );
+            if ( nNN == 1 ) {
+              colorsDists2.resize( 1 );
+              for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
+              isDone = true;
             }
-            double maxColorDist2 = std::numeric_limits<double>::min();
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int j = i + 1; j < nNN; ++j ) {
-                const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-                if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+            if ( !isDone ) {
+              std::vector<PCCVector3D> colors;
+              colors.resize( 0 );
+              colors.resize( nNN );
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
               }
-            }
-            if ( maxColorDist2 <= maxColorDist2Bwd ) {
-              for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
-              if ( useDistWeightedAverageBwd ) {
-                double sumWeights{0.0};
-                for ( auto& i : colorsDists2 ) {
-                  const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                  for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( i.color[k] * weight ); }
-                  sumWeights += weight;
+              double maxColorDist2 = std::numeric_limits<double>::min();
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int j = i + 1; j < nNN; ++j ) {
+                  const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                  if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
                 }
-                centroid2 /= sumWeights;
-                if ( excludeColorOutlier ) {
-                  PCCVector3D excludeOutlierCentroid2( 0.0 );
-                  size_t      excludeCount = 0;
-                  sumWeights               = 0.0;
+              }
+              if ( maxColorDist2 <= maxColorDist2Bwd ) {
+                for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
+                if ( useDistWeightedAverageBwd ) {
+                  double sumWeights{0.0};
                   for ( auto& i : colorsDists2 ) {
-                    PCCVector3D sourceColor( i.color[0], i.color[1], i.color[2] );
-                    double      dist = ( sourceColor - centroid2 ).getNorm2();
-                    if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
-                      excludeCount += 1;
-                      continue;
-                    }
                     const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                    for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( i.color[k] * weight ); }
+                    for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( i.color[k] * weight ); }
                     sumWeights += weight;
                   }
+                  centroid2 /= sumWeights;
+                  if ( excludeColorOutlier ) {
+                    PCCVector3D excludeOutlierCentroid2( 0.0 );
+                    size_t      excludeCount = 0;
+                    sumWeights               = 0.0;
+                    for ( auto& i : colorsDists2 ) {
+                      PCCVector3D sourceColor( i.color[0], i.color[1], i.color[2] );
+                      double      dist = ( sourceColor - centroid2 ).getNorm2();
+                      if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
+                        excludeCount += 1;
+                        continue;
+                      }
+                      const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
+                      for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( i.color[k] * weight ); }
+                      sumWeights += weight;
+                    }
 
-                  if ( excludeCount != nNN && excludeCount != 0 ) { centroid2 = excludeOutlierCentroid2 / sumWeights; }
+                    if ( excludeCount != nNN && excludeCount != 0 ) {
+                      centroid2 = excludeOutlierCentroid2 / sumWeights;
+                    }
+                  }
+                } else {
+                  for ( auto& coldist : colorsDists2 ) {
+                    for ( int k = 0; k < 3; ++k ) { centroid2[k] += coldist.color[k]; }
+                  }
+                  centroid2 /= colorsDists2.size();
                 }
+                isDone = true;
               } else {
-                for ( auto& coldist : colorsDists2 ) {
-                  for ( int k = 0; k < 3; ++k ) { centroid2[k] += coldist.color[k]; }
-                }
-                centroid2 /= colorsDists2.size();
+                colorsDists2.pop_back();
               }
-              isDone = true;
-            } else {
-              colorsDists2.pop_back();
             }
           }
         }
-      }
-      auto   H  = double( colorsDists2.size() );
-      double D2 = 0.0;
-      for ( const auto& color2dist : colorsDists2 ) {
-        auto color2 = color2dist.color;
-        for ( size_t k = 0; k < 3; ++k ) {
-          const double d2 = centroid2[k] - color2[k];
-          D2 += d2 * d2;
-        }
-      }
-      const double r      = double( pointCountTarget ) / double( pointCountSource );
-      const double delta2 = ( centroid2 - centroid1 ).getNorm2();
-      const double eps    = 0.000001;
-
-      const bool fixWeight = true;        // m42538
-      if ( fixWeight || delta2 > eps ) {  // centroid2 != centroid1
-        double w = 0.0;
-
-        if ( !fixWeight ) {
-          const double alpha = D2 / delta2;
-          const double a     = H * r - 1.0;
-          const double c     = alpha * r - 1.0;
-          if ( fabs( a ) < eps ) {
-            w = -0.5 * c;
-          } else {
-            const double delta = 1.0 - a * c;
-            if ( delta >= 0.0 ) { w = ( -1.0 + sqrt( delta ) ) / a; }
+        auto   H  = double( colorsDists2.size() );
+        double D2 = 0.0;
+        for ( const auto& color2dist : colorsDists2 ) {
+          auto color2 = color2dist.color;
+          for ( size_t k = 0; k < 3; ++k ) {
+            const double d2 = centroid2[k] - color2[k];
+            D2 += d2 * d2;
           }
         }
-        const double oneMinusW = 1.0 - w;
-        PCCVector3D  color0;
-        for ( size_t k = 0; k < 3; ++k ) {
-          color0[k] = PCCClip( round( w * centroid1[k] + oneMinusW * centroid2[k] ), 0.0, 65535.0 );
-        }
-        const double rSource  = 1.0 / double( pointCountSource );
-        const double rTarget  = 1.0 / double( pointCountTarget );
-        const double maxValue = std::numeric_limits<uint16_t>::max();
-        double       minError = std::numeric_limits<double>::max();
-        PCCVector3D  bestColor( color0 );
-        PCCVector3D  color;
-        for ( int32_t s1 = -searchRange; s1 <= searchRange; ++s1 ) {
-          color[0] = PCCClip( color0[0] + s1, 0.0, maxValue );
-          for ( int32_t s2 = -searchRange; s2 <= searchRange; ++s2 ) {
-            color[1] = PCCClip( color0[1] + s2, 0.0, maxValue );
-            for ( int32_t s3 = -searchRange; s3 <= searchRange; ++s3 ) {
-              color[2] = PCCClip( color0[2] + s3, 0.0, maxValue );
-
-              double e1 = 0.0;
-              for ( size_t k = 0; k < 3; ++k ) {
-                const double d = color[k] - color1[k];
-                e1 += d * d;
-              }
-              e1 *= rTarget;
-
-              double e2 = 0.0;
-              for ( const auto& color2dist : colorsDists2 ) {
-                auto color2 = color2dist.color;
+        const double r      = double( pointCountTarget ) / double( pointCountSource );
+        const double delta2 = ( centroid2 - centroid1 ).getNorm2();
+        const double eps    = 0.000001;
+
+        const bool fixWeight = true;        // m42538
+        if ( fixWeight || delta2 > eps ) {  // centroid2 != centroid1
+          double w = 0.0;
+
+          if ( !fixWeight ) {
+            const double alpha = D2 / delta2;
+            const double a     = H * r - 1.0;
+            const double c     = alpha * r - 1.0;
+            if ( fabs( a ) < eps ) {
+              w = -0.5 * c;
+            } else {
+              const double delta = 1.0 - a * c;
+              if ( delta >= 0.0 ) { w = ( -1.0 + sqrt( delta ) ) / a; }
+            }
+          }
+          const double oneMinusW = 1.0 - w;
+          PCCVector3D  color0;
+          for ( size_t k = 0; k < 3; ++k ) {
+            color0[k] = PCCClip( round( w * centroid1[k] + oneMinusW * centroid2[k] ), 0.0, 65535.0 );
+          }
+          const double rSource  = 1.0 / double( pointCountSource );
+          const double rTarget  = 1.0 / double( pointCountTarget );
+          const double maxValue = std::numeric_limits<uint16_t>::max();
+          double       minError = std::numeric_limits<double>::max();
+          PCCVector3D  bestColor( color0 );
+          PCCVector3D  color;
+          for ( int32_t s1 = -searchRange; s1 <= searchRange; ++s1 ) {
+            color[0] = PCCClip( color0[0] + s1, 0.0, maxValue );
+            for ( int32_t s2 = -searchRange; s2 <= searchRange; ++s2 ) {
+              color[1] = PCCClip( color0[1] + s2, 0.0, maxValue );
+              for ( int32_t s3 = -searchRange; s3 <= searchRange; ++s3 ) {
+                color[2] = PCCClip( color0[2] + s3, 0.0, maxValue );
+
+                double e1 = 0.0;
                 for ( size_t k = 0; k < 3; ++k ) {
-                  const double d = color[k] - color2[k];
-                  e2 += d * d;
+                  const double d = color[k] - color1[k];
+                  e1 += d * d;
                 }
-              }
-              e2 *= rSource;
+                e1 *= rTarget;
+
+                double e2 = 0.0;
+                for ( const auto& color2dist : colorsDists2 ) {
+                  auto color2 = color2dist.color;
+                  for ( size_t k = 0; k < 3; ++k ) {
+                    const double d = color[k] - color2[k];
+                    e2 += d * d;
+                  }
+                }
+                e2 *= rSource;
 
-              const double error = std::max( e1, e2 );
-              if ( error < minError ) {
-                minError  = error;
-                bestColor = color;
+                const double error = std::max( e1, e2 );
+                if ( error < minError ) {
+                  minError  = error;
+                  bestColor = color;
+                }
               }
             }
           }
+          target.setColor16bit(
+              index, PCCColor16bit( uint16_t( bestColor[0] ), uint16_t( bestColor[1] ), uint16_t( bestColor[2] ) ) );
+        } else {  // centroid2 == centroid1
+          target.setColor16bit( index, color1 );
         }
-        target.setColor16bit(
-            index, PCCColor16bit( uint16_t( bestColor[0] ), uint16_t( bestColor[1] ), uint16_t( bestColor[2] ) ) );
-      } else {  // centroid2 == centroid1
-        target.setColor16bit( index, color1 );
       }
     }
-  }
+  } );
   return true;
 }
 bool PCCPointSet3::transferColorsFilter3( PCCPointSet3& target,
@@ -2106,67 +2217,72 @@ bool PCCPointSet3::transferColorsFilter3( PCCPointSet3& target,
   PCCKdTree kdtreeTarget( target );
   PCCKdTree kdtreeSource( source );
   target.addColors();
-  std::vector<PCCColor3B>              refinedColors1;
-  std::vector<std::vector<PCCColor3B>> refinedColors2;
+  std::vector<PCCColor3B>           refinedColors1;
+  PCCTransferCandidates<PCCColor3B> refinedColors2;
   refinedColors1.resize( pointCountTarget );
-  refinedColors2.resize( pointCountTarget );
   const size_t num_results = 1;
-  PCCNNResult  result;
   //  Find THE closest point in reconstruction to each source point
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    kdtreeSource.search( target[index], num_results, result );
-    refinedColors1[index] = source.getColor( result.indices( 0 ) );
-  }
+  transferParallelFor( pointCountTarget, [&]( const size_t start, const size_t end ) {
+    PCCNNResult result;
+    for ( size_t index = start; index < end; ++index ) {
+      kdtreeSource.search( target[index], num_results, result );
+      refinedColors1[index] = source.getColor( result.indices( 0 ) );
+    }
+  } );
   //  Find points in source that are closest to point in reconstruction
-  for ( size_t index = 0; index < pointCountSource; ++index ) {
-    const PCCColor3B color = source.getColor( index );
-    kdtreeTarget.search( source[index], num_results, result );
-    refinedColors2[result.indices( 0 )].push_back( color );
-  }
-
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    const PCCColor3B               color1  = refinedColors1[index];
-    const std::vector<PCCColor3B>& colors2 = refinedColors2[index];
-    if ( colors2.empty() || losslessAttribute ) {
-      target.setColor( index, color1 );
-    } else {
-      const auto        H = double( colors2.size() );
-      const PCCVector3D centroid1( color1[0], color1[1], color1[2] );
-      PCCVector3D       centroid2( 0.0 );
-      for ( const auto& color2 : colors2 ) {
-        for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += color2[k]; }
-      }
-      centroid2 /= H;
+  refinedColors2.init( pointCountTarget, pointCountSource, num_results,
+                       [&]( const size_t index, PCCNNResult& result, uint32_t* targets, PCCColor3B* values ) {
+                         kdtreeTarget.search( source[index], num_results, result );
+                         targets[0] = uint32_t( result.indices( 0 ) );
+                         values[0]  = source.getColor( index );
+                         return size_t( 1 );
+                       } );
+
+  transferParallelFor( pointCountTarget, [&]( const size_t start, const size_t end ) {
+    for ( size_t index = start; index < end; ++index ) {
+      const PCCColor3B color1  = refinedColors1[index];
+      const auto       colors2 = refinedColors2[index];
+      if ( colors2.empty() || losslessAttribute ) {
+        target.setColor( index, color1 );
+      } else {
+        const auto        H = double( colors2.size() );
+        const PCCVector3D centroid1( color1[0], color1[1], color1[2] );
+        PCCVector3D       centroid2( 0.0 );
+        for ( const auto& color2 : colors2 ) {
+          for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += color2[k]; }
+        }
+        centroid2 /= H;
 
-      double D2 = 0.0;
-      for ( const auto& color2 : colors2 ) {
-        for ( size_t k = 0; k < 3; ++k ) {
-          const double d2 = centroid2[k] - color2[k];
-          D2 += d2 * d2;
+        double D2 = 0.0;
+        for ( const auto& color2 : colors2 ) {
+          for ( size_t k = 0; k < 3; ++k ) {
+            const double d2 = centroid2[k] - color2[k];
+            D2 += d2 * d2;
+          }
         }
-      }
-      //      const double r = double(pointCountTarget) /
-      // double(pointCountSource);
-      const double delta2 = ( centroid2 - centroid1 ).getNorm2();
-      const double eps    = 0.000001;
-
-      const bool fixWeight = true;        // m42538
-      if ( fixWeight || delta2 > eps ) {  // centroid2 != centroid1
-        double w = 0.0;
-
-        const double oneMinusW = 1.0 - w;
-        PCCVector3D  color0;
-        for ( size_t k = 0; k < 3; ++k ) {
-          color0[k] = PCCClip( round( w * centroid1[k] + oneMinusW * centroid2[k] ), 0.0, 65535.0 );
+        //      const double r = double(pointCountTarget) /
+        // double(pointCountSource);
+        const double delta2 = ( centroid2 - centroid1 ).getNorm2();
+        const double eps    = 0.000001;
+
+        const bool fixWeight = true;        // m42538
+        if ( fixWeight || delta2 > eps ) {  // centroid2 != centroid1
+          double w = 0.0;
+
+          const double oneMinusW = 1.0 - w;
+          PCCVector3D  color0;
+          for ( size_t k = 0; k < 3; ++k ) {
+            color0[k] = PCCClip( round( w * centroid1[k] + oneMinusW * centroid2[k] ), 0.0, 65535.0 );
+          }
+          PCCVector3D bestColor( color0 );
+          target.setColor( index,
+                           PCCColor3B( uint8_t( bestColor[0] ), uint8_t( bestColor[1] ), uint8_t( bestColor[2] ) ) );
+        } else {  // centroid2 == centroid1
+          target.setColor( index, color1 );
         }
-        PCCVector3D bestColor( color0 );
-        target.setColor( index,
-                         PCCColor3B( uint8_t( bestColor[0] ), uint8_t( bestColor[1] ), uint8_t( bestColor[2] ) ) );
-      } else {  // centroid2 == centroid1
-        target.setColor( index, color1 );
       }
     }
-  }
+  } );
   return true;
 }
 
@@ -2181,69 +2297,75 @@ bool PCCPointSet3::transferColorSimple( PCCPointSet3& target, const double bestC
   PCCKdTree kdtreeSource( source );
   PCCKdTree kdtreeTarget( target );
 
-  std::vector<PCCColor3B>              refinedColors1;
-  std::vector<std::vector<PCCColor3B>> refinedColors2;
+  std::vector<PCCColor3B>           refinedColors1;
+  PCCTransferCandidates<PCCColor3B> refinedColors2;
   refinedColors1.resize( pointCountTarget );
-  refinedColors2.resize( pointCountTarget );
   const size_t num_results = 1;
-  PCCNNResult  result;
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    kdtreeSource.search( target[index], num_results, result );
-    refinedColors1[index] = source.getColor( result.indices( 0 ) );
-  }
-  for ( size_t index = 0; index < pointCountSource; ++index ) {
-    const PCCColor3B color = source.getColor( index );
-    kdtreeTarget.search( source[index], num_results, result );
-    refinedColors2[result.indices( 0 )].push_back( color );
-  }
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    const PCCColor3B              color1  = refinedColors1[index];
-    const std::vector<PCCColor3B> colors2 = refinedColors2[index];
-    if ( colors2.empty() ) {
-      target.setColor( index, color1 );
-    } else {
-      double      s        = 1.0 / colors2.size();
-      double      r1       = 1.0 / pointCountTarget;
-      double      r2       = 1.0 / ( pointCountSource * colors2.size() );
-      double      w1       = 0.0;
-      double      minError = std::numeric_limits<double>::max();
-      PCCVector3D bestColor;
-      while ( w1 <= 1.0 ) {
-        const double w2 = 1.0 - w1;
-        PCCVector3D  color( 0.0 );
-        for ( const auto& color2 : colors2 ) {
-          for ( size_t k = 0; k < 3; ++k ) { color[k] += color2[k]; }
-        }
-        for ( size_t k = 0; k < 3; ++k ) {
-          color[k] = ( std::min )( round( w2 * s * color[k] + w1 * color1[k] ), 255.0 );
-        }
-
-        double e1 = 0.0;
-        for ( size_t k = 0; k < 3; ++k ) {
-          const double d = color[k] - color1[k];
-          e1 += d * d;
-        }
-        e1 *= r1;
+  transferParallelFor( pointCountTarget, [&]( const size_t start, const size_t end ) {
+    PCCNNResult result;
+    for ( size_t index = start; index < end; ++index ) {
+      kdtreeSource.search( target[index], num_results, result );
+      refinedColors1[index] = source.getColor( result.indices( 0 ) );
+    }
+  } );
+  refinedColors2.init( pointCountTarget, pointCountSource, num_results,
+                       [&]( const size_t index, PCCNNResult& result, uint32_t* targets, PCCColor3B* values ) {
+                         kdtreeTarget.search( source[index], num_results, result );
+                         targets[0] = uint32_t( result.indices( 0 ) );
+                         values[0]  = source.getColor( index );
+                         return size_t( 1 );
+                       } );
+  transferParallelFor( pointCountTarget, [&]( const size_t start, const size_t end ) {
+    for ( size_t index = start; index < end; ++index ) {
+      const PCCColor3B color1  = refinedColors1[index];
+      const auto       colors2 = refinedColors2[index];
+      if ( colors2.empty() ) {
+        target.setColor( index, color1 );
+      } else {
+        double      s        = 1.0 / colors2.size();
+        double      r1       = 1.0 / pointCountTarget;
+        double      r2       = 1.0 / ( pointCountSource * colors2.size() );
+        double      w1       = 0.0;
+        double      minError = std::numeric_limits<double>::max();
+        PCCVector3D bestColor;
+        while ( w1 <= 1.0 ) {
+          const double w2 = 1.0 - w1;
+          PCCVector3D  color( 0.0 );
+          for ( const auto& color2 : colors2 ) {
+            for ( size_t k = 0; k < 3; ++k ) { color[k] += color2[k]; }
+          }
+          for ( size_t k = 0; k < 3; ++k ) {
+            color[k] = ( std::min )( round( w2 * s * color[k] + w1 * color1[k] ), 255.0 );
+          }
 
-        double e2 = 0.0;
-        for ( const auto& color2 : colors2 ) {
+          double e1 = 0.0;
           for ( size_t k = 0; k < 3; ++k ) {
-            const double d = color[k] - color2[k];
-            e2 += d * d;
+            const double d = color[k] - color1[k];
+            e1 += d * d;
           }
-        }
-        e2 *= r2;
+          e1 *= r1;
 
-        const double e = ( std::max )( e1, e2 );
-        if ( e < minError ) {
-          bestColor = color;
-          minError  = e;
+          double e2 = 0.0;
+          for ( const auto& color2 : colors2 ) {
+            for ( size_t k = 0; k < 3; ++k ) {
+              const double d = color[k] - color2[k];
+              e2 += d * d;
+            }
+          }
+          e2 *= r2;
+
+          const double e = ( std::max )( e1, e2 );
+          if ( e < minError ) {
+            bestColor = color;
+            minError  = e;
+          }
+          w1 += bestColorSearchStep;
         }
-        w1 += bestColorSearchStep;
+        target.setColor( index,
+                         PCCColor3B( uint8_t( bestColor[0] ), uint8_t( bestColor[1] ), uint8_t( bestColor[2] ) ) );
       }
-      target.setColor( index, PCCColor3B( uint8_t( bestColor[0] ), uint8_t( bestColor[1] ), uint8_t( bestColor[2] ) ) );
     }
-  }
+  } );
   return true;
 }
 
@@ -2254,28 +2376,30 @@ bool PCCPointSet3::transferColorWeight( PCCPointSet3& target, const double bestC
   if ( ( pointCountSource == 0u ) || ( pointCountTarget == 0u ) || !source.hasColors() ) { return false; }
   target.addColors16bit();
   PCCKdTree    kdtreeSource( source );
-  PCCNNResult  result;
   const size_t num_results = 5;
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    kdtreeSource.search( target[index], num_results, result );
-    PCCVector3D color16bit( 0.0 );
-    if ( result.size() > 1 && result.dist( 0 ) > 0.0001 ) {
-      double sum = 0;
-      for ( size_t i = 0; i < result.size(); ++i ) {
-        const double w     = 1.0 / pow( result.dist( i ), 2.0 );
-        auto         found = source.getColor16bit( result.indices( i ) );
-        PCCVector3D  scaled;
-        scaled = found;
-        color16bit += scaled * w;
-        sum += w;
+  transferParallelFor( pointCountTarget, [&]( const size_t start, const size_t end ) {
+    PCCNNResult result;
+    for ( size_t index = start; index < end; ++index ) {
+      kdtreeSource.search( target[index], num_results, result );
+      PCCVector3D color16bit( 0.0 );
+      if ( result.size() > 1 && result.dist( 0 ) > 0.0001 ) {
+        double sum = 0;
+        for ( size_t i = 0; i < result.size(); ++i ) {
+          const double w     = 1.0 / pow( result.dist( i ), 2.0 );
+          auto         found = source.getColor16bit( result.indices( i ) );
+          PCCVector3D  scaled;
+          scaled = found;
+          color16bit += scaled * w;
+          sum += w;
+        }
+        color16bit /= sum;
+      } else {
+        const auto& found = source.getColor16bit( result.indices( 0 ) );
+        color16bit        = found;
       }
-      color16bit /= sum;
-    } else {
-      const auto& found = source.getColor16bit( result.indices( 0 ) );
-      color16bit        = found;
+      target.getColor16bit( index ) = color16bit;
     }
-    target.getColor16bit( index ) = color16bit;
-  }
+  } );
   return true;
 }
 
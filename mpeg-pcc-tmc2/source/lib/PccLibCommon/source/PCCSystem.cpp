@@ -36,10 +36,21 @@
 #include <windows.h>
 #endif
 
+#include <atomic>
 #include <chrono>
+#include <cstdio>
 #include <memory>
+#include <thread>
 #include "PCCSystem.h"
 
+#if HAVE_MKFIFO
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 //===========================================================================
 
 #if _WIN32
@@ -105,3 +116,52 @@ int pcc::system( const char* command ) noexcept {
 #endif
 
 //===========================================================================
+
+int pcc::system( const char* command, const std::vector<PCCSystemStream>& streams ) {
+  for ( const auto& stream : streams ) { std::remove( stream.path_.c_str() ); }
+#if HAVE_MKFIFO
+  bool fifo = true;
+  for ( const auto& stream : streams ) { fifo = fifo && mkfifo( stream.path_.c_str(), 0600 ) == 0; }
+  if ( fifo ) {
+    std::vector<std::atomic<bool>> done( streams.size() );
+    std::vector<std::thread>       transfers;
+    for ( size_t i = 0; i < streams.size(); i++ ) {
+      done[i] = false;
+      transfers.emplace_back( [&, i] {
+        // a child exiting before reading all its input must not raise SIGPIPE
+        sigset_t signals;
+        sigemptyset( &signals );
+        sigaddset( &signals, SIGPIPE );
+        pthread_sigmask( SIG_BLOCK, &signals, nullptr );
+        streams[i].transfer_( streams[i].path_ );
+        done[i] = true;
+      } );
+    }
+    const int ret = pcc::system( command );
+    // release the transfers still waiting for the child to open their FIFO
+    for ( size_t i = 0; i < streams.size(); i++ ) {
+      while ( !done[i] ) {
+        const int flags = ( streams[i].input_ ? O_RDONLY : O_WRONLY ) | O_NONBLOCK | O_CLOEXEC;
+        const int fd    = open( streams[i].path_.c_str(), flags );
+        if ( fd >= 0 ) { close( fd ); }
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+      }
+    }
+    for ( auto& transfer : transfers ) { transfer.join(); }
+    for ( const auto& stream : streams ) { std::remove( stream.path_.c_str() ); }
+    return ret;
+  }
+  for ( const auto& stream : streams ) { std::remove( stream.path_.c_str() ); }
+#endif
+  for ( const auto& stream : streams ) {
+    if ( stream.input_ ) { stream.transfer_( stream.path_ ); }
+  }
+  const int ret = pcc::system( command );
+  for ( const auto& stream : streams ) {
+    if ( !stream.input_ ) { stream.transfer_( stream.path_ ); }
+  }
+  for ( const auto& stream : streams ) { std::remove( stream.path_.c_str() ); }
+  return ret;
+}
+
+//===========================================================================
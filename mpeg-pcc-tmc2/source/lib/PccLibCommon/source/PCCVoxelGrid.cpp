@@ -0,0 +1,265 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "PCCCommon.h"
+
+#include "PCCPointSet.h"
+#include "PCCVoxelGrid.h"
+
+using namespace pcc;
+
+static const int64_t g_infiniteDistance = ( std::numeric_limits<int64_t>::max )();
+
+void PCCVoxelGrid::init( const PCCPointSet3& pointCloud ) {
+  const size_t pointCount = pointCloud.getPointCount();
+  positions_.clear();
+  indices_.clear();
+  cells_.clear();
+  table_.clear();
+  for ( size_t a = 0; a < 3; a++ ) {
+    min_[a] = 0;
+    max_[a] = -1;
+  }
+  if ( pointCount == 0 ) { return; }
+  tableBits_ = 4;
+  while ( ( size_t( 1 ) << tableBits_ ) < 2 * pointCount ) { tableBits_++; }
+  const size_t         mask = ( size_t( 1 ) << tableBits_ ) - 1;
+  std::vector<int32_t> cellIndex( pointCount );
+
+  // the smallest cell size holding on average at least 8 points per occupied cell is used
+  for ( shift_ = 1;; shift_++ ) {
+    cells_.clear();
+    table_.assign( mask + 1, -1 );
+    for ( size_t i = 0; i < pointCount; i++ ) {
+      const auto    point = pointCloud[i];
+      const int32_t x     = static_cast<int32_t>( point[0] ) >> shift_;
+      const int32_t y     = static_cast<int32_t>( point[1] ) >> shift_;
+      const int32_t z     = static_cast<int32_t>( point[2] ) >> shift_;
+      size_t        h     = hash( key( x, y, z ) );
+      while ( table_[h] >= 0 ) {
+        const auto& cell = cells_[table_[h]];
+        if ( cell.x_ == x && cell.y_ == y && cell.z_ == z ) { break; }
+        h = ( h + 1 ) & mask;
+      }
+      if ( table_[h] < 0 ) {
+        table_[h] = static_cast<int32_t>( cells_.size() );
+        cells_.push_back( {x, y, z, 0, 0} );
+      }
+      cellIndex[i] = table_[h];
+      cells_[table_[h]].end_++;
+    }
+    if ( pointCount >= 8 * cells_.size() || shift_ == 8 ) { break; }
+  }
+
+  // points are stored cell by cell, keeping their input order within each cell
+  uint32_t start = 0;
+  for ( size_t a = 0; a < 3; a++ ) {
+    min_[a] = ( std::numeric_limits<int32_t>::max )();
+    max_[a] = ( std::numeric_limits<int32_t>::min )();
+  }
+  for ( auto& cell : cells_ ) {
+    const uint32_t count = cell.end_;
+    cell.start_ = cell.end_ = start;
+    start += count;
+    const int32_t coords[3] = {cell.x_, cell.y_, cell.z_};
+    for ( size_t a = 0; a < 3; a++ ) {
+      min_[a] = ( std::min )( min_[a], coords[a] );
+      max_[a] = ( std::max )( max_[a], coords[a] );
+    }
+  }
+  positions_.resize( pointCount );
+  indices_.resize( pointCount );
+  for ( size_t i = 0; i < pointCount; i++ ) {
+    const uint32_t position = cells_[cellIndex[i]].end_++;
+    positions_[position]    = pointCloud[i];
+    indices_[position]      = static_cast<uint32_t>( i );
+  }
+}
+
+const PCCVoxelGrid::Cell* PCCVoxelGrid::find( const int32_t x, const int32_t y, const int32_t z ) const {
+  const size_t mask = table_.size() - 1;
+  for ( size_t h = hash( key( x, y, z ) ); table_[h] >= 0; h = ( h + 1 ) & mask ) {
+    const auto& cell = cells_[table_[h]];
+    if ( cell.x_ == x && cell.y_ == y && cell.z_ == z ) { return &cell; }
+  }
+  return nullptr;
+}
+
+int64_t PCCVoxelGrid::lowerBound( const PCCPoint3D& point, const int32_t* center, const int32_t ring ) const {
+  // squared distance from the point to the closest occupied cell outside the rings already visited
+  const int32_t side = 1 << shift_;
+  int64_t       best = g_infiniteDistance;
+  for ( size_t a = 0; a < 3; a++ ) {
+    const int32_t lo = ( center[a] - ring ) * side, hi = ( center[a] + ring + 1 ) * side;
+    if ( center[a] - ring > min_[a] ) { best = ( std::min )( best, int64_t( point[a] - lo + 1 ) ); }
+    if ( center[a] + ring < max_[a] ) { best = ( std::min )( best, int64_t( hi - point[a] ) ); }
+  }
+  return best == g_infiniteDistance ? best : best * best;
+}
+
+int64_t PCCVoxelGrid::boxDistance( const PCCPoint3D& point, const Cell& cell ) const {
+  const int32_t side      = 1 << shift_;
+  const int32_t coords[3] = {cell.x_, cell.y_, cell.z_};
+  int64_t       dist      = 0;
+  for ( size_t a = 0; a < 3; a++ ) {
+    const int32_t lo = coords[a] * side, hi = lo + side - 1;
+    const int64_t d  = point[a] < lo ? lo - point[a] : point[a] > hi ? point[a] - hi : 0;
+    dist += d * d;
+  }
+  return dist;
+}
+
+int32_t PCCVoxelGrid::ringOf( const int32_t* center, const Cell& cell ) const {
+  return ( std::max )( ( std::max )( std::abs( cell.x_ - center[0] ), std::abs( cell.y_ - center[1] ) ),
+                       std::abs( cell.z_ - center[2] ) );
+}
+
+template <typename Visitor>
+void PCCVoxelGrid::visitRing( const int32_t* center, const int32_t ring, Visitor visitor ) const {
+  const int32_t x0 = ( std::max )( center[0] - ring, min_[0] ), x1 = ( std::min )( center[0] + ring, max_[0] );
+  const int32_t y0 = ( std::max )( center[1] - ring, min_[1] ), y1 = ( std::min )( center[1] + ring, max_[1] );
+  const int32_t z0 = ( std::max )( center[2] - ring, min_[2] ), z1 = ( std::min )( center[2] + ring, max_[2] );
+  for ( int32_t x = x0; x <= x1; x++ ) {
+    for ( int32_t y = y0; y <= y1; y++ ) {
+      if ( std::abs( x - center[0] ) == ring || std::abs( y - center[1] ) == ring ) {
+        for ( int32_t z = z0; z <= z1; z++ ) {
+          if ( const Cell* cell = find( x, y, z ) ) { visitor( *cell ); }
+        }
+      } else {
+        // inside the x/y faces only the two z faces of the ring are new
+        if ( z0 == center[2] - ring ) {
+          if ( const Cell* cell = find( x, y, z0 ) ) { visitor( *cell ); }
+        }
+        if ( z1 == center[2] + ring ) {
+          if ( const Cell* cell = find( x, y, z1 ) ) { visitor( *cell ); }
+        }
+      }
+    }
+  }
+}
+
+void PCCVoxelGrid::addCell( const PCCPoint3D& point, const Cell& cell, Candidates& candidates ) const {
+  for ( uint32_t j = cell.start_; j < cell.end_; j++ ) {
+    const int64_t dx   = positions_[j][0] - point[0];
+    const int64_t dy   = positions_[j][1] - point[1];
+    const int64_t dz   = positions_[j][2] - point[2];
+    const int64_t dist = dx * dx + dy * dy + dz * dz;
+    if ( dist >= candidates.worst_ ) { continue; }
+    // sorted insertion, equal distances keep their insertion order
+    size_t i = candidates.count_;
+    for ( ; i > 0 && candidates.dist_[i - 1] > dist; i-- ) {
+      if ( i < candidates.capacity_ ) {
+        candidates.dist_[i]    = candidates.dist_[i - 1];
+        candidates.indices_[i] = candidates.indices_[i - 1];
+      }
+    }
+    if ( i < candidates.capacity_ ) {
+      candidates.dist_[i]    = static_cast<double>( dist );
+      candidates.indices_[i] = indices_[j];
+    }
+    if ( candidates.count_ < candidates.capacity_ ) { candidates.count_++; }
+    if ( candidates.count_ == candidates.capacity_ ) {
+      candidates.worst_ = static_cast<int64_t>( candidates.dist_[candidates.capacity_ - 1] );
+    }
+  }
+}
+
+void PCCVoxelGrid::addCell( const PCCPoint3D&                        point,
+                            const Cell&                              cell,
+                            const int64_t                            radius,
+                            std::vector<std::pair<size_t, double>>& ret ) const {
+  for ( uint32_t j = cell.start_; j < cell.end_; j++ ) {
+    const int64_t dx   = positions_[j][0] - point[0];
+    const int64_t dy   = positions_[j][1] - point[1];
+    const int64_t dz   = positions_[j][2] - point[2];
+    const int64_t dist = dx * dx + dy * dy + dz * dz;
+    if ( dist < radius ) { ret.emplace_back( indices_[j], static_cast<double>( dist ) ); }
+  }
+}
+
+size_t PCCVoxelGrid::search( const PCCPoint3D& point, const size_t num_results, size_t* indices, double* dist ) const {
+  if ( cells_.empty() || num_results == 0 ) { return 0; }
+  Candidates    candidates = {indices, dist, num_results, 0, g_infiniteDistance};
+  const int32_t center[3]  = {static_cast<int32_t>( point[0] ) >> shift_, static_cast<int32_t>( point[1] ) >> shift_,
+                             static_cast<int32_t>( point[2] ) >> shift_};
+  int32_t       maxRing    = 0;
+  for ( size_t a = 0; a < 3; a++ ) {
+    maxRing = ( std::max )( maxRing, ( std::max )( center[a] - min_[a], max_[a] - center[a] ) );
+  }
+  for ( int32_t ring = 0; ring <= maxRing; ring++ ) {
+    const size_t side = 2 * ring + 1, inner = side - 2;
+    if ( ring > 0 && side * side * side - inner * inner * inner > cells_.size() ) {
+      // far out: scanning the remaining occupied cells is cheaper than probing the empty ones
+      for ( const auto& cell : cells_ ) {
+        if ( ringOf( center, cell ) >= ring && boxDistance( point, cell ) < candidates.worst_ ) {
+          addCell( point, cell, candidates );
+        }
+      }
+      break;
+    }
+    visitRing( center, ring, [&]( const Cell& cell ) { addCell( point, cell, candidates ); } );
+    if ( candidates.worst_ <= lowerBound( point, center, ring ) ) { break; }
+  }
+  return candidates.count_;
+}
+
+void PCCVoxelGrid::searchRadius( const PCCPoint3D&                        point,
+                                 const double                             radius,
+                                 std::vector<std::pair<size_t, double>>& ret ) const {
+  ret.clear();
+  if ( cells_.empty() || !( radius > 0 ) ) { return; }
+  // integer squared distances d satisfy d < radius exactly when d < ceil( radius )
+  const int64_t limit     = radius >= 1e18 ? g_infiniteDistance : static_cast<int64_t>( std::ceil( radius ) );
+  const int32_t center[3] = {static_cast<int32_t>( point[0] ) >> shift_, static_cast<int32_t>( point[1] ) >> shift_,
+                             static_cast<int32_t>( point[2] ) >> shift_};
+  int32_t       maxRing   = 0;
+  for ( size_t a = 0; a < 3; a++ ) {
+    maxRing = ( std::max )( maxRing, ( std::max )( center[a] - min_[a], max_[a] - center[a] ) );
+  }
+  for ( int32_t ring = 0; ring <= maxRing; ring++ ) {
+    const size_t side = 2 * ring + 1, inner = side - 2;
+    if ( ring > 0 && side * side * side - inner * inner * inner > cells_.size() ) {
+      for ( const auto& cell : cells_ ) {
+        if ( ringOf( center, cell ) >= ring && boxDistance( point, cell ) < limit ) {
+          addCell( point, cell, limit, ret );
+        }
+      }
+      break;
+    }
+    visitRing( center, ring, [&]( const Cell& cell ) { addCell( point, cell, limit, ret ); } );
+    if ( lowerBound( point, center, ring ) >= limit ) { break; }
+  }
+  std::sort( ret.begin(), ret.end(), []( const std::pair<size_t, double>& a, const std::pair<size_t, double>& b ) {
+    return a.second < b.second || ( a.second == b.second && a.first < b.first );
+  } );
+}
@@ -38,6 +38,7 @@
 #include "PCCCodec.h"
 #include "PCCMath.h"
 #include "PCCPatch.h"
+#include <functional>
 
 namespace pcc {
 
@@ -49,6 +50,7 @@ class PatchFrameGeometryParameterSet;
 class GeometryPatchParameterSet;
 class V3CParameterSet;
 class PLRData;
+class PCCVideoDecoder;
 
 template <typename T, size_t N>
 class PCCImage;
@@ -61,6 +63,9 @@ class PCCDecoder : public PCCCodec {
 
   int decode( PCCContext& context, PCCGroupOfFrames& reconstruct, int32_t atlasIndex );
 
+  // streaming mode: the reconstructed frames are handed over by groups of streamingFrameCount_ frames, then released
+  void setFrameOutput( std::function<int( PCCGroupOfFrames& frames )> frameOutput ) { frameOutput_ = frameOutput; }
+
   void setParameters( const PCCDecoderParameters& params );
   void setReconstructionParameters( const PCCDecoderParameters& params );
   void setPostProcessingSeiParameters( GeneratePointCloudParameters& gpcParams, PCCContext& context, size_t atglIndex );
@@ -71,6 +76,20 @@ class PCCDecoder : public PCCCodec {
   void createPatchFrameDataStructure( PCCContext& context, size_t atglIndex );
 
  private:
+  struct VideoDecodingTask {
+    const void*                             video_;         // decoded video: the tasks sharing a video are run in order
+    std::string                             trace_;         // picture log header of the sub-stream
+    size_t                                  pictureCount_;  // pictures of the video: one per frame or per map
+    std::function<void( PCCVideoDecoder& )> decode_;        // decoding of the sub-stream
+    std::function<void( size_t index )>     convert_;       // conversion of a decoded picture to the nominal bitdepth
+  };
+  struct VideoDecodingProgress;
+  // in streaming mode, the tasks are left running in background until finishVideoDecoding()
+  void       decodeVideos( std::vector<VideoDecodingTask>& tasks, VideoDecodingProgress& progress );
+  void       waitVideoDecoding( VideoDecodingProgress& progress, size_t endFrame );
+  void       releaseVideoDecoding( VideoDecodingProgress& progress, size_t endFrame );
+  void       finishVideoDecoding( std::vector<VideoDecodingTask>& tasks, VideoDecodingProgress& progress );
+  void       releaseVideoFrames( PCCContext& context, size_t startFrame, size_t endFrame, size_t frameCount );
   void       setPointLocalReconstruction( PCCContext& context );
   void       setPLRData( PCCFrameContext& tile, PCCPatch& patch, PLRData& plrd, size_t occupancyPackingBlockSize );
   void       setTilePartitionSizeAfti( PCCContext& context );
@@ -83,8 +102,9 @@ class PCCDecoder : public PCCCodec {
   void       setConsitantFourCCCode( PCCContext& context, size_t atglIndex );
   PCCCodecId getCodedCodecId( PCCContext& context, const uint8_t codecCodecId, const std::string& videoDecoderPath );
 
-  PCCDecoderParameters     params_;
-  std::vector<std::string> consitantFourCCCode_;
+  PCCDecoderParameters                            params_;
+  std::vector<std::string>                        consitantFourCCCode_;
+  std::function<int( PCCGroupOfFrames& frames )> frameOutput_;
 };
 
 };  // namespace pcc
@@ -59,6 +59,8 @@ class PCCDecoderParameters {
   std::string       colorSpaceConversionPath_;
   std::string       inverseColorSpaceConversionConfig_;
   size_t            nbThread_;
+  size_t            spatialIndexType_;
+  size_t            streamingFrameCount_;
   bool              keepIntermediateFiles_;
   bool              patchColorSubsampling_;
   size_t            bestColorSearchRange_;
@@ -35,6 +35,8 @@
 #define PCCVideoDecoder_h
 
 #include "PCCCommon.h"
+#include <mutex>
+#include <functional>
 
 namespace pcc {
 
@@ -67,8 +69,28 @@ class PCCVideoDecoder {
 
   void setLogger( PCCLogger& logger ) { logger_ = &logger; }
 
+  // When deferred, the picture log of the decoded videos is kept until flushTrace() is called, so that concurrent
+  // decodings can be logged in the bitstream order.
+  void setDeferredTrace( bool deferred ) { deferTrace_ = deferred; }
+  void flushTrace();
+
+  // When set, decompress() sizes the video to pictureCount pictures and stores each picture in place, once decoded and
+  // converted, before handing its index over: the pictures are available while the next ones are being decoded.
+  void setPictureOutput( size_t pictureCount, std::function<void( size_t index )> pictureOutput ) {
+    streamedPictureCount_ = pictureCount;
+    pictureOutput_        = pictureOutput;
+  }
+  // number of pictures output by the last decompress()
+  size_t getPictureCount() const { return pictureCount_; }
+
  private:
-  PCCLogger* logger_ = nullptr;
+  PCCLogger*                          logger_     = nullptr;
+  bool                                deferTrace_ = false;
+  std::string                         pictureTrace_;
+  size_t                              pictureCount_         = 0;
+  size_t                              streamedPictureCount_ = 0;
+  std::function<void( size_t index )> pictureOutput_;
+  static std::mutex                   libraryDecoderMutex_;
 };
 
 };  // namespace pcc
@@ -40,6 +40,9 @@
 #include "PCCVideoDecoder.h"
 #include "PCCGroupOfFrames.h"
 #include "PCCDecoder.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #if defined( ENABLE_TBB )
 #include <tbb/tbb.h>
 #endif
@@ -47,6 +50,21 @@
 using namespace pcc;
 using namespace std;
 
+// In streaming mode, the videos are decoded in background threads while the frames are reconstructed: the decoders
+// publish the frames of which all the pictures are available and the reconstruction releases the frames it has output.
+struct PCCDecoder::VideoDecodingProgress {
+  size_t                           frameCount_     = 0;
+  size_t                           windowSize_     = 0;  // frames reconstructed together, 0 when not streaming
+  size_t                           releasedFrames_ = 0;
+  bool                             finished_       = false;  // set once the reconstruction is done
+  std::vector<PCCVideoDecoder>     videoDecoders_;
+  std::vector<std::vector<size_t>> groups_;         // tasks decoding the same video
+  std::vector<size_t>              decodedFrames_;  // per group
+  std::vector<std::thread>         threads_;
+  std::mutex                       mutex_;
+  std::condition_variable          condition_;
+};
+
 PCCDecoder::PCCDecoder() {
 #ifdef ENABLE_PAPI_PROFILING
   initPapiProfiler();
@@ -72,8 +90,6 @@ int PCCDecoder::decode( PCCContext& context, PCCGroupOfFrames& reconstructs, int
 #endif
   createPatchFrameDataStructure( context );
 
-  PCCVideoDecoder videoDecoder;
-  videoDecoder.setLogger( *logger_ );
   std::stringstream path;
   auto&             sps              = context.getVps();
   auto&             ai               = sps.getAttributeInformation( atlasIndex );
@@ -95,93 +111,111 @@ int PCCDecoder::decode( PCCContext& context, PCCGroupOfFrames& reconstructs, int
   printf( "=> Video decoder : occupancy = %d geometry = %d \n", (int)occupancyCodecId, (int)geometryCodecId );
   printf( " Decode 0 size = %zu \n", context.getVideoBitstream( VIDEO_OCCUPANCY ).size() );
   fflush( stdout );
-  TRACE_PICTURE( "Occupancy\n" );
-  TRACE_PICTURE( "MapIdx = 0, AuxiliaryVideoFlag = 0\n" );
-  videoDecoder.decompress( context.getVideoOccupancyMap(),                // video
-                           context,                                       // contexts
-                           path.str(),                                    // path
-                           context.getVideoBitstream( VIDEO_OCCUPANCY ),  // bitstream
-                           params_.byteStreamVideoCoderOccupancy_,        // byte stream video coder
-                           occupancyCodecId,                              // codecId
-                           params_.videoDecoderOccupancyPath_,            // decoder path
-                           8,                                             // output bit depth
-                           params_.keepIntermediateFiles_ );              // keep intermediate files
-
-  // converting the decoded bitdepth to the nominal bitdepth
-  context.getVideoOccupancyMap().convertBitdepth( 8, oi.getOccupancy2DBitdepthMinus1() + 1,
-                                                  oi.getOccupancyMSBAlignFlag() );
+  // in streaming mode, the frames are reconstructed by groups of streamingFrameCount_ frames handed over to the
+  // frame output and released with their video pictures, so that the memory is bounded by the size of the group.
+  const bool   streaming  = params_.streamingFrameCount_ > 0 && frameOutput_;
+  const size_t windowSize = streaming ? params_.streamingFrameCount_ : frameCount;
+  // The video sub-streams are independent until the reconstruction starts: one decoding task is created per
+  // sub-stream and the tasks are run concurrently. The tasks writing the same video are run in order and the picture
+  // logs are written in the bitstream order once all the videos have been decoded. In streaming mode, the videos are
+  // decoded while the first frames are reconstructed.
+  std::vector<VideoDecodingTask> tasks;
+  tasks.push_back( { &context.getVideoOccupancyMap(), "Occupancy\nMapIdx = 0, AuxiliaryVideoFlag = 0\n", frameCount,
+                     [&]( PCCVideoDecoder& videoDecoder ) {
+                       videoDecoder.decompress( context.getVideoOccupancyMap(),                // video
+                                                context,                                       // contexts
+                                                path.str(),                                    // path
+                                                context.getVideoBitstream( VIDEO_OCCUPANCY ),  // bitstream
+                                                params_.byteStreamVideoCoderOccupancy_,  // byte stream video coder
+                                                occupancyCodecId,                        // codecId
+                                                params_.videoDecoderOccupancyPath_,      // decoder path
+                                                8,                                       // output bit depth
+                                                params_.keepIntermediateFiles_ );        // keep intermediate files
+                     },
+                     [&]( size_t index ) {
+                       // converting the decoded bitdepth to the nominal bitdepth
+                       context.getVideoOccupancyMap().getFrame( index ).convertBitdepth(
+                           8, oi.getOccupancy2DBitdepthMinus1() + 1, oi.getOccupancyMSBAlignFlag() );
+                     } } );
 
   if ( sps.getMultipleMapStreamsPresentFlag( atlasIndex ) ) {
     context.getVideoGeometryMultiple().resize( sps.getMapCountMinus1( atlasIndex ) + 1 );
-    size_t totalGeoSize = 0;
     for ( uint32_t mapIndex = 0; mapIndex < sps.getMapCountMinus1( atlasIndex ) + 1; mapIndex++ ) {
-      TRACE_PICTURE( "Geometry\n" );
-      TRACE_PICTURE( "MapIdx = %d, AuxiliaryVideoFlag = 0\n", mapIndex );
-      std::cout << "*******Video Decoding: Geometry[" << mapIndex << "] ********" << std::endl;
-      auto  geometryIndex  = static_cast<PCCVideoType>( VIDEO_GEOMETRY_D0 + mapIndex );
-      auto& videoBitstream = context.getVideoBitstream( geometryIndex );
-      videoDecoder.decompress( context.getVideoGeometryMultiple( mapIndex ),  // video
-                               context,                                       // contexts
-                               path.str(),                                    // path
-                               videoBitstream,                                // bitstream
-                               params_.byteStreamVideoCoderGeometry_,         // byte stream video coder
-                               geometryCodecId,                               // codecId
-                               params_.videoDecoderGeometryPath_,             // decoder path
-                               geometryBitDepth,                              // output bit depth
-                               params_.keepIntermediateFiles_,                // keep intermediate files
-                               0 );                                           // SHVC layer index
-
-      context.getVideoGeometryMultiple()[mapIndex].convertBitdepth(
-          geometryBitDepth, gi.getGeometry2dBitdepthMinus1() + 1, gi.getGeometryMSBAlignFlag() );
-      std::cout << "geometry D" << mapIndex << " video ->" << videoBitstream.size() << " B" << std::endl;
-      totalGeoSize += videoBitstream.size();
+      tasks.push_back(
+          { &context.getVideoGeometryMultiple( mapIndex ),
+            stringFormat( "Geometry\nMapIdx = %d, AuxiliaryVideoFlag = 0\n", mapIndex ), frameCount,
+            [&, mapIndex]( PCCVideoDecoder& videoDecoder ) {
+              std::cout << "*******Video Decoding: Geometry[" << mapIndex << "] ********" << std::endl;
+              auto  geometryIndex  = static_cast<PCCVideoType>( VIDEO_GEOMETRY_D0 + mapIndex );
+              auto& videoBitstream = context.getVideoBitstream( geometryIndex );
+              videoDecoder.decompress( context.getVideoGeometryMultiple( mapIndex ),  // video
+                                       context,                                       // contexts
+                                       path.str(),                                    // path
+                                       videoBitstream,                                // bitstream
+                                       params_.byteStreamVideoCoderGeometry_,         // byte stream video coder
+                                       geometryCodecId,                               // codecId
+                                       params_.videoDecoderGeometryPath_,             // decoder path
+                                       geometryBitDepth,                              // output bit depth
+                                       params_.keepIntermediateFiles_,                // keep intermediate files
+                                       0 );                                           // SHVC layer index
+              std::cout << "geometry D" << mapIndex << " video ->" << videoBitstream.size() << " B" << std::endl;
+            },
+            [&, mapIndex]( size_t index ) {
+              context.getVideoGeometryMultiple()[mapIndex].getFrame( index ).convertBitdepth(
+                  geometryBitDepth, gi.getGeometry2dBitdepthMinus1() + 1, gi.getGeometryMSBAlignFlag() );
+            } } );
     }
-    std::cout << "total geometry video ->" << totalGeoSize << " B" << std::endl;
   } else {
-    TRACE_PICTURE( "Geometry\n" );
-    TRACE_PICTURE( "MapIdx = 0, AuxiliaryVideoFlag = 0\n" );
-    std::cout << "*******Video Decoding: Geometry ********" << std::endl;
-    auto& videoBitstream = context.getVideoBitstream( VIDEO_GEOMETRY );
-
-    printf( " Decode G size = %zu \n", videoBitstream.size() );
-    fflush( stdout );
-    videoDecoder.decompress( context.getVideoGeometryMultiple( 0 ),  // video
-                             context,                                // contexts
-                             path.str(),                             // path
-                             videoBitstream,                         // bitstream
-                             params_.byteStreamVideoCoderGeometry_,  // byte stream video coder
-                             geometryCodecId,                        // codecId
-                             params_.videoDecoderGeometryPath_,      // decoder path
-                             geometryBitDepth,                       // output bit depth
-                             params_.keepIntermediateFiles_,         // keep intermediate files
-                             params_.shvcLayerIndex_ );              // SHVC layer index
-
-    context.getVideoGeometryMultiple()[0].convertBitdepth( geometryBitDepth, gi.getGeometry2dBitdepthMinus1() + 1,
-                                                           gi.getGeometryMSBAlignFlag() );
-    std::cout << "geometry video ->" << videoBitstream.size() << " B" << std::endl;
+    tasks.push_back( { &context.getVideoGeometryMultiple( 0 ), "Geometry\nMapIdx = 0, AuxiliaryVideoFlag = 0\n",
+                       frameCount * mapCount,
+                       [&]( PCCVideoDecoder& videoDecoder ) {
+                         std::cout << "*******Video Decoding: Geometry ********" << std::endl;
+                         auto& videoBitstream = context.getVideoBitstream( VIDEO_GEOMETRY );
+
+                         printf( " Decode G size = %zu \n", videoBitstream.size() );
+                         fflush( stdout );
+                         videoDecoder.decompress( context.getVideoGeometryMultiple( 0 ),  // video
+                                                  context,                                // contexts
+                                                  path.str(),                             // path
+                                                  videoBitstream,                         // bitstream
+                                                  params_.byteStreamVideoCoderGeometry_,  // byte stream video coder
+                                                  geometryCodecId,                        // codecId
+                                                  params_.videoDecoderGeometryPath_,      // decoder path
+                                                  geometryBitDepth,                       // output bit depth
+                                                  params_.keepIntermediateFiles_,         // keep intermediate files
+                                                  params_.shvcLayerIndex_ );              // SHVC layer index
+                         std::cout << "geometry video ->" << videoBitstream.size() << " B" << std::endl;
+                       },
+                       [&]( size_t index ) {
+                         context.getVideoGeometryMultiple()[0].getFrame( index ).convertBitdepth(
+                             geometryBitDepth, gi.getGeometry2dBitdepthMinus1() + 1, gi.getGeometryMSBAlignFlag() );
+                       } } );
   }
 
   if ( asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag() &&
        sps.getAuxiliaryVideoPresentFlag( atlasIndex ) ) {
-    TRACE_PICTURE( "MapIdx = 0, AuxiliaryVideoFlag = 1\n" );
-    std::cout << "*******Video Decoding: Aux Geometry ********" << std::endl;
-    auto& videoBitstreamMP = context.getVideoBitstream( VIDEO_GEOMETRY_RAW );
-    auto  auxGeometryCodecId =
+    auto auxGeometryCodecId =
         getCodedCodecId( context, gi.getAuxiliaryGeometryCodecId(), params_.videoDecoderGeometryPath_ );
-    videoDecoder.decompress( context.getVideoRawPointsGeometry(),    // video
-                             context,                                // contexts
-                             path.str(),                             // path
-                             videoBitstreamMP,                       // bitstream
-                             params_.byteStreamVideoCoderGeometry_,  // byte stream video coder
-                             auxGeometryCodecId,                     // codecId
-                             params_.videoDecoderGeometryPath_,      // decoder path
-                             geometryBitDepth,                       // output bit depth
-                             params_.keepIntermediateFiles_,         // keep intermediate files
-                             params_.shvcLayerIndex_ );              // SHVC layer index
-
-    context.getVideoRawPointsGeometry().convertBitdepth( geometryBitDepth, gi.getGeometry2dBitdepthMinus1() + 1,
-                                                         gi.getGeometryMSBAlignFlag() );
-    std::cout << " raw points geometry -> " << videoBitstreamMP.size() << " B " << endl;
+    tasks.push_back( { &context.getVideoRawPointsGeometry(), "MapIdx = 0, AuxiliaryVideoFlag = 1\n", frameCount,
+                       [&, auxGeometryCodecId]( PCCVideoDecoder& videoDecoder ) {
+                         std::cout << "*******Video Decoding: Aux Geometry ********" << std::endl;
+                         auto& videoBitstreamMP = context.getVideoBitstream( VIDEO_GEOMETRY_RAW );
+                         videoDecoder.decompress( context.getVideoRawPointsGeometry(),    // video
+                                                  context,                                // contexts
+                                                  path.str(),                             // path
+                                                  videoBitstreamMP,                       // bitstream
+                                                  params_.byteStreamVideoCoderGeometry_,  // byte stream video coder
+                                                  auxGeometryCodecId,                     // codecId
+                                                  params_.videoDecoderGeometryPath_,      // decoder path
+                                                  geometryBitDepth,                       // output bit depth
+                                                  params_.keepIntermediateFiles_,         // keep intermediate files
+                                                  params_.shvcLayerIndex_ );              // SHVC layer index
+                         std::cout << " raw points geometry -> " << videoBitstreamMP.size() << " B " << endl;
+                       },
+                       [&]( size_t index ) {
+                         context.getVideoRawPointsGeometry().getFrame( index ).convertBitdepth(
+                             geometryBitDepth, gi.getGeometry2dBitdepthMinus1() + 1, gi.getGeometryMSBAlignFlag() );
+                       } } );
   }
 
   if ( ai.getAttributeCount() > 0 ) {
@@ -194,92 +228,113 @@ int PCCDecoder::decode( PCCContext& context, PCCGroupOfFrames& reconstructs, int
       printf( "CodecId attributeCodecId = %d \n", (int)attributeCodecId );
       for ( int attrPartitionIndex = 0; attrPartitionIndex < attributeDimension; attrPartitionIndex++ ) {
         if ( sps.getMultipleMapStreamsPresentFlag( atlasIndex ) ) {
-          int sizeAttributeVideo = 0;
           context.getVideoAttributesMultiple().resize( sps.getMapCountMinus1( atlasIndex ) + 1 );
           // this allocation is considering only one attribute, with a single partition, but multiple streams
           for ( uint32_t mapIndex = 0; mapIndex < sps.getMapCountMinus1( atlasIndex ) + 1; mapIndex++ ) {
             // decompress T[mapIndex]
-            TRACE_PICTURE( "Attribute\n" );
-            TRACE_PICTURE( "AttrIdx = %d, AttrPartIdx = %d, AttrTypeID = %d, MapIdx = %d, AuxiliaryVideoFlag = 0\n",
-                           attrIndex, attrPartitionIndex, attributeTypeId, mapIndex );
-            std::cout << "*******Video Decoding: Attribute [" << mapIndex << "] ********" << std::endl;
-            auto  attributeIndex = static_cast<PCCVideoType>( VIDEO_ATTRIBUTE_T0 + attrPartitionIndex +
-                                                             MAX_NUM_ATTR_PARTITIONS * mapIndex );
-            auto& videoBitstream = context.getVideoBitstream( attributeIndex );
-            videoDecoder.decompress( context.getVideoAttributesMultiple( mapIndex ),  // video
-                                     context,                                         // contexts
-                                     path.str(),                                      // path
-                                     videoBitstream,                                  // bitstream
-                                     params_.byteStreamVideoCoderAttribute_,          // byte stream video coder
-                                     attributeCodecId,                                // codecId
-                                     params_.videoDecoderAttributePath_,              // decoder path
-                                     attributeBitDepth,                               // output bit depth
-                                     params_.keepIntermediateFiles_,                  // keep intermediate files
-                                     params_.shvcLayerIndex_,                         // SHVC layer index
-                                     params_.patchColorSubsampling_,                  // patch color subsampling
-                                     params_.inverseColorSpaceConversionConfig_,      // inverse color space conversion
-                                     params_.colorSpaceConversionPath_ );             // color space conversion path
-            std::cout << "attribute T" << mapIndex << " video ->" << videoBitstream.size() << " B" << std::endl;
-            sizeAttributeVideo += videoBitstream.size();
+            tasks.push_back(
+                { &context.getVideoAttributesMultiple( mapIndex ),
+                  stringFormat( "Attribute\nAttrIdx = %d, AttrPartIdx = %d, AttrTypeID = %d, MapIdx = %d, "
+                                "AuxiliaryVideoFlag = 0\n",
+                                attrIndex, attrPartitionIndex, attributeTypeId, mapIndex ),
+                  frameCount,
+                  [&, attributeBitDepth, attributeCodecId, attrPartitionIndex,
+                   mapIndex]( PCCVideoDecoder& videoDecoder ) {
+                    std::cout << "*******Video Decoding: Attribute [" << mapIndex << "] ********" << std::endl;
+                    auto  attributeIndex = static_cast<PCCVideoType>( VIDEO_ATTRIBUTE_T0 + attrPartitionIndex +
+                                                                     MAX_NUM_ATTR_PARTITIONS * mapIndex );
+                    auto& videoBitstream = context.getVideoBitstream( attributeIndex );
+                    videoDecoder.decompress( context.getVideoAttributesMultiple( mapIndex ),  // video
+                                             context,                                         // contexts
+                                             path.str(),                                      // path
+                                             videoBitstream,                                  // bitstream
+                                             params_.byteStreamVideoCoderAttribute_,  // byte stream video coder
+                                             attributeCodecId,                        // codecId
+                                             params_.videoDecoderAttributePath_,      // decoder path
+                                             attributeBitDepth,                       // output bit depth
+                                             params_.keepIntermediateFiles_,          // keep intermediate files
+                                             params_.shvcLayerIndex_,                 // SHVC layer index
+                                             params_.patchColorSubsampling_,          // patch color subsampling
+                                             params_.inverseColorSpaceConversionConfig_,  // inverse color space
+                                             params_.colorSpaceConversionPath_ );  // color space conversion path
+                    std::cout << "attribute T" << mapIndex << " video ->" << videoBitstream.size() << " B"
+                              << std::endl;
+                  },
+                  nullptr } );
           }
-          std::cout << "attribute    video ->" << sizeAttributeVideo << " B" << std::endl;
         } else {
-          TRACE_PICTURE( "Attribute\n" );
-          TRACE_PICTURE( "AttrIdx = 0, AttrPartIdx = %d, AttrTypeID = %d, MapIdx = 0, AuxiliaryVideoFlag = 0\n",
-                         attrPartitionIndex, attributeTypeId );
-          std::cout << "*******Video Decoding: Attribute ********" << std::endl;
-          auto  attributeIndex = static_cast<PCCVideoType>( VIDEO_ATTRIBUTE + attrPartitionIndex );
-          auto& videoBitstream = context.getVideoBitstream( attributeIndex );
-          printf( " Decode T size = %zu \n", videoBitstream.size() );
-          fflush( stdout );
-          videoDecoder.decompress( context.getVideoAttributesMultiple( 0 ),     // video
-                                   context,                                     // contexts
-                                   path.str(),                                  // path
-                                   videoBitstream,                              // bitstream
-                                   params_.byteStreamVideoCoderAttribute_,      // byte stream video coder
-                                   attributeCodecId,                            // codecId
-                                   params_.videoDecoderAttributePath_,          // decoder path
-                                   attributeBitDepth,                           // output bit depth
-                                   params_.keepIntermediateFiles_,              // keep intermediate files
-                                   params_.shvcLayerIndex_,                     // SHVC layer index
-                                   params_.patchColorSubsampling_,              // patch color subsampling
-                                   params_.inverseColorSpaceConversionConfig_,  // inverse color space conversionConfig
-                                   params_.colorSpaceConversionPath_ );         // color space conversion path
-          std::cout << "attribute video  ->" << videoBitstream.size() << " B" << std::endl;
+          tasks.push_back(
+              { &context.getVideoAttributesMultiple( 0 ),
+                stringFormat( "Attribute\nAttrIdx = 0, AttrPartIdx = %d, AttrTypeID = %d, MapIdx = 0, "
+                              "AuxiliaryVideoFlag = 0\n",
+                              attrPartitionIndex, attributeTypeId ),
+                frameCount * mapCount,
+                [&, attributeBitDepth, attributeCodecId, attrPartitionIndex]( PCCVideoDecoder& videoDecoder ) {
+                  std::cout << "*******Video Decoding: Attribute ********" << std::endl;
+                  auto  attributeIndex = static_cast<PCCVideoType>( VIDEO_ATTRIBUTE + attrPartitionIndex );
+                  auto& videoBitstream = context.getVideoBitstream( attributeIndex );
+                  printf( " Decode T size = %zu \n", videoBitstream.size() );
+                  fflush( stdout );
+                  videoDecoder.decompress( context.getVideoAttributesMultiple( 0 ),  // video
+                                           context,                                  // contexts
+                                           path.str(),                               // path
+                                           videoBitstream,                           // bitstream
+                                           params_.byteStreamVideoCoderAttribute_,   // byte stream video coder
+                                           attributeCodecId,                         // codecId
+                                           params_.videoDecoderAttributePath_,       // decoder path
+                                           attributeBitDepth,                        // output bit depth
+                                           params_.keepIntermediateFiles_,           // keep intermediate files
+                                           params_.shvcLayerIndex_,                  // SHVC layer index
+                                           params_.patchColorSubsampling_,           // patch color subsampling
+                                           params_.inverseColorSpaceConversionConfig_,  // inverse color space
+                                           params_.colorSpaceConversionPath_ );  // color space conversion path
+                  std::cout << "attribute video  ->" << videoBitstream.size() << " B" << std::endl;
+                },
+                nullptr } );
         }
 
         if ( asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag() &&
              sps.getAuxiliaryVideoPresentFlag( atlasIndex ) ) {
-          std::cout << "*******Video Decoding: Aux Attribute ********" << std::endl;
-          auto attributeIndex = static_cast<PCCVideoType>( VIDEO_ATTRIBUTE_RAW + attrPartitionIndex );
-          TRACE_PICTURE( "Attribute\n" );
-          TRACE_PICTURE( "AttrIdx = 0, AttrPartIdx = %d, AttrTypeID = %d, MapIdx = 0, AuxiliaryVideoFlag = 1\n",
-                         attrPartitionIndex, attributeTypeId );
-          auto& videoBitstreamMP    = context.getVideoBitstream( attributeIndex );
-          auto  auxAttributeCodecId = getCodedCodecId( context, ai.getAuxiliaryAttributeCodecId( attrIndex ),
+          auto auxAttributeCodecId = getCodedCodecId( context, ai.getAuxiliaryAttributeCodecId( attrIndex ),
                                                       params_.videoDecoderAttributePath_ );
           printf( "CodecId auxAttributeCodecId = %d \n", (int)auxAttributeCodecId );
-          videoDecoder.decompress( context.getVideoRawPointsAttribute(),        // video
-                                   context,                                     // contexts
-                                   path.str(),                                  // path
-                                   videoBitstreamMP,                            // bitstream
-                                   params_.byteStreamVideoCoderAttribute_,      // byte stream video coder
-                                   auxAttributeCodecId,                         // codecId
-                                   params_.videoDecoderAttributePath_,          // decoder path
-                                   attributeBitDepth,                           // output bit depth
-                                   params_.keepIntermediateFiles_,              // keep intermediate files
-                                   params_.shvcLayerIndex_,                     // SHVC layer index
-                                   false,                                       // patch color subsampling
-                                   params_.inverseColorSpaceConversionConfig_,  // inverse color space conversionConfig
-                                   params_.colorSpaceConversionPath_ );         // color space conversion path
-          // generateRawPointsAttributefromVideo( context, reconstructs );
-          std::cout << " raw points attribute -> " << videoBitstreamMP.size() << " B" << endl;
+          tasks.push_back(
+              { &context.getVideoRawPointsAttribute(),
+                stringFormat( "Attribute\nAttrIdx = 0, AttrPartIdx = %d, AttrTypeID = %d, MapIdx = 0, "
+                              "AuxiliaryVideoFlag = 1\n",
+                              attrPartitionIndex, attributeTypeId ),
+                frameCount,
+                [&, attributeBitDepth, auxAttributeCodecId, attrPartitionIndex]( PCCVideoDecoder& videoDecoder ) {
+                  std::cout << "*******Video Decoding: Aux Attribute ********" << std::endl;
+                  auto  attributeIndex   = static_cast<PCCVideoType>( VIDEO_ATTRIBUTE_RAW + attrPartitionIndex );
+                  auto& videoBitstreamMP = context.getVideoBitstream( attributeIndex );
+                  videoDecoder.decompress( context.getVideoRawPointsAttribute(),     // video
+                                           context,                                  // contexts
+                                           path.str(),                               // path
+                                           videoBitstreamMP,                         // bitstream
+                                           params_.byteStreamVideoCoderAttribute_,   // byte stream video coder
+                                           auxAttributeCodecId,                      // codecId
+                                           params_.videoDecoderAttributePath_,       // decoder path
+                                           attributeBitDepth,                        // output bit depth
+                                           params_.keepIntermediateFiles_,           // keep intermediate files
+                                           params_.shvcLayerIndex_,                  // SHVC layer index
+                                           false,                                    // patch color subsampling
+                                           params_.inverseColorSpaceConversionConfig_,  // inverse color space
+                                           params_.colorSpaceConversionPath_ );  // color space conversion path
+                  // generateRawPointsAttributefromVideo( context, reconstructs );
+                  std::cout << " raw points attribute -> " << videoBitstreamMP.size() << " B" << endl;
+                },
+                nullptr } );
         }
       }
     }
   }
+  VideoDecodingProgress progress;
+  progress.frameCount_ = frameCount;
+  progress.windowSize_ = streaming ? windowSize : 0;
+  decodeVideos( tasks, progress );
 
-  reconstructs.setFrameCount( frameCount );
+  reconstructs.setFrameCount( streaming ? 0 : frameCount );
   // recreating the prediction list per attribute (either the attribute is coded absolute, or follows the geometry)
   // see contribution m52529
   std::vector<std::vector<bool>> absoluteT1List;
@@ -299,193 +354,382 @@ int PCCDecoder::decode( PCCContext& context, PCCGroupOfFrames& reconstructs, int
   }
   printf( "generate point cloud of %zu frames \n", frameCount );
   fflush( stdout );
-  for ( size_t frameIdx = 0; frameIdx < frameCount; frameIdx++ ) {
-    // All video have been decoded, start reconsctruction processes
-    if ( asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag() &&
-         sps.getAuxiliaryVideoPresentFlag( atlasIndex ) ) {
-      for ( int attrIndex = 0; attrIndex < ai.getAttributeCount(); attrIndex++ ) {
-        int attributeDimensionPartitions = ai.getAttributeDimensionPartitionsMinus1( attrIndex ) + 1;
-        for ( int attrPartitionIndex = 0; attrPartitionIndex < attributeDimensionPartitions; attrPartitionIndex++ ) {
-          printf( "generateRawPointsAttributefromVideo attrIndex = %d attrPartitionIndex = %d \n", attrIndex,
-                  attrPartitionIndex );
-          fflush( stdout );
-          generateRawPointsAttributefromVideo( context, frameIdx );
+  // All video have been decoded (in streaming mode, the pictures of the first frames), start reconsctruction
+  // processes: the frames and the tiles of each frame are reconstructed concurrently, the conformance traces are
+  // logged in the frame order once the frames are done.
+  if ( streaming ) { waitVideoDecoding( progress, ( std::min )( windowSize, frameCount ) ); }
+  context.setOccupancyPrecision( sps.getFrameWidth( atlasIndex ) / context.getVideoOccupancyMap().getWidth() );
+  const bool useAuxVideo = asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag() &&
+                           sps.getAuxiliaryVideoPresentFlag( atlasIndex );
+  // the streamed videos are already sized to their picture count and are being written
+  if ( useAuxVideo && !streaming ) { context.getVideoRawPointsAttribute().resize( context.size() ); }
+  std::vector<std::string> pcFrameTraces( frameCount );
+  std::vector<std::string> recFrameTraces( frameCount );
+#if defined( ENABLE_TBB ) && defined( CODEC_TRACE )
+  // codec traces are written by the reconstruction processes: keep them in order
+  tbb::task_arena limited( 1 );
+#elif defined( ENABLE_TBB )
+  tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
+#endif
+  for ( size_t startFrame = 0; startFrame < frameCount; startFrame += windowSize ) {
+    const size_t     endFrame = ( std::min )( startFrame + windowSize, frameCount );
+    PCCGroupOfFrames streamedFrames( streaming ? endFrame - startFrame : 0 );
+    auto&            frames     = streaming ? streamedFrames : reconstructs;
+    const size_t     frameShift = streaming ? startFrame : 0;
+    if ( streaming ) { waitVideoDecoding( progress, endFrame ); }
+#if defined( ENABLE_TBB )
+    limited.execute( [&] {
+      tbb::parallel_for( startFrame, endFrame, [&]( const size_t frameIdx ) {
+#else
+    for ( size_t frameIdx = startFrame; frameIdx < endFrame; frameIdx++ ) {
+#endif
+        if ( useAuxVideo ) {
+          for ( int attrIndex = 0; attrIndex < ai.getAttributeCount(); attrIndex++ ) {
+            int attributeDimensionPartitions = ai.getAttributeDimensionPartitionsMinus1( attrIndex ) + 1;
+            for ( int attrPartitionIndex = 0; attrPartitionIndex < attributeDimensionPartitions;
+                  attrPartitionIndex++ ) {
+              printf( "generateRawPointsAttributefromVideo attrIndex = %d attrPartitionIndex = %d \n", attrIndex,
+                      attrPartitionIndex );
+              fflush( stdout );
+              generateRawPointsAttributefromVideo( context, frameIdx );
+            }
+          }
+        }  // getAuxiliaryVideoEnabledFlag()
+
+        const size_t                              tileCount = context[frameIdx].getNumTilesInAtlasFrame();
+        std::vector<GeneratePointCloudParameters> tileGpcParams( tileCount );
+        std::vector<GeneratePointCloudParameters> tilePpSEIParams( tileCount );
+        std::vector<PCCPointSet3>                 tileReconstructs( tileCount );
+        std::vector<std::vector<uint32_t>>        tilePartitions( tileCount );
+        auto&                                     reconstruct = frames[frameIdx - frameShift];
+        std::vector<uint32_t>                     partition;
+        for ( size_t tileIdx = 0; tileIdx < tileCount; tileIdx++ ) {
+          auto atglIndex = context.getAtlasHighLevelSyntax().getAtlasTileLayerIndex( frameIdx, tileIdx );
+          setGeneratePointCloudParameters( tileGpcParams[tileIdx], context, atglIndex );
+          setPostProcessingSeiParameters( tilePpSEIParams[tileIdx], context, atglIndex );
         }
-      }
-    }  // getAuxiliaryVideoEnabledFlag()
-
-    context.setOccupancyPrecision( sps.getFrameWidth( atlasIndex ) / context.getVideoOccupancyMap().getWidth() );
-    GeneratePointCloudParameters gpcParams;
-    GeneratePointCloudParameters ppSEIParams;
-
-    auto&                 reconstruct = reconstructs[frameIdx];
-    std::vector<uint32_t> partition;
-    // Decode point cloud
-    printf( "call generatePointCloud() \n" );
-    std::vector<size_t> accTilePointCount;
-    accTilePointCount.resize( ai.getAttributeCount(), 0 );
-    for ( size_t tileIdx = 0; tileIdx < context[frameIdx].getNumTilesInAtlasFrame(); tileIdx++ ) {
-      auto atglIndex = context.getAtlasHighLevelSyntax().getAtlasTileLayerIndex( frameIdx, tileIdx );
-      setGeneratePointCloudParameters( gpcParams, context, atglIndex );
-      setPostProcessingSeiParameters( ppSEIParams, context, atglIndex );
-      // std::cout << "Processing frame " << frameIdx << " tile " << tileIdx << std::endl;
-      auto& tile = context[frameIdx].getTile( tileIdx );
-      if ( !ppSEIParams.pbfEnableFlag_ ) {
-        generateOccupancyMap( tile, context.getVideoOccupancyMap().getFrame( tile.getFrameIndex() ),
-                              context.getOccupancyPrecision(), oi.getLossyOccupancyCompressionThreshold(),
-                              asps.getEomPatchEnabledFlag() );
-      }
-      if ( context[frameIdx].getNumTilesInAtlasFrame() > 1 ) {
-        generateTileBlockToPatchFromOccupancyMapVideo(
-            context, tile, frameIdx, context.getVideoOccupancyMap().getFrame( frameIdx ),
-            size_t( 1 ) << asps.getLog2PatchPackingBlockSize(), context.getOccupancyPrecision() );
 
-      } else {
-        generateBlockToPatchFromOccupancyMapVideo(
-            context, tile, frameIdx, context.getVideoOccupancyMap().getFrame( frameIdx ),
-            size_t( 1 ) << asps.getLog2PatchPackingBlockSize(), context.getOccupancyPrecision() );
+        // Decode point cloud: the tiles cover disjoint areas of the occupancy map video
+        printf( "call generatePointCloud() \n" );
+#if defined( ENABLE_TBB )
+        tbb::parallel_for( size_t( 0 ), tileCount, [&]( const size_t tileIdx ) {
+#else
+      for ( size_t tileIdx = 0; tileIdx < tileCount; tileIdx++ ) {
+#endif
+          auto& tile = context[frameIdx].getTile( tileIdx );
+          if ( !tilePpSEIParams[tileIdx].pbfEnableFlag_ ) {
+            generateOccupancyMap( tile, context.getVideoOccupancyMap().getFrame( tile.getFrameIndex() ),
+                                  context.getOccupancyPrecision(), oi.getLossyOccupancyCompressionThreshold(),
+                                  asps.getEomPatchEnabledFlag() );
+          }
+          if ( tileCount > 1 ) {
+            generateTileBlockToPatchFromOccupancyMapVideo(
+                context, tile, frameIdx, context.getVideoOccupancyMap().getFrame( frameIdx ),
+                size_t( 1 ) << asps.getLog2PatchPackingBlockSize(), context.getOccupancyPrecision() );
+
+          } else {
+            generateBlockToPatchFromOccupancyMapVideo(
+                context, tile, frameIdx, context.getVideoOccupancyMap().getFrame( frameIdx ),
+                size_t( 1 ) << asps.getLog2PatchPackingBlockSize(), context.getOccupancyPrecision() );
+          }
+          printf( "call generatePointCloud() \n" );
+          generatePointCloud( tileReconstructs[tileIdx], context, frameIdx, tileIdx, tileGpcParams[tileIdx],
+                              tilePartitions[tileIdx], true );
+#if defined( ENABLE_TBB )
+        } );
+#else
       }
+#endif
 
-      printf( "call generatePointCloud() \n" );
-      PCCPointSet3 tileReconstrct;
-      generatePointCloud( tileReconstrct, context, frameIdx, tileIdx, gpcParams, partition, true );
-      reconstruct.appendPointSet( tileReconstrct );
-      if ( context[frameIdx].getNumTilesInAtlasFrame() > 1 )
-        context[frameIdx].getTitleFrameContext().appendPointToPixel(
-            context[frameIdx].getTile( tileIdx ).getPointToPixel() );
-      if ( ai.getAttributeCount() > 0 ) {
-        reconstruct.addColors();
-        reconstruct.addColors16bit();
-        for ( size_t attIdx = 0; attIdx < ai.getAttributeCount(); attIdx++ ) {
-          printf( "start colorPointCloud attIdx = %zu / %u ] \n", attIdx, ai.getAttributeCount() );
-          fflush( stdout );
-          size_t updatedPointCount  = colorPointCloud( reconstruct, context, tile, absoluteT1List[attIdx],
-                                                      sps.getMultipleMapStreamsPresentFlag( atlasIndex ),
-                                                      ai.getAttributeCount(), accTilePointCount[attIdx], gpcParams );
-          accTilePointCount[attIdx] = updatedPointCount;
-        }
-      }
-    }  // tile
+        // the tiles are appended in order: the point indices of the frame do not depend on the scheduling
+        std::vector<size_t> accTilePointCount;
+        accTilePointCount.resize( ai.getAttributeCount(), 0 );
+        for ( size_t tileIdx = 0; tileIdx < tileCount; tileIdx++ ) {
+          auto& tile = context[frameIdx].getTile( tileIdx );
+          reconstruct.appendPointSet( tileReconstructs[tileIdx] );
+          partition.insert( partition.end(), tilePartitions[tileIdx].begin(), tilePartitions[tileIdx].end() );
+          if ( tileCount > 1 ) context[frameIdx].getTitleFrameContext().appendPointToPixel( tile.getPointToPixel() );
+          if ( ai.getAttributeCount() > 0 ) {
+            reconstruct.addColors();
+            reconstruct.addColors16bit();
+            for ( size_t attIdx = 0; attIdx < ai.getAttributeCount(); attIdx++ ) {
+              printf( "start colorPointCloud attIdx = %zu / %u ] \n", attIdx, ai.getAttributeCount() );
+              fflush( stdout );
+              size_t updatedPointCount  = colorPointCloud( reconstruct, context, tile, absoluteT1List[attIdx],
+                                                          sps.getMultipleMapStreamsPresentFlag( atlasIndex ),
+                                                          ai.getAttributeCount(), accTilePointCount[attIdx],
+                                                          tileGpcParams[tileIdx] );
+              accTilePointCount[attIdx] = updatedPointCount;
+            }
+          }
+        }  // tile
+        // post-processing uses the parameters of the last tile
+        const auto& ppSEIParams = tilePpSEIParams.back();
 
 #ifdef CONFORMANCE_TRACE
-    size_t numProjPoints = 0, numRawPoints = 0, numEomPoints = 0;
-    for ( size_t tileIdx = 0; tileIdx < context[frameIdx].getNumTilesInAtlasFrame(); tileIdx++ ) {
-      auto& tile = context[frameIdx].getTile( tileIdx );
-      numProjPoints += tile.getTotalNumberOfRegularPoints();
-      numEomPoints += tile.getTotalNumberOfEOMPoints();
-      numRawPoints += tile.getTotalNumberOfRawPoints();
-    }  // tile
-    if ( ai.getAttributeCount() == 0 ) {
-      reconstructs[frameIdx].removeColors();
-      reconstructs[frameIdx].removeColors16bit();
-    } else {
-      bool isAttributes444 = context.getVideoAttributesMultiple( 0 ).getColorFormat() == PCCCOLORFORMAT::RGB444;
-      if ( !isAttributes444 ) {  // lossy: convert 16-bit yuv444 to 8-bit RGB444
-        reconstructs[frameIdx].convertYUV16ToRGB8();
-      } else {
-        reconstructs[frameIdx].copyRGB16ToRGB8();
-      }
-    }
-    TRACE_PCFRAME( "AtlasFrameIndex = %d\n", frameIdx );
-    TRACE_PCFRAME( "PointCloudFrameOrderCntVal = %d, NumProjPoints = %zu, NumRawPoints = %zu, NumEomPoints = %zu,",
-                   frameIdx, numProjPoints, numRawPoints, numEomPoints );
-    auto checksumFrame = reconstructs[frameIdx].computeChecksum( true );
-    TRACE_PCFRAME( " MD5 checksum = " );
-    for ( auto& c : checksumFrame ) { TRACE_PCFRAME( "%02x", c ); }
-    TRACE_PCFRAME( "\n" );
+        size_t numProjPoints = 0, numRawPoints = 0, numEomPoints = 0;
+        for ( size_t tileIdx = 0; tileIdx < tileCount; tileIdx++ ) {
+          auto& tile = context[frameIdx].getTile( tileIdx );
+          numProjPoints += tile.getTotalNumberOfRegularPoints();
+          numEomPoints += tile.getTotalNumberOfEOMPoints();
+          numRawPoints += tile.getTotalNumberOfRawPoints();
+        }  // tile
+        if ( ai.getAttributeCount() == 0 ) {
+          reconstruct.removeColors();
+          reconstruct.removeColors16bit();
+        } else {
+          bool isAttributes444 = context.getVideoAttributesMultiple( 0 ).getColorFormat() == PCCCOLORFORMAT::RGB444;
+          if ( !isAttributes444 ) {  // lossy: convert 16-bit yuv444 to 8-bit RGB444
+            reconstruct.convertYUV16ToRGB8();
+          } else {
+            reconstruct.copyRGB16ToRGB8();
+          }
+        }
+        auto& pcFrameTrace = pcFrameTraces[frameIdx];
+        pcFrameTrace += stringFormat( "AtlasFrameIndex = %d\n", frameIdx );
+        pcFrameTrace += stringFormat(
+            "PointCloudFrameOrderCntVal = %d, NumProjPoints = %zu, NumRawPoints = %zu, NumEomPoints = %zu,", frameIdx,
+            numProjPoints, numRawPoints, numEomPoints );
+        auto checksumFrame = reconstruct.computeChecksum( true );
+        pcFrameTrace += " MD5 checksum = ";
+        for ( auto& c : checksumFrame ) { pcFrameTrace += stringFormat( "%02x", c ); }
+        pcFrameTrace += "\n";
 #endif
 
-    // Post-Processing
-    TRACE_PATCH( "Post-Processing: postprocessSmoothing = %zu pbfEnableFlag = %d \n", params_.attrTransferFilterType_,
-                 ppSEIParams.pbfEnableFlag_ );
-    if ( params_.applyGeoSmoothingType_ != 0 && ppSEIParams.flagGeometrySmoothing_ ) {
-      PCCPointSet3 tempFrameBuffer = reconstruct;
-      if ( ppSEIParams.gridSmoothing_ ) {
-        smoothPointCloudPostprocess( reconstruct, params_.colorTransform_, ppSEIParams, partition );
-      }
-      if ( ai.getAttributeCount() > 0 ) {
-        bool isAttributes444 = context.getVideoAttributesMultiple( 0 ).getColorFormat() == PCCCOLORFORMAT::RGB444;
-        printf( "isAttributes444 = %d Format = %d \n", isAttributes444,
-                context.getVideoAttributesMultiple( 0 ).getColorFormat() );
-        fflush( stdout );
-
-        if ( !ppSEIParams.pbfEnableFlag_ ) {
-          // These are different attribute transfer functions
-          if ( params_.attrTransferFilterType_ == 1 || params_.attrTransferFilterType_ == 5 ) {
-            TRACE_PATCH( " transferColors16bitBP \n" );
-            tempFrameBuffer.transferColors16bitBP( reconstruct,                      // target
-                                                   params_.attrTransferFilterType_,  // filterType
-                                                   int32_t( 0 ),                     // searchRange
-                                                   isAttributes444,                  // losslessAttribute
-                                                   8,                                // numNeighborsColorTransferFwd
-                                                   1,                                // numNeighborsColorTransferBwd
-                                                   true,                             // useDistWeightedAverageFwd
-                                                   true,                             // useDistWeightedAverageBwd
-                                                   true,        // skipAvgIfIdenticalSourcePointPresentFwd
-                                                   false,       // skipAvgIfIdenticalSourcePointPresentBwd
-                                                   4,           // distOffsetFwd
-                                                   4,           // distOffsetBwd
-                                                   1000,        // maxGeometryDist2Fwd
-                                                   1000,        // maxGeometryDist2Bwd
-                                                   1000 * 256,  // maxColorDist2Fwd
-                                                   1000 * 256   // maxColorDist2Bwd
-            );
-          } else if ( params_.attrTransferFilterType_ == 2 ) {
-            TRACE_PATCH( " transferColorWeight \n" );
-            tempFrameBuffer.transferColorWeight( reconstruct, 0.1 );
-          } else if ( params_.attrTransferFilterType_ == 3 ) {
-            TRACE_PATCH( " transferColorsFilter3 \n" );
-            tempFrameBuffer.transferColorsFilter3( reconstruct, int32_t( 0 ), isAttributes444 );
-          } else if ( params_.attrTransferFilterType_ == 7 || params_.attrTransferFilterType_ == 9 ) {
-            TRACE_PATCH( " transferColorsFilter3 \n" );
-            tempFrameBuffer.transferColorsBackward16bitBP( reconstruct,                      //  target
-                                                           params_.attrTransferFilterType_,  //  filterType
-                                                           int32_t( 0 ),                     //  searchRange
-                                                           isAttributes444,                  //  losslessAttribute
-                                                           8,           //  numNeighborsColorTransferFwd
-                                                           1,           //  numNeighborsColorTransferBwd
-                                                           true,        //  useDistWeightedAverageFwd
-                                                           true,        //  useDistWeightedAverageBwd
-                                                           true,        //  skipAvgIfIdenticalSourcePointPresentFwd
-                                                           false,       //  skipAvgIfIdenticalSourcePointPresentBwd
-                                                           4,           //  distOffsetFwd
-                                                           4,           //  distOffsetBwd
-                                                           1000,        //  maxGeometryDist2Fwd
-                                                           1000,        //  maxGeometryDist2Bwd
-                                                           1000 * 256,  //  maxColorDist2Fwd
-                                                           1000 * 256   //  maxColorDist2Bwd
-            );
+        // Post-Processing
+        TRACE_PATCH( "Post-Processing: postprocessSmoothing = %zu pbfEnableFlag = %d \n",
+                     params_.attrTransferFilterType_, ppSEIParams.pbfEnableFlag_ );
+        if ( params_.applyGeoSmoothingType_ != 0 && ppSEIParams.flagGeometrySmoothing_ ) {
+          PCCPointSet3 tempFrameBuffer = reconstruct;
+          if ( ppSEIParams.gridSmoothing_ ) {
+            smoothPointCloudPostprocess( reconstruct, params_.colorTransform_, ppSEIParams, partition );
           }
+          if ( ai.getAttributeCount() > 0 ) {
+            bool isAttributes444 = context.getVideoAttributesMultiple( 0 ).getColorFormat() == PCCCOLORFORMAT::RGB444;
+            printf( "isAttributes444 = %d Format = %d \n", isAttributes444,
+                    context.getVideoAttributesMultiple( 0 ).getColorFormat() );
+            fflush( stdout );
+
+            if ( !ppSEIParams.pbfEnableFlag_ ) {
+              // These are different attribute transfer functions
+              if ( params_.attrTransferFilterType_ == 1 || params_.attrTransferFilterType_ == 5 ) {
+                TRACE_PATCH( " transferColors16bitBP \n" );
+                tempFrameBuffer.transferColors16bitBP( reconstruct,                      // target
+                                                       params_.attrTransferFilterType_,  // filterType
+                                                       int32_t( 0 ),                     // searchRange
+                                                       isAttributes444,                  // losslessAttribute
+                                                       8,                                // numNeighborsColorTransferFwd
+                                                       1,                                // numNeighborsColorTransferBwd
+                                                       true,                             // useDistWeightedAverageFwd
+                                                       true,                             // useDistWeightedAverageBwd
+                                                       true,        // skipAvgIfIdenticalSourcePointPresentFwd
+                                                       false,       // skipAvgIfIdenticalSourcePointPresentBwd
+                                                       4,           // distOffsetFwd
+                                                       4,           // distOffsetBwd
+                                                       1000,        // maxGeometryDist2Fwd
+                                                       1000,        // maxGeometryDist2Bwd
+                                                       1000 * 256,  // maxColorDist2Fwd
+                                                       1000 * 256   // maxColorDist2Bwd
+                );
+              } else if ( params_.attrTransferFilterType_ == 2 ) {
+                TRACE_PATCH( " transferColorWeight \n" );
+                tempFrameBuffer.transferColorWeight( reconstruct, 0.1 );
+              } else if ( params_.attrTransferFilterType_ == 3 ) {
+                TRACE_PATCH( " transferColorsFilter3 \n" );
+                tempFrameBuffer.transferColorsFilter3( reconstruct, int32_t( 0 ), isAttributes444 );
+              } else if ( params_.attrTransferFilterType_ == 7 || params_.attrTransferFilterType_ == 9 ) {
+                TRACE_PATCH( " transferColorsFilter3 \n" );
+                tempFrameBuffer.transferColorsBackward16bitBP( reconstruct,                      //  target
+                                                               params_.attrTransferFilterType_,  //  filterType
+                                                               int32_t( 0 ),                     //  searchRange
+                                                               isAttributes444,                  //  losslessAttribute
+                                                               8,           //  numNeighborsColorTransferFwd
+                                                               1,           //  numNeighborsColorTransferBwd
+                                                               true,        //  useDistWeightedAverageFwd
+                                                               true,        //  useDistWeightedAverageBwd
+                                                               true,        //  skipAvgIfIdenticalSourcePointPresentFwd
+                                                               false,       //  skipAvgIfIdenticalSourcePointPresentBwd
+                                                               4,           //  distOffsetFwd
+                                                               4,           //  distOffsetBwd
+                                                               1000,        //  maxGeometryDist2Fwd
+                                                               1000,        //  maxGeometryDist2Bwd
+                                                               1000 * 256,  //  maxColorDist2Fwd
+                                                               1000 * 256   //  maxColorDist2Bwd
+                );
+              }
+            }
+          }  // if ( ai.getAttributeCount() > 0 )
         }
-      }  // if ( ai.getAttributeCount() > 0 )
+        if ( ai.getAttributeCount() > 0 ) {
+          if ( params_.applyAttrSmoothingType_ != 0 && ppSEIParams.flagColorSmoothing_ ) {
+            TRACE_PATCH( " colorSmoothing \n" );
+            colorSmoothing( reconstruct, params_.colorTransform_, ppSEIParams );
+          }
+          if ( context.getVideoAttributesMultiple( 0 ).getColorFormat() !=
+               PCCCOLORFORMAT::RGB444 ) {  // lossy: convert 16-bit yuv444 to 8-bit RGB444
+            TRACE_PATCH( "lossy: convert 16-bit yuv444 to 8-bit RGB444 (convertYUV16ToRGB8) \n" );
+            reconstruct.convertYUV16ToRGB8();
+          } else {  // lossless: copy 16-bit RGB to 8-bit RGB
+            TRACE_PATCH( "lossy: lossless: copy 16-bit RGB to 8-bit RGB (copyRGB16ToRGB8) \n" );
+            reconstruct.copyRGB16ToRGB8();
+          }
+        }
+        /*auto tmp = reconstruct.computeChecksum();
+        TRACE_PCFRAME( " MD5 checksum = " );
+        for ( auto& c : tmp ) { TRACE_PCFRAME( "%02x", c ); }
+        TRACE_PCFRAME( "\n" );*/
+#ifdef CONFORMANCE_TRACE
+        auto& recFrameTrace = recFrameTraces[frameIdx];
+        recFrameTrace += stringFormat( "AtlasFrameIndex = %d\n", frameIdx );
+        auto checksum = reconstruct.computeChecksum( true );
+        recFrameTrace += " MD5 checksum = ";
+        for ( auto& c : checksum ) { recFrameTrace += stringFormat( "%02x", c ); }
+        recFrameTrace += "\n";
+#endif
+#if defined( ENABLE_TBB )
+      } );
+    } );
+#else
     }
-    if ( ai.getAttributeCount() > 0 ) {
-      if ( params_.applyAttrSmoothingType_ != 0 && ppSEIParams.flagColorSmoothing_ ) {
-        TRACE_PATCH( " colorSmoothing \n" );
-        colorSmoothing( reconstruct, params_.colorTransform_, ppSEIParams );
-      }
-      if ( context.getVideoAttributesMultiple( 0 ).getColorFormat() !=
-           PCCCOLORFORMAT::RGB444 ) {  // lossy: convert 16-bit yuv444 to 8-bit RGB444
-        TRACE_PATCH( "lossy: convert 16-bit yuv444 to 8-bit RGB444 (convertYUV16ToRGB8) \n" );
-        reconstruct.convertYUV16ToRGB8();
-      } else {  // lossless: copy 16-bit RGB to 8-bit RGB
-        TRACE_PATCH( "lossy: lossless: copy 16-bit RGB to 8-bit RGB (copyRGB16ToRGB8) \n" );
-        reconstruct.copyRGB16ToRGB8();
+#endif
+    for ( size_t frameIdx = startFrame; frameIdx < endFrame; frameIdx++ ) {
+      TRACE_PCFRAME( "%s", pcFrameTraces[frameIdx].c_str() );
+      TRACE_RECFRAME( "%s", recFrameTraces[frameIdx].c_str() );
+    }
+    if ( streaming ) {
+      int ret = frameOutput_( frames );
+      releaseVideoFrames( context, startFrame, endFrame, frameCount );
+      releaseVideoDecoding( progress, endFrame );
+      if ( ret != 0 ) {
+        finishVideoDecoding( tasks, progress );
+        return ret;
       }
     }
-    /*auto tmp = reconstruct.computeChecksum();
-    TRACE_PCFRAME( " MD5 checksum = " );
-    for ( auto& c : tmp ) { TRACE_PCFRAME( "%02x", c ); }
-    TRACE_PCFRAME( "\n" );*/
-    TRACE_RECFRAME( "AtlasFrameIndex = %d\n", frameIdx );
-    auto checksum = reconstructs[frameIdx].computeChecksum( true );
-    TRACE_RECFRAME( " MD5 checksum = " );
-    for ( auto& c : checksum ) { TRACE_RECFRAME( "%02x", c ); }
-    TRACE_RECFRAME( "\n" );
   }
+  if ( streaming ) { finishVideoDecoding( tasks, progress ); }
   return 0;
 }
 
+void PCCDecoder::releaseVideoFrames( PCCContext& context, size_t startFrame, size_t endFrame, size_t frameCount ) {
+  auto release = [&]( auto& video ) {
+    const size_t pictureCount = video.getFrameCount() / frameCount;  // pictures per frame: 1 or mapCount
+    for ( size_t i = startFrame * pictureCount; i < endFrame * pictureCount; i++ ) { video.getFrame( i ).release(); }
+  };
+  release( context.getVideoOccupancyMap() );
+  for ( auto& video : context.getVideoGeometryMultiple() ) { release( video ); }
+  for ( auto& video : context.getVideoAttributesMultiple() ) { release( video ); }
+  release( context.getVideoRawPointsGeometry() );
+  release( context.getVideoRawPointsAttribute() );
+}
+
+void PCCDecoder::decodeVideos( std::vector<VideoDecodingTask>& tasks, VideoDecodingProgress& progress ) {
+  auto&                    videoDecoders = progress.videoDecoders_;
+  auto&                    groups        = progress.groups_;
+  std::vector<const void*> groupVideos;
+  videoDecoders.resize( tasks.size() );
+  for ( size_t taskIdx = 0; taskIdx < tasks.size(); taskIdx++ ) {
+    videoDecoders[taskIdx].setLogger( *logger_ );
+    videoDecoders[taskIdx].setDeferredTrace( true );
+    auto it = std::find( groupVideos.begin(), groupVideos.end(), tasks[taskIdx].video_ );
+    if ( it == groupVideos.end() ) {
+      groupVideos.push_back( tasks[taskIdx].video_ );
+      groups.push_back( {taskIdx} );
+    } else {
+      groups[it - groupVideos.begin()].push_back( taskIdx );
+    }
+  }
+  progress.decodedFrames_.assign( groups.size(), 0 );
+  auto decodeGroup = [&tasks, &progress]( const size_t groupIdx ) {
+    const bool streaming = progress.windowSize_ > 0;
+    for ( auto taskIdx : progress.groups_[groupIdx] ) {
+      auto& task         = tasks[taskIdx];
+      auto& videoDecoder = progress.videoDecoders_[taskIdx];
+      // each task overwrites the video: only the pictures of the last one are streamed
+      if ( streaming && taskIdx == progress.groups_[groupIdx].back() ) {
+        const size_t pictureCountPerFrame =
+            ( std::max )( task.pictureCount_ / ( std::max )( progress.frameCount_, size_t( 1 ) ), size_t( 1 ) );
+        videoDecoder.setPictureOutput( task.pictureCount_, [&task, &progress, groupIdx,
+                                                            pictureCountPerFrame]( size_t index ) {
+          if ( task.convert_ ) { task.convert_( index ); }
+          const size_t                 decodedFrames = ( index + 1 ) / pictureCountPerFrame;
+          std::unique_lock<std::mutex> lock( progress.mutex_ );
+          progress.decodedFrames_[groupIdx] = decodedFrames;
+          progress.condition_.notify_all();
+          // the decoding is paused while its pictures are more than one window ahead of the reconstruction
+          progress.condition_.wait( lock, [&] {
+            return progress.finished_ || decodedFrames < progress.releasedFrames_ + 2 * progress.windowSize_;
+          } );
+        } );
+        task.decode_( videoDecoder );
+      } else {
+        task.decode_( videoDecoder );
+        if ( task.convert_ ) {
+          for ( size_t index = 0; index < videoDecoder.getPictureCount(); index++ ) { task.convert_( index ); }
+        }
+      }
+    }
+    if ( streaming ) {
+      // the missing pictures, if any, must not block the reconstruction
+      std::lock_guard<std::mutex> lock( progress.mutex_ );
+      progress.decodedFrames_[groupIdx] = ( std::numeric_limits<size_t>::max )();
+      progress.condition_.notify_all();
+    }
+  };
+  if ( progress.windowSize_ > 0 ) {
+    // the decoders wait for the reconstruction: they can't share the worker threads of the reconstruction
+    for ( size_t groupIdx = 0; groupIdx < groups.size(); groupIdx++ ) {
+      progress.threads_.emplace_back( decodeGroup, groupIdx );
+    }
+    return;
+  }
+#if defined( ENABLE_TBB )
+  tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), groups.size(), [&]( const size_t groupIdx ) {
+#else
+  for ( size_t groupIdx = 0; groupIdx < groups.size(); groupIdx++ ) {
+#endif
+      decodeGroup( groupIdx );
+#if defined( ENABLE_TBB )
+    } );
+  } );
+#else
+  }
+#endif
+  for ( size_t taskIdx = 0; taskIdx < tasks.size(); taskIdx++ ) {
+    TRACE_PICTURE( "%s", tasks[taskIdx].trace_.c_str() );
+    videoDecoders[taskIdx].flushTrace();
+  }
+}
+
+void PCCDecoder::waitVideoDecoding( VideoDecodingProgress& progress, size_t endFrame ) {
+  std::unique_lock<std::mutex> lock( progress.mutex_ );
+  progress.condition_.wait( lock, [&] {
+    return std::all_of( progress.decodedFrames_.begin(), progress.decodedFrames_.end(),
+                        [&]( size_t decodedFrames ) { return decodedFrames >= endFrame; } );
+  } );
+}
+
+void PCCDecoder::releaseVideoDecoding( VideoDecodingProgress& progress, size_t endFrame ) {
+  std::lock_guard<std::mutex> lock( progress.mutex_ );
+  progress.releasedFrames_ = endFrame;
+  progress.condition_.notify_all();
+}
+
+void PCCDecoder::finishVideoDecoding( std::vector<VideoDecodingTask>& tasks, VideoDecodingProgress& progress ) {
+  {
+    std::lock_guard<std::mutex> lock( progress.mutex_ );
+    progress.finished_ = true;
+    progress.condition_.notify_all();
+  }
+  for ( auto& thread : progress.threads_ ) { thread.join(); }
+  progress.threads_.clear();
+  for ( size_t taskIdx = 0; taskIdx < tasks.size(); taskIdx++ ) {
+    TRACE_PICTURE( "%s", tasks[taskIdx].trace_.c_str() );
+    progress.videoDecoders_[taskIdx].flushTrace();
+  }
+}
+
 void PCCDecoder::setPointLocalReconstruction( PCCContext& context ) {
   auto& asps = context.getAtlasSequenceParameterSet( 0 );
   TRACE_PATCH( "PLR = %d \n", asps.getPLREnabledFlag() );
@@ -49,6 +49,8 @@ PCCDecoderParameters::PCCDecoderParameters() {
   byteStreamVideoCoderGeometry_      = true;
   byteStreamVideoCoderAttribute_     = true;
   nbThread_                          = 1;
+  spatialIndexType_                  = 0;
+  streamingFrameCount_               = 0;
   keepIntermediateFiles_             = false;
   pixelDeinterleavingType_           = -1;
   pointLocalReconstructionType_      = -1;
@@ -72,6 +74,8 @@ void PCCDecoderParameters::print() {
   std::cout << "\t startFrameNumber                    " << startFrameNumber_ << std::endl;
   std::cout << "\t colorTransform                      " << colorTransform_ << std::endl;
   std::cout << "\t nbThread                            " << nbThread_ << std::endl;
+  std::cout << "\t spatialIndexType                    " << spatialIndexType_ << std::endl;
+  std::cout << "\t streamingFrameCount                 " << streamingFrameCount_ << std::endl;
   std::cout << "\t keepIntermediateFiles               " << keepIntermediateFiles_ << std::endl;
   std::cout << "\t video encoding" << std::endl;
   std::cout << "\t   colorSpaceConversionPath          " << colorSpaceConversionPath_ << std::endl;
@@ -104,6 +108,10 @@ bool PCCDecoderParameters::check() {
     ret = false;
     std::cerr << "compressedStreamPath not set or exist\n";
   }
+  if ( spatialIndexType_ > 1 ) {
+    ret = false;
+    std::cerr << "spatialIndexType must be 0 (kd-tree) or 1 (voxel grid)\n";
+  }
   if ( inverseColorSpaceConversionConfig_.empty() || !exist( inverseColorSpaceConversionConfig_ ) ) {
     ret = false;
     std::cerr << "inverseColorSpaceConversionConfig not set or exist\n";
@@ -53,9 +53,16 @@
 
 using namespace pcc;
 
+std::mutex PCCVideoDecoder::libraryDecoderMutex_;
+
 PCCVideoDecoder::PCCVideoDecoder()  = default;
 PCCVideoDecoder::~PCCVideoDecoder() = default;
 
+void PCCVideoDecoder::flushTrace() {
+  if ( !pictureTrace_.empty() ) { TRACE_PICTURE( "%s", pictureTrace_.c_str() ); }
+  pictureTrace_.clear();
+}
+
 template <typename T>
 bool PCCVideoDecoder::decompress( PCCVideo<T, 3>&    video,
                                   PCCContext&        contexts,
@@ -107,26 +114,6 @@ bool PCCVideoDecoder::decompress( PCCVideo<T, 3>&    video,
     shmDecoder->setLayerIndex( shvcLayerIndex );
   }
 #endif
-  decoder->decode( bitstream, video, outputBitDepth, decoderPath, fileName );
-  size_t width      = video.getWidth();
-  size_t height     = video.getHeight();
-  bool   is444      = video.is444();
-  size_t frameIndex = 0;
-  for ( auto& image : video ) {
-    TRACE_PICTURE( " IdxOutOrderCntVal = %d, ", frameIndex++ );
-    TRACE_PICTURE( " MD5checksumChan0 = %s, ", image.computeMD5( 0 ).c_str() );
-    TRACE_PICTURE( " MD5checksumChan1 = %s, ", image.computeMD5( 1 ).c_str() );
-    TRACE_PICTURE( " MD5checksumChan2 = %s \n", image.computeMD5( 2 ).c_str() );
-  }
-  TRACE_PICTURE( "Width =  %d, Height = %d \n", video.getWidth(), video.getHeight() );
-  printf( "Decoded frame = %zu x %zu %zu bits is444 = %d NumFrames = %zu \n", width, height, outputBitDepth, is444,
-          video.getFrameCount() );
-  fflush( stdout );
-  if ( keepIntermediateFiles ) {
-    bitstream.write( binFileName );
-    video.write( video.addFormat( fileName + "_rec", outputBitDepth == 8 ? "8" : "10" ), outputBitDepth == 8 ? 1 : 2 );
-  }
-
   // Convert dec video
   std::shared_ptr<PCCVirtualColorConverter<T>> converter;
   std::string                                  configInverseColorSpace;
@@ -141,238 +128,349 @@ bool PCCVideoDecoder::decompress( PCCVideo<T, 3>&    video,
 #endif
     configInverseColorSpace = inverseColorSpaceConversionConfig;
   }
-  if ( inverseColorSpaceConversionConfig.empty() || is444 ) {
-    if ( is444 ) {
-      video.setDeprecatedColorFormat( 0 );
+  // The pictures are converted by groups: the whole video once decoded or, when a picture output is set, each
+  // picture as it leaves the decoder. The streamed pictures are stored in place in the video, sized up front.
+  const bool    streamed = static_cast<bool>( pictureOutput_ );
+  const size_t  nbyte    = outputBitDepth == 8 ? 1 : 2;
+  size_t        videoWidth = 0, videoHeight = 0, pictureCount = 0;
+  bool          videoIs444 = false, converted = true;
+  std::string   recFileName, convertedRecFileName, pictureTrace;
+  std::ofstream recFile, convertedRecFile;
+  // the output FIFO of the streaming decoders is named from fileName + "_rec": the converters must not use it
+  const std::string convertFileName = fileName + ( streamed ? "_rec_converted" : "_rec" );
+  auto convertPictures = [&]( PCCVideo<T, 3>& pictures, size_t firstPicture ) -> bool {
+    const size_t width  = pictures.getWidth();
+    const size_t height = pictures.getHeight();
+    const bool   is444  = pictures.is444();
+    if ( inverseColorSpaceConversionConfig.empty() || is444 ) {
+      if ( is444 ) {
+        pictures.setDeprecatedColorFormat( 0 );
+      } else {
+        pictures.setDeprecatedColorFormat( 1 );
+        pictures.convertYUV420ToYUV444();
+      }
     } else {
-      video.setDeprecatedColorFormat( 1 );
-      video.convertYUV420ToYUV444();
-    }
-  } else {
-    if ( patchColorSubsampling ) {
-      PCCVideo<T, 3> video444;
-      video444 = video;
-      video444.convertYUV420ToYUV444();
-      // perform color-upsampling based on patch information
-      for ( size_t frNum = 0; frNum < video.getFrameCount(); frNum++ ) {
-        // context variable, contains the patch information
-        auto& context = contexts[frNum / 2];
-        // full resolution image (already filled by previous dilation
-        auto& refImage = video444.getFrame( frNum );
-        // image that will contain the per-patch chroma sub-sampled image
-        auto& destImage = video.getFrame( frNum );
-        destImage.resize( width, height, PCCCOLORFORMAT::YUV444 );
-        // iterate the patch information and perform chroma down-sampling on each patch individually
-        std::vector<PCCPatch>& patches      = context.getTitleFrameContext().getPatches();
-        std::vector<size_t>&   blockToPatch = context.getTitleFrameContext().getBlockToPatch();
-        for ( int patchIdx = 0; patchIdx <= patches.size(); patchIdx++ ) {
-          size_t occupancyResolution;
-          size_t patch_left;
-          size_t patch_top;
-          size_t patch_width;
-          size_t patch_height;
-          if ( patchIdx == 0 ) {
-            // background, does not have a corresponding patch
-            auto& patch         = patches[0];
-            occupancyResolution = patch.getOccupancyResolution();
-            patch_left          = 0;
-            patch_top           = 0;
-            patch_width         = width;
-            patch_height        = height;
-          } else {
-            auto& patch         = patches[patchIdx - 1];
-            occupancyResolution = patch.getOccupancyResolution();
-            patch_left          = patch.getU0() * occupancyResolution;
-            patch_top           = patch.getV0() * occupancyResolution;
-            if ( !( patch.isPatchDimensionSwitched() ) ) {
-              patch_width  = patch.getSizeU0() * occupancyResolution;
-              patch_height = patch.getSizeV0() * occupancyResolution;
+      if ( patchColorSubsampling ) {
+        PCCVideo<T, 3> video444;
+        video444 = pictures;
+        video444.convertYUV420ToYUV444();
+        // perform color-upsampling based on patch information
+        for ( size_t frNum = 0; frNum < pictures.getFrameCount(); frNum++ ) {
+          // context variable, contains the patch information
+          auto& context = contexts[( firstPicture + frNum ) / 2];
+          // full resolution image (already filled by previous dilation
+          auto& refImage = video444.getFrame( frNum );
+          // image that will contain the per-patch chroma sub-sampled image
+          auto& destImage = pictures.getFrame( frNum );
+          destImage.resize( width, height, PCCCOLORFORMAT::YUV444 );
+          // iterate the patch information and perform chroma down-sampling on each patch individually
+          std::vector<PCCPatch>& patches      = context.getTitleFrameContext().getPatches();
+          std::vector<size_t>&   blockToPatch = context.getTitleFrameContext().getBlockToPatch();
+          for ( int patchIdx = 0; patchIdx <= patches.size(); patchIdx++ ) {
+            size_t occupancyResolution;
+            size_t patch_left;
+            size_t patch_top;
+            size_t patch_width;
+            size_t patch_height;
+            if ( patchIdx == 0 ) {
+              // background, does not have a corresponding patch
+              auto& patch         = patches[0];
+              occupancyResolution = patch.getOccupancyResolution();
+              patch_left          = 0;
+              patch_top           = 0;
+              patch_width         = width;
+              patch_height        = height;
             } else {
-              patch_width  = patch.getSizeV0() * occupancyResolution;
-              patch_height = patch.getSizeU0() * occupancyResolution;
+              auto& patch         = patches[patchIdx - 1];
+              occupancyResolution = patch.getOccupancyResolution();
+              patch_left          = patch.getU0() * occupancyResolution;
+              patch_top           = patch.getV0() * occupancyResolution;
+              if ( !( patch.isPatchDimensionSwitched() ) ) {
+                patch_width  = patch.getSizeU0() * occupancyResolution;
+                patch_height = patch.getSizeV0() * occupancyResolution;
+              } else {
+                patch_width  = patch.getSizeV0() * occupancyResolution;
+                patch_height = patch.getSizeU0() * occupancyResolution;
+              }
             }
-          }
-          // initializing the image container with zeros
-          PCCImage<T, 3> tmpImage;
-          tmpImage.resize( patch_width, patch_height, PCCCOLORFORMAT::YUV444 );
-          // cut out the patch image
-          refImage.copyBlock( patch_top, patch_left, patch_width, patch_height, tmpImage );
+            // initializing the image container with zeros
+            PCCImage<T, 3> tmpImage;
+            tmpImage.resize( patch_width, patch_height, PCCCOLORFORMAT::YUV444 );
+            // cut out the patch image
+            refImage.copyBlock( patch_top, patch_left, patch_width, patch_height, tmpImage );
 
-          // fill in the blocks by extending the edges
-          for ( size_t i = 0; i < patch_height / occupancyResolution; i++ ) {
-            for ( size_t j = 0; j < patch_width / occupancyResolution; j++ ) {
-              if ( blockToPatch[( i + patch_top / occupancyResolution ) * ( width / occupancyResolution ) + j +
-                                patch_left / occupancyResolution] == patchIdx ) {
-                // do nothing
-                continue;
-              } else {
-                // search for the block that contains attribute information and
-                // extend the block edge
-                int              direction;
-                int              searchIndex;
-                std::vector<int> neighborIdx( 4, -1 );
-                std::vector<int> neighborDistance( 4, ( std::numeric_limits<int>::max )() );
-                // looking for the neighboring block to the left of the
-                // current block
-                searchIndex = j;
-                while ( searchIndex >= 0 ) {
-                  if ( blockToPatch[( i + patch_top / occupancyResolution ) * ( width / occupancyResolution ) +
-                                    searchIndex + patch_left / occupancyResolution] == patchIdx ) {
-                    neighborIdx[0]      = searchIndex;
-                    neighborDistance[0] = j - searchIndex;
-                    searchIndex         = 0;
-                  }
-                  searchIndex--;
-                }
-                // looking for the neighboring block to the right of the
-                // current block
-                searchIndex = j;
-                while ( searchIndex < patch_width / occupancyResolution ) {
-                  if ( blockToPatch[( i + patch_top / occupancyResolution ) * ( width / occupancyResolution ) +
-                                    searchIndex + patch_left / occupancyResolution] == patchIdx ) {
-                    neighborIdx[1]      = searchIndex;
-                    neighborDistance[1] = searchIndex - j;
-                    searchIndex         = patch_width / occupancyResolution;
-                  }
-                  searchIndex++;
-                }
-                // looking for the neighboring block above the current block
-                searchIndex = i;
-                while ( searchIndex >= 0 ) {
-                  if ( blockToPatch[( searchIndex + patch_top / occupancyResolution ) *
-                                        ( width / occupancyResolution ) +
-                                    j + patch_left / occupancyResolution] == patchIdx ) {
-                    neighborIdx[2]      = searchIndex;
-                    neighborDistance[2] = i - searchIndex;
-                    searchIndex         = 0;
-                  }
-                  searchIndex--;
-                }
-                // looking for the neighboring block below the current block
-                searchIndex = i;
-                while ( searchIndex < patch_height / occupancyResolution ) {
-                  if ( blockToPatch[( searchIndex + patch_top / occupancyResolution ) *
-                                        ( width / occupancyResolution ) +
-                                    j + patch_left / occupancyResolution] == patchIdx ) {
-                    neighborIdx[3]      = searchIndex;
-                    neighborDistance[3] = searchIndex - i;
-                    searchIndex         = patch_height / occupancyResolution;
+            // fill in the blocks by extending the edges
+            for ( size_t i = 0; i < patch_height / occupancyResolution; i++ ) {
+              for ( size_t j = 0; j < patch_width / occupancyResolution; j++ ) {
+                if ( blockToPatch[( i + patch_top / occupancyResolution ) * ( width / occupancyResolution ) + j +
+                                  patch_left / occupancyResolution] == patchIdx ) {
+                  // do nothing
+                  continue;
+                } else {
+                  // search for the block that contains attribute information and
+                  // extend the block edge
+                  int              direction;
+                  int              searchIndex;
+                  std::vector<int> neighborIdx( 4, -1 );
+                  std::vector<int> neighborDistance( 4, ( std::numeric_limits<int>::max )() );
+                  // looking for the neighboring block to the left of the
+                  // current block
+                  searchIndex = j;
+                  while ( searchIndex >= 0 ) {
+                    if ( blockToPatch[( i + patch_top / occupancyResolution ) * ( width / occupancyResolution ) +
+                                      searchIndex + patch_left / occupancyResolution] == patchIdx ) {
+                      neighborIdx[0]      = searchIndex;
+                      neighborDistance[0] = j - searchIndex;
+                      searchIndex         = 0;
+                    }
+                    searchIndex--;
                   }
-                  searchIndex++;
-                }
-                // check if the candidate was found
-                assert( *( std::max )( neighborIdx.begin(), neighborIdx.end() ) > 0 );
-                // now fill in the block with the edge value coming from the
-                // nearest neighbor
-                direction =
-                    ( std::min_element )( neighborDistance.begin(), neighborDistance.end() ) - neighborDistance.begin();
-                if ( direction == 0 ) {
-                  // copying from left neighboring block
-                  for ( size_t iBlk = 0; iBlk < occupancyResolution; iBlk++ ) {
-                    for ( size_t jBlk = 0; jBlk < occupancyResolution; jBlk++ ) {
-                      tmpImage.setValue(
-                          0, j * occupancyResolution + jBlk, i * occupancyResolution + iBlk,
-                          tmpImage.getValue( 0, neighborIdx[0] * occupancyResolution + occupancyResolution - 1,
-                                             i * occupancyResolution + iBlk ) );
-                      tmpImage.setValue(
-                          1, j * occupancyResolution + jBlk, i * occupancyResolution + iBlk,
-                          tmpImage.getValue( 1, neighborIdx[0] * occupancyResolution + occupancyResolution - 1,
-                                             i * occupancyResolution + iBlk ) );
-                      tmpImage.setValue(
-                          2, j * occupancyResolution + jBlk, i * occupancyResolution + iBlk,
-                          tmpImage.getValue( 2, neighborIdx[0] * occupancyResolution + occupancyResolution - 1,
-                                             i * occupancyResolution + iBlk ) );
+                  // looking for the neighboring block to the right of the
+                  // current block
+                  searchIndex = j;
+                  while ( searchIndex < patch_width / occupancyResolution ) {
+                    if ( blockToPatch[( i + patch_top / occupancyResolution ) * ( width / occupancyResolution ) +
+                                      searchIndex + patch_left / occupancyResolution] == patchIdx ) {
+                      neighborIdx[1]      = searchIndex;
+                      neighborDistance[1] = searchIndex - j;
+                      searchIndex         = patch_width / occupancyResolution;
                     }
+                    searchIndex++;
                   }
-                } else if ( direction == 1 ) {
-                  // copying block from right neighboring position
-                  for ( size_t iBlk = 0; iBlk < occupancyResolution; iBlk++ ) {
-                    for ( size_t jBlk = 0; jBlk < occupancyResolution; jBlk++ ) {
-                      tmpImage.setValue( 0, j * occupancyResolution + jBlk, i * occupancyResolution + iBlk,
-                                         tmpImage.getValue( 0, neighborIdx[1] * occupancyResolution,
-                                                            i * occupancyResolution + iBlk ) );
-                      tmpImage.setValue( 1, j * occupancyResolution + jBlk, i * occupancyResolution + iBlk,
-                                         tmpImage.getValue( 1, neighborIdx[1] * occupancyResolution,
-                                                            i * occupancyResolution + iBlk ) );
-                      tmpImage.setValue( 2, j * occupancyResolution + jBlk, i * occupancyResolution + iBlk,
-                                         tmpImage.getValue( 2, neighborIdx[1] * occupancyResolution,
-                                                            i * occupancyResolution + iBlk ) );
+                  // looking for the neighboring block above the current block
+                  searchIndex = i;
+                  while ( searchIndex >= 0 ) {
+                    if ( blockToPatch[( searchIndex + patch_top / occupancyResolution ) *
+                                          ( width / occupancyResolution ) +
+                                      j + patch_left / occupancyResolution] == patchIdx ) {
+                      neighborIdx[2]      = searchIndex;
+                      neighborDistance[2] = i - searchIndex;
+                      searchIndex         = 0;
                     }
+                    searchIndex--;
                   }
-                } else if ( direction == 2 ) {
-                  // copying block from above
-                  for ( size_t iBlk = 0; iBlk < occupancyResolution; iBlk++ ) {
-                    for ( size_t jBlk = 0; jBlk < occupancyResolution; jBlk++ ) {
-                      tmpImage.setValue(
-                          0, j * occupancyResolution + jBlk, i * occupancyResolution + iBlk,
-                          tmpImage.getValue( 0, j * occupancyResolution + jBlk,
-                                             neighborIdx[2] * occupancyResolution + occupancyResolution - 1 ) );
-                      tmpImage.setValue(
-                          1, j * occupancyResolution + jBlk, i * occupancyResolution + iBlk,
-                          tmpImage.getValue( 1, j * occupancyResolution + jBlk,
-                                             neighborIdx[2] * occupancyResolution + occupancyResolution - 1 ) );
-                      tmpImage.setValue(
-                          2, j * occupancyResolution + jBlk, i * occupancyResolution + iBlk,
-                          tmpImage.getValue( 2, j * occupancyResolution + jBlk,
-                                             neighborIdx[2] * occupancyResolution + occupancyResolution - 1 ) );
+                  // looking for the neighboring block below the current block
+                  searchIndex = i;
+                  while ( searchIndex < patch_height / occupancyResolution ) {
+                    if ( blockToPatch[( searchIndex + patch_top / occupancyResolution ) *
+                                          ( width / occupancyResolution ) +
+                                      j + patch_left / occupancyResolution] == patchIdx ) {
+                      neighborIdx[3]      = searchIndex;
+                      neighborDistance[3] = searchIndex - i;
+                      searchIndex         = patch_height / occupancyResolution;
                     }
+                    searchIndex++;
                   }
-                } else if ( direction == 3 ) {
-                  // copying block from below
-                  for ( size_t iBlk = 0; iBlk < occupancyResolution; iBlk++ ) {
-                    for ( size_t jBlk = 0; jBlk < occupancyResolution; jBlk++ ) {
-                      tmpImage.setValue( 0, j * occupancyResolution + jBlk, i * occupancyResolution + iBlk,
-                                         tmpImage.getValue( 0, j * occupancyResolution + jBlk,
-                                                            neighborIdx[3] * occupancyResolution ) );
-                      tmpImage.setValue( 1, j * occupancyResolution + jBlk, i * occupancyResolution + iBlk,
-                                         tmpImage.getValue( 1, j * occupancyResolution + jBlk,
-                                                            neighborIdx[3] * occupancyResolution ) );
-                      tmpImage.setValue( 2, j * occupancyResolution + jBlk, i * occupancyResolution + iBlk,
-                                         tmpImage.getValue( 2, j * occupancyResolution + jBlk,
-                                                            neighborIdx[3] * occupancyResolution ) );
+                  // check if the candidate was found
+                  assert( *( std::max )( neighborIdx.begin(), neighborIdx.end() ) > 0 );
+                  // now fill in the block with the edge value coming from the
+                  // nearest neighbor
+                  direction =
+                      ( std::min_element )( neighborDistance.begin(), neighborDistance.end() ) - neighborDistance.begin();
+                  if ( direction == 0 ) {
+                    // copying from left neighboring block
+                    for ( size_t iBlk = 0; iBlk < occupancyResolution; iBlk++ ) {
+                      for ( size_t jBlk = 0; jBlk < occupancyResolution; jBlk++ ) {
+                        tmpImage.setValue(
+                            0, j * occupancyResolution + jBlk, i * occupancyResolution + iBlk,
+                            tmpImage.getValue( 0, neighborIdx[0] * occupancyResolution + occupancyResolution - 1,
+                                               i * occupancyResolution + iBlk ) );
+                        tmpImage.setValue(
+                            1, j * occupancyResolution + jBlk, i * occupancyResolution + iBlk,
+                            tmpImage.getValue( 1, neighborIdx[0] * occupancyResolution + occupancyResolution - 1,
+                                               i * occupancyResolution + iBlk ) );
+                        tmpImage.setValue(
+                            2, j * occupancyResolution + jBlk, i * occupancyResolution + iBlk,
+                            tmpImage.getValue( 2, neighborIdx[0] * occupancyResolution + occupancyResolution - 1,
+                                               i * occupancyResolution + iBlk ) );
+                      }
+                    }
+                  } else if ( direction == 1 ) {
+                    // copying block from right neighboring position
+                    for ( size_t iBlk = 0; iBlk < occupancyResolution; iBlk++ ) {
+                      for ( size_t jBlk = 0; jBlk < occupancyResolution; jBlk++ ) {
+                        tmpImage.setValue( 0, j * occupancyResolution + jBlk, i * occupancyResolution + iBlk,
+                                           tmpImage.getValue( 0, neighborIdx[1] * occupancyResolution,
+                                                              i * occupancyResolution + iBlk ) );
+                        tmpImage.setValue( 1, j * occupancyResolution + jBlk, i * occupancyResolution + iBlk,
+                                           tmpImage.getValue( 1, neighborIdx[1] * occupancyResolution,
+                                                              i * occupancyResolution + iBlk ) );
+                        tmpImage.setValue( 2, j * occupancyResolution + jBlk, i * occupancyResolution + iBlk,
+                                           tmpImage.getValue( 2, neighborIdx[1] * occupancyResolution,
+                                                              i * occupancyResolution + iBlk ) );
+                      }
+                    }
+                  } else if ( direction == 2 ) {
+                    // copying block from above
+                    for ( size_t iBlk = 0; iBlk < occupancyResolution; iBlk++ ) {
+                      for ( size_t jBlk = 0; jBlk < occupancyResolution; jBlk++ ) {
+                        tmpImage.setValue(
+                            0, j * occupancyResolution + jBlk, i * occupancyResolution + iBlk,
+                            tmpImage.getValue( 0, j * occupancyResolution + jBlk,
+                                               neighborIdx[2] * occupancyResolution + occupancyResolution - 1 ) );
+                        tmpImage.setValue(
+                            1, j * occupancyResolution + jBlk, i * occupancyResolution + iBlk,
+                            tmpImage.getValue( 1, j * occupancyResolution + jBlk,
+                                               neighborIdx[2] * occupancyResolution + occupancyResolution - 1 ) );
+                        tmpImage.setValue(
+                            2, j * occupancyResolution + jBlk, i * occupancyResolution + iBlk,
+                            tmpImage.getValue( 2, j * occupancyResolution + jBlk,
+                                               neighborIdx[2] * occupancyResolution + occupancyResolution - 1 ) );
+                      }
                     }
+                  } else if ( direction == 3 ) {
+                    // copying block from below
+                    for ( size_t iBlk = 0; iBlk < occupancyResolution; iBlk++ ) {
+                      for ( size_t jBlk = 0; jBlk < occupancyResolution; jBlk++ ) {
+                        tmpImage.setValue( 0, j * occupancyResolution + jBlk, i * occupancyResolution + iBlk,
+                                           tmpImage.getValue( 0, j * occupancyResolution + jBlk,
+                                                              neighborIdx[3] * occupancyResolution ) );
+                        tmpImage.setValue( 1, j * occupancyResolution + jBlk, i * occupancyResolution + iBlk,
+                                           tmpImage.getValue( 1, j * occupancyResolution + jBlk,
+                                                              neighborIdx[3] * occupancyResolution ) );
+                        tmpImage.setValue( 2, j * occupancyResolution + jBlk, i * occupancyResolution + iBlk,
+                                           tmpImage.getValue( 2, j * occupancyResolution + jBlk,
+                                                              neighborIdx[3] * occupancyResolution ) );
+                      }
+                    }
+                  } else {
+                    printf( "This condition should never occur, report an error" );
+                    return false;
                   }
-                } else {
-                  printf( "This condition should never occur, report an error" );
-                  return false;
                 }
               }
             }
-          }
-          // perform downsampling
-          // const std::string rgbRecFileNamePatch = addVideoFormat( fileName
-          // + "_tmp", patch_width, patch_height,
-          // false, false ); const std::string yuvRecFileNamePatch =
-          // addVideoFormat( fileName + "_tmp", patch_width,
-          // patch_height, true, true );
-          PCCVideo<T, 3> tmpVideo;
-          tmpVideo.resize( 1 );
-          tmpVideo[0] = tmpImage;
-          converter->convert( configInverseColorSpace, tmpVideo, colorSpaceConversionPath, fileName + "_tmp" );
-          tmpImage = tmpVideo[0];
-          // substitute the pixels in the output image for compression
-          for ( size_t i = 0; i < patch_height; i++ ) {
-            for ( size_t j = 0; j < patch_width; j++ ) {
-              if ( context.getTitleFrameContext().getBlockToPatch()[( ( i + patch_top ) / occupancyResolution ) *
-                                                                        ( width / occupancyResolution ) +
-                                                                    ( j + patch_left ) / occupancyResolution] ==
-                   patchIdx ) {
-                // do nothing
-                for ( size_t cc = 0; cc < 3; cc++ ) {
-                  destImage.setValue( cc, j + patch_left, i + patch_top, tmpImage.getValue( cc, j, i ) );
+            // perform downsampling
+            // const std::string rgbRecFileNamePatch = addVideoFormat( fileName
+            // + "_tmp", patch_width, patch_height,
+            // false, false ); const std::string yuvRecFileNamePatch =
+            // addVideoFormat( fileName + "_tmp", patch_width,
+            // patch_height, true, true );
+            PCCVideo<T, 3> tmpVideo;
+            tmpVideo.resize( 1 );
+            tmpVideo[0] = tmpImage;
+            converter->convert( configInverseColorSpace, tmpVideo, colorSpaceConversionPath, fileName + "_tmp" );
+            tmpImage = tmpVideo[0];
+            // substitute the pixels in the output image for compression
+            for ( size_t i = 0; i < patch_height; i++ ) {
+              for ( size_t j = 0; j < patch_width; j++ ) {
+                if ( context.getTitleFrameContext().getBlockToPatch()[( ( i + patch_top ) / occupancyResolution ) *
+                                                                          ( width / occupancyResolution ) +
+                                                                      ( j + patch_left ) / occupancyResolution] ==
+                     patchIdx ) {
+                  // do nothing
+                  for ( size_t cc = 0; cc < 3; cc++ ) {
+                    destImage.setValue( cc, j + patch_left, i + patch_top, tmpImage.getValue( cc, j, i ) );
+                  }
                 }
               }
             }
           }
         }
+      } else {
+        converter->convert( configInverseColorSpace, pictures, colorSpaceConversionPath, convertFileName );
+        pictures.setDeprecatedColorFormat( colorSpaceConversionPath.empty() ? 1 : 2 );
       }
-    } else {
-      converter->convert( configInverseColorSpace, video, colorSpaceConversionPath, fileName + "_rec" );
-      video.setDeprecatedColorFormat( colorSpaceConversionPath.empty() ? 1 : 2 );
-      if ( keepIntermediateFiles ) { video.write( video.addFormat( fileName + "_rec", "16" ), 2 ); }
     }
+    return true;
+  };
+  auto outputPictures = [&]( PCCVideo<T, 3>& pictures ) {
+    if ( pictureCount == 0 ) {
+      videoWidth  = pictures.getWidth();
+      videoHeight = pictures.getHeight();
+      videoIs444  = pictures.is444();
+    }
+#ifdef CONFORMANCE_TRACE
+    for ( size_t i = 0; i < pictures.getFrameCount(); i++ ) {
+      auto& image = pictures[i];
+      pictureTrace += stringFormat( " IdxOutOrderCntVal = %d, ", pictureCount + i );
+      pictureTrace += stringFormat( " MD5checksumChan0 = %s, ", image.computeMD5( 0 ).c_str() );
+      pictureTrace += stringFormat( " MD5checksumChan1 = %s, ", image.computeMD5( 1 ).c_str() );
+      pictureTrace += stringFormat( " MD5checksumChan2 = %s \n", image.computeMD5( 2 ).c_str() );
+    }
+#endif
+    if ( keepIntermediateFiles ) {
+      if ( !recFile.is_open() ) {
+        recFileName = pictures.addFormat( fileName + "_rec", outputBitDepth == 8 ? "8" : "10" );
+        recFile.open( streamed ? recFileName + ".part" : recFileName, std::ios::binary );
+      }
+      for ( auto& image : pictures ) { image.write( recFile, nbyte ); }
+    }
+    converted = convertPictures( pictures, pictureCount ) && converted;
+    if ( keepIntermediateFiles && !inverseColorSpaceConversionConfig.empty() && !videoIs444 &&
+         !patchColorSubsampling ) {
+      if ( !convertedRecFile.is_open() ) {
+        convertedRecFileName = pictures.addFormat( fileName + "_rec", "16" );
+        convertedRecFile.open( streamed ? convertedRecFileName + ".part" : convertedRecFileName, std::ios::binary );
+      }
+      for ( auto& image : pictures ) { image.write( convertedRecFile, 2 ); }
+    }
+    if ( streamed ) {
+      for ( size_t i = 0; i < pictures.getFrameCount(); i++ ) {
+        const size_t index = pictureCount + i;
+        if ( index < video.getFrameCount() ) {
+          video[index].swap( pictures[i] );
+          pictureOutput_( index );
+        }
+      }
+    }
+    pictureCount += pictures.getFrameCount();
+  };
+  if ( streamed ) {
+    if ( !decoder->hasPictureOutput() ) {
+      printf( "Warning: codecId %d has no picture output, the %s video is decoded as a whole before being streamed\n",
+              (int)codecId, type.c_str() );
+      fflush( stdout );
+    }
+    video.clear();
+    video.resize( streamedPictureCount_ );
+    decoder->setPictureOutput( [&]( PCCImage<T, 3>& picture ) {
+      PCCVideo<T, 3> pictures;
+      pictures.resize( 1 );
+      pictures[0].swap( picture );
+      outputPictures( pictures );
+    } );
   }
-  return true;
+  // the decoders clear their video: the streamed video is kept out of their reach
+  PCCVideo<T, 3> decodedVideo;
+  {
+    std::unique_lock<std::mutex> lock( libraryDecoderMutex_, std::defer_lock );
+    if ( !decoder->isReentrant() ) { lock.lock(); }
+    decoder->decode( bitstream, streamed ? decodedVideo : video, outputBitDepth, decoderPath, fileName );
+  }
+  if ( !streamed ) {
+    outputPictures( video );
+  } else {
+    // the decoders without picture output have filled the video: its pictures are handed over now, outside of the
+    // decoder lock
+    for ( size_t i = 0; i < decodedVideo.getFrameCount(); i++ ) {
+      PCCVideo<T, 3> pictures;
+      pictures.resize( 1 );
+      pictures[0].swap( decodedVideo[i] );
+      outputPictures( pictures );
+    }
+  }
+  if ( keepIntermediateFiles ) {
+    bitstream.write( binFileName );
+    recFile.close();
+    convertedRecFile.close();
+    if ( streamed ) {
+      std::rename( ( recFileName + ".part" ).c_str(), recFileName.c_str() );
+      if ( !convertedRecFileName.empty() ) {
+        std::rename( ( convertedRecFileName + ".part" ).c_str(), convertedRecFileName.c_str() );
+      }
+    }
+  }
+#ifdef CONFORMANCE_TRACE
+  pictureTrace += stringFormat( "Width =  %d, Height = %d \n", videoWidth, videoHeight );
+  pictureTrace_ += pictureTrace;
+  if ( !deferTrace_ ) { flushTrace(); }
+#endif
+  printf( "Decoded frame = %zu x %zu %zu bits is444 = %d NumFrames = %zu \n", videoWidth, videoHeight, outputBitDepth,
+          videoIs444, pictureCount );
+  fflush( stdout );
+  pictureCount_ = pictureCount;
+  return converted;
 }
 
 template bool pcc::PCCVideoDecoder::decompress<uint8_t>( PCCVideo<uint8_t, 3>& video,
@@ -37,7 +37,9 @@
 #include "PCCEncoderParameters.h"
 #include "PCCCodec.h"
 #include "PCCKdTree.h"
+#include "PCCOccupancyCanvas.h"
 #include <map>
+#include <functional>
 
 namespace pcc {
 
@@ -193,6 +195,7 @@ class PCCEncoder : public PCCCodec {
                                 int         lastFramePlus1 = -1 );
   bool relocateTileGeometryVideo( PCCContext& context );
   bool generateGeometryVideo( const PCCGroupOfFrames& sources, PCCContext& context );
+  void encodeVideosConcurrently( const std::vector<std::function<void()>>& videoEncodes );
   bool generateAttributeVideo( const PCCGroupOfFrames&     sources,
                                PCCGroupOfFrames&           reconstruct,
                                PCCContext&                 context,
@@ -238,7 +241,7 @@ class PCCEncoder : public PCCCodec {
                                size_t            y,
                                uint16_t          mean_val,
                                PCCImageGeometry& image,
-                               PCCKdTree&        kdtree,
+                               const PCCKdTree&  kdtree,
                                PCCFrameContext&  frame );
 
   // Push-pull background filling
@@ -267,6 +270,9 @@ class PCCEncoder : public PCCCodec {
   void regionFill( PCCImage<T, 3>& image, std::vector<uint32_t>& occupancyMap, PCCImage<T, 3>& imageLowRes );
 
   //**placing patches**//
+  // the orientations the packers try for a patch, in their order: the default one only, or the first ones of
+  // g_orientationHorizontal or g_orientationVertical depending on the patch shape
+  static std::vector<size_t> getPackingOrientations( const PCCPatch& patch, bool defaultOnly, size_t numOrientations );
   void packFlexible( PCCFrameContext& tile,
                      int              packingStrategy,
                      size_t           frameWidth,
@@ -289,20 +295,20 @@ class PCCEncoder : public PCCCodec {
 
   size_t packRawPointsPatchSimple( PCCFrameContext& tile, size_t patchStartOffsetX = 0, size_t patchStartOffsetY = 0 );
 
-  size_t packRawPointsPatch( PCCFrameContext&   frame,
-                             std::vector<bool>& occupancyMap,
-                             size_t             width,
-                             size_t&            height,
-                             size_t             occupancySizeU,
-                             size_t             occupancySizeV,
-                             size_t             maxOccupancyRow );
-  void   packEOMAttributePointsPatch( PCCFrameContext&   frame,
-                                      std::vector<bool>& occupancyMap,
-                                      size_t             width,
-                                      size_t&            height,
-                                      size_t             occupancySizeU,
-                                      size_t             occupancySizeV,
-                                      size_t             maxOccupancyRow );
+  size_t packRawPointsPatch( PCCFrameContext&    frame,
+                             PCCOccupancyCanvas& occupancyMap,
+                             size_t              width,
+                             size_t&             height,
+                             size_t              occupancySizeU,
+                             size_t              occupancySizeV,
+                             size_t              maxOccupancyRow );
+  void   packEOMAttributePointsPatch( PCCFrameContext&    frame,
+                                      PCCOccupancyCanvas& occupancyMap,
+                                      size_t              width,
+                                      size_t&             height,
+                                      size_t              occupancySizeU,
+                                      size_t              occupancySizeV,
+                                      size_t              maxOccupancyRow );
   void   adjustReferenceAtlasFrames( PCCContext& context, size_t tileIndex );
   double adjustReferenceAtlasFrame( PCCContext&            context,
                                     PCCFrameContext&       tile,
@@ -392,16 +398,16 @@ class PCCEncoder : public PCCCodec {
                                  int         safeguard,
                                  bool        hasRefFrame );
   static void updatePatchInformation( PCCContext& context, size_t tileIndex, SubContext& subContext );
-  void        packingWithoutRefForFirstFrameNoglobalPatch( PCCPatch&          patch,
-                                                           size_t             i,
-                                                           size_t             icount,
-                                                           size_t&            occupancySizeU,
-                                                           size_t&            occupancySizeV,
-                                                           const size_t       safeguard,
-                                                           std::vector<bool>& occupancyMap,
-                                                           size_t&            heightGPA,
-                                                           size_t&            widthGPA,
-                                                           size_t&            maxOccupancyRow );
+  void        packingWithoutRefForFirstFrameNoglobalPatch( PCCPatch&           patch,
+                                                           size_t              i,
+                                                           size_t              icount,
+                                                           size_t&             occupancySizeU,
+                                                           size_t&             occupancySizeV,
+                                                           const size_t        safeguard,
+                                                           PCCOccupancyCanvas& occupancyMap,
+                                                           size_t&             heightGPA,
+                                                           size_t&             widthGPA,
+                                                           size_t&             maxOccupancyRow );
 
   void packingWithRefForFirstFrameNoglobalPatch( PCCPatch&                    patch,
                                                  const std::vector<PCCPatch>& prePatches,
@@ -411,7 +417,7 @@ class PCCEncoder : public PCCCodec {
                                                  size_t&                      occupancySizeU,
                                                  size_t&                      occupancySizeV,
                                                  const size_t                 safeguard,
-                                                 std::vector<bool>&           occupancyMap,
+                                                 PCCOccupancyCanvas&          occupancyMap,
                                                  size_t&                      heightGPA,
                                                  size_t&                      widthGPA,
                                                  size_t&                      maxOccupancyRow );
@@ -443,12 +449,18 @@ class PCCEncoder : public PCCCodec {
   uint64_t               mortonAddr( const PCCPoint3D& vec, int depth );
   void                   create3DMotionEstimationFiles( PCCContext& context, const std::string& path );
   static void            remove3DMotionEstimationFiles( const std::string& path );
-  void                   presmoothPointCloudColor( PCCPointSet3& reconstruct, const PCCEncoderParameters params );
+  void                   presmoothPointCloudColor( PCCPointSet3&              reconstruct,
+                                                   PCCSharedKdTree&           reconstructKdTree,
+                                                   const PCCEncoderParameters params );
   PCCVector3D            calculateWeightNormal( size_t geometryBitDepth3D, const PCCPointSet3& source );
 
   //**print out**//
-  static void printMap( std::vector<bool> img, const size_t sizeU, const size_t sizeV );
-  static void printMapTetris( std::vector<bool> img, const size_t sizeU, const size_t sizeV, std::vector<int> horizon );
+  template <typename Map>
+  static void printMap( const Map& img, const size_t sizeU, const size_t sizeV );
+  static void printMapTetris( const PCCOccupancyCanvas& img,
+                              const size_t              sizeU,
+                              const size_t              sizeV,
+                              std::vector<int>          horizon );
 
   PCCEncoderParameters params_;
 };
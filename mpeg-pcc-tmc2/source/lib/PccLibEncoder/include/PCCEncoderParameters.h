@@ -74,6 +74,8 @@ class PCCEncoderParameters {
   size_t            nbThread_;
   size_t            frameCount_;
   size_t            groupOfFramesSize_;
+  size_t            concurrentGofCount_;
+  size_t            spatialIndexType_;
   std::string       uncompressedDataPath_;
   uint32_t          forcedSsvhUnitSizePrecisionBytes_;
 
@@ -103,6 +105,7 @@ class PCCEncoderParameters {
   size_t voxelDimensionGridBasedSegmentation_;
   size_t nnNormalEstimation_;
   size_t normalOrientation_;
+  size_t normalEigenSolver_;
   bool   gridBasedRefineSegmentation_;
   size_t maxNNCountRefineSegmentation_;
   size_t iterationCountRefineSegmentation_;
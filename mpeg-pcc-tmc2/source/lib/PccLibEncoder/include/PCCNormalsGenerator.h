@@ -44,6 +44,15 @@ enum PCCNormalsGeneratorOrientation {
   PCC_NORMALS_GENERATOR_ORIENTATION_CUBEMAP_PROJECTION = 3
 };
 
+// eigen decomposition of the neighbourhood covariance matrices. The iterative (Jacobi) solver is the reference and
+// gives the normals of previous versions bit-exactly. The closed-form (trigonometric) solver is faster and agrees
+// with it up to rounding; neighbourhoods whose two smallest eigenvalues are too close for a stable closed-form
+// eigenvector fall back to the iterative solver.
+enum PCCNormalsGeneratorEigenSolver {
+  PCC_NORMALS_GENERATOR_EIGEN_SOLVER_ITERATIVE   = 0,
+  PCC_NORMALS_GENERATOR_EIGEN_SOLVER_CLOSED_FORM = 1
+};
+
 struct PCCNormalsGenerator3Parameters {
   PCCVector3D                    viewPoint_;
   double                         radiusNormalSmoothing_;
@@ -58,6 +67,7 @@ struct PCCNormalsGenerator3Parameters {
   bool                           storeEigenvalues_;
   bool                           storeNumberOfNearestNeighborsInNormalEstimation_;
   bool                           storeCentroids_;
+  PCCNormalsGeneratorEigenSolver eigenSolver_;
 };
 
 class PCCNormalsGenerator3 {
@@ -70,6 +80,14 @@ class PCCNormalsGenerator3 {
       return weight_ < rhs.weight_;
     }
   };
+  // neighbors of the points for one orientation query, nearestNeighborCount_ slots per point: they are searched
+  // in parallel before the serial propagation, or on first use for the points that were not selected
+  struct PCCNormalsBatch;
+  struct PCCNeighborCache {
+    PCCNNQuery3           query_;
+    std::vector<uint32_t> counts_;
+    std::vector<uint32_t> indices_;
+  };
 
  public:
   PCCNormalsGenerator3( void )                        = default;
@@ -101,11 +119,14 @@ class PCCNormalsGenerator3 {
   }
   size_t getNormalCount() const { return normals_.size(); }
 
-  void computeNormal( const size_t                          index,
-                      const PCCPointSet3&                   pointCloud,
-                      const PCCKdTree&                      kdtree,
-                      const PCCNormalsGenerator3Parameters& params,
-                      PCCNNResult&                          nNResult );
+  // computes the normals of the points [start, end), at most PCCNormalsBatch::maxSize_ of them
+  void computeNormalBatch( const size_t                          start,
+                           const size_t                          end,
+                           const PCCPointSet3&                   pointCloud,
+                           const PCCKdTree&                      kdtree,
+                           const PCCNormalsGenerator3Parameters& params,
+                           PCCNNResult&                          nNResult,
+                           PCCNormalsBatch&                      batch );
   void computeNormals( const PCCPointSet3&                   pointCloud,
                        const PCCKdTree&                      kdtree,
                        const PCCNormalsGenerator3Parameters& params );
@@ -115,10 +136,21 @@ class PCCNormalsGenerator3 {
   void addNeighbors( const uint32_t      current,
                      const PCCPointSet3& pointCloud,
                      const PCCKdTree&    kdtree,
-                     PCCNNQuery3&        nNQuery,
+                     PCCNeighborCache&   cache,
                      PCCNNResult&        nNResult,
                      PCCVector3D&        accumulatedNormals,
                      size_t&             numberOfNormals );
+  void initNeighborCache( PCCNeighborCache& cache, const PCCNNQuery3& nNQuery, const size_t pointCount );
+  // searches the neighbors of the points whose visited_ flag is visitedFlag
+  void fillNeighborCache( PCCNeighborCache&   cache,
+                          const PCCPointSet3& pointCloud,
+                          const PCCKdTree&    kdtree,
+                          const uint32_t      visitedFlag );
+  void searchNeighbors( const uint32_t      current,
+                        const PCCPointSet3& pointCloud,
+                        const PCCKdTree&    kdtree,
+                        PCCNeighborCache&   cache,
+                        PCCNNResult&        nNResult );
   void smoothNormals( const PCCPointSet3&                   pointCloud,
                       const PCCKdTree&                      kdtree,
                       const PCCNormalsGenerator3Parameters& params );
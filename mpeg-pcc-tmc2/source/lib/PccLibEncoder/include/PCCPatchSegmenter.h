@@ -39,17 +39,81 @@
 
 namespace pcc {
 
-typedef std::unordered_map<uint64_t, std::vector<size_t>> Voxels;
-
 class PCCNormalsGenerator3;
 class PCCKdTree;
+class PCCSharedKdTree;
 class PCCPatch;
 
+// adjacency lists stored in compressed sparse row form: the neighbors of node i, in search order, are
+// neighbors_[offsets_[i]] up to neighbors_[offsets_[i + 1]], with their squared distances when they are kept
+class PCCAdjacencyGraph {
+ public:
+  class Neighbors {
+   public:
+    Neighbors( const uint32_t* begin, const uint32_t* end ) : begin_( begin ), end_( end ) {}
+    inline const uint32_t* begin() const { return begin_; }
+    inline const uint32_t* end() const { return end_; }
+    inline size_t          size() const { return end_ - begin_; }
+    inline uint32_t        operator[]( const size_t index ) const { return begin_[index]; }
+
+   private:
+    const uint32_t* begin_;
+    const uint32_t* end_;
+  };
+  PCCAdjacencyGraph()  = default;
+  ~PCCAdjacencyGraph() = default;
+
+  inline size_t    size() const { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+  inline Neighbors operator[]( const size_t index ) const {
+    return Neighbors( neighbors_.data() + offsets_[index], neighbors_.data() + offsets_[index + 1] );
+  }
+  inline const float* getDistances( const size_t index ) const { return dist_.data() + offsets_[index]; }
+  inline void         clear() {
+    offsets_.clear();
+    neighbors_.clear();
+    dist_.clear();
+  }
+  // the neighbor lists of the nodes are given in node order
+  void init( const std::vector<uint32_t>& counts, std::vector<uint32_t>& neighbors, std::vector<float>& dist );
+  // every node has the same number of neighbors, filled by the caller through getNeighbors() and getDistances()
+  void init( const size_t nodeCount, const size_t neighborCount, const bool keepDistances );
+  // keeps the first counts[i] neighbors of each node i
+  void                   truncate( const std::vector<uint32_t>& counts );
+  std::vector<uint32_t>& getNeighbors() { return neighbors_; }
+  std::vector<float>&    getDistances() { return dist_; }
+
+ private:
+  std::vector<uint32_t> offsets_;
+  std::vector<uint32_t> neighbors_;
+  std::vector<float>    dist_;
+};
+
+// occupied cells of a voxel grid, numbered in the order of their first point: the points of cell i, in increasing
+// order, are points_[offsets_[i]] up to points_[offsets_[i + 1]]
+class PCCGridCells {
+ public:
+  PCCGridCells()  = default;
+  ~PCCGridCells() = default;
+
+  inline size_t          size() const { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+  inline size_t          getPointCount( const size_t index ) const { return offsets_[index + 1] - offsets_[index]; }
+  inline const uint32_t* begin( const size_t index ) const { return points_.data() + offsets_[index]; }
+  inline const uint32_t* end( const size_t index ) const { return points_.data() + offsets_[index + 1]; }
+  inline uint32_t        getFirstPoint( const size_t index ) const { return points_[offsets_[index]]; }
+  // groups the points by cell, keys[i] being the cell key of point i
+  void init( const std::vector<uint64_t>& keys );
+
+ private:
+  std::vector<uint32_t> offsets_;
+  std::vector<uint32_t> points_;
+};
+
 struct PCCPatchSegmenter3Parameters {
   bool             gridBasedSegmentation_;
   size_t           voxelDimensionGridBasedSegmentation_;
   size_t           nnNormalEstimation_;
   size_t           normalOrientation_;
+  size_t           normalEigenSolver_;
   bool             gridBasedRefineSegmentation_;
   size_t           maxNNCountRefineSegmentation_;
   size_t           iterationCountRefineSegmentation_;
@@ -111,19 +175,17 @@ class PCCPatchSegmenter3 {
                 const PCCPatchSegmenter3Parameters& params,
                 std::vector<PCCPatch>&              patches,
                 std::vector<PCCPointSet3>&          subPointCloud,
-                float&                              distanceSrcRec );
+                float&                              distanceSrcRec,
+                PCCSharedKdTree&                    kdtree );
 
   void convertPointsToVoxels( const PCCPointSet3& source,
                               size_t              geoBits,
                               size_t              voxDim,
                               PCCPointSet3&       sourceVox,
-                              Voxels&             voxels );
+                              PCCGridCells&       voxels );
 
   void applyVoxelsDataToPoints( size_t                pointCount,
-                                size_t                geoBits,
-                                size_t                voxDim,
-                                Voxels&               voxels,  // const
-                                const PCCPointSet3&   source,
+                                const PCCGridCells&   voxels,
                                 PCCNormalsGenerator3& normalsGen,
                                 std::vector<size_t>&  partitions );
 
@@ -138,22 +200,21 @@ class PCCPatchSegmenter3 {
                             const PCCVector3D*          orientations,
                             const size_t                orientationCount,
                             std::vector<size_t>&        partition );
-  void computeAdjacencyInfo( const PCCPointSet3&               pointCloud,
-                             const PCCKdTree&                  kdtree,
-                             std::vector<std::vector<size_t>>& adj,
-                             const size_t                      maxNNCount );
-
-  void computeAdjacencyInfoDist( const PCCPointSet3&               pointCloud,
-                                 const PCCKdTree&                  kdtree,
-                                 std::vector<std::vector<size_t>>& adj,
-                                 std::vector<std::vector<double>>& adjDist,
-                                 const size_t                      maxNNCount );
-
-  void computeAdjacencyInfoInRadius( const PCCPointSet3&                 pointCloud,
-                                     const PCCKdTree&                    kdtree,
-                                     std::vector<std::vector<uint32_t>>& adj,
-                                     const size_t                        maxNNCount,
-                                     const size_t                        radius );
+  void computeAdjacencyInfo( const PCCPointSet3& pointCloud,
+                             const PCCKdTree&    kdtree,
+                             PCCAdjacencyGraph&  adj,
+                             const size_t        maxNNCount );
+
+  void computeAdjacencyInfoDist( const PCCPointSet3& pointCloud,
+                                 const PCCKdTree&    kdtree,
+                                 PCCAdjacencyGraph&  adj,
+                                 const size_t        maxNNCount );
+
+  void computeAdjacencyInfoInRadius( const PCCPointSet3& pointCloud,
+                                     const PCCKdTree&    kdtree,
+                                     PCCAdjacencyGraph&  adj,
+                                     const size_t        maxNNCount,
+                                     const size_t        radius );
 
   bool colorSimilarity( PCCColor3B& colorD1candidate, PCCColor3B& colorD0, uint8_t threshold ) {
     bool bSimilarity = ( std::abs( colorD0[0] - colorD1candidate[0] ) < threshold ) &&
@@ -285,7 +346,7 @@ class PCCPatchSegmenter3 {
                                           const double                      minGradient,
                                           const size_t                      minNumHighGradientPoints,
                                           std::vector<size_t>&              partition,
-                                          std::vector<std::vector<size_t>>& adj,
+                                          const PCCAdjacencyGraph&          adj,
                                           std::vector<std::vector<size_t>>& connectedComponents );
   static void determinePatchOrientation( const size_t         additionalProjectionAxis,
                                          const bool           absoluteD1,
@@ -310,7 +371,7 @@ class PCCPatchSegmenter3 {
                                  const double                      minGradient,
                                  const size_t                      minNumHighGradientPoints,
                                  PCCPatch&                         patch,
-                                 std::vector<std::vector<size_t>>& adj,
+                                 const PCCAdjacencyGraph&          adj,
                                  std::vector<std::vector<size_t>>& highGradientConnectedComponents,
                                  std::vector<bool>&                isRemoved );
 
@@ -423,7 +484,6 @@ class Rect {
   int y_;
 };
 
-typedef std::vector<uint32_t> PointIndicesVector_t;
 typedef std::vector<uint16_t> ScoresVector_t;
 
 typedef enum {
@@ -433,80 +493,38 @@ typedef enum {
   S_DIRECT_EDGE = 0x11   // single-point in a voxel, considered as a direct edge-voxel
 } VoxEdge;
 
-// holds the point indices of every point in a given grid cell
-class PointIndicesOfGridCell {
+// voxel classification state of the cells of the grid-based refinement [m56635], stored in flat arrays
+class PCCGridCellAttributes {
  public:
-  PointIndicesOfGridCell() = default;
-  PointIndicesOfGridCell( const uint32_t uiMaxNumPoints ) :
-      m_pPointIndices( std::make_unique<PointIndicesVector_t>() ) {
-    m_pPointIndices->reserve( uiMaxNumPoints );
-  }
+  PCCGridCellAttributes()  = default;
+  ~PCCGridCellAttributes() = default;
 
-  inline PointIndicesVector_t* getPointIndices() { return m_pPointIndices.get(); }
-  inline void                  addPointIndex( uint32_t uiPointIdx ) { m_pPointIndices->push_back( uiPointIdx ); }
-  inline uint8_t               getPointCount() { return (uint8_t)m_pPointIndices->size(); }
+  void init( const size_t cellCount, const size_t orientationCount );
 
- protected:
-  std::unique_ptr<PointIndicesVector_t> m_pPointIndices;
-};
-
-// holds the scoreSmooths of the points in a cell
-class AttributeOfGridCell {
- public:
-  AttributeOfGridCell() = default;
-
-  AttributeOfGridCell( const size_t orientationCount ) {
-    m_pScoreSmooth  = std::make_unique<ScoresVector_t>( orientationCount, 0 );
-    m_uiUpdateFlag  = true;
-    m_uiTotalPoints = 0;
+  inline const uint16_t* getScoreSmooth( const size_t index ) const {
+    return scoreSmooth_.data() + index * orientationCount_;
   }
-
-  inline ScoresVector_t* getScoreSmooth() { return m_pScoreSmooth.get(); }
-
-  inline void updateScores( const PointIndicesVector_t& point_indices,
-                            const std::vector<size_t>&  partitions ) noexcept {
-    // clears the scores
-    std::fill( m_pScoreSmooth->begin(), m_pScoreSmooth->end(), 0 );
-    auto& scores = *m_pScoreSmooth;
-    for ( const auto& j : point_indices ) { ++scores[partitions[j]]; }
-
-    // update voxel type (1st voxel classification)
-    updateVoxelTypeWithScores();
+  inline uint8_t getEdge( const size_t index ) const { return edge_[index]; }
+  inline uint8_t getPPI( const size_t index ) const { return ppi_[index]; }
+  inline void    updateEdge( const size_t index, const uint8_t edge ) { edge_[index] = edge; }
+  inline void    setUpdatedFlag( const size_t index ) { updateFlag_[index] = 1; }
+  inline void    setNumOfTotalPoints( const size_t index, const uint8_t pointCount ) {
+    totalPoints_[index] = pointCount;
+    edge_[index]        = ( pointCount == 1 ) ? S_DIRECT_EDGE : M_DIRECT_EDGE;
   }
+  // counts the partitions of the given points and updates the voxel type (1st voxel classification)
+  void updateScores( const size_t               index,
+                     const uint32_t*            begin,
+                     const uint32_t*            end,
+                     const std::vector<size_t>& partitions );
 
-  inline uint8_t getEdge() { return m_uiVoxEdge; }
-  inline uint8_t getPPI() { return m_uiVoxPpi; }
-
-  inline void updateEdge( uint8_t uiVoxEdge ) { m_uiVoxEdge = uiVoxEdge; }
-  inline void setUpdatedFlag() { m_uiUpdateFlag = true; }
-
-  inline void updateVoxelTypeWithScores() {
-    if ( !m_uiUpdateFlag ) { return; }
-
-    // update edge-type
-    if ( m_uiVoxEdge != S_DIRECT_EDGE ) {
-      size_t uniformityIdx = m_pScoreSmooth->size() - std::count( m_pScoreSmooth->begin(), m_pScoreSmooth->end(), 0 );
-      m_uiVoxEdge          = ( uniformityIdx == 1 ) ? NO_EDGE : M_DIRECT_EDGE;
-    }
-
-    // update _ppi
-    const auto& maxScore = std::max_element( m_pScoreSmooth->begin(), m_pScoreSmooth->end() );
-    m_uiVoxPpi           = (uint8_t)std::distance( m_pScoreSmooth->begin(), maxScore );
-
-    m_uiUpdateFlag = false;
-  }
-
-  inline void setNumOfTotalPoints( uint8_t uiPointCount ) {
-    m_uiTotalPoints = uiPointCount;
-    m_uiVoxEdge     = ( m_uiTotalPoints == 1 ) ? S_DIRECT_EDGE : M_DIRECT_EDGE;
-  }
-
- protected:
-  std::unique_ptr<ScoresVector_t> m_pScoreSmooth;
-  uint8_t                         m_uiVoxEdge;      //
-  uint8_t                         m_uiUpdateFlag;   // TRUE, FALSE
-  uint8_t                         m_uiTotalPoints;  // voxDim * voxDim * voxDim
-  uint8_t                         m_uiVoxPpi;       // 0 - (orientationCount-1) [6, 10 ..etc]
+ private:
+  size_t                orientationCount_ = 0;
+  std::vector<uint16_t> scoreSmooth_;
+  std::vector<uint8_t>  edge_;
+  std::vector<uint8_t>  updateFlag_;
+  std::vector<uint8_t>  totalPoints_;  // voxDim * voxDim * voxDim
+  std::vector<uint8_t>  ppi_;          // 0 - (orientationCount-1) [6, 10 ..etc]
 };
 
 float computeIOU( Rect a, Rect b );
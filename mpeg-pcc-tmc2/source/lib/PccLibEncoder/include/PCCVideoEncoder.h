@@ -34,6 +34,7 @@
 #define PCCVideoEncoder_h
 
 #include "PCCCommon.h"
+#include <mutex>
 
 namespace pcc {
 
@@ -85,7 +86,8 @@ class PCCVideoEncoder {
   void setLogger( PCCLogger& logger ) { logger_ = &logger; }
 
  private:
-  PCCLogger* logger_ = nullptr;
+  PCCLogger*        logger_ = nullptr;
+  static std::mutex libraryEncoderMutex_;
 };
 
 };  // namespace pcc
@@ -45,6 +45,7 @@
 #include "PCCChrono.h"
 #include "PCCEncoder.h"
 #include "PCCEncoderConstant.h"
+#include <sstream>
 #if defined( ENABLE_TBB )
 #include <tbb/tbb.h>
 #endif
@@ -52,6 +53,10 @@
 using namespace std;
 using namespace pcc;
 
+// stream of the packing logs: std::cout, or the log of the tile packed by the thread while placeSegments packs the
+// tiles concurrently
+static thread_local std::ostream* g_packingLog = &std::cout;
+
 std::string getEncoderConfig1L( const std::string& string ) {
   std::string sub    = string.substr( 0, string.find_last_of( '.' ) );
   std::string result = sub + "-1L.cfg";
@@ -72,6 +77,7 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
   size_t pointLocalReconstructionOriginal   = static_cast<size_t>( params_.pointLocalReconstruction_ );
   size_t layerCountMinus1Original           = params_.mapCountMinus1_;
   size_t singleMapPixelInterleavingOriginal = static_cast<size_t>( params_.singleMapPixelInterleaving_ );
+  size_t numMaxTilePerFrameOriginal         = params_.numMaxTilePerFrame_;
 #if defined( ENABLE_TBB )
   if ( params_.nbThread_ > 0 ) { tbb::task_scheduler_init init( static_cast<int>( params_.nbThread_ ) ); }
 #endif
@@ -80,6 +86,7 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
   assert( sources.getFrameCount() < 256 );
   if ( ( params_.rawPointsPatch_ || params_.lossyRawPointsPatch_ ) && params_.tileSegmentationType_ > 0 &&
        params_.numMaxTilePerFrame_ > 1 ) {
+    // the raw patches get their own tile in every group of frames: the count is restored on exit
     params_.numMaxTilePerFrame_ += 1;
   }
   reconstructs.setFrameCount( sources.getFrameCount() );
@@ -132,49 +139,16 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
   // GENERATE OCCUPANCY MAP
   generateOccupancyMap( context, true );
 
-  // ENCODE OCCUPANCY MAP
-  TRACE_PICTURE( "Occupancy\n" );
-  TRACE_PICTURE( "MapIdx = 0, AuxiliaryVideoFlag = 0\n" );
-  auto& videoBitstream = context.createVideoBitstream( VIDEO_OCCUPANCY );
-  generateOccupancyMapVideo( sources, context );
-  auto& videoOccupancyMap = context.getVideoOccupancyMap();
-  videoEncoder.compress( videoOccupancyMap,                         // video
-                         path.str(),                                // path
-                         params_.occupancyMapQP_,                   // QP
-                         videoBitstream,                            // bitstream
-                         params_.occupancyMapConfig_,               // config file
-                         params_.videoEncoderOccupancyPath_,        // encoder path
-                         params_.videoEncoderOccupancyCodecId_,     // Codec id
-                         params_.byteStreamVideoCoderOccupancy_,    // byteStreamVideoCoder
-                         context,                                   // context
-                         ( params_.EOMFixBitCount_ <= 8 ) ? 1 : 2,  // nByte
-                         false,                                     // use444CodecIo
-                         false,                                     // use3dmv
-                         false,                                     // usePccRDO
-                         0,                                         // SHVC Layer Index
-                         0,                                         // SHVC ratio X
-                         0,                                         // SHVC ratio Y
-                         8,                                         // internalBitDepth
-                         false,                                     // useConversion
-                         params_.keepIntermediateFiles_ );          // keepIntermediateFiles
-  if ( params_.offsetLossyOM_ > 0 ) { modifyOccupancyMap( sources, context ); }
-  if ( !params_.useRawPointsSeparateVideo_ && ( params_.rawPointsPatch_ || params_.lossyRawPointsPatch_ ) ) {
-    markRawPatchLocationOccupancyMapVideo( context );
-  }
-  if ( params_.tileSegmentationType_ > 0 ) {
-    generateAtlasBlockToPatchFromOccupancyMapVideo( context, params_.occupancyResolution_,
-                                                    params_.occupancyPrecision_ );
-  } else {
-    generateBlockToPatchFromOccupancyMapVideo( context, params_.occupancyResolution_, params_.occupancyPrecision_ );
-  }
-
-  // Generate GEOMETRY IMAGE & dilation
-  generateGeometryVideo( sources, context );
-
-  // ENCODE GEOMETRY IMAGE
-  TRACE_PICTURE( "Geometry\n" );
-  TRACE_PICTURE( "MapIdx = 0, AuxiliaryVideoFlag = 0\n" );
-  if ( params_.use3dmc_ || params_.usePccRDO_ ) { create3DMotionEstimationFiles( context, path.str() ); }
+  // ENCODE OCCUPANCY MAP, GEOMETRY AND RAW POINTS GEOMETRY
+  // The raw points geometry video does not depend on the occupancy and geometry videos: it is placed and generated
+  // first, then compressed concurrently with them. The bitstreams are created first as the bitstream list must not
+  // grow while they are filled.
+  auto&      asps        = context.getAtlasSequenceParameterSet( atlasIndex );
+  const bool useAuxVideo = asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag();
+  context.createVideoBitstream( VIDEO_OCCUPANCY );
+  context.createVideoBitstream( params_.multipleStreams_ ? VIDEO_GEOMETRY_D0 : VIDEO_GEOMETRY );
+  if ( params_.multipleStreams_ ) { context.createVideoBitstream( VIDEO_GEOMETRY_D1 ); }
+  if ( useAuxVideo ) { context.createVideoBitstream( VIDEO_GEOMETRY_RAW ); }
   auto&  gi                      = context.getVps().getGeometryInformation( atlasIndex );
   size_t geometryVideoBitDepth   = gi.getGeometry2dBitdepthMinus1() + 1;
   size_t geometryMPVideoBitDepth = gi.getGeometry2dBitdepthMinus1() + 1;
@@ -182,42 +156,44 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
   size_t nbyteGeoMP              = ( geometryMPVideoBitDepth <= 8 ) ? 1 : 2;
   size_t internalBitDepth        = params_.videoEncoderInternalBitdepth_;
   if ( params_.rawPointsPatch_ ) { internalBitDepth = geometryVideoBitDepth; }
-  auto&       videoBitstreamD0 = params_.multipleStreams_ ? context.createVideoBitstream( VIDEO_GEOMETRY_D0 )
-                                                          : context.createVideoBitstream( VIDEO_GEOMETRY );
-  auto&       videoGeometry    = context.getVideoGeometryMultiple()[0];
-  std::string geometryConfigFile =
-      params_.multipleStreams_
-          ? params_.geometry0Config_
-          : ( params_.mapCountMinus1_ == 0 ? getEncoderConfig1L( params_.geometryConfig_ ) : params_.geometryConfig_ );
-  videoEncoder.compress( videoGeometry,                             // video
-                         path.str(),                                // path
-                         params_.geometryQP_ + params_.deltaQPD0_,  // QP
-                         videoBitstreamD0,                          // bitstream
-                         geometryConfigFile,                        // config file
-                         params_.videoEncoderGeometryPath_,         // encoder path
-                         params_.videoEncoderGeometryCodecId_,      // Codec id
-                         params_.byteStreamVideoCoderGeometry_,     // byteStreamVideoCoder
-                         context,                                   // context
-                         nbyteGeo,                                  // nbyte
-                         false,                                     // use444CodecIo
-                         params_.use3dmc_,                          // use3dmv
-                         params_.usePccRDO_,                        // usePccRDO
-                         params_.shvcLayerIndex_,                   // SHVC layer index
-                         params_.shvcRateX_,                        // SHVC rate X
-                         params_.shvcRateY_,                        // SHVC rate Y
-                         internalBitDepth,                          // internalBitDepth
-                         false,                                     // useConversion
-                         params_.keepIntermediateFiles_ );          // keep intermediate
-  size_t sizeGeometryVideo = videoBitstreamD0.size();
-  std::cout << "sizeGeometryVideo: " << sizeGeometryVideo << std::endl;
-  if ( params_.multipleStreams_ ) {
-    if ( params_.lossyRawPointsPatch_ ) {
-      std::cout << "Error: lossyRawPointsPatch has not been implemented for "
-                   "absoluteD1_ = 0 as "
-                   "yet. Exiting... "
-                << std::endl;
-      std::exit( -1 );
-    }
+  auto& videoOccupancyMap = context.getVideoOccupancyMap();
+  auto& videoGeometry     = context.getVideoGeometryMultiple()[0];
+  if ( params_.multipleStreams_ && params_.lossyRawPointsPatch_ ) {
+    std::cout << "Error: lossyRawPointsPatch has not been implemented for "
+                 "absoluteD1_ = 0 as "
+                 "yet. Exiting... "
+              << std::endl;
+    std::exit( -1 );
+  }
+  auto encodeGeometryD0 = [&] {
+    TRACE_PICTURE( "Geometry\n" );
+    TRACE_PICTURE( "MapIdx = 0, AuxiliaryVideoFlag = 0\n" );
+    auto& videoBitstreamD0 = context.getVideoBitstream( params_.multipleStreams_ ? VIDEO_GEOMETRY_D0 : VIDEO_GEOMETRY );
+    std::string geometryConfigFile =
+        params_.multipleStreams_ ? params_.geometry0Config_
+                                 : ( params_.mapCountMinus1_ == 0 ? getEncoderConfig1L( params_.geometryConfig_ )
+                                                                  : params_.geometryConfig_ );
+    videoEncoder.compress( videoGeometry,                             // video
+                           path.str(),                                // path
+                           params_.geometryQP_ + params_.deltaQPD0_,  // QP
+                           videoBitstreamD0,                          // bitstream
+                           geometryConfigFile,                        // config file
+                           params_.videoEncoderGeometryPath_,         // encoder path
+                           params_.videoEncoderGeometryCodecId_,      // Codec id
+                           params_.byteStreamVideoCoderGeometry_,     // byteStreamVideoCoder
+                           context,                                   // context
+                           nbyteGeo,                                  // nbyte
+                           false,                                     // use444CodecIo
+                           params_.use3dmc_,                          // use3dmv
+                           params_.usePccRDO_,                        // usePccRDO
+                           params_.shvcLayerIndex_,                   // SHVC layer index
+                           params_.shvcRateX_,                        // SHVC rate X
+                           params_.shvcRateY_,                        // SHVC rate Y
+                           internalBitDepth,                          // internalBitDepth
+                           false,                                     // useConversion
+                           params_.keepIntermediateFiles_ );          // keep intermediate
+  };
+  auto encodeGeometryD1 = [&] {
     if ( !params_.absoluteD1_ ) {
       // Form differential video geometry1
       for ( size_t f = 0; f < frames.size(); ++f ) {
@@ -232,7 +208,7 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
     TRACE_PICTURE( "Geometry\n" );
     TRACE_PICTURE( "MapIdx = 1, AuxiliaryVideoFlag = 0\n" );
     auto& videoGeometryD1  = context.getVideoGeometryMultiple()[1];
-    auto& videoBitstreamD1 = context.createVideoBitstream( VIDEO_GEOMETRY_D1 );
+    auto& videoBitstreamD1 = context.getVideoBitstream( VIDEO_GEOMETRY_D1 );
     videoEncoder.compress( videoGeometryD1,                           // video
                            path.str(),                                // path
                            params_.geometryQP_ + params_.deltaQPD1_,  // QP
@@ -252,41 +228,99 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
                            internalBitDepth,                          // internalBitDepth
                            false,                                     // useConversion
                            params_.keepIntermediateFiles_ );          // keep intermediate
-    size_t sizeGeometryVideoD1 = videoBitstreamD1.size();
+  };
+  std::vector<std::function<void()>> videoEncodes;
+  videoEncodes.push_back( [&] {
+    TRACE_PICTURE( "Occupancy\n" );
+    TRACE_PICTURE( "MapIdx = 0, AuxiliaryVideoFlag = 0\n" );
+    auto& videoBitstream = context.getVideoBitstream( VIDEO_OCCUPANCY );
+    generateOccupancyMapVideo( sources, context );
+    videoEncoder.compress( videoOccupancyMap,                         // video
+                           path.str(),                                // path
+                           params_.occupancyMapQP_,                   // QP
+                           videoBitstream,                            // bitstream
+                           params_.occupancyMapConfig_,               // config file
+                           params_.videoEncoderOccupancyPath_,        // encoder path
+                           params_.videoEncoderOccupancyCodecId_,     // Codec id
+                           params_.byteStreamVideoCoderOccupancy_,    // byteStreamVideoCoder
+                           context,                                   // context
+                           ( params_.EOMFixBitCount_ <= 8 ) ? 1 : 2,  // nByte
+                           false,                                     // use444CodecIo
+                           false,                                     // use3dmv
+                           false,                                     // usePccRDO
+                           0,                                         // SHVC Layer Index
+                           0,                                         // SHVC ratio X
+                           0,                                         // SHVC ratio Y
+                           8,                                         // internalBitDepth
+                           false,                                     // useConversion
+                           params_.keepIntermediateFiles_ );          // keepIntermediateFiles
+    if ( params_.offsetLossyOM_ > 0 ) { modifyOccupancyMap( sources, context ); }
+    if ( !params_.useRawPointsSeparateVideo_ && ( params_.rawPointsPatch_ || params_.lossyRawPointsPatch_ ) ) {
+      markRawPatchLocationOccupancyMapVideo( context );
+    }
+    if ( params_.tileSegmentationType_ > 0 ) {
+      generateAtlasBlockToPatchFromOccupancyMapVideo( context, params_.occupancyResolution_,
+                                                      params_.occupancyPrecision_ );
+    } else {
+      generateBlockToPatchFromOccupancyMapVideo( context, params_.occupancyResolution_, params_.occupancyPrecision_ );
+    }
+
+    // Generate GEOMETRY IMAGE & dilation
+    generateGeometryVideo( sources, context );
+
+    // ENCODE GEOMETRY IMAGE: the absolute geometry maps do not depend on each other
+    if ( params_.use3dmc_ || params_.usePccRDO_ ) { create3DMotionEstimationFiles( context, path.str() ); }
+    if ( params_.multipleStreams_ && params_.absoluteD1_ ) {
+      encodeVideosConcurrently( {encodeGeometryD0, encodeGeometryD1} );
+    } else {
+      encodeGeometryD0();
+      if ( params_.multipleStreams_ ) { encodeGeometryD1(); }
+    }
+  } );
+  if ( useAuxVideo ) {
+    // the auxiliary tiles and the raw points video are only read by the compression below, and the occupancy and
+    // geometry videos never read the auxiliary video positions of the raw and EOM patches: the placement stays
+    // serial, only the compressions overlap
+    std::cout << "*******Video: Aux (Geometry) ********" << std::endl;
+    placeAuxiliaryPointsTiles( context );
+    generateRawPointsGeometryVideo( context );
+    videoEncodes.push_back( [&] {
+      TRACE_PICTURE( "MapIdx = 0, AuxiliaryVideoFlag = 1\n" );
+      auto& videoRawPointsGeometryBitstream = context.getVideoBitstream( VIDEO_GEOMETRY_RAW );
+      auto& videoRawPointsGeometry          = context.getVideoRawPointsGeometry();
+      videoEncoder.compress( videoRawPointsGeometry,                 // video,
+                             path.str(),                             // path,
+                             params_.auxGeometryQP_,                 // qp,
+                             videoRawPointsGeometryBitstream,        // bitstream,
+                             params_.geometryAuxVideoConfig_,        // encoderConfig,
+                             params_.videoEncoderGeometryPath_,      // encoderPath,
+                             params_.videoEncoderGeometryCodecId_,   // codecId,
+                             params_.byteStreamVideoCoderGeometry_,  // byteStreamVideoCoder,
+                             context,                                // context
+                             nbyteGeoMP,                             // nbyte
+                             false,                                  // use444CodecIo
+                             false,                                  // use3dmv
+                             false,                                  // usePccRDO
+                             params_.shvcLayerIndex_,                // SHVC layer index
+                             params_.shvcRateX_,                     // SHVC rate X
+                             params_.shvcRateY_,                     // SHVC rate Y
+                             internalBitDepth,                       // internalBitDepth
+                             false,                                  // useConversion
+                             params_.keepIntermediateFiles_ );       // keepIntermediateFiles
+    } );
+  }
+  encodeVideosConcurrently( videoEncodes );
+  size_t sizeGeometryVideo =
+      context.getVideoBitstream( params_.multipleStreams_ ? VIDEO_GEOMETRY_D0 : VIDEO_GEOMETRY ).size();
+  std::cout << "sizeGeometryVideo: " << sizeGeometryVideo << std::endl;
+  if ( params_.multipleStreams_ ) {
+    size_t sizeGeometryVideoD1 = context.getVideoBitstream( VIDEO_GEOMETRY_D1 ).size();
     std::cout << "sizeGeometryVideoD1: " << sizeGeometryVideoD1 << std::endl;
     std::cout << "geometryVideo ->" << ( sizeGeometryVideo + sizeGeometryVideoD1 ) << "=" << sizeGeometryVideo << "+"
               << sizeGeometryVideoD1 << " B ("
               << ( ( sizeGeometryVideo + sizeGeometryVideoD1 ) * 8.0 ) / ( 2 * frames.size() * pointCount ) << " bpp)"
               << std::endl;
   }
-  auto& asps = context.getAtlasSequenceParameterSet( atlasIndex );
-  if ( asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag() ) {
-    TRACE_PICTURE( "MapIdx = 0, AuxiliaryVideoFlag = 1\n" );
-    std::cout << "*******Video: Aux (Geometry) ********" << std::endl;
-    placeAuxiliaryPointsTiles( context );
-    auto& videoRawPointsGeometryBitstream = context.createVideoBitstream( VIDEO_GEOMETRY_RAW );
-    generateRawPointsGeometryVideo( context );
-    auto& videoRawPointsGeometry = context.getVideoRawPointsGeometry();
-    videoEncoder.compress( videoRawPointsGeometry,                 // video,
-                           path.str(),                             // path,
-                           params_.auxGeometryQP_,                 // qp,
-                           videoRawPointsGeometryBitstream,        // bitstream,
-                           params_.geometryAuxVideoConfig_,        // encoderConfig,
-                           params_.videoEncoderGeometryPath_,      // encoderPath,
-                           params_.videoEncoderGeometryCodecId_,   // codecId,
-                           params_.byteStreamVideoCoderGeometry_,  // byteStreamVideoCoder,
-                           context,                                // context
-                           nbyteGeoMP,                             // nbyte
-                           false,                                  // use444CodecIo
-                           false,                                  // use3dmv
-                           false,                                  // usePccRDO
-                           params_.shvcLayerIndex_,                // SHVC layer index
-                           params_.shvcRateX_,                     // SHVC rate X
-                           params_.shvcRateY_,                     // SHVC rate Y
-                           internalBitDepth,                       // internalBitDepth
-                           false,                                  // useConversion
-                           params_.keepIntermediateFiles_ );       // keepIntermediateFiles
-  }
   // Tile summary
   printf( "****TileInfo***Summary******************\n" );
   fflush( stdout );
@@ -316,24 +350,60 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
   context.allocOneLayerData();
   std::vector<std::vector<uint32_t>> partitions;
   partitions.resize( context.size() );
+  // the frames and the tiles of each frame are reconstructed concurrently: each tile only updates its own patches
+  // and buffers, the tile outputs are appended in order once the tiles of the frame are done.
+#if defined( ENABLE_TBB ) && defined( CODEC_TRACE )
+  // codec traces are written by the reconstruction processes: keep them in order
+  tbb::task_arena reconstructArena( 1 );
+#elif defined( ENABLE_TBB )
+  tbb::task_arena reconstructArena( static_cast<int>( params_.nbThread_ ) );
+#endif
+#if defined( ENABLE_TBB )
+  reconstructArena.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), context.size(), [&]( const size_t frameIdx ) {
+#else
   for ( size_t frameIdx = 0; frameIdx < context.size(); frameIdx++ ) {
-    auto& frame = context[frameIdx];
-    for ( size_t tileIdx = 0; tileIdx < frame.getNumTilesInAtlasFrame(); tileIdx++ ) {
-      PCCPointSet3 tileReconstrct;
-      auto&        tile = frame.getTile( tileIdx );
-      if ( params_.pointLocalReconstruction_ ) {
-        auto& videoGeometryMultiple = context.getVideoGeometryMultiple();
-        pointLocalReconstructionSearch( context, tile, videoGeometryMultiple, gpcParams );
-      }
-      generatePointCloud( tileReconstrct, context, frameIdx, tileIdx, gpcParams, partitions[frameIdx], false );
-      reconstructs[frameIdx].appendPointSet( tileReconstrct );
-      if ( frame.getNumTilesInAtlasFrame() != 1 ) {
-        frame.getTitleFrameContext().appendPointToPixel( tile.getPointToPixel() );
-      }
+#endif
+      auto&                              frame     = context[frameIdx];
+      const size_t                       tileCount = frame.getNumTilesInAtlasFrame();
+      std::vector<PCCPointSet3>          tileReconstructs( tileCount );
+      std::vector<std::vector<uint32_t>> tilePartitions( tileCount );
+#if defined( ENABLE_TBB )
+      tbb::parallel_for( size_t( 0 ), tileCount, [&]( const size_t tileIdx ) {
+#else
+    for ( size_t tileIdx = 0; tileIdx < tileCount; tileIdx++ ) {
+#endif
+        auto& tile = frame.getTile( tileIdx );
+        if ( params_.pointLocalReconstruction_ ) {
+          auto& videoGeometryMultiple = context.getVideoGeometryMultiple();
+          pointLocalReconstructionSearch( context, tile, videoGeometryMultiple, gpcParams );
+        }
+        generatePointCloud( tileReconstructs[tileIdx], context, frameIdx, tileIdx, gpcParams, tilePartitions[tileIdx],
+                            false );
+#if defined( ENABLE_TBB )
+      } );
+#else
     }
+#endif
+      auto& partition = partitions[frameIdx];
+      for ( size_t tileIdx = 0; tileIdx < tileCount; tileIdx++ ) {
+        auto& tile = frame.getTile( tileIdx );
+        reconstructs[frameIdx].appendPointSet( tileReconstructs[tileIdx] );
+        partition.insert( partition.end(), tilePartitions[tileIdx].begin(), tilePartitions[tileIdx].end() );
+        if ( tileCount != 1 ) { frame.getTitleFrameContext().appendPointToPixel( tile.getPointToPixel() ); }
+      }
+#if defined( ENABLE_TBB )
+    } );
+  } );
+#else
   }
+#endif
 
   auto& ai = sps.getAttributeInformation( atlasIndex );
+  // without attributes, the geometry padding was the last search of the source trees
+  if ( ai.getAttributeCount() == 0 ) {
+    for ( auto& frame : frames ) { frame.getSourceKdTree().clear(); }
+  }
   if ( ai.getAttributeCount() > 0 ) {
     std::cout << "Attribute Coding starts" << std::endl;
     const size_t mapCount = params_.mapCountMinus1_ + 1;
@@ -423,48 +493,50 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
 #endif
     }
     // ENCODE ATTRIBUTE IMAGE
-    TRACE_PICTURE( "Attribute\n" );
-    std::cout << "attribute video " << std::endl;
-    auto&        videoBitstream = params_.multipleStreams_ ? context.createVideoBitstream( VIDEO_ATTRIBUTE_T0 )
-                                                           : context.createVideoBitstream( VIDEO_ATTRIBUTE );
-    const size_t nbyteAtt       = 1;
-    int attrPartitionIndex      = sps.getAttributeInformation( atlasIndex ).getAttributeDimensionPartitionsMinus1( 0 );
-    int attrTypeId              = sps.getAttributeInformation( atlasIndex ).getAttributeTypeId( 0 );
-    TRACE_PICTURE( "MapIdx = 0, AuxiliaryVideoFlag = 0, AttrIdx = 0, AttrPartIdx = %d, AttrTypeID = %d\n",
-                   attrPartitionIndex, attrTypeId );
-    auto encoderConfig0 = params_.multipleStreams_
-                              ? ( params_.mapCountMinus1_ == 0 ? getEncoderConfig1L( params_.attributeConfig_ )
-                                                               : params_.attribute0Config_ )
-                              : ( params_.mapCountMinus1_ == 0 ? getEncoderConfig1L( params_.attributeConfig_ )
-                                                               : params_.attributeConfig_ );
-    videoEncoder.compress( context.getVideoAttributesMultiple()[0],         // video,
-                           path.str(),                                      // path
-                           params_.attributeQP_ + params_.deltaQPT0_,       // qp
-                           videoBitstream,                                  // bitstream
-                           encoderConfig0,                                  // encoderConfig
-                           params_.videoEncoderAttributePath_,              // encoderPath
-                           params_.videoEncoderAttributeCodecId_,           // codecId
-                           params_.byteStreamVideoCoderAttribute_,          // byteStreamVideoCoder
-                           context,                                         // context
-                           nbyteAtt,                                        // nbyte
-                           params_.attributeVideo444_,                      // use444CodecIo
-                           params_.use3dmc_,                                // use3dmv
-                           params_.usePccRDO_,                              // usePccRDO
-                           params_.shvcLayerIndex_,                         // SHVC layer index
-                           params_.shvcRateX_,                              // SHVC rate X
-                           params_.shvcRateY_,                              // SHVC rate Y
-                           params_.rawPointsPatch_ ? 8 : internalBitDepth,  // internalBitDepth
-                           !params_.rawPointsPatch_,                        // useConversion
-                           params_.keepIntermediateFiles_,                  // keepIntermediateFiles
-                           params_.colorSpaceConversionConfig_,             // colorSpaceConversionConfig
-                           params_.inverseColorSpaceConversionConfig_,      // inverseColorSpaceConversionConfig
-                           params_.colorSpaceConversionPath_ );             // colorSpaceConversionPath
-
-    auto sizeAttributeVideo = videoBitstream.size();
-    std::cout << "attribute video ->" << sizeAttributeVideo << " B ("
-              << ( sizeAttributeVideo * 8.0 ) / ( 2 * frames.size() * pointCount ) << " bpp)" << std::endl;
-
-    if ( params_.multipleStreams_ ) {
+    // The absolute attribute maps and the raw points attribute video do not depend on each other: they are encoded
+    // concurrently, the second map is chained to the first one when it is predicted from it.
+    context.createVideoBitstream( params_.multipleStreams_ ? VIDEO_ATTRIBUTE_T0 : VIDEO_ATTRIBUTE );
+    if ( params_.multipleStreams_ ) { context.createVideoBitstream( VIDEO_ATTRIBUTE_T1 ); }
+    if ( useAuxVideo ) { context.createVideoBitstream( VIDEO_ATTRIBUTE_RAW ); }
+    const size_t nbyteAtt = 1;
+    int attrPartitionIndex = sps.getAttributeInformation( atlasIndex ).getAttributeDimensionPartitionsMinus1( 0 );
+    int attrTypeId         = sps.getAttributeInformation( atlasIndex ).getAttributeTypeId( 0 );
+    auto encodeAttributeT0 = [&] {
+      TRACE_PICTURE( "Attribute\n" );
+      std::cout << "attribute video " << std::endl;
+      auto& videoBitstream =
+          context.getVideoBitstream( params_.multipleStreams_ ? VIDEO_ATTRIBUTE_T0 : VIDEO_ATTRIBUTE );
+      TRACE_PICTURE( "MapIdx = 0, AuxiliaryVideoFlag = 0, AttrIdx = 0, AttrPartIdx = %d, AttrTypeID = %d\n",
+                     attrPartitionIndex, attrTypeId );
+      auto encoderConfig0 = params_.multipleStreams_
+                                ? ( params_.mapCountMinus1_ == 0 ? getEncoderConfig1L( params_.attributeConfig_ )
+                                                                 : params_.attribute0Config_ )
+                                : ( params_.mapCountMinus1_ == 0 ? getEncoderConfig1L( params_.attributeConfig_ )
+                                                                 : params_.attributeConfig_ );
+      videoEncoder.compress( context.getVideoAttributesMultiple()[0],         // video,
+                             path.str(),                                      // path
+                             params_.attributeQP_ + params_.deltaQPT0_,       // qp
+                             videoBitstream,                                  // bitstream
+                             encoderConfig0,                                  // encoderConfig
+                             params_.videoEncoderAttributePath_,              // encoderPath
+                             params_.videoEncoderAttributeCodecId_,           // codecId
+                             params_.byteStreamVideoCoderAttribute_,          // byteStreamVideoCoder
+                             context,                                         // context
+                             nbyteAtt,                                        // nbyte
+                             params_.attributeVideo444_,                      // use444CodecIo
+                             params_.use3dmc_,                                // use3dmv
+                             params_.usePccRDO_,                              // usePccRDO
+                             params_.shvcLayerIndex_,                         // SHVC layer index
+                             params_.shvcRateX_,                              // SHVC rate X
+                             params_.shvcRateY_,                              // SHVC rate Y
+                             params_.rawPointsPatch_ ? 8 : internalBitDepth,  // internalBitDepth
+                             !params_.rawPointsPatch_,                        // useConversion
+                             params_.keepIntermediateFiles_,                  // keepIntermediateFiles
+                             params_.colorSpaceConversionConfig_,             // colorSpaceConversionConfig
+                             params_.inverseColorSpaceConversionConfig_,      // inverseColorSpaceConversionConfig
+                             params_.colorSpaceConversionPath_ );             // colorSpaceConversionPath
+    };
+    auto encodeAttributeT1 = [&] {
       // Form differential video attribute1
       if ( !params_.absoluteT1_ ) {
         for ( size_t f = 0; f < frames.size(); ++f ) {
@@ -485,7 +557,7 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
       TRACE_PICTURE( "Attribute\n" );
       TRACE_PICTURE( "AttrIdx = 0, AttrPartIdx = %d, AttrTypeID = %d, MapIdx = 1, AuxiliaryVideoFlag = 0\n",
                      attrPartitionIndex, attrTypeId );
-      auto& videoBitstreamT1 = context.createVideoBitstream( VIDEO_ATTRIBUTE_T1 );
+      auto& videoBitstreamT1 = context.getVideoBitstream( VIDEO_ATTRIBUTE_T1 );
       auto  encoderConfig1 =
           params_.mapCountMinus1_ == 0 ? getEncoderConfig1L( params_.attributeConfig_ ) : params_.attribute1Config_;
       videoEncoder.compress( context.getVideoAttributesMultiple()[1],         // video,
@@ -510,47 +582,66 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
                              params_.colorSpaceConversionConfig_,             // colorSpaceConversionConfig
                              params_.inverseColorSpaceConversionConfig_,      // inverseColorSpaceConversionConfig
                              params_.colorSpaceConversionPath_ );             // keepIntermediateFiles
-      size_t sizeAttributeVideoT1 = videoBitstreamT1.size();
+    };
+    std::vector<std::function<void()>> attributeEncodes;
+    if ( params_.multipleStreams_ && params_.absoluteT1_ ) {
+      attributeEncodes.push_back( encodeAttributeT0 );
+      attributeEncodes.push_back( encodeAttributeT1 );
+    } else {
+      attributeEncodes.push_back( [&] {
+        encodeAttributeT0();
+        if ( params_.multipleStreams_ ) { encodeAttributeT1(); }
+      } );
+    }
+    if ( useAuxVideo ) {
+      attributeEncodes.push_back( [&] {
+        TRACE_PICTURE( "Attribute\n" );
+        TRACE_PICTURE( "AttrIdx = 0, AttrPartIdx = %d, AttrTypeID = %d, MapIdx = 0, AuxiliaryVideoFlag = 1\n",
+                       attrPartitionIndex, attrTypeId );
+        std::cout << "*******Video: Aux (Attribute) ********" << std::endl;
+        auto& videoBitstreamMP = context.getVideoBitstream( VIDEO_ATTRIBUTE_RAW );
+        generateRawPointsAttributeVideo( context );
+        auto&        videoRawPointsAttribute = context.getVideoRawPointsAttribute();
+        const size_t nByteAttMP              = 1;
+        videoEncoder.compress( videoRawPointsAttribute,                     // video,
+                               path.str(),                                  // path
+                               params_.auxAttributeQP_,                     // qp
+                               videoBitstreamMP,                            // bitstream
+                               params_.attributeAuxVideoConfig_,            // encoderConfig
+                               params_.videoEncoderAttributePath_,          // encoderPath
+                               params_.videoEncoderAttributeCodecId_,       // codecId
+                               params_.byteStreamVideoCoderAttribute_,      // byteStreamVideoCoder
+                               context,                                     // context
+                               nByteAttMP,                                  // nbyte
+                               params_.attributeVideo444_,                  // use444CodecIo
+                               false,                                       // use3dmv
+                               false,                                       // usePccRDO
+                               params_.shvcLayerIndex_,                     // SHVC layer index
+                               params_.shvcRateX_,                          // SHVC rate X
+                               params_.shvcRateY_,                          // SHVC rate Y
+                               10,                                          // internalBitDepth
+                               !params_.rawPointsPatch_,                    // useConversion
+                               params_.keepIntermediateFiles_,              // keepIntermediateFiles
+                               params_.colorSpaceConversionConfig_,         // colorSpaceConversionConfig
+                               params_.inverseColorSpaceConversionConfig_,  // inverseColorSpaceConversionConfig
+                               params_.colorSpaceConversionPath_ );         // colorSpaceConversionPath
+        printf( "generateRawPointsAttributefromVideo \n" );
+        videoRawPointsAttribute.resize( context.size() );
+        for ( size_t fi = 0; fi < context.size(); fi++ ) { generateRawPointsAttributefromVideo( context, fi ); }
+      } );
+    }
+    encodeVideosConcurrently( attributeEncodes );
+    auto sizeAttributeVideo =
+        context.getVideoBitstream( params_.multipleStreams_ ? VIDEO_ATTRIBUTE_T0 : VIDEO_ATTRIBUTE ).size();
+    std::cout << "attribute video ->" << sizeAttributeVideo << " B ("
+              << ( sizeAttributeVideo * 8.0 ) / ( 2 * frames.size() * pointCount ) << " bpp)" << std::endl;
+    if ( params_.multipleStreams_ ) {
+      size_t sizeAttributeVideoT1 = context.getVideoBitstream( VIDEO_ATTRIBUTE_T1 ).size();
       std::cout << "attribute video ->" << ( sizeAttributeVideo + sizeAttributeVideoT1 ) << "=" << sizeAttributeVideo
                 << "+" << sizeAttributeVideoT1 << " B ("
                 << ( ( sizeAttributeVideo + sizeAttributeVideoT1 ) * 8.0 ) / ( 2 * frames.size() * pointCount )
                 << " bpp)" << std::endl;
     }
-
-    if ( asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag() ) {
-      TRACE_PICTURE( "Attribute\n" );
-      TRACE_PICTURE( "AttrIdx = 0, AttrPartIdx = %d, AttrTypeID = %d, MapIdx = 0, AuxiliaryVideoFlag = 1\n",
-                     attrPartitionIndex, attrTypeId );
-      std::cout << "*******Video: Aux (Attribute) ********" << std::endl;
-      auto& videoBitstreamMP = context.createVideoBitstream( VIDEO_ATTRIBUTE_RAW );
-      generateRawPointsAttributeVideo( context );
-      auto&        videoRawPointsAttribute = context.getVideoRawPointsAttribute();
-      const size_t nByteAttMP              = 1;
-      videoEncoder.compress( videoRawPointsAttribute,                     // video,
-                             path.str(),                                  // path
-                             params_.auxAttributeQP_,                     // qp
-                             videoBitstreamMP,                            // bitstream
-                             params_.attributeAuxVideoConfig_,            // encoderConfig
-                             params_.videoEncoderAttributePath_,          // encoderPath
-                             params_.videoEncoderAttributeCodecId_,       // codecId
-                             params_.byteStreamVideoCoderAttribute_,      // byteStreamVideoCoder
-                             context,                                     // context
-                             nByteAttMP,                                  // nbyte
-                             params_.attributeVideo444_,                  // use444CodecIo
-                             false,                                       // use3dmv
-                             false,                                       // usePccRDO
-                             params_.shvcLayerIndex_,                     // SHVC layer index
-                             params_.shvcRateX_,                          // SHVC rate X
-                             params_.shvcRateY_,                          // SHVC rate Y
-                             10,                                          // internalBitDepth
-                             !params_.rawPointsPatch_,                    // useConversion
-                             params_.keepIntermediateFiles_,              // keepIntermediateFiles
-                             params_.colorSpaceConversionConfig_,         // colorSpaceConversionConfig
-                             params_.inverseColorSpaceConversionConfig_,  // inverseColorSpaceConversionConfig
-                             params_.colorSpaceConversionPath_ );         // colorSpaceConversionPath
-      printf( "generateRawPointsAttributefromVideo \n" );
-      for ( size_t fi = 0; fi < context.size(); fi++ ) { generateRawPointsAttributefromVideo( context, fi ); }
-    }
   }  // attribute
 
   if ( params_.flagGeometrySmoothing_ ) {
@@ -628,6 +719,9 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
 #endif
   std::cout << "Post Processing Point Clouds" << std::endl;
   bool isAttributes444 = static_cast<int>( params_.rawPointsPatch_ ) == 1;
+#if defined( ENABLE_TBB )
+  tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
+#endif
   for ( size_t frameIdx = 0; frameIdx < sources.getFrameCount(); frameIdx++ ) {
     GeneratePointCloudParameters ppSEIParams;
     setPostProcessingSeiParameters( ppSEIParams, context );
@@ -649,54 +743,61 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
       if ( ppSEIParams.gridSmoothing_ ) {
         smoothPointCloudPostprocess( reconstruct, params_.colorTransform_, ppSEIParams, partition );
       }
-      if ( ai.getAttributeCount() > 0 ) {
-        if ( !ppSEIParams.pbfEnableFlag_ ) {
-          // These are different attribute transfer functions
-          if ( params_.attrTransferFilterType_ == 1 || params_.attrTransferFilterType_ == 5 ) {
-            TRACE_PATCH( " transferColors16bitBP \n" );
-            tempFrameBuffer.transferColors16bitBP( reconstruct,                      // target
-                                                   params_.attrTransferFilterType_,  // filterType
-                                                   int32_t( 0 ),                     // searchRange
-                                                   isAttributes444,                  // losslessAttribute
-                                                   8,                                // numNeighborsColorTransferFwd
-                                                   1,                                // numNeighborsColorTransferBwd
-                                                   true,                             // useDistWeightedAverageFwd
-                                                   true,                             // useDistWeightedAverageBwd
-                                                   true,          // skipAvgIfIdenticalSourcePointPresentFwd
-                                                   false,         // skipAvgIfIdenticalSourcePointPresentBwd
-                                                   4,             // distOffsetFwd
-                                                   4,             // distOffsetBwd
-                                                   1000,          // maxGeometryDist2Fwd
-                                                   1000,          // maxGeometryDist2Bwd
-                                                   1000 * 256,    // maxColorDist2Fwd
-                                                   1000 * 256 );  // maxColorDist2Bwd
-          } else if ( params_.attrTransferFilterType_ == 2 ) {
-            TRACE_PATCH( " transferColorWeight \n" );
-            tempFrameBuffer.transferColorWeight( reconstruct, 0.1 );
-          } else if ( params_.attrTransferFilterType_ == 3 ) {
-            TRACE_PATCH( " transferColorsFilter3 \n" );
-            tempFrameBuffer.transferColorsFilter3( reconstruct, int32_t( 0 ), isAttributes444 );
-          } else if ( params_.attrTransferFilterType_ == 7 || params_.attrTransferFilterType_ == 9 ) {
-            TRACE_PATCH( " transferColorsFilter3 \n" );
-            tempFrameBuffer.transferColorsBackward16bitBP( reconstruct,                      //  target
-                                                           params_.attrTransferFilterType_,  //  filterType
-                                                           int32_t( 0 ),                     //  searchRange
-                                                           isAttributes444,                  //  losslessAttribute
-                                                           8,             //  numNeighborsColorTransferFwd
-                                                           1,             //  numNeighborsColorTransferBwd
-                                                           true,          //  useDistWeightedAverageFwd
-                                                           true,          //  useDistWeightedAverageBwd
-                                                           true,          //  skipAvgIfIdenticalSourcePointPresentFwd
-                                                           false,         //  skipAvgIfIdenticalSourcePointPresentBwd
-                                                           4,             //  distOffsetFwd
-                                                           4,             //  distOffsetBwd
-                                                           1000,          //  maxGeometryDist2Fwd
-                                                           1000,          //  maxGeometryDist2Bwd
-                                                           1000 * 256,    //  maxColorDist2Fwd
-                                                           1000 * 256 );  //  maxColorDist2Bwd
+#if defined( ENABLE_TBB )
+      // the attribute transfers run their loops in the arena of the caller
+      limited.execute( [&] {
+#endif
+        if ( ai.getAttributeCount() > 0 ) {
+          if ( !ppSEIParams.pbfEnableFlag_ ) {
+            // These are different attribute transfer functions
+            if ( params_.attrTransferFilterType_ == 1 || params_.attrTransferFilterType_ == 5 ) {
+              TRACE_PATCH( " transferColors16bitBP \n" );
+              tempFrameBuffer.transferColors16bitBP( reconstruct,                      // target
+                                                     params_.attrTransferFilterType_,  // filterType
+                                                     int32_t( 0 ),                     // searchRange
+                                                     isAttributes444,                  // losslessAttribute
+                                                     8,                                // numNeighborsColorTransferFwd
+                                                     1,                                // numNeighborsColorTransferBwd
+                                                     true,                             // useDistWeightedAverageFwd
+                                                     true,                             // useDistWeightedAverageBwd
+                                                     true,          // skipAvgIfIdenticalSourcePointPresentFwd
+                                                     false,         // skipAvgIfIdenticalSourcePointPresentBwd
+                                                     4,             // distOffsetFwd
+                                                     4,             // distOffsetBwd
+                                                     1000,          // maxGeometryDist2Fwd
+                                                     1000,          // maxGeometryDist2Bwd
+                                                     1000 * 256,    // maxColorDist2Fwd
+                                                     1000 * 256 );  // maxColorDist2Bwd
+            } else if ( params_.attrTransferFilterType_ == 2 ) {
+              TRACE_PATCH( " transferColorWeight \n" );
+              tempFrameBuffer.transferColorWeight( reconstruct, 0.1 );
+            } else if ( params_.attrTransferFilterType_ == 3 ) {
+              TRACE_PATCH( " transferColorsFilter3 \n" );
+              tempFrameBuffer.transferColorsFilter3( reconstruct, int32_t( 0 ), isAttributes444 );
+            } else if ( params_.attrTransferFilterType_ == 7 || params_.attrTransferFilterType_ == 9 ) {
+              TRACE_PATCH( " transferColorsFilter3 \n" );
+              tempFrameBuffer.transferColorsBackward16bitBP( reconstruct,                      //  target
+                                                             params_.attrTransferFilterType_,  //  filterType
+                                                             int32_t( 0 ),                     //  searchRange
+                                                             isAttributes444,                  //  losslessAttribute
+                                                             8,             //  numNeighborsColorTransferFwd
+                                                             1,             //  numNeighborsColorTransferBwd
+                                                             true,          //  useDistWeightedAverageFwd
+                                                             true,          //  useDistWeightedAverageBwd
+                                                             true,          //  skipAvgIfIdenticalSourcePointPresentFwd
+                                                             false,         //  skipAvgIfIdenticalSourcePointPresentBwd
+                                                             4,             //  distOffsetFwd
+                                                             4,             //  distOffsetBwd
+                                                             1000,          //  maxGeometryDist2Fwd
+                                                             1000,          //  maxGeometryDist2Bwd
+                                                             1000 * 256,    //  maxColorDist2Fwd
+                                                             1000 * 256 );  //  maxColorDist2Bwd
+            }
           }
-        }
-      }  // if ( ai.getAttributeCount() > 0 )
+        }  // if ( ai.getAttributeCount() > 0 )
+#if defined( ENABLE_TBB )
+      } );
+#endif
     }
     if ( ai.getAttributeCount() > 0 ) {
       if ( params_.applyAttrSmoothingType_ != 0 && ppSEIParams.flagColorSmoothing_ ) {
@@ -724,38 +825,67 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
   params_.pointLocalReconstruction_   = ( pointLocalReconstructionOriginal != 0u );
   params_.mapCountMinus1_             = layerCountMinus1Original;
   params_.singleMapPixelInterleaving_ = ( singleMapPixelInterleavingOriginal != 0u );
+  params_.numMaxTilePerFrame_         = numMaxTilePerFrameOriginal;
   printf( "Done Encoder \n" );
   fflush( stdout );
   return 0;
 }
 
-void PCCEncoder::printMap( std::vector<bool> img, const size_t sizeU, const size_t sizeV ) {
-  std::cout << std::endl;
-  std::cout << "PrintMap size = " << sizeU << " x " << sizeV << std::endl;
+void PCCEncoder::encodeVideosConcurrently( const std::vector<std::function<void()>>& videoEncodes ) {
+#if defined( ENABLE_TBB ) && defined( CONFORMANCE_TRACE )
+  // the picture traces are written by the video encodes: keep them in order
+  tbb::task_arena limited( 1 );
+#elif defined( ENABLE_TBB )
+  // the video encodes mostly wait on the external encoders: each one holds a thread of the budget. The HM, VTM and
+  // JM library encoders are not reentrant and PCCVideoEncoder::compress() serializes them on a process-wide lock, so
+  // only the App encoders, running in their own process, actually overlap.
+  tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
+#endif
+#if defined( ENABLE_TBB )
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), videoEncodes.size(), [&]( const size_t i ) { videoEncodes[i](); } );
+  } );
+#else
+  for ( const auto& videoEncode : videoEncodes ) { videoEncode(); }
+#endif
+}
+
+template <typename Map>
+void PCCEncoder::printMap( const Map& img, const size_t sizeU, const size_t sizeV ) {
+  *g_packingLog << std::endl;
+  *g_packingLog << "PrintMap size = " << sizeU << " x " << sizeV << std::endl;
   for ( size_t v = 0; v < sizeV; ++v ) {
-    for ( size_t u = 0; u < sizeU; ++u ) { std::cout << ( img[v * sizeU + u] ? 'X' : '.' ); }
-    std::cout << std::endl;
+    for ( size_t u = 0; u < sizeU; ++u ) { *g_packingLog << ( img[v * sizeU + u] ? 'X' : '.' ); }
+    *g_packingLog << std::endl;
   }
-  std::cout << std::endl;
+  *g_packingLog << std::endl;
 }
 
-void PCCEncoder::printMapTetris( std::vector<bool> img,
-                                 const size_t      sizeU,
-                                 const size_t      sizeV,
-                                 std::vector<int>  horizon ) {
-  std::cout << std::endl;
-  std::cout << "PrintMap size = " << sizeU << " x " << sizeV << std::endl;
+void PCCEncoder::printMapTetris( const PCCOccupancyCanvas& img,
+                                 const size_t              sizeU,
+                                 const size_t              sizeV,
+                                 std::vector<int>          horizon ) {
+  *g_packingLog << std::endl;
+  *g_packingLog << "PrintMap size = " << sizeU << " x " << sizeV << std::endl;
   for ( int v = 0; v < sizeV; ++v ) {
     for ( int u = 0; u < sizeU; ++u ) {
       if ( v == horizon[u] ) {
-        std::cout << ( img[v * sizeU + u] ? 'U' : 'O' );
+        *g_packingLog << ( img[v * sizeU + u] ? 'U' : 'O' );
       } else {
-        std::cout << ( img[v * sizeU + u] ? 'X' : '.' );
+        *g_packingLog << ( img[v * sizeU + u] ? 'X' : '.' );
       }
     }
-    std::cout << std::endl;
+    *g_packingLog << std::endl;
   }
-  std::cout << std::endl;
+  *g_packingLog << std::endl;
+}
+
+std::vector<size_t> PCCEncoder::getPackingOrientations( const PCCPatch& patch,
+                                                        bool            defaultOnly,
+                                                        size_t          numOrientations ) {
+  if ( defaultOnly ) { return {PATCH_ORIENTATION_DEFAULT}; }
+  const auto& orientations = patch.getSizeU0() > patch.getSizeV0() ? g_orientationHorizontal : g_orientationVertical;
+  return std::vector<size_t>( orientations.begin(), orientations.begin() + numOrientations );
 }
 
 template <typename T>
@@ -1194,9 +1324,9 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
   if ( patches.empty() ) {
     if ( tile.getNumberOfRawPointsPatches() == 0 ) { return; }
     if ( tile.getUseRawPointsSeparateVideo() ) { return; }
-    std::vector<bool> occupancyMap;
-    size_t            occupancySizeU = presetWidth / params_.occupancyResolution_;
-    size_t            occupancySizeV = presetHeight / params_.occupancyResolution_;
+    PCCOccupancyCanvas occupancyMap;
+    size_t             occupancySizeU = presetWidth / params_.occupancyResolution_;
+    size_t             occupancySizeV = presetHeight / params_.occupancyResolution_;
     if ( presetWidth == 0 || presetHeight == 0 ) {
       auto& rawPointsPatch = tile.getRawPointsPatch( 0 );
       auto  rawPointsPatchBlocks =
@@ -1221,12 +1351,12 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
       emptyTile = true;
       height    = 64;
     }
-    std::cout << "frame " << tile.getFrameIndex() << " tile " << tile.getTileIndex()
-              << " spatialConsistencyPackFlexible(patchEmpty): actualImageSize " << width << " x " << height;
+    *g_packingLog << "frame " << tile.getFrameIndex() << " tile " << tile.getTileIndex()
+                  << " spatialConsistencyPackFlexible(patchEmpty): actualImageSize " << width << " x " << height;
     if ( emptyTile )
-      std::cout << " height adjusted" << std::endl;
+      *g_packingLog << " height adjusted" << std::endl;
     else
-      std::cout << std::endl;
+      *g_packingLog << std::endl;
     return;
   }
   if ( packingStrategy == 0 ) {
@@ -1286,15 +1416,15 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
 
   // remove the below logs when useless.
   if ( g_printDetailedInfo ) {
-    std::cout << "patches.size:" << patches.size() << ",reOrderedPatches.size:" << newOrderPatches.size()
-              << ",matchedpatches.size:" << tile.getNumMatchedPatches() << std::endl;
+    *g_packingLog << "patches.size:" << patches.size() << ",reOrderedPatches.size:" << newOrderPatches.size()
+                  << ",matchedpatches.size:" << tile.getNumMatchedPatches() << std::endl;
   }
   patches = newOrderPatches;
   if ( g_printDetailedInfo ) {
-    std::cout << "Patch order:" << std::endl;
+    *g_packingLog << "Patch order:" << std::endl;
     for ( auto& patch : patches ) {
-      std::cout << "Patch[" << patch.getIndex() << "]=(" << patch.getSizeU0() << "," << patch.getSizeV0() << ")"
-                << std::endl;
+      *g_packingLog << "Patch[" << patch.getIndex() << "]=(" << patch.getSizeU0() << "," << patch.getSizeV0() << ")"
+                    << std::endl;
     }
   }
   for ( auto& patch : patches ) { occupancySizeU = (std::max)( occupancySizeU, patch.getSizeU0() + 1 ); }
@@ -1302,15 +1432,15 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
   int tileWidth   = occupancySizeU / numTilesHor;
   int tileHeight  = int( tileWidth * params_.tileHeightToWidthRatio_ );
   if ( params_.enablePointCloudPartitioning_ ) {
-    std::cout << "frame " << tile.getFrameIndex() << " tilesize: " << tileWidth << "x" << tileHeight << std::endl;
-  }
-  occupancySizeV                    = ( occupancySizeV >= tileHeight ) ? occupancySizeV : tileHeight;
-  width                             = occupancySizeU * params_.occupancyResolution_;
-  height                            = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  int               numOrientations = packingStrategy == 0 ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
-  std::vector<bool> occupancyMap;
-  occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+    *g_packingLog << "frame " << tile.getFrameIndex() << " tilesize: " << tileWidth << "x" << tileHeight << std::endl;
+  }
+  occupancySizeV                     = ( occupancySizeV >= tileHeight ) ? occupancySizeV : tileHeight;
+  width                              = occupancySizeU * params_.occupancyResolution_;
+  height                             = occupancySizeV * params_.occupancyResolution_;
+  size_t             maxOccupancyRow = 0;
+  int                numOrientations = packingStrategy == 0 ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
+  PCCOccupancyCanvas occupancyMap;
+  occupancyMap.resize( occupancySizeU * occupancySizeV );
   for ( auto& patch : patches ) {
     assert( patch.getSizeU0() <= occupancySizeU );
     assert( patch.getSizeV0() <= occupancySizeV );
@@ -1325,51 +1455,30 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
         if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_ ) ) {
           locationFound = true;
           if ( g_printDetailedInfo ) {
-            std::cout << "Maintained orientation " << patch.getPatchOrientation() << " for matched patch "
-                      << patch.getIndex() << " in the same position (" << patch.getU0() << "," << patch.getV0() << ")"
-                      << std::endl;
+            *g_packingLog << "Maintained orientation " << patch.getPatchOrientation() << " for matched patch "
+                          << patch.getIndex() << " in the same position (" << patch.getU0() << ","
+                          << patch.getV0() << ")" << std::endl;
           }
         }
         // if the patch couldn't fit, try to fit the patch in the top left position
-        for ( int v = 0; v <= occupancySizeV && !locationFound; ++v ) {
-          for ( int u = 0; u <= occupancySizeU && !locationFound; ++u ) {
-            patch.setU0( u );
-            patch.setV0( v );
-            if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
-                                            safeguard ) ) {
-              locationFound = true;
-              if ( g_printDetailedInfo ) {
-                std::cout << "Maintained orientation " << patch.getPatchOrientation() << " for matched patch "
-                          << patch.getIndex() << " (" << u << "," << v << ")" << std::endl;
-              }
-            }
+        if ( !locationFound && patch.findFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV,
+                                                         params_.lowDelayEncoding_, {patch.getPatchOrientation()},
+                                                         safeguard, Tile(), params_.nbThread_ ) ) {
+          locationFound = true;
+          if ( g_printDetailedInfo ) {
+            *g_packingLog << "Maintained orientation " << patch.getPatchOrientation() << " for matched patch "
+                          << patch.getIndex() << " (" << patch.getU0() << "," << patch.getV0() << ")" << std::endl;
           }
         }
       } else {
         // best effort
-        for ( size_t v = 0; v < occupancySizeV && !locationFound; ++v ) {
-          for ( size_t u = 0; u < occupancySizeU && !locationFound; ++u ) {
-            patch.setU0( u );
-            patch.setV0( v );
-            for ( size_t orientationIdx = 0; orientationIdx < numOrientations && !locationFound; orientationIdx++ ) {
-              if ( packingStrategy == 0 )
-                patch.setPatchOrientation( PATCH_ORIENTATION_DEFAULT );
-              else {
-                if ( patch.getSizeU0() > patch.getSizeV0() ) {
-                  patch.setPatchOrientation( g_orientationHorizontal[orientationIdx] );
-                } else {
-                  patch.setPatchOrientation( g_orientationVertical[orientationIdx] );
-                }
-              }
-              if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
-                                              safeguard ) ) {
-                locationFound = true;
-                if ( g_printDetailedInfo ) {
-                  std::cout << "Orientation " << patch.getPatchOrientation() << " selected for unmatched patch "
-                            << patch.getIndex() << " (" << u << "," << v << ")" << std::endl;
-                }
-              }
-            }
+        if ( patch.findFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
+                                       getPackingOrientations( patch, packingStrategy == 0, numOrientations ),
+                                       safeguard, Tile(), params_.nbThread_ ) ) {
+          locationFound = true;
+          if ( g_printDetailedInfo ) {
+            *g_packingLog << "Orientation " << patch.getPatchOrientation() << " selected for unmatched patch "
+                          << patch.getIndex() << " (" << patch.getU0() << "," << patch.getV0() << ")" << std::endl;
           }
         }
       }
@@ -1382,9 +1491,9 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
       for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
         int coord = patch.patchBlock2CanvasBlock( u0, v0, occupancySizeU, occupancySizeV );
         if ( params_.lowDelayEncoding_ ) {
-          occupancyMap[coord] = true;
-        } else {
-          occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * patch.getSizeU0() + u0];
+          occupancyMap.set( coord );
+        } else if ( occupancy[v0 * patch.getSizeU0() + u0] ) {
+          occupancyMap.set( coord );
         }
       }
     }
@@ -1407,8 +1516,8 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
     packEOMAttributePointsPatch( tile, occupancyMap, width, height, occupancySizeU, occupancySizeV, maxOccupancyRow );
   }
   if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV ); }
-  std::cout << "frame " << tile.getFrameIndex() << " tile " << tile.getTileIndex()
-            << " spatialConsistencyPackFlexible: actualImageSize " << width << " x " << height << std::endl;
+  *g_packingLog << "frame " << tile.getFrameIndex() << " tile " << tile.getTileIndex()
+                << " spatialConsistencyPackFlexible: actualImageSize " << width << " x " << height << std::endl;
 }
 
 void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame,
@@ -1470,23 +1579,23 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame,
 
   // remove the below logs when useless.
   if ( g_printDetailedInfo ) {
-    std::cout << "patches.size:" << patches.size() << ",reOrderedPatches.size:" << newOrderPatches.size()
-              << ",matchedpatches.size:" << frame.getNumMatchedPatches() << std::endl;
+    *g_packingLog << "patches.size:" << patches.size() << ",reOrderedPatches.size:" << newOrderPatches.size()
+                  << ",matchedpatches.size:" << frame.getNumMatchedPatches() << std::endl;
   }
   patches = newOrderPatches;
   if ( g_printDetailedInfo ) {
-    std::cout << "Patch order:" << std::endl;
+    *g_packingLog << "Patch order:" << std::endl;
     for ( auto& patch : patches ) {
-      std::cout << "Patch[" << patch.getIndex() << "]=(" << patch.getSizeU0() << "," << patch.getSizeV0() << ")"
-                << std::endl;
+      *g_packingLog << "Patch[" << patch.getIndex() << "]=(" << patch.getSizeU0() << "," << patch.getSizeV0() << ")"
+                    << std::endl;
     }
   }
   for ( auto& patch : patches ) { occupancySizeU = (std::max)( occupancySizeU, patch.getSizeU0() + 1 ); }
-  width                             = occupancySizeU * params_.occupancyResolution_;
-  height                            = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
-  occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+  width                              = occupancySizeU * params_.occupancyResolution_;
+  height                             = occupancySizeV * params_.occupancyResolution_;
+  size_t             maxOccupancyRow = 0;
+  PCCOccupancyCanvas occupancyMap;
+  occupancyMap.resize( occupancySizeU * occupancySizeV );
   std::vector<int> horizon;
   horizon.resize( occupancySizeU, 0 );
 
@@ -1517,7 +1626,7 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame,
           // Translate coordinates and mask them out.
           int xp = x + prevPatches[patch.getBestMatchIdx()].getU0();
           int yp = y + prevPatches[patch.getBestMatchIdx()].getV0();
-          if ( g_printDetailedInfo ) { std::cout << "Testing position (" << xp << ',' << yp << ')' << std::endl; }
+          if ( g_printDetailedInfo ) { *g_packingLog << "Testing position (" << xp << ',' << yp << ')' << std::endl; }
           if ( xp >= 0 && xp < occupancySizeU && yp >= 0 && yp < occupancySizeV ) {
             patch.setU0( xp );
             patch.setV0( yp );
@@ -1527,8 +1636,8 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame,
               bestU         = xp;
               bestV         = yp;
               if ( g_printDetailedInfo ) {
-                std::cout << "Maintained orientation " << patch.getPatchOrientation() << " for matched patch "
-                          << patch.getIndex() << " in new position (" << xp << "," << yp << ")" << std::endl;
+                *g_packingLog << "Maintained orientation " << patch.getPatchOrientation() << " for matched patch "
+                              << patch.getIndex() << " in new position (" << xp << "," << yp << ")" << std::endl;
               }
             }
           }
@@ -1554,8 +1663,8 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame,
               if ( !patch.isPatchLocationAboveHorizon( horizon, topHorizon, bottomHorizon, rightHorizon,
                                                        leftHorizon ) ) {
                 if ( g_printDetailedInfo ) {
-                  std::cout << "(" << u << "," << v << "|" << patch.getPatchOrientation() << ") above horizon"
-                            << std::endl;
+                  *g_packingLog << "(" << u << "," << v << "|" << patch.getPatchOrientation() << ") above horizon"
+                                << std::endl;
                 }
                 continue;
               }
@@ -1585,16 +1694,16 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame,
         patch.setV0( bestV );
         patch.setPatchOrientation( bestOrientation );
         if ( g_printDetailedInfo ) {
-          std::cout << "Selected position (" << bestU << "," << bestV << ") and orientation " << bestOrientation
-                    << std::endl;
+          *g_packingLog << "Selected position (" << bestU << "," << bestV << ") and orientation " << bestOrientation
+                        << std::endl;
         }
         // update the horizon
         patch.updateHorizon( horizon, topHorizon, bottomHorizon, rightHorizon, leftHorizon );
         // debugging
         if ( g_printDetailedInfo ) {
-          std::cout << "New Horizon :[";
-          for ( int i = 0; i < occupancySizeU; i++ ) { std::cout << horizon[i] << ","; }
-          std::cout << "]" << std::endl;
+          *g_packingLog << "New Horizon :[";
+          for ( int i = 0; i < occupancySizeU; i++ ) { *g_packingLog << horizon[i] << ","; }
+          *g_packingLog << "]" << std::endl;
         }
       }
     }
@@ -1602,9 +1711,9 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame,
       for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
         int coord = patch.patchBlock2CanvasBlock( u0, v0, occupancySizeU, occupancySizeV );
         if ( params_.lowDelayEncoding_ ) {
-          occupancyMap[coord] = true;
-        } else {
-          occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * patch.getSizeU0() + u0];
+          occupancyMap.set( coord );
+        } else if ( occupancy[v0 * patch.getSizeU0() + u0] ) {
+          occupancyMap.set( coord );
         }
       }
     }
@@ -1628,7 +1737,7 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame,
     packEOMAttributePointsPatch( frame, occupancyMap, width, height, occupancySizeU, occupancySizeV, maxOccupancyRow );
   }
   if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV ); }
-  std::cout << "actualImageSize (spatialConsistencyPackTetris) " << width << " x " << height << std::endl;
+  *g_packingLog << "actualImageSize (spatialConsistencyPackTetris) " << width << " x " << height << std::endl;
 }
 
 // GTP - GLOBAL PATCH PACKING
@@ -1642,7 +1751,7 @@ void PCCEncoder::findMatchesForGlobalTetrisPacking( PCCFrameContext& tile, PCCFr
     if ( g_printDetailedInfo ) {
       for ( int patchIdx = 0; patchIdx < patches.size(); patchIdx++ ) {
         auto& patch = patches[patchIdx];
-        std::cout << "Sorted Patch[" << patchIdx << "]->";
+        *g_packingLog << "Sorted Patch[" << patchIdx << "]->";
         patch.setU0( 0 );
         patch.setV0( 0 );
         patch.print();
@@ -1684,15 +1793,15 @@ void PCCEncoder::findMatchesForGlobalTetrisPacking( PCCFrameContext& tile, PCCFr
            ( ( area2 / area1 ) < params_.globalPackingStrategyThreshold_ ) ) {
         // this seems like an unlike mismatch, will break the chain here
         if ( g_printDetailedInfo ) {
-          std::cout << "Removing the match because areas are too different:" << std::endl;
-          std::cout << "elem.ID =" << curPatch.getIndex() << std::endl;
-          std::cout << "elem.sizeU0 =" << curPatch.getSizeU0() << std::endl;
-          std::cout << "elem.sizeV0 =" << curPatch.getSizeV0() << std::endl;
-          std::cout << "area =" << area1 << std::endl;
-          std::cout << "previous_elem.ID =" << patch.getIndex() << std::endl;
-          std::cout << "elem.sizeU0 =" << patch.getSizeU0() << std::endl;
-          std::cout << "elem.sizeV0 =" << patch.getSizeV0() << std::endl;
-          std::cout << "area =" << area2 << std::endl;
+          *g_packingLog << "Removing the match because areas are too different:" << std::endl;
+          *g_packingLog << "elem.ID =" << curPatch.getIndex() << std::endl;
+          *g_packingLog << "elem.sizeU0 =" << curPatch.getSizeU0() << std::endl;
+          *g_packingLog << "elem.sizeV0 =" << curPatch.getSizeV0() << std::endl;
+          *g_packingLog << "area =" << area1 << std::endl;
+          *g_packingLog << "previous_elem.ID =" << patch.getIndex() << std::endl;
+          *g_packingLog << "elem.sizeU0 =" << patch.getSizeU0() << std::endl;
+          *g_packingLog << "elem.sizeV0 =" << patch.getSizeV0() << std::endl;
+          *g_packingLog << "area =" << area2 << std::endl;
         }
       } else {
         // store the best match index
@@ -1712,11 +1821,11 @@ void PCCEncoder::findMatchesForGlobalTetrisPacking( PCCFrameContext& tile, PCCFr
     for ( int patchIdx = 0; patchIdx < patches.size(); patchIdx++ ) {
       auto& patch = patches[patchIdx];
       if ( patchIdx < tile.getNumMatchedPatches() ) {
-        std::cout << "Matched (refPatch[" << patches[patchIdx].getBestMatchIdx()
-                  << "]=" << prevPatches[patches[patchIdx].getBestMatchIdx()].getIndex() << ") Patch[" << patchIdx
-                  << "]->";
+        *g_packingLog << "Matched (refPatch[" << patches[patchIdx].getBestMatchIdx()
+                      << "]=" << prevPatches[patches[patchIdx].getBestMatchIdx()].getIndex() << ") Patch[" << patchIdx
+                      << "]->";
       } else {
-        std::cout << "Unmatched Patch[" << patchIdx << "]->";
+        *g_packingLog << "Unmatched Patch[" << patchIdx << "]->";
       }
       patch.setU0( 0 );
       patch.setV0( 0 );
@@ -1980,8 +2089,8 @@ void PCCEncoder::doGlobalTetrisPacking( PCCContext& context,
       }
       numOrientations = params_.packingStrategy_ == 0 ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
 
-      std::vector<bool> occupancyMap;
-      occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+      PCCOccupancyCanvas occupancyMap;
+      occupancyMap.resize( occupancySizeU * occupancySizeV );
       int indNextMatchedPatch = 0;
       // patch loop
       for ( int patchIdx = 0; patchIdx < patchMatrixSortedIndexes[frameIdx].size(); patchIdx++ ) {
@@ -2257,9 +2366,9 @@ void PCCEncoder::doGlobalTetrisPacking( PCCContext& context,
           for ( size_t u0 = 0; u0 < curGlobalElem.getSizeU0(); ++u0 ) {
             int coord = curGlobalElem.patchBlock2CanvasBlock( u0, v0, occupancySizeU, occupancySizeV );
             if ( params_.lowDelayEncoding_ ) {
-              occupancyMap[coord] = true;
-            } else {
-              occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * curGlobalElem.getSizeU0() + u0];
+              occupancyMap.set( coord );
+            } else if ( occupancy[v0 * curGlobalElem.getSizeU0() + u0] ) {
+              occupancyMap.set( coord );
             }
           }
         }
@@ -2317,9 +2426,9 @@ void PCCEncoder::packFlexible( PCCFrameContext& tile,
   if ( patches.empty() ) {
     if ( tile.getNumberOfRawPointsPatches() == 0 ) { return; }
     if ( tile.getUseRawPointsSeparateVideo() ) { return; }
-    std::vector<bool> occupancyMap;
-    size_t            occupancySizeU = presetWidth / params_.occupancyResolution_;
-    size_t            occupancySizeV = presetHeight / params_.occupancyResolution_;
+    PCCOccupancyCanvas occupancyMap;
+    size_t             occupancySizeU = presetWidth / params_.occupancyResolution_;
+    size_t             occupancySizeV = presetHeight / params_.occupancyResolution_;
     if ( presetWidth == 0 || presetHeight == 0 ) {
       auto& rawPointsPatch = tile.getRawPointsPatch( 0 );
       auto  rawPointsPatchBlocks =
@@ -2344,12 +2453,12 @@ void PCCEncoder::packFlexible( PCCFrameContext& tile,
       emptyTile = true;
       height    = 64;
     }
-    std::cout << "frame " << tile.getFrameIndex() << " tile " << tile.getTileIndex()
-              << " packFlexible(patchEmpty): actualImageSize " << width << " x " << height;
+    *g_packingLog << "frame " << tile.getFrameIndex() << " tile " << tile.getTileIndex()
+                  << " packFlexible(patchEmpty): actualImageSize " << width << " x " << height;
     if ( emptyTile )
-      std::cout << " height adjusted" << std::endl;
+      *g_packingLog << " height adjusted" << std::endl;
     else
-      std::cout << std::endl;
+      *g_packingLog << std::endl;
     return;
   }
   // sorting by patch largest dimension
@@ -2359,10 +2468,10 @@ void PCCEncoder::packFlexible( PCCFrameContext& tile,
     std::sort( patches.begin(), patches.end(), []( PCCPatch& a, PCCPatch& b ) { return a.gt( b ); } );
   }
   if ( g_printDetailedInfo ) {
-    std::cout << "Patch order:" << std::endl;
+    *g_packingLog << "Patch order:" << std::endl;
     for ( auto& patch : patches ) {
-      std::cout << "Patch[" << patch.getIndex() << "]=(" << patch.getSizeU0() << "," << patch.getSizeV0() << ")"
-                << std::endl;
+      *g_packingLog << "Patch[" << patch.getIndex() << "]=(" << patch.getSizeU0() << "," << patch.getSizeV0() << ")"
+                    << std::endl;
     }
   }
   size_t occupancySizeU = presetWidth / params_.occupancyResolution_;
@@ -2374,42 +2483,26 @@ void PCCEncoder::packFlexible( PCCFrameContext& tile,
   int tileWidth   = occupancySizeU / numTilesHor;
   int tileHeight  = int( tileWidth * params_.tileHeightToWidthRatio_ );
   if ( params_.enablePointCloudPartitioning_ )
-    std::cout << "frame " << tile.getFrameIndex() << " tilesize: " << tileWidth << "x" << tileHeight << std::endl;
-  occupancySizeV                    = ( occupancySizeV >= tileHeight ) ? occupancySizeV : tileHeight;
-  height                            = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
-  int               numOrientations = ( packingStrategy == 0 ) ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
-  occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+    *g_packingLog << "frame " << tile.getFrameIndex() << " tilesize: " << tileWidth << "x" << tileHeight << std::endl;
+  occupancySizeV                     = ( occupancySizeV >= tileHeight ) ? occupancySizeV : tileHeight;
+  height                             = occupancySizeV * params_.occupancyResolution_;
+  size_t             maxOccupancyRow = 0;
+  PCCOccupancyCanvas occupancyMap;
+  int                numOrientations = ( packingStrategy == 0 ) ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
+  occupancyMap.resize( occupancySizeU * occupancySizeV );
   for ( auto& patch : patches ) {
     assert( patch.getSizeU0() <= occupancySizeU );
     assert( patch.getSizeV0() <= occupancySizeV );
     bool  locationFound = false;
     auto& occupancy     = patch.getOccupancy();
     while ( !locationFound ) {
-      for ( size_t v = 0; v < occupancySizeV && !locationFound; ++v ) {
-        for ( size_t u = 0; u < occupancySizeU && !locationFound; ++u ) {
-          patch.setU0( u );
-          patch.setV0( v );
-          for ( size_t orientationIdx = 0; orientationIdx < numOrientations && !locationFound; orientationIdx++ ) {
-            if ( packingStrategy == 0 )
-              patch.setPatchOrientation( PATCH_ORIENTATION_DEFAULT );
-            else {
-              if ( patch.getSizeU0() > patch.getSizeV0() ) {
-                patch.setPatchOrientation( g_orientationHorizontal[orientationIdx] );
-              } else {
-                patch.setPatchOrientation( g_orientationVertical[orientationIdx] );
-              }
-            }
-            if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
-                                            safeguard ) ) {
-              locationFound = true;
-              if ( g_printDetailedInfo ) {
-                std::cout << "Orientation " << patch.getPatchOrientation() << " selected for patch " << patch.getIndex()
-                          << " (" << u << "," << v << ")" << std::endl;
-              }
-            }
-          }
+      if ( patch.findFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
+                                     getPackingOrientations( patch, packingStrategy == 0, numOrientations ),
+                                     safeguard, Tile(), params_.nbThread_ ) ) {
+        locationFound = true;
+        if ( g_printDetailedInfo ) {
+          *g_packingLog << "Orientation " << patch.getPatchOrientation() << " selected for patch " << patch.getIndex()
+                        << " (" << patch.getU0() << "," << patch.getV0() << ")" << std::endl;
         }
       }
       if ( !locationFound ) {
@@ -2421,9 +2514,9 @@ void PCCEncoder::packFlexible( PCCFrameContext& tile,
       for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
         int coord = patch.patchBlock2CanvasBlock( u0, v0, occupancySizeU, occupancySizeV );
         if ( params_.lowDelayEncoding_ ) {
-          occupancyMap[coord] = true;
-        } else {
-          occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * patch.getSizeU0() + u0];
+          occupancyMap.set( coord );
+        } else if ( occupancy[v0 * patch.getSizeU0() + u0] ) {
+          occupancyMap.set( coord );
         }
       }
     }
@@ -2444,8 +2537,8 @@ void PCCEncoder::packFlexible( PCCFrameContext& tile,
     packEOMAttributePointsPatch( tile, occupancyMap, width, height, occupancySizeU, occupancySizeV, maxOccupancyRow );
   }
   if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV ); }
-  std::cout << "frame " << tile.getFrameIndex() << " tile " << tile.getTileIndex() << " packFlexible: actualImageSize "
-            << width << " x " << height << std::endl;
+  *g_packingLog << "frame " << tile.getFrameIndex() << " tile " << tile.getTileIndex()
+                << " packFlexible: actualImageSize " << width << " x " << height << std::endl;
 }
 
 void PCCEncoder::packMultipleTiles( PCCAtlasFrameContext& atlasFrame, int safeguard ) {
@@ -2468,29 +2561,18 @@ void PCCEncoder::packMultipleTiles( PCCAtlasFrameContext& atlasFrame, int safegu
   int tileHeight = int( tileWidth * params_.tileHeightToWidthRatio_ );
   if ( params_.enablePointCloudPartitioning_ )
     std::cout << "frame " << frame.getFrameIndex() << " tilesize: " << tileWidth << "x" << tileHeight << std::endl;
-  occupancySizeV                    = ( occupancySizeV >= tileHeight ) ? occupancySizeV : tileHeight;
-  width                             = occupancySizeU * params_.occupancyResolution_;
-  height                            = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
-  occupancyMap.resize( occupancySizeU * occupancySizeV, false );
-  std::vector<Tile> tilesNotAvailable;  // set of all tiles occupied by prev ROIs of current ROI
-  int               lastOccupiedTileIndex          = -1;
-  int               lastOccupiedTileIndexByPrevROI = -1;
+  occupancySizeV                     = ( occupancySizeV >= tileHeight ) ? occupancySizeV : tileHeight;
+  width                              = occupancySizeU * params_.occupancyResolution_;
+  height                             = occupancySizeV * params_.occupancyResolution_;
+  size_t             maxOccupancyRow = 0;
+  PCCOccupancyCanvas occupancyMap;
+  occupancyMap.resize( occupancySizeU * occupancySizeV );
+  int lastOccupiedTileIndex          = -1;
+  int lastOccupiedTileIndexByPrevROI = -1;
   // loop over ROIs
   for ( int roiIndex = 0; roiIndex < numROIs; ++roiIndex ) {
-    tilesNotAvailable.clear();
-    if ( roiIndex > 0 ) {
-      lastOccupiedTileIndexByPrevROI = lastOccupiedTileIndex;
-      for ( int tileIndex = 0; tileIndex <= lastOccupiedTileIndexByPrevROI; ++tileIndex ) {
-        Tile tile;
-        tile.minU = ( tileIndex % numTilesHor ) * tileWidth;
-        tile.minV = ( tileIndex / numTilesHor ) * tileHeight;
-        tile.maxU = tile.minU + tileWidth - 1;
-        tile.maxV = tile.minV + tileHeight - 1;
-        tilesNotAvailable.push_back( tile );
-      }
-    }
+    // the tiles occupied by the previous ROIs are skipped
+    if ( roiIndex > 0 ) { lastOccupiedTileIndexByPrevROI = lastOccupiedTileIndex; }
     // loop over patches of current ROI
     for ( auto& patch : patches ) {
       if ( roiIndex != patch.getRoiIndex() ) { continue; }
@@ -2508,33 +2590,16 @@ void PCCEncoder::packMultipleTiles( PCCAtlasFrameContext& atlasFrame, int safegu
           tile.maxU = tile.minU + tileWidth - 1;
           tile.minV = ( tileIndex / numTilesHor ) * tileHeight;
           tile.maxV = tile.minV + tileHeight - 1;
-          for ( int v = 0; v <= occupancySizeV && !locationFound; ++v ) {
-            for ( int u = 0; u <= occupancySizeU && !locationFound; ++u ) {
-              patch.setU0( u );
-              patch.setV0( v );
-              bool tileIsAvailable = true;
-              if ( roiIndex > 0 ) {
-                for ( auto& tile : tilesNotAvailable ) {
-                  if ( ( tile.minU <= u && u <= tile.maxU ) && ( tile.minV <= v && v <= tile.maxV ) &&
-                       ( !locationFound ) ) {
-                    tileIsAvailable = false;
-                    break;
-                  }
-                }
-              }
-              if ( tileIsAvailable ) {
-                if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
-                                                safeguard, tile ) ) {
-                  locationFound = true;
-                  if ( tileIndex > lastOccupiedTileIndex ) { lastOccupiedTileIndex = tileIndex; }
-                  std::cout << "intra: ROI[" << roiIndex << "] patch " << patch.getIndex() << "\t@(" << patch.getU0()
-                            << "," << patch.getV0() << ")\ts(" << patch.getSizeU0() << "x" << patch.getSizeV0()
-                            << ")\to" << patch.getPatchOrientation() << " fitted in tile-" << tileIndex + 1 << "/"
-                            << numTilesAvailable << "-----[" << tile.minU << "," << tile.maxU << "][" << tile.minV
-                            << "," << tile.maxV << "]" << std::endl;
-                }
-              }
-            }
+          // a fit lies in the tile, so never in the tiles of the previous ROIs which come before it
+          if ( patch.findFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
+                                         {PATCH_ORIENTATION_DEFAULT}, safeguard, tile, params_.nbThread_ ) ) {
+            locationFound = true;
+            if ( tileIndex > lastOccupiedTileIndex ) { lastOccupiedTileIndex = tileIndex; }
+            std::cout << "intra: ROI[" << roiIndex << "] patch " << patch.getIndex() << "\t@(" << patch.getU0() << ","
+                      << patch.getV0() << ")\ts(" << patch.getSizeU0() << "x" << patch.getSizeV0() << ")\to"
+                      << patch.getPatchOrientation() << " fitted in tile-" << tileIndex + 1 << "/" << numTilesAvailable
+                      << "-----[" << tile.minU << "," << tile.maxU << "][" << tile.minV << "," << tile.maxV << "]"
+                      << std::endl;
           }
         }
         if ( !locationFound ) {
@@ -2546,8 +2611,7 @@ void PCCEncoder::packMultipleTiles( PCCAtlasFrameContext& atlasFrame, int safegu
         const size_t v = patch.getV0() + v0;
         for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
           const size_t u = patch.getU0() + u0;
-          occupancyMap[v * occupancySizeU + u] =
-              occupancyMap[v * occupancySizeU + u] || occupancy[v0 * patch.getSizeU0() + u0];
+          if ( occupancy[v0 * patch.getSizeU0() + u0] ) { occupancyMap.set( v * occupancySizeU + u ); }
         }
       }
       height          = (std::max)( height, ( patch.getV0() + patch.getSizeV0() ) * patch.getOccupancyResolution() );
@@ -2596,12 +2660,12 @@ void PCCEncoder::packFlexibleMultipleTiles( PCCAtlasFrameContext& atlasFrame,
 
   // initializating the tile map to -1 (not assigned)
   partitionToTileMap.resize( numTilesHor * numTilesVer, -1 );
-  width                             = occupancySizeU * params_.occupancyResolution_;
-  height                            = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
-  int               numOrientations = params_.useEightOrientations_ ? 8 : 2;
-  occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+  width                              = occupancySizeU * params_.occupancyResolution_;
+  height                             = occupancySizeV * params_.occupancyResolution_;
+  size_t             maxOccupancyRow = 0;
+  PCCOccupancyCanvas occupancyMap;
+  int                numOrientations = params_.useEightOrientations_ ? 8 : 2;
+  occupancyMap.resize( occupancySizeU * occupancySizeV );
   std::vector<Tile> tilesNotAvailable;
   int               lastOccupiedTileIndex          = -1;
   int               lastOccupiedTileIndexByPrevROI = -1;
@@ -2675,30 +2739,17 @@ void PCCEncoder::packFlexibleMultipleTiles( PCCAtlasFrameContext& atlasFrame,
             tile.minV = (tileStartPosV)*tileHeight;
             tile.maxV = tile.minV + tileHeight * (numTilesInTileVert)-1;
             // now look for a possible position in the defined tile group
-            for ( size_t v = 0; v < occupancySizeV && !locationFound; ++v ) {
-              for ( size_t u = 0; u < occupancySizeU && !locationFound; ++u ) {
-                patch.setU0( u );
-                patch.setV0( v );
-                for ( size_t orientationIdx = 0; orientationIdx < numOrientations && !locationFound;
-                      orientationIdx++ ) {
-                  if ( patch.getSizeU0() > patch.getSizeV0() ) {
-                    patch.setPatchOrientation( g_orientationHorizontal[orientationIdx] );
-                  } else {
-                    patch.setPatchOrientation( g_orientationVertical[orientationIdx] );
-                  }
-                  if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV,
-                                                  params_.lowDelayEncoding_, safeguard, tile ) ) {
-                    locationFound = true;
-                    std::cout << "intra: ROI[" << roiIndex << "] patch " << patch.getIndex() << "\t@(" << patch.getU0()
-                              << "," << patch.getV0() << ")\ts(" << patch.getSizeU0() << "x" << patch.getSizeV0()
-                              << ")\to" << patch.getPatchOrientation() << " fitted in tile-[" << tile.minU << ","
-                              << tile.maxU << "][" << tile.minV << "," << tile.maxV << "]" << std::endl;
-                    if ( g_printDetailedInfo ) {
-                      std::cout << "Orientation " << patch.getPatchOrientation() << " selected for patch "
-                                << patch.getIndex() << " (" << u << "," << v << ")" << std::endl;
-                    }
-                  }
-                }
+            if ( patch.findFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
+                                           getPackingOrientations( patch, false, numOrientations ), safeguard, tile,
+                                           params_.nbThread_ ) ) {
+              locationFound = true;
+              std::cout << "intra: ROI[" << roiIndex << "] patch " << patch.getIndex() << "\t@(" << patch.getU0()
+                        << "," << patch.getV0() << ")\ts(" << patch.getSizeU0() << "x" << patch.getSizeV0() << ")\to"
+                        << patch.getPatchOrientation() << " fitted in tile-[" << tile.minU << "," << tile.maxU << "]["
+                        << tile.minV << "," << tile.maxV << "]" << std::endl;
+              if ( g_printDetailedInfo ) {
+                std::cout << "Orientation " << patch.getPatchOrientation() << " selected for patch "
+                          << patch.getIndex() << " (" << patch.getU0() << "," << patch.getV0() << ")" << std::endl;
               }
             }
           }
@@ -2716,10 +2767,7 @@ void PCCEncoder::packFlexibleMultipleTiles( PCCAtlasFrameContext& atlasFrame,
       for ( size_t v0 = 0; v0 < patch.getSizeV0(); ++v0 ) {
         for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
           int coord = patch.patchBlock2CanvasBlock( u0, v0, occupancySizeU, occupancySizeV );
-          if ( params_.lowDelayEncoding_ )
-            occupancyMap[coord] = true;
-          else
-            occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * patch.getSizeU0() + u0];
+          if ( params_.lowDelayEncoding_ || occupancy[v0 * patch.getSizeU0() + u0] ) { occupancyMap.set( coord ); }
           // also claim the tile for the ROI
           size_t x, y;
           patch.patch2Canvas( u0, v0, occupancySizeU * patch.getOccupancyResolution(),
@@ -2836,19 +2884,18 @@ void PCCEncoder::spatialConsistencyPackMultipleTiles( PCCAtlasFrameContext& atla
   int tileHeight  = int( tileWidth * params_.tileHeightToWidthRatio_ );
   if ( params_.enablePointCloudPartitioning_ )
     std::cout << "frame " << frame.getFrameIndex() << " tilesize: " << tileWidth << "x" << tileHeight << std::endl;
-  occupancySizeV                    = ( occupancySizeV >= tileHeight ) ? occupancySizeV : tileHeight;
-  width                             = occupancySizeU * params_.occupancyResolution_;
-  height                            = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
-  occupancyMap.resize( occupancySizeU * occupancySizeV, false );
-  std::vector<Tile> tilesNotAvailable;
-  int               numROIs                        = params_.numROIs_;
-  int               lastOccupiedTileIndex          = -1;
-  int               lastOccupiedTileIndexHor       = -1;
-  int               lastOccupiedTileIndexVer       = -1;
-  int               lastOccupiedTileIndexByPrevROI = -1;
-  int               numTilesAvailable;
+  occupancySizeV                     = ( occupancySizeV >= tileHeight ) ? occupancySizeV : tileHeight;
+  width                              = occupancySizeU * params_.occupancyResolution_;
+  height                             = occupancySizeV * params_.occupancyResolution_;
+  size_t             maxOccupancyRow = 0;
+  PCCOccupancyCanvas occupancyMap;
+  occupancyMap.resize( occupancySizeU * occupancySizeV );
+  int numROIs                        = params_.numROIs_;
+  int lastOccupiedTileIndex          = -1;
+  int lastOccupiedTileIndexHor       = -1;
+  int lastOccupiedTileIndexVer       = -1;
+  int lastOccupiedTileIndexByPrevROI = -1;
+  int numTilesAvailable;
   // loop over ROIs
   for ( size_t roiIndex = 0; roiIndex < numROIs; ++roiIndex ) {
     // find top left corner to start placing the tile group, and determine the maximum horizontal size
@@ -2872,33 +2919,16 @@ void PCCEncoder::spatialConsistencyPackMultipleTiles( PCCAtlasFrameContext& atla
               tile.maxU = tile.minU + tileWidth - 1;
               tile.minV = ( tileIndex / numTilesHor ) * tileHeight;
               tile.maxV = tile.minV + tileHeight - 1;
-              for ( size_t v = 0; v <= occupancySizeV && !locationFound; ++v ) {
-                for ( size_t u = 0; u <= occupancySizeU && !locationFound; ++u ) {
-                  patch.setU0( u );
-                  patch.setV0( v );
-                  bool tileIsAvailable = true;
-                  if ( roiIndex > 0 ) {
-                    for ( auto& tile : tilesNotAvailable ) {
-                      if ( ( tile.minU <= u && u <= tile.maxU ) && ( tile.minV <= v && v <= tile.maxV ) &&
-                           ( !locationFound ) ) {
-                        tileIsAvailable = false;
-                        break;
-                      }
-                    }
-                  }
-                  if ( tileIsAvailable ) {
-                    if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV,
-                                                    params_.lowDelayEncoding_, safeguard, tile ) ) {
-                      locationFound = true;
-                      if ( tileIndex > lastOccupiedTileIndex ) { lastOccupiedTileIndex = tileIndex; }
-                      std::cout << "ROI[" << roiIndex << "] patch " << patch.getIndex() << "\t@(" << patch.getU0()
-                                << "," << patch.getV0() << ")\ts(" << patch.getSizeU0() << "x" << patch.getSizeV0()
-                                << ")\to" << patch.getPatchOrientation() << " fitted in tile-" << tileIndex + 1 << "/"
-                                << numTilesAvailable << "-----[" << tile.minU << "," << tile.maxU << "][" << tile.minV
-                                << "," << tile.maxV << "] +-+-+-+-+-(NOT MATCHED patch)-+-+-+-+-+" << std::endl;
-                    }
-                  }
-                }
+              // a fit lies in the tile, so never in the tiles of the previous ROIs which come before it
+              if ( patch.findFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
+                                             {PATCH_ORIENTATION_DEFAULT}, safeguard, tile, params_.nbThread_ ) ) {
+                locationFound = true;
+                if ( tileIndex > lastOccupiedTileIndex ) { lastOccupiedTileIndex = tileIndex; }
+                std::cout << "ROI[" << roiIndex << "] patch " << patch.getIndex() << "\t@(" << patch.getU0() << ","
+                          << patch.getV0() << ")\ts(" << patch.getSizeU0() << "x" << patch.getSizeV0() << ")\to"
+                          << patch.getPatchOrientation() << " fitted in tile-" << tileIndex + 1 << "/"
+                          << numTilesAvailable << "-----[" << tile.minU << "," << tile.maxU << "][" << tile.minV
+                          << "," << tile.maxV << "] +-+-+-+-+-(NOT MATCHED patch)-+-+-+-+-+" << std::endl;
               }
             }
             if ( !locationFound ) {
@@ -2910,8 +2940,7 @@ void PCCEncoder::spatialConsistencyPackMultipleTiles( PCCAtlasFrameContext& atla
             const size_t v = patch.getV0() + v0;
             for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
               const size_t u = patch.getU0() + u0;
-              occupancyMap[v * occupancySizeU + u] =
-                  occupancyMap[v * occupancySizeU + u] || occupancy[v0 * patch.getSizeU0() + u0];
+              if ( occupancy[v0 * patch.getSizeU0() + u0] ) { occupancyMap.set( v * occupancySizeU + u ); }
             }
           }
           height = (std::max)( height, ( patch.getV0() + patch.getSizeV0() ) * patch.getOccupancyResolution() );
@@ -3011,12 +3040,12 @@ void PCCEncoder::spatialConsistencyPackFlexibleMultipleTiles( PCCAtlasFrameConte
   int numTilesVer = occupancySizeV / tileHeight;
   // initializating the tile map to -1 (not assigned)
   partitionToTileMap.resize( numTilesHor * numTilesVer, -1 );
-  width                             = occupancySizeU * params_.occupancyResolution_;
-  height                            = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  int               numOrientations = params_.useEightOrientations_ ? 8 : 2;
-  std::vector<bool> occupancyMap;
-  occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+  width                              = occupancySizeU * params_.occupancyResolution_;
+  height                             = occupancySizeV * params_.occupancyResolution_;
+  size_t             maxOccupancyRow = 0;
+  int                numOrientations = params_.useEightOrientations_ ? 8 : 2;
+  PCCOccupancyCanvas occupancyMap;
+  occupancyMap.resize( occupancySizeU * occupancySizeV );
   // loop over ROIs
   bool isCurrent_ROI_empty = true;
   for ( size_t roiIndex = 0; roiIndex < numROIs; ++roiIndex ) {
@@ -3119,23 +3148,19 @@ void PCCEncoder::spatialConsistencyPackFlexibleMultipleTiles( PCCAtlasFrameConte
                 tile.minV = (tileStartPosV)*tileHeight;
                 tile.maxV = tile.minV + tileHeight * (numTilesInTileVert)-1;
                 // now look for a possible position in the defined tile group
-                for ( size_t v = 0; v < occupancySizeV && !locationFound; ++v ) {
-                  for ( size_t u = 0; u < occupancySizeU && !locationFound; ++u ) {
-                    patch.setU0( u );
-                    patch.setV0( v );
-                    if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV,
-                                                    params_.lowDelayEncoding_, safeguard, tile ) ) {
-                      locationFound = true;
-                      std::cout << "inter: ROI[" << roiIndex << "] patch " << patch.getIndex() << "\t@("
-                                << patch.getU0() << "," << patch.getV0() << ")\ts(" << patch.getSizeU0() << "x"
-                                << patch.getSizeV0() << ")\to" << patch.getPatchOrientation() << " fitted in tile-["
-                                << tile.minU << "," << tile.maxU << "][" << tile.minV << "," << tile.maxV << "]"
-                                << " +-+-+-+-+-(MATCHED patch placed on new position)-+-+-+-+-+" << std::endl;
-                      if ( g_printDetailedInfo ) {
-                        std::cout << "Orientation " << patch.getPatchOrientation() << " selected for patch "
-                                  << patch.getIndex() << " (" << u << "," << v << ")" << std::endl;
-                      }
-                    }
+                if ( patch.findFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV,
+                                               params_.lowDelayEncoding_, {patch.getPatchOrientation()}, safeguard,
+                                               tile, params_.nbThread_ ) ) {
+                  locationFound = true;
+                  std::cout << "inter: ROI[" << roiIndex << "] patch " << patch.getIndex() << "\t@(" << patch.getU0()
+                            << "," << patch.getV0() << ")\ts(" << patch.getSizeU0() << "x" << patch.getSizeV0()
+                            << ")\to" << patch.getPatchOrientation() << " fitted in tile-[" << tile.minU << ","
+                            << tile.maxU << "][" << tile.minV << "," << tile.maxV << "]"
+                            << " +-+-+-+-+-(MATCHED patch placed on new position)-+-+-+-+-+" << std::endl;
+                  if ( g_printDetailedInfo ) {
+                    std::cout << "Orientation " << patch.getPatchOrientation() << " selected for patch "
+                              << patch.getIndex() << " (" << patch.getU0() << "," << patch.getV0() << ")"
+                              << std::endl;
                   }
                 }
               }
@@ -3154,31 +3179,17 @@ void PCCEncoder::spatialConsistencyPackFlexibleMultipleTiles( PCCAtlasFrameConte
               tile.minV = (tileStartPosV)*tileHeight;
               tile.maxV = tile.minV + tileHeight * (numTilesInTileVert)-1;
               // now look for a possible position in the defined tile group
-              for ( size_t v = 0; v < occupancySizeV && !locationFound; ++v ) {
-                for ( size_t u = 0; u < occupancySizeU && !locationFound; ++u ) {
-                  patch.setU0( u );
-                  patch.setV0( v );
-                  for ( size_t orientationIdx = 0; orientationIdx < numOrientations && !locationFound;
-                        orientationIdx++ ) {
-                    if ( patch.getSizeU0() > patch.getSizeV0() ) {
-                      patch.setPatchOrientation( g_orientationHorizontal[orientationIdx] );
-                    } else {
-                      patch.setPatchOrientation( g_orientationVertical[orientationIdx] );
-                    }
-                    if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV,
-                                                    params_.lowDelayEncoding_, safeguard, tile ) ) {
-                      locationFound = true;
-                      std::cout << "intra: ROI[" << roiIndex << "] patch " << patch.getIndex() << "\t@("
-                                << patch.getU0() << "," << patch.getV0() << ")\ts(" << patch.getSizeU0() << "x"
-                                << patch.getSizeV0() << ")\to" << patch.getPatchOrientation() << " fitted in tile-["
-                                << tile.minU << "," << tile.maxU << "][" << tile.minV << "," << tile.maxV << "]"
-                                << std::endl;
-                      if ( g_printDetailedInfo ) {
-                        std::cout << "Orientation " << patch.getPatchOrientation() << " selected for patch "
-                                  << patch.getIndex() << " (" << u << "," << v << ")" << std::endl;
-                      }
-                    }
-                  }
+              if ( patch.findFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
+                                             getPackingOrientations( patch, false, numOrientations ), safeguard, tile,
+                                             params_.nbThread_ ) ) {
+                locationFound = true;
+                std::cout << "intra: ROI[" << roiIndex << "] patch " << patch.getIndex() << "\t@(" << patch.getU0()
+                          << "," << patch.getV0() << ")\ts(" << patch.getSizeU0() << "x" << patch.getSizeV0()
+                          << ")\to" << patch.getPatchOrientation() << " fitted in tile-[" << tile.minU << ","
+                          << tile.maxU << "][" << tile.minV << "," << tile.maxV << "]" << std::endl;
+                if ( g_printDetailedInfo ) {
+                  std::cout << "Orientation " << patch.getPatchOrientation() << " selected for patch "
+                            << patch.getIndex() << " (" << patch.getU0() << "," << patch.getV0() << ")" << std::endl;
                 }
               }
             }
@@ -3200,9 +3211,9 @@ void PCCEncoder::spatialConsistencyPackFlexibleMultipleTiles( PCCAtlasFrameConte
         for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
           int coord = patch.patchBlock2CanvasBlock( u0, v0, occupancySizeU, occupancySizeV );
           if ( params_.lowDelayEncoding_ ) {
-            occupancyMap[coord] = true;
-          } else {
-            occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * patch.getSizeU0() + u0];
+            occupancyMap.set( coord );
+          } else if ( occupancy[v0 * patch.getSizeU0() + u0] ) {
+            occupancyMap.set( coord );
           }
           // also claim the tile for the ROI
           size_t x, y;
@@ -3265,26 +3276,26 @@ void PCCEncoder::packTetris( PCCFrameContext& frame, size_t presetWidth, size_t
   // sorting by patch largest dimension
   std::sort( patches.begin(), patches.end(), []( PCCPatch& a, PCCPatch& b ) { return a.gt( b ); } );
   if ( g_printDetailedInfo ) {
-    std::cout << "Patch order:" << std::endl;
+    *g_packingLog << "Patch order:" << std::endl;
     for ( auto& patch : patches ) {
-      std::cout << "Patch[" << patch.getIndex() << "]=(" << patch.getSizeU0() << "," << patch.getSizeV0() << ")"
-                << std::endl;
+      *g_packingLog << "Patch[" << patch.getIndex() << "]=(" << patch.getSizeU0() << "," << patch.getSizeV0() << ")"
+                    << std::endl;
     }
   }
   size_t occupancySizeU = presetWidth / params_.occupancyResolution_;
   size_t occupancySizeV = (std::max)( patches[0].getSizeV0(), patches[0].getSizeU0() );
   for ( auto& patch : patches ) { occupancySizeU = (std::max)( occupancySizeU, patch.getSizeU0() + 1 ); }
-  width                             = occupancySizeU * params_.occupancyResolution_;
-  height                            = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
-  occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+  width                              = occupancySizeU * params_.occupancyResolution_;
+  height                             = occupancySizeV * params_.occupancyResolution_;
+  size_t             maxOccupancyRow = 0;
+  PCCOccupancyCanvas occupancyMap;
+  occupancyMap.resize( occupancySizeU * occupancySizeV );
   std::vector<int> horizon;
   horizon.resize( occupancySizeU, 0 );
   if ( g_printDetailedInfo ) {
-    std::cout << "Horizon :[";
-    for ( int i = 0; i < occupancySizeU; i++ ) { std::cout << horizon[i] << ","; }
-    std::cout << "]" << std::endl;
+    *g_packingLog << "Horizon :[";
+    for ( int i = 0; i < occupancySizeU; i++ ) { *g_packingLog << horizon[i] << ","; }
+    *g_packingLog << "]" << std::endl;
   }
   for ( auto& patch : patches ) {
     assert( patch.getSizeU0() <= occupancySizeU );
@@ -3313,20 +3324,20 @@ void PCCEncoder::packTetris( PCCFrameContext& frame, size_t presetWidth, size_t
             patch.setPatchOrientation( g_orientationVertical[orientationIdx] );
             if ( !patch.isPatchLocationAboveHorizon( horizon, topHorizon, bottomHorizon, rightHorizon, leftHorizon ) ) {
               if ( g_printDetailedInfo ) {
-                std::cout << "(" << u << "," << v << "|" << patch.getPatchOrientation() << ") above horizon"
-                          << std::endl;
+                *g_packingLog << "(" << u << "," << v << "|" << patch.getPatchOrientation() << ") above horizon"
+                              << std::endl;
               }
               continue;
             }
             if ( g_printDetailedInfo ) {
-              std::cout << "(" << u << "," << v << "|" << patch.getPatchOrientation() << ")" << std::endl;
+              *g_packingLog << "(" << u << "," << v << "|" << patch.getPatchOrientation() << ")" << std::endl;
             }
             if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
                                             safeguard ) ) {
               // now calculate the wasted space
               int wasted_space =
                   patch.calculateWastedSpace( horizon, topHorizon, bottomHorizon, rightHorizon, leftHorizon );
-              if ( g_printDetailedInfo ) { std::cout << "(wasted space) = " << wasted_space << std::endl; }
+              if ( g_printDetailedInfo ) { *g_packingLog << "(wasted space) = " << wasted_space << std::endl; }
               if ( wasted_space < best_wasted_space ) {
                 best_wasted_space = wasted_space;
                 bestU             = u;
@@ -3342,7 +3353,7 @@ void PCCEncoder::packTetris( PCCFrameContext& frame, size_t presetWidth, size_t
         occupancySizeV *= 2;
         occupancyMap.resize( occupancySizeU * occupancySizeV );
         if ( g_printDetailedInfo ) {
-          std::cout << "Increasing frame size (" << occupancySizeU << "," << occupancySizeV << ")" << std::endl;
+          *g_packingLog << "Increasing frame size (" << occupancySizeU << "," << occupancySizeV << ")" << std::endl;
         }
       } else {
         // select the best position and orientation
@@ -3350,16 +3361,16 @@ void PCCEncoder::packTetris( PCCFrameContext& frame, size_t presetWidth, size_t
         patch.setV0( bestV );
         patch.setPatchOrientation( bestOrientation );
         if ( g_printDetailedInfo ) {
-          std::cout << "Selected position (" << bestU << "," << bestV << ") and orientation " << bestOrientation
-                    << "(wasted space=" << best_wasted_space << ")" << std::endl;
+          *g_packingLog << "Selected position (" << bestU << "," << bestV << ") and orientation " << bestOrientation
+                        << "(wasted space=" << best_wasted_space << ")" << std::endl;
         }
         // update the horizon
         patch.updateHorizon( horizon, topHorizon, bottomHorizon, rightHorizon, leftHorizon );
         // debugging
         if ( g_printDetailedInfo ) {
-          std::cout << "Horizon :[";
-          for ( int i = 0; i < occupancySizeU; i++ ) { std::cout << horizon[i] << ","; }
-          std::cout << "]" << std::endl;
+          *g_packingLog << "Horizon :[";
+          for ( int i = 0; i < occupancySizeU; i++ ) { *g_packingLog << horizon[i] << ","; }
+          *g_packingLog << "]" << std::endl;
         }
       }
     }
@@ -3367,9 +3378,9 @@ void PCCEncoder::packTetris( PCCFrameContext& frame, size_t presetWidth, size_t
       for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
         int coord = patch.patchBlock2CanvasBlock( u0, v0, occupancySizeU, occupancySizeV );
         if ( params_.lowDelayEncoding_ ) {
-          occupancyMap[coord] = true;
-        } else {
-          occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * patch.getSizeU0() + u0];
+          occupancyMap.set( coord );
+        } else if ( occupancy[v0 * patch.getSizeU0() + u0] ) {
+          occupancyMap.set( coord );
         }
       }
     }
@@ -3393,16 +3404,16 @@ void PCCEncoder::packTetris( PCCFrameContext& frame, size_t presetWidth, size_t
     packEOMAttributePointsPatch( frame, occupancyMap, width, height, occupancySizeU, occupancySizeV, maxOccupancyRow );
   }
   if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV ); }
-  std::cout << "actualImageSize(packTetris) " << width << " x " << height << std::endl;
+  *g_packingLog << "actualImageSize(packTetris) " << width << " x " << height << std::endl;
 }
 
-void PCCEncoder::packEOMAttributePointsPatch( PCCFrameContext&   frame,
-                                              std::vector<bool>& occupancyMap,
-                                              size_t             width,
-                                              size_t&            height,
-                                              size_t             occupancySizeU,
-                                              size_t             occupancySizeV,
-                                              size_t             maxOccupancyRow ) {
+void PCCEncoder::packEOMAttributePointsPatch( PCCFrameContext&    frame,
+                                              PCCOccupancyCanvas& occupancyMap,
+                                              size_t              width,
+                                              size_t&             height,
+                                              size_t              occupancySizeU,
+                                              size_t              occupancySizeV,
+                                              size_t              maxOccupancyRow ) {
   if ( !params_.useRawPointsSeparateVideo_ ) { assert( width == frame.getWidth() ); }
   auto&  eomPatches = frame.getEomPatches();
   size_t lastHeight = height;
@@ -3472,13 +3483,13 @@ size_t PCCEncoder::packRawPointsPatchSimple( PCCFrameContext& tile,
   return totalHeight;
 }
 
-size_t PCCEncoder::packRawPointsPatch( PCCFrameContext&   tile,
-                                       std::vector<bool>& occupancyMap,
-                                       size_t             width,
-                                       size_t&            height,
-                                       size_t             occupancySizeU,
-                                       size_t             occupancySizeV,
-                                       size_t             maxOccupancyRow ) {
+size_t PCCEncoder::packRawPointsPatch( PCCFrameContext&    tile,
+                                       PCCOccupancyCanvas& occupancyMap,
+                                       size_t              width,
+                                       size_t&             height,
+                                       size_t              occupancySizeU,
+                                       size_t              occupancySizeV,
+                                       size_t              maxOccupancyRow ) {
   size_t numberOfRawPointsPatches = tile.getNumberOfRawPointsPatches();
   size_t safeguard                = 0;
   for ( int i = 0; i < numberOfRawPointsPatches; i++ ) {
@@ -3521,17 +3532,15 @@ size_t PCCEncoder::packRawPointsPatch( PCCFrameContext&   tile,
     // now placing the raw points patch in the atlas
     bool locationFound = false;
     while ( !locationFound ) {
-      patch.setPatchOrientation( PATCH_ORIENTATION_DEFAULT );
-      for ( int v = maxOccupancyRow; v <= occupancySizeV && !locationFound; ++v ) {
-        for ( int u = 0; u <= occupancySizeU && !locationFound; ++u ) {
-          patch.setU0( u );
-          patch.setV0( v );
-          if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
-                                          safeguard ) ) {
-            locationFound = true;
-          }
-        }
-      }
+      // the rows below maxOccupancyRow, as a tile covering the canvas width
+      Tile rows;
+      rows.minU     = 0;
+      rows.maxU     = int( occupancySizeU ) - 1;
+      rows.minV     = int( maxOccupancyRow );
+      rows.maxV     = int( occupancySizeV ) - 1;
+      locationFound = patch.findFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV,
+                                                params_.lowDelayEncoding_, {PATCH_ORIENTATION_DEFAULT}, safeguard, rows,
+                                                params_.nbThread_ );
       if ( !locationFound ) {
         occupancySizeV *= 2;
         occupancyMap.resize( occupancySizeU * occupancySizeV );
@@ -3544,10 +3553,11 @@ size_t PCCEncoder::packRawPointsPatch( PCCFrameContext&   tile,
       for ( size_t u0 = 0; u0 < rawPointsPatch.sizeU0_; ++u0 ) {
         const size_t u = rawPointsPatch.u0_ + u0;
         if ( params_.lowDelayEncoding_ ) {
-          occupancyMap[v * occupancySizeU + u] = true;
+          occupancyMap.set( v * occupancySizeU + u );
         } else {
-          occupancyMap[v * occupancySizeU + u] =
-              occupancyMap[v * occupancySizeU + u] || rawPointsPatchOccupancy[v0 * rawPointsPatch.sizeU0_ + u0];
+          if ( rawPointsPatchOccupancy[v0 * rawPointsPatch.sizeU0_ + u0] ) {
+            occupancyMap.set( v * occupancySizeU + u );
+          }
         }
       }
       height = (std::max)( height, ( patch.getV0() + patch.getSizeV0() ) * params_.occupancyResolution_ );
@@ -3693,7 +3703,7 @@ bool PCCEncoder::generateSegments( const PCCPointSet3&                 source,
     PCCPatchSegmenter3 segmenter;
     segmenter.setNbThread( params_.nbThread_ );
     segmenter.compute( source, frame.getFrameIndex(), segmenterParams, patches, frame.getSrcPointCloudByPatch(),
-                       distanceSrcRec );
+                       distanceSrcRec, frameContext.getSourceKdTree() );
   } else {
     segmentationPartiallyAddtinalProjectionPlane( source, frame, segmenterParams, frameIndex, distanceSrcRec );
   }
@@ -4428,13 +4438,13 @@ void PCCEncoder::placeAuxiliaryPointsTiles( PCCContext& context ) {
     // set height
     for ( size_t tileIdx = 0; tileIdx < numTilesInSeg; tileIdx++ ) {
       for ( size_t frameIdx = firstFrame; frameIdx < lastFrame; frameIdx++ ) {
-        auto&             tile = context[frameIdx].getTile( tileIdx );
-        std::vector<bool> auxPointsOccupancyMap;
-        size_t            auxPointsOccupancySizeU = maxWidth / params_.occupancyResolution_;
-        size_t            auxPointsOccupancySizeV = 1;
-        size_t            auxPointsTileHeight     = 0;
-        size_t            auxPointsTileWidth      = maxWidth;
-        auxPointsOccupancyMap.resize( auxPointsOccupancySizeU * auxPointsOccupancySizeV, false );
+        auto&              tile = context[frameIdx].getTile( tileIdx );
+        PCCOccupancyCanvas auxPointsOccupancyMap;
+        size_t             auxPointsOccupancySizeU = maxWidth / params_.occupancyResolution_;
+        size_t             auxPointsOccupancySizeV = 1;
+        size_t             auxPointsTileHeight     = 0;
+        size_t             auxPointsTileWidth      = maxWidth;
+        auxPointsOccupancyMap.resize( auxPointsOccupancySizeU * auxPointsOccupancySizeV );
         if ( tile.getRawPointsPatches().size() == 0 ) {
           printf( "packRawPointsPatch[0/0]: none\n" );
         } else {
@@ -4677,6 +4687,7 @@ bool PCCEncoder::generateSegments( const PCCGroupOfFrames& sources, PCCContext&
   params.voxelDimensionGridBasedSegmentation_ = params_.voxelDimensionGridBasedSegmentation_;
   params.nnNormalEstimation_                  = params_.nnNormalEstimation_;
   params.normalOrientation_                   = params_.normalOrientation_;
+  params.normalEigenSolver_                   = params_.normalEigenSolver_;
   params.gridBasedRefineSegmentation_         = params_.gridBasedRefineSegmentation_;
   params.maxNNCountRefineSegmentation_        = params_.maxNNCountRefineSegmentation_;
   params.iterationCountRefineSegmentation_    = params_.iterationCountRefineSegmentation_;
@@ -4765,48 +4776,73 @@ bool PCCEncoder::placeSegments( const PCCGroupOfFrames& sources, PCCContext& con
     generateTilesFromImage( context );
   } else {
     if ( params_.numMaxTilePerFrame_ > 1 ) { generateTilesFromSegments( context ); }
+    // the tiles hold disjoint patches and a tile is only packed against the same tile of the previous frame: the
+    // tiles are packed concurrently, the global patch allocation then processes them one by one. The packing logs of
+    // each tile are collected and printed in tile order, as the serial packing prints them.
+    std::vector<size_t>      initTileWidth( params_.numMaxTilePerFrame_ );
+    std::vector<size_t>      initTileHeight( params_.numMaxTilePerFrame_ );
+    std::vector<std::string> tileLogs( params_.numMaxTilePerFrame_ );
+#if defined( ENABLE_TBB )
+    tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
+    limited.execute( [&] {
+      tbb::parallel_for( size_t( 0 ), params_.numMaxTilePerFrame_, [&]( const size_t tileIdx ) {
+#else
     for ( size_t tileIdx = 0; tileIdx < params_.numMaxTilePerFrame_; tileIdx++ ) {
-      size_t initTileWidth  = context.getFrame( 0 ).getTile( tileIdx ).getWidth();
-      size_t initTileHeight = context.getFrame( 0 ).getTile( tileIdx ).getHeight();
-      for ( size_t frameIndex = 0; frameIndex < context.size(); frameIndex++ ) {
-        if ( sources[frameIndex].getPointCount() == 0u ) { 
-          std::cout<<"Allow processing a empty frame"<<endl;
-        }
-        auto&  tile       = context.getFrame( frameIndex ).getTile( tileIdx );
-        size_t tileWidth  = tile.getWidth();
-        size_t tileHeight = tile.getHeight();
-        size_t preIndex   = frameIndex > 0 ? ( frameIndex - 1 ) : 0;
-        auto&  prevTile   = context.getFrame( preIndex ).getTile( tileIdx );
-        if ( params_.levelOfDetailX_ > 1 || params_.levelOfDetailY_ > 1 ) { generateScaledGeometry( tile ); }
-        if ( params_.occupancyMapRefinement_ ) { refineOccupancyMap( tile ); }
-        if ( ( frameIndex == 0 ) || ( !params_.constrainedPack_ ) ) {
-          if ( params_.packingStrategy_ < 2 ) {
-            packFlexible( tile, params_.packingStrategy_, tileWidth, tileHeight, params_.safeGuardDistance_,
-                          params_.enablePointCloudPartitioning_ );
-          } else if ( params_.packingStrategy_ == 2 ) {
-            packTetris( tile, tileWidth, tileHeight, params_.safeGuardDistance_ );
+#endif
+        std::ostringstream tileLog;
+        std::ostream*      previousLog = g_packingLog;
+        g_packingLog                   = &tileLog;
+        initTileWidth[tileIdx]         = context.getFrame( 0 ).getTile( tileIdx ).getWidth();
+        initTileHeight[tileIdx]        = context.getFrame( 0 ).getTile( tileIdx ).getHeight();
+        for ( size_t frameIndex = 0; frameIndex < context.size(); frameIndex++ ) {
+          if ( sources[frameIndex].getPointCount() == 0u ) { 
+            *g_packingLog<<"Allow processing a empty frame"<<endl;
           }
-        } else {
-          if ( params_.packingStrategy_ < 2 ) {
-            if ( params_.globalPatchAllocation_ == 2 ) {
-              findMatchesForGlobalTetrisPacking( tile, prevTile );
-            } else {
-              spatialConsistencyPackFlexible( tile, prevTile, params_.packingStrategy_, tileWidth, tileHeight,
-                                              params_.safeGuardDistance_, params_.enablePointCloudPartitioning_ );
+          auto&  tile       = context.getFrame( frameIndex ).getTile( tileIdx );
+          size_t tileWidth  = tile.getWidth();
+          size_t tileHeight = tile.getHeight();
+          size_t preIndex   = frameIndex > 0 ? ( frameIndex - 1 ) : 0;
+          auto&  prevTile   = context.getFrame( preIndex ).getTile( tileIdx );
+          if ( params_.levelOfDetailX_ > 1 || params_.levelOfDetailY_ > 1 ) { generateScaledGeometry( tile ); }
+          if ( params_.occupancyMapRefinement_ ) { refineOccupancyMap( tile ); }
+          if ( ( frameIndex == 0 ) || ( !params_.constrainedPack_ ) ) {
+            if ( params_.packingStrategy_ < 2 ) {
+              packFlexible( tile, params_.packingStrategy_, tileWidth, tileHeight, params_.safeGuardDistance_,
+                            params_.enablePointCloudPartitioning_ );
+            } else if ( params_.packingStrategy_ == 2 ) {
+              packTetris( tile, tileWidth, tileHeight, params_.safeGuardDistance_ );
             }
-          } else if ( params_.packingStrategy_ == 2 ) {
-            if ( params_.globalPatchAllocation_ == 2 ) {
-              findMatchesForGlobalTetrisPacking( tile, prevTile );  // this could also be a different prevFrame,
-              // it depends on the prediction structure
-            } else {
-              spatialConsistencyPackTetris( tile, prevTile, tileWidth, tileHeight, params_.safeGuardDistance_ );
+          } else {
+            if ( params_.packingStrategy_ < 2 ) {
+              if ( params_.globalPatchAllocation_ == 2 ) {
+                findMatchesForGlobalTetrisPacking( tile, prevTile );
+              } else {
+                spatialConsistencyPackFlexible( tile, prevTile, params_.packingStrategy_, tileWidth, tileHeight,
+                                                params_.safeGuardDistance_, params_.enablePointCloudPartitioning_ );
+              }
+            } else if ( params_.packingStrategy_ == 2 ) {
+              if ( params_.globalPatchAllocation_ == 2 ) {
+                findMatchesForGlobalTetrisPacking( tile, prevTile );  // this could also be a different prevFrame,
+                // it depends on the prediction structure
+              } else {
+                spatialConsistencyPackTetris( tile, prevTile, tileWidth, tileHeight, params_.safeGuardDistance_ );
+              }
             }
           }
-        }
-      }  // frame
+        }  // frame
 
-      // placing tiles in a frame
-      resizeTileGeometryVideo( context, tileIdx, initTileWidth, initTileHeight );
+        // placing tiles in a frame
+        resizeTileGeometryVideo( context, tileIdx, initTileWidth[tileIdx], initTileHeight[tileIdx] );
+        g_packingLog      = previousLog;
+        tileLogs[tileIdx] = tileLog.str();
+#if defined( ENABLE_TBB )
+      } );
+    } );
+#else
+    }
+#endif
+    for ( const auto& tileLog : tileLogs ) { std::cout << tileLog; }
+    for ( size_t tileIdx = 0; tileIdx < params_.numMaxTilePerFrame_; tileIdx++ ) {
       std::cout << "\t->tile " << tileIdx << " ImageSize " << context.getFrame( 0 ).getTile( tileIdx ).getWidth()
                 << " x " << context.getFrame( 0 ).getTile( tileIdx ).getHeight() << std::endl;
       if ( params_.globalPatchAllocation_ > 0 && context.getFrame( 0 ).getTile( tileIdx ).getPatches().size() > 0 ) {
@@ -4820,7 +4856,7 @@ bool PCCEncoder::placeSegments( const PCCGroupOfFrames& sources, PCCContext& con
         } else if ( params_.globalPatchAllocation_ == 2 ) {
           doGlobalTetrisPacking( context, tileIdx, tileWidth, tileHeight );
         }
-        resizeTileGeometryVideo( context, tileIdx, initTileWidth, initTileHeight );
+        resizeTileGeometryVideo( context, tileIdx, initTileWidth[tileIdx], initTileHeight[tileIdx] );
         std::cout << "\n\t-->after GPA\ttile " << tileIdx << " ImageSize "
                   << context.getFrame( 0 ).getTile( tileIdx ).getWidth() << " x "
                   << context.getFrame( 0 ).getTile( tileIdx ).getHeight() << std::endl;
@@ -4987,9 +5023,9 @@ size_t PCCEncoder::generateTilesFromImage( PCCContext& context ) {
         tile.getEomPatches().push_back( eomPatch );
         // relocate eomPatches in the tile
         if ( !tile.getUseRawPointsSeparateVideo() ) {
-          std::vector<bool> occupancyMap;
-          size_t            occupancySizeU = tile.getWidth() / params_.occupancyResolution_;
-          size_t            occupancySizeV = tile.getHeight() / params_.occupancyResolution_;
+          PCCOccupancyCanvas occupancyMap;
+          size_t             occupancySizeU = tile.getWidth() / params_.occupancyResolution_;
+          size_t             occupancySizeV = tile.getHeight() / params_.occupancyResolution_;
           occupancyMap.resize( occupancySizeU * occupancySizeV );
           packEOMAttributePointsPatch( tile, occupancyMap, tile.getWidth(), tile.getHeight(), occupancySizeU,
                                        occupancySizeV, 0 );
@@ -5009,9 +5045,9 @@ size_t PCCEncoder::generateTilesFromImage( PCCContext& context ) {
       tile.getPatches().clear();
       tile.setWidth( frame.getWidth() );
       tile.setHeight( params_.tilePartitionHeight_ * 64 );
-      std::vector<bool> occupancyMap;
-      size_t            occupancySizeU = tile.getWidth() / params_.occupancyResolution_;
-      size_t            occupancySizeV = tile.getHeight() / params_.occupancyResolution_;
+      PCCOccupancyCanvas occupancyMap;
+      size_t             occupancySizeU = tile.getWidth() / params_.occupancyResolution_;
+      size_t             occupancySizeV = tile.getHeight() / params_.occupancyResolution_;
       occupancyMap.resize( occupancySizeU * occupancySizeV );
       if ( tile.getNumberOfRawPointsPatches() > 0 && !tile.getUseRawPointsSeparateVideo() ) {
         size_t height = tile.getHeight();
@@ -5137,97 +5173,134 @@ void PCCEncoder::generateTilesFromSegments( PCCContext& context ) {
   minimumTileWidth  = std::max( minimumTileWidth, minSize0 * params_.occupancyResolution_ );
   size_t tile0Width = std::ceil( static_cast<double>( params_.minimumImageWidth_ - minimumTileWidth ) / 64.0 ) * 64;
   minimumTileWidth  = params_.minimumImageWidth_ - tile0Width;
-  std::vector<size_t> tileHeight;
+  // the frames are split into tiles concurrently, the tile heights carry over from the previous frames and are set
+  // once all the frames are split.
+  std::vector<std::vector<size_t>> tileHeights( context.size() );
+#if defined( ENABLE_TBB )
+  tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), context.size(), [&]( const size_t fi ) {
+#else
   for ( size_t fi = 0; fi < context.size(); fi++ ) {
-    tileHeight.resize( context[fi].getNumTilesInAtlasFrame() );
-    auto& patchSegmentationFrame = context[fi].getTitleFrameContext();
-    auto& patches                = patchSegmentationFrame.getPatches();
-    std::sort( patches.begin(), patches.end(), []( PCCPatch& a, PCCPatch& b ) { return a.gt( b ); } );
-    auto& tile0 = context[fi].getTile( 0 );
-    auto& tile1 = context[fi].getTile( 1 );
-    auto& tile2 = context[fi].getTile( 2 );
-    tile0.setWidth( tile0Width );
-    tile1.setWidth( minimumTileWidth );
-    tile2.setWidth( tile0Width );
-    tile0.setTileIndex( 0 );
-    tile1.setTileIndex( 1 );
-    tile2.setTileIndex( 2 );
-    PCCEomPatch eomPatch[3];
-    eomPatch[0].eomCount_ = eomPatch[1].eomCount_ = eomPatch[2].eomCount_ = 0;
-    size_t numPatchInTile0                                                = std::min( size_t( 3 ), patches.size() );
-    tileHeight[0]                                                         = 0;
-    for ( size_t patchIdx = 0; patchIdx < numPatchInTile0; patchIdx++ ) {
-      patches[patchIdx].setTileIndex( 0 );
-      patches[patchIdx].setFrameIndex( fi );
-      tile0.getPatches().push_back( patches[patchIdx] );
-      tileHeight[0] =
-          std::max( tileHeight[0], std::max( patches[patchIdx].getSizeU0() * params_.occupancyResolution_,
-                                             patches[patchIdx].getSizeV0() * params_.occupancyResolution_ ) );
-      if ( params_.enhancedOccupancyMapCode_ ) {
-        eomPatch[0].memberPatches_.push_back( patchIdx );
-        eomPatch[0].eomCountPerPatch_.push_back( patches[patchIdx].getEOMCount() );
-        eomPatch[0].eomCount_ += patches[patchIdx].getEOMCount();
-      }  // if eom enabled
-    }    // group0
-    for ( size_t patchIdx = numPatchInTile0; patchIdx < patches.size(); patchIdx++ ) {
-      patches[patchIdx].setFrameIndex( fi );
-      if ( std::max( patches[patchIdx].getSizeU0() * patches[patchIdx].getOccupancyResolution(),
-                     patches[patchIdx].getSizeV0() * patches[patchIdx].getOccupancyResolution() ) < minimumTileWidth ) {
-        patches[patchIdx].setTileIndex( 1 );
-        tile1.getPatches().push_back( patches[patchIdx] );
-        tileHeight[1] =
-            std::max( tileHeight[1], std::max( patches[patchIdx].getSizeU0() * params_.occupancyResolution_,
-                                               patches[patchIdx].getSizeV0() * params_.occupancyResolution_ ) );
-        if ( params_.enhancedOccupancyMapCode_ ) {
-          eomPatch[1].memberPatches_.push_back( tile1.getPatches().size() - 1 );
-          eomPatch[1].eomCountPerPatch_.push_back( patches[patchIdx].getEOMCount() );
-          eomPatch[1].eomCount_ += patches[patchIdx].getEOMCount();
-        }  // if eom enabled
-      } else {
-        patches[patchIdx].setTileIndex( 2 );
-        tile2.getPatches().push_back( patches[patchIdx] );
-        tileHeight[2] =
-            std::max( tileHeight[2], std::max( patches[patchIdx].getSizeU0() * params_.occupancyResolution_,
+#endif
+      auto& tileHeight = tileHeights[fi];
+      tileHeight.resize( context[fi].getNumTilesInAtlasFrame(), 0 );
+      auto& patchSegmentationFrame = context[fi].getTitleFrameContext();
+      auto& patches                = patchSegmentationFrame.getPatches();
+      std::sort( patches.begin(), patches.end(), []( PCCPatch& a, PCCPatch& b ) { return a.gt( b ); } );
+      auto& tile0 = context[fi].getTile( 0 );
+      auto& tile1 = context[fi].getTile( 1 );
+      auto& tile2 = context[fi].getTile( 2 );
+      tile0.setWidth( tile0Width );
+      tile1.setWidth( minimumTileWidth );
+      tile2.setWidth( tile0Width );
+      tile0.setTileIndex( 0 );
+      tile1.setTileIndex( 1 );
+      tile2.setTileIndex( 2 );
+      PCCEomPatch eomPatch[3];
+      eomPatch[0].eomCount_ = eomPatch[1].eomCount_ = eomPatch[2].eomCount_ = 0;
+      size_t numPatchInTile0                                                = std::min( size_t( 3 ), patches.size() );
+      tileHeight[0]                                                         = 0;
+      for ( size_t patchIdx = 0; patchIdx < numPatchInTile0; patchIdx++ ) {
+        patches[patchIdx].setTileIndex( 0 );
+        patches[patchIdx].setFrameIndex( fi );
+        tile0.getPatches().push_back( patches[patchIdx] );
+        tileHeight[0] =
+            std::max( tileHeight[0], std::max( patches[patchIdx].getSizeU0() * params_.occupancyResolution_,
                                                patches[patchIdx].getSizeV0() * params_.occupancyResolution_ ) );
         if ( params_.enhancedOccupancyMapCode_ ) {
-          eomPatch[2].memberPatches_.push_back( tile2.getPatches().size() - 1 );
-          eomPatch[2].eomCountPerPatch_.push_back( patches[patchIdx].getEOMCount() );
-          eomPatch[2].eomCount_ += patches[patchIdx].getEOMCount();
+          eomPatch[0].memberPatches_.push_back( patchIdx );
+          eomPatch[0].eomCountPerPatch_.push_back( patches[patchIdx].getEOMCount() );
+          eomPatch[0].eomCount_ += patches[patchIdx].getEOMCount();
         }  // if eom enabled
+      }    // group0
+      for ( size_t patchIdx = numPatchInTile0; patchIdx < patches.size(); patchIdx++ ) {
+        patches[patchIdx].setFrameIndex( fi );
+        if ( std::max( patches[patchIdx].getSizeU0() * patches[patchIdx].getOccupancyResolution(),
+                       patches[patchIdx].getSizeV0() * patches[patchIdx].getOccupancyResolution() ) < minimumTileWidth ) {
+          patches[patchIdx].setTileIndex( 1 );
+          tile1.getPatches().push_back( patches[patchIdx] );
+          tileHeight[1] =
+              std::max( tileHeight[1], std::max( patches[patchIdx].getSizeU0() * params_.occupancyResolution_,
+                                                 patches[patchIdx].getSizeV0() * params_.occupancyResolution_ ) );
+          if ( params_.enhancedOccupancyMapCode_ ) {
+            eomPatch[1].memberPatches_.push_back( tile1.getPatches().size() - 1 );
+            eomPatch[1].eomCountPerPatch_.push_back( patches[patchIdx].getEOMCount() );
+            eomPatch[1].eomCount_ += patches[patchIdx].getEOMCount();
+          }  // if eom enabled
+        } else {
+          patches[patchIdx].setTileIndex( 2 );
+          tile2.getPatches().push_back( patches[patchIdx] );
+          tileHeight[2] =
+              std::max( tileHeight[2], std::max( patches[patchIdx].getSizeU0() * params_.occupancyResolution_,
+                                                 patches[patchIdx].getSizeV0() * params_.occupancyResolution_ ) );
+          if ( params_.enhancedOccupancyMapCode_ ) {
+            eomPatch[2].memberPatches_.push_back( tile2.getPatches().size() - 1 );
+            eomPatch[2].eomCountPerPatch_.push_back( patches[patchIdx].getEOMCount() );
+            eomPatch[2].eomCount_ += patches[patchIdx].getEOMCount();
+          }  // if eom enabled
+        }
+      }  // patches
+      // no non-zero tile: an empty frame has no patch to move and is rejected by the tile size check
+      if ( tile1.getPatches().size() == 0 || tile2.getPatches().size() == 0 ) {
+        auto& desTile = ( tile1.getPatches().size() == 0 ) ? tile1 : tile2;
+        auto& srcTile = ( tile1.getPatches().size() == 0 ) ? tile2 : tile1;
+        if ( !srcTile.getPatches().empty() ) {
+          desTile.getPatches().push_back( srcTile.getPatches()[srcTile.getPatches().size() - 1] );
+          srcTile.getPatches().pop_back();
+        }
+      }
+      if ( params_.enhancedOccupancyMapCode_ ) {
+        tile0.getEomPatches().push_back( eomPatch[0] );
+        tile1.getEomPatches().push_back( eomPatch[1] );
+        tile2.getEomPatches().push_back( eomPatch[2] );
+      }
+      if ( ( params_.rawPointsPatch_ || params_.lossyRawPointsPatch_ ) ) {
+        auto& tile3 = context[fi].getTile( 3 );
+        tile0.getRawPointsPatches().clear();
+        tile1.getRawPointsPatches().clear();
+        tile2.getRawPointsPatches().clear();
+        // rawpatches are in a seperate tile
+        tile3.setWidth( params_.minimumImageWidth_ );
+        tile3.setTileIndex( 3 );
+        tile3.getPatches().clear();
+        auto& rawPatches = patchSegmentationFrame.getRawPointsPatches();
+        for ( size_t patchIdx = 0; patchIdx < rawPatches.size(); patchIdx++ ) {
+          rawPatches[patchIdx].tileIndex_  = 3;
+          rawPatches[patchIdx].frameIndex_ = fi;
+          tile3.getRawPointsPatches().push_back( rawPatches[patchIdx] );
+        }  // rawPatch
+        tile3.setTotalNumberOfRawPoints( patchSegmentationFrame.getTotalNumberOfRawPoints() );
+      }
+      for ( size_t ti = 0; ti < context[fi].getNumTilesInAtlasFrame(); ti++ ) {
+        auto& tile = context[fi].getTile( ti );
+        if ( tile.getEomPatches().size() != 0 ) {
+          for ( auto& eomPatch : tile.getEomPatches() ) {
+            eomPatch.occupancyResolution_ = params_.occupancyResolution_;
+            eomPatch.frameIndex_          = fi;
+            eomPatch.tileIndex_           = ti;
+          }
+        }
+      }
+#if defined( ENABLE_TBB )
+    } );
+  } );
+#else
+  }
+#endif
+  for ( size_t fi = 0; fi < context.size(); fi++ ) {
+    auto& tileHeight = tileHeights[fi];
+    if ( fi > 0 ) {
+      for ( size_t ti = 1; ti < tileHeight.size(); ti++ ) {
+        tileHeight[ti] = std::max( tileHeight[ti], tileHeights[fi - 1][ti] );
       }
-    }  // patches
-    // no non-zero tile
-    if ( tile1.getPatches().size() == 0 || tile2.getPatches().size() == 0 ) {
-      auto& desTile = ( tile1.getPatches().size() == 0 ) ? tile1 : tile2;
-      auto& srcTile = ( tile1.getPatches().size() == 0 ) ? tile2 : tile1;
-      desTile.getPatches().push_back( srcTile.getPatches()[srcTile.getPatches().size() - 1] );
-      srcTile.getPatches().pop_back();
     }
+    auto& tile0 = context[fi].getTile( 0 );
+    auto& tile1 = context[fi].getTile( 1 );
+    auto& tile2 = context[fi].getTile( 2 );
     tile0.setHeight( tileHeight[0] );
     tile1.setHeight( tileHeight[1] );
     tile2.setHeight( tileHeight[2] );
-    if ( params_.enhancedOccupancyMapCode_ ) {
-      tile0.getEomPatches().push_back( eomPatch[0] );
-      tile1.getEomPatches().push_back( eomPatch[1] );
-      tile2.getEomPatches().push_back( eomPatch[2] );
-    }
-    if ( ( params_.rawPointsPatch_ || params_.lossyRawPointsPatch_ ) ) {
-      auto& tile3 = context[fi].getTile( 3 );
-      tile0.getRawPointsPatches().clear();
-      tile1.getRawPointsPatches().clear();
-      tile2.getRawPointsPatches().clear();
-      // rawpatches are in a seperate tile
-      tile3.setWidth( params_.minimumImageWidth_ );
-      tile3.setTileIndex( 3 );
-      tile3.getPatches().clear();
-      auto& rawPatches = patchSegmentationFrame.getRawPointsPatches();
-      for ( size_t patchIdx = 0; patchIdx < rawPatches.size(); patchIdx++ ) {
-        rawPatches[patchIdx].tileIndex_  = 3;
-        rawPatches[patchIdx].frameIndex_ = fi;
-        tile3.getRawPointsPatches().push_back( rawPatches[patchIdx] );
-      }  // rawPatch
-      tile3.setTotalNumberOfRawPoints( patchSegmentationFrame.getTotalNumberOfRawPoints() );
-    }
     printf( "generateTilesFromSegments: tile[0] : %zux%zu, %zu patches\n", tile0.getWidth(), tile0.getHeight(),
             tile0.getPatches().size() );
     printf( "generateTilesFromSegments: tile[1] : %zux%zu, %zu patches\n", tile1.getWidth(), tile1.getHeight(),
@@ -5244,99 +5317,100 @@ void PCCEncoder::generateTilesFromSegments( PCCContext& context ) {
       printf( "ERROR: tiles sizes in not correct. \n" );
       exit( 254 );
     }
-
-    for ( size_t ti = 0; ti < context[fi].getNumTilesInAtlasFrame(); ti++ ) {
-      auto& tile = context[fi].getTile( ti );
-      if ( tile.getEomPatches().size() != 0 ) {
-        for ( auto& eomPatch : tile.getEomPatches() ) {
-          eomPatch.occupancyResolution_ = params_.occupancyResolution_;
-          eomPatch.frameIndex_          = fi;
-          eomPatch.tileIndex_           = ti;
-        }
-      }
-    }
-
   }  // fi
 }
 
 void PCCEncoder::placeTiles( PCCContext& context, size_t minFrameWidth, size_t minFrameHeight ) {
   if ( params_.tileSegmentationType_ == 1 ) {
   } else {
-    // packing
+    // the frames are placed concurrently and logged in order
+#if defined( ENABLE_TBB )
+    tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
+    limited.execute( [&] {
+      tbb::parallel_for( size_t( 0 ), context.size(), [&]( const size_t frameIdx ) {
+#else
     for ( size_t frameIdx = 0; frameIdx < context.size(); frameIdx++ ) {
-      auto&  tile0       = context[frameIdx].getTile( 0 );
-      auto&  tile1       = context[frameIdx].getTile( 1 );
-      auto&  tile2       = context[frameIdx].getTile( 2 );
-      size_t frameWidth  = tile0.getWidth();
-      size_t frameHeight = tile0.getHeight();
-      // tile0 : (start from 0,0)
-      tile0.setLeftTopXInFrame( 0 );
-      tile0.setLeftTopYInFrame( 0 );
-      // right
-      tile1.setLeftTopXInFrame( frameWidth );
-      tile1.setLeftTopYInFrame( 0 );
-      frameWidth += tile1.getWidth();
-      // bottom left
-      tile2.setLeftTopXInFrame( 0 );
-      tile2.setLeftTopYInFrame( frameHeight );
-      frameHeight += tile2.getHeight();
-      frameHeight = std::max( frameHeight, tile1.getHeight() );
-      if ( params_.rawPointsPatch_ || params_.lossyRawPointsPatch_ ) {
-        // bottom
-        auto& tile3 = context[frameIdx].getTile( 3 );
-        tile3.setLeftTopXInFrame( 0 );
-        if ( !params_.useRawPointsSeparateVideo_ ) {
-          tile3.setLeftTopYInFrame( frameHeight );
-          frameWidth = std::max( frameWidth, tile3.getWidth() );
-          frameHeight += tile3.getHeight();
-        }
-      }
-      // copying to titleFrameContext
-      auto& outputFrame = context[frameIdx].getTitleFrameContext();
-      outputFrame.setWidth( frameWidth );
-      outputFrame.setHeight( frameHeight );
-      auto& outputFrameOccupanctMap = outputFrame.getOccupancyMap();
-      outputFrameOccupanctMap.resize( frameWidth * frameHeight );
-      outputFrame.getPatches().clear();
-      outputFrame.getRawPointsPatches().clear();
-      outputFrame.getEomPatches().clear();
-
-      for ( size_t tileIdx = 0; tileIdx < context[frameIdx].getNumTilesInAtlasFrame(); tileIdx++ ) {
-        auto& inputTile          = context[frameIdx].getTile( tileIdx );
-        auto& outputFramePatches = outputFrame.getPatches();
-        auto& inputTilePatches   = inputTile.getPatches();
-        for ( size_t patchIdx = 0; patchIdx < inputTilePatches.size(); patchIdx++ ) {
-          outputFramePatches.push_back( inputTilePatches[patchIdx] );
-          auto& patch = outputFramePatches[outputFramePatches.size() - 1];
-          patch.setU0( patch.getU0() + inputTile.getLeftTopXInFrame() / params_.occupancyResolution_ );
-          patch.setV0( patch.getV0() + inputTile.getLeftTopYInFrame() / params_.occupancyResolution_ );
-        }
-        // raw
-        auto& outputFrameRawPatches = outputFrame.getRawPointsPatches();
-        auto& inputTileRawPatches   = inputTile.getRawPointsPatches();
-        for ( size_t patchIdx = 0; patchIdx < inputTileRawPatches.size(); patchIdx++ ) {
-          outputFrameRawPatches.push_back( inputTileRawPatches[patchIdx] );
+#endif
+        auto&  tile0       = context[frameIdx].getTile( 0 );
+        auto&  tile1       = context[frameIdx].getTile( 1 );
+        auto&  tile2       = context[frameIdx].getTile( 2 );
+        size_t frameWidth  = tile0.getWidth();
+        size_t frameHeight = tile0.getHeight();
+        // tile0 : (start from 0,0)
+        tile0.setLeftTopXInFrame( 0 );
+        tile0.setLeftTopYInFrame( 0 );
+        // right
+        tile1.setLeftTopXInFrame( frameWidth );
+        tile1.setLeftTopYInFrame( 0 );
+        frameWidth += tile1.getWidth();
+        // bottom left
+        tile2.setLeftTopXInFrame( 0 );
+        tile2.setLeftTopYInFrame( frameHeight );
+        frameHeight += tile2.getHeight();
+        frameHeight = std::max( frameHeight, tile1.getHeight() );
+        if ( params_.rawPointsPatch_ || params_.lossyRawPointsPatch_ ) {
+          // bottom
+          auto& tile3 = context[frameIdx].getTile( 3 );
+          tile3.setLeftTopXInFrame( 0 );
           if ( !params_.useRawPointsSeparateVideo_ ) {
-            outputFrameRawPatches[outputFrameRawPatches.size() - 1].u0_ +=
+            tile3.setLeftTopYInFrame( frameHeight );
+            frameWidth = std::max( frameWidth, tile3.getWidth() );
+            frameHeight += tile3.getHeight();
+          }
+        }
+        // copying to titleFrameContext
+        auto& outputFrame = context[frameIdx].getTitleFrameContext();
+        outputFrame.setWidth( frameWidth );
+        outputFrame.setHeight( frameHeight );
+        auto& outputFrameOccupanctMap = outputFrame.getOccupancyMap();
+        outputFrameOccupanctMap.resize( frameWidth * frameHeight );
+        outputFrame.getPatches().clear();
+        outputFrame.getRawPointsPatches().clear();
+        outputFrame.getEomPatches().clear();
+
+        for ( size_t tileIdx = 0; tileIdx < context[frameIdx].getNumTilesInAtlasFrame(); tileIdx++ ) {
+          auto& inputTile          = context[frameIdx].getTile( tileIdx );
+          auto& outputFramePatches = outputFrame.getPatches();
+          auto& inputTilePatches   = inputTile.getPatches();
+          for ( size_t patchIdx = 0; patchIdx < inputTilePatches.size(); patchIdx++ ) {
+            outputFramePatches.push_back( inputTilePatches[patchIdx] );
+            auto& patch = outputFramePatches[outputFramePatches.size() - 1];
+            patch.setU0( patch.getU0() + inputTile.getLeftTopXInFrame() / params_.occupancyResolution_ );
+            patch.setV0( patch.getV0() + inputTile.getLeftTopYInFrame() / params_.occupancyResolution_ );
+          }
+          // raw
+          auto& outputFrameRawPatches = outputFrame.getRawPointsPatches();
+          auto& inputTileRawPatches   = inputTile.getRawPointsPatches();
+          for ( size_t patchIdx = 0; patchIdx < inputTileRawPatches.size(); patchIdx++ ) {
+            outputFrameRawPatches.push_back( inputTileRawPatches[patchIdx] );
+            if ( !params_.useRawPointsSeparateVideo_ ) {
+              outputFrameRawPatches[outputFrameRawPatches.size() - 1].u0_ +=
+                  inputTile.getLeftTopXInFrame() / params_.occupancyResolution_;
+              outputFrameRawPatches[outputFrameRawPatches.size() - 1].v0_ +=
+                  inputTile.getLeftTopYInFrame() / params_.occupancyResolution_;
+            }
+          }
+          // eom
+          auto& outputFrameEomPatches = outputFrame.getEomPatches();
+          auto& inputTileEomPatches   = inputTile.getEomPatches();
+          for ( size_t patchIdx = 0; patchIdx < inputTileEomPatches.size(); patchIdx++ ) {
+            outputFrameEomPatches.push_back( inputTileEomPatches[patchIdx] );
+            outputFrameEomPatches[outputFrameEomPatches.size() - 1].u0_ +=
                 inputTile.getLeftTopXInFrame() / params_.occupancyResolution_;
-            outputFrameRawPatches[outputFrameRawPatches.size() - 1].v0_ +=
+            outputFrameEomPatches[outputFrameEomPatches.size() - 1].v0_ +=
                 inputTile.getLeftTopYInFrame() / params_.occupancyResolution_;
           }
-        }
-        // eom
-        auto& outputFrameEomPatches = outputFrame.getEomPatches();
-        auto& inputTileEomPatches   = inputTile.getEomPatches();
-        for ( size_t patchIdx = 0; patchIdx < inputTileEomPatches.size(); patchIdx++ ) {
-          outputFrameEomPatches.push_back( inputTileEomPatches[patchIdx] );
-          outputFrameEomPatches[outputFrameEomPatches.size() - 1].u0_ +=
-              inputTile.getLeftTopXInFrame() / params_.occupancyResolution_;
-          outputFrameEomPatches[outputFrameEomPatches.size() - 1].v0_ +=
-              inputTile.getLeftTopYInFrame() / params_.occupancyResolution_;
-        }
-      }  // tileIdx
-      context[frameIdx].updatePartitionInfoPerFrame(
-          frameIdx, frameWidth, frameHeight, params_.numMaxTilePerFrame_, true, params_.tilePartitionWidth_,
-          params_.tilePartitionHeight_, params_.tilePartitionWidthList_, params_.tilePartitionHeightList_ );
+        }  // tileIdx
+        context[frameIdx].updatePartitionInfoPerFrame(
+            frameIdx, frameWidth, frameHeight, params_.numMaxTilePerFrame_, true, params_.tilePartitionWidth_,
+            params_.tilePartitionHeight_, params_.tilePartitionWidthList_, params_.tilePartitionHeightList_ );
+#if defined( ENABLE_TBB )
+      } );
+    } );
+#else
+    }
+#endif
+    for ( size_t frameIdx = 0; frameIdx < context.size(); frameIdx++ ) {
       for ( size_t ti = 0; ti < context[frameIdx].getNumTilesInAtlasFrame(); ti++ ) {
         auto& tile = context[frameIdx].getTile( ti );
         if ( tile.getPatches().size() != 0 )
@@ -5615,7 +5689,8 @@ bool PCCEncoder::resizeTileGeometryVideo( PCCContext& context,
     maxHeight = (std::max)( maxHeight, frameHeight );
   } else {
     maxWidth = std::ceil( (double)maxWidth / 64.0 ) * 64;
-    printf( "maxWidth: %zu, frameWidth: %zu\n", maxWidth, context[0].getTitleFrameContext().getWidth() );
+    *g_packingLog << "maxWidth: " << maxWidth << ", frameWidth: " << context[0].getTitleFrameContext().getWidth()
+                  << std::endl;
     maxWidth  = std::min( maxWidth, context[0].getTitleFrameContext().getWidth() );
     maxHeight = std::ceil( (double)maxHeight / 64.0 ) * 64;
   }
@@ -5894,7 +5969,7 @@ size_t PCCEncoder::adjustDepth3DPadding( size_t            x,
                                          size_t            y,
                                          uint16_t          mean_val,
                                          PCCImageGeometry& image,
-                                         PCCKdTree&        kdtree,
+                                         const PCCKdTree&  kdtree,
                                          PCCFrameContext&  frame ) {
   auto&  blockToPatch = frame.getBlockToPatch();
   auto&  patches      = frame.getPatches();
@@ -5965,7 +6040,7 @@ void PCCEncoder::dilate3DPadding( const PCCPointSet3&     source,
   std::vector<uint32_t> occupancyMapTemp;
   auto&                 occupancyMapOriginal = frame.getOccupancyMap();
   occupancyMapTemp.resize( image.getWidth() * image.getHeight(), 0 );
-  PCCKdTree kdtree( source );
+  const PCCKdTree&      kdtree = frameInfo.getSourceKdTree().get( source );
   // fill in positions that are added to the sequence, because of occupancyMap video coding
   for ( size_t y_OM = 0; y_OM < occupancyMap.getHeight(); ++y_OM ) {
     for ( size_t x_OM = 0; x_OM < occupancyMap.getWidth(); ++x_OM ) {
@@ -6179,7 +6254,12 @@ void PCCEncoder::createCoarseLayer( PCCImage<T, 3>&        image,
   mipOccupancyMap.resize( ( dyadicWidth / 2 ) * ( dyadicHeight / 2 ), 0 );
   int stride    = image.getWidth();
   int newStride = ( dyadicWidth / 2 );
+  // the rows of the mipmap are independent
+#if defined( ENABLE_TBB )
+  tbb::parallel_for( size_t( 0 ), mip.getHeight(), [&]( const size_t y ) {
+#else
   for ( size_t y = 0; y < mip.getHeight(); y++ ) {
+#endif
     for ( size_t x = 0; x < mip.getWidth(); x++ ) {
       double num[3] = { 0.0, 0.0, 0.0 };
       double den    = 0;
@@ -6198,156 +6278,124 @@ void PCCEncoder::createCoarseLayer( PCCImage<T, 3>&        image,
         for ( int cc = 0; cc < 3; cc++ ) { mip.setValue( cc, x, y, std::round( num[cc] / den ) ); }
       }
     }
+#if defined( ENABLE_TBB )
+  } );
+#else
   }
+#endif
 }
 
 template <typename T>
 void PCCEncoder::regionFill( PCCImage<T, 3>& image, std::vector<uint32_t>& occupancyMap, PCCImage<T, 3>& imageLowRes ) {
-  int                   stride        = image.getWidth();
-  int                   numElem       = 0;
-  int                   numSparseElem = 0;
-  std::vector<uint32_t> indexing;
-  indexing.resize( occupancyMap.size() );
-  for ( int i = 0; i < occupancyMap.size(); i++ ) {
-    if ( occupancyMap[i] == 0 ) {
-      indexing[i] = numElem;
-      numElem++;
-    }
-  }
-  // create a sparse matrix with the coefficients
-  std::vector<uint32_t> iSparse;
-  std::vector<uint32_t> jSparse;
-  std::vector<double>   valSparse;
-  iSparse.resize( numElem * 5 );
-  jSparse.resize( numElem * 5 );
-  valSparse.resize( numElem * 5 );
-  // create an initial solution using the low-resolution
-  std::vector<double> b[3];
-  b[0].resize( numElem );
-  b[1].resize( numElem );
-  b[2].resize( numElem );
-  // fill in the system
-  int idx       = 0;
-  int idxSparse = 0;
-  for ( int row = 0; row < image.getHeight(); row++ ) {
-    for ( int column = 0; column < image.getWidth(); column++ ) {
-      if ( occupancyMap[column + stride * row] == 0 ) {
-        int count = 0;
-        b[0][idx] = 0;
-        b[1][idx] = 0;
-        b[2][idx] = 0;
-        for ( int i = -1; i < 2; i++ ) {
-          for ( int j = -1; j < 2; j++ ) {
-            if ( ( i == j ) || ( i == -j ) ) { continue; }
-            if ( ( column + j < 0 ) || ( column + j > image.getWidth() - 1 ) ) { continue; }
-            if ( ( row + i < 0 ) || ( row + i > image.getHeight() - 1 ) ) { continue; }
-            count++;
-            if ( occupancyMap[column + j + stride * ( row + i )] == 1 ) {
-              b[0][idx] += image.getValue( 0, column + j, row + i );
-              b[1][idx] += image.getValue( 1, column + j, row + i );
-              b[2][idx] += image.getValue( 2, column + j, row + i );
-            } else {
-              iSparse[idxSparse]   = idx;
-              jSparse[idxSparse]   = indexing[column + j + stride * ( row + i )];
-              valSparse[idxSparse] = -1;
-              idxSparse++;
-            }
-          }
+  const int width   = image.getWidth();
+  const int height  = image.getHeight();
+  const int stride  = width;
+  int       numElem = 0;
+  // the unknowns are solved in place on full resolution grids: the occupied pixels hold the boundary values
+  std::vector<double> x[3];
+  for ( int cc = 0; cc < 3; cc++ ) { x[cc].resize( size_t( width ) * height ); }
+  double mean[3] = { 0.0, 0.0, 0.0 };
+  int    idx     = 0;
+  for ( int row = 0; row < height; row++ ) {
+    for ( int column = 0; column < width; column++ ) {
+      const int pos = column + stride * row;
+      if ( occupancyMap[pos] == 0 ) {
+        numElem++;
+      } else {
+        for ( int cc = 0; cc < 3; cc++ ) {
+          x[cc][pos] = image.getValue( cc, column, row );
+          mean[cc] += x[cc][pos];
         }
-        // now insert the weight of the center pixel
-        iSparse[idxSparse]   = idx;
-        jSparse[idxSparse]   = idx;
-        valSparse[idxSparse] = count;
         idx++;
-        idxSparse++;
       }
     }
   }
-  numSparseElem = idxSparse;
-  // now solve the linear system Ax=b using Gauss-Siedel relaxation, with initial guess coming from the lower resolution
-  std::vector<double> x[3];
-  x[0].resize( numElem );
-  x[1].resize( numElem );
-  x[2].resize( numElem );
+  // no empty pixel to fill
+  if ( numElem == 0 ) { return; }
+  // create an initial solution using the low-resolution image
   if ( imageLowRes.getWidth() == image.getWidth() ) {
     // low resolution image not provided, let's use for the initialization the mean value of the active pixels
-    double mean[3] = { 0.0, 0.0, 0.0 };
-    idx            = 0;
-    for ( int row = 0; row < image.getHeight(); row++ ) {
-      for ( int column = 0; column < image.getWidth(); column++ ) {
-        if ( occupancyMap[column + stride * row] == 1 ) {
-          mean[0] += double( image.getValue( 0, column, row ) );
-          mean[1] += double( image.getValue( 1, column, row ) );
-          mean[2] += double( image.getValue( 2, column, row ) );
-          idx++;
-        }
-      }
-    }
-    mean[0] /= idx;
-    mean[1] /= idx;
-    mean[2] /= idx;
-    idx = 0;
-    for ( int row = 0; row < image.getHeight(); row++ ) {
-      for ( int column = 0; column < image.getWidth(); column++ ) {
-        if ( occupancyMap[column + stride * row] == 0 ) {
-          x[0][idx] = mean[0];
-          x[1][idx] = mean[1];
-          x[2][idx] = mean[2];
-          idx++;
-        }
-      }
-    }
-  } else {
-    idx = 0;
-    for ( int row = 0; row < image.getHeight(); row++ ) {
-      for ( int column = 0; column < image.getWidth(); column++ ) {
-        if ( occupancyMap[column + stride * row] == 0 ) {
-          x[0][idx] = imageLowRes.getValue( 0, column / 2, row / 2 );
-          x[1][idx] = imageLowRes.getValue( 1, column / 2, row / 2 );
-          x[2][idx] = imageLowRes.getValue( 2, column / 2, row / 2 );
-          idx++;
+    for ( int cc = 0; cc < 3; cc++ ) { mean[cc] /= idx; }
+  }
+  for ( int row = 0; row < height; row++ ) {
+    for ( int column = 0; column < width; column++ ) {
+      const int pos = column + stride * row;
+      if ( occupancyMap[pos] == 0 ) {
+        for ( int cc = 0; cc < 3; cc++ ) {
+          x[cc][pos] = imageLowRes.getWidth() == image.getWidth() ? mean[cc]
+                                                                   : imageLowRes.getValue( cc, column / 2, row / 2 );
         }
       }
     }
   }
-  int    maxIteration = 1024;
-  double maxError     = 0.00001;
+  // now solve the linear system Ax=b using red-black Gauss-Siedel relaxation: the pixels of one color only depend on
+  // the pixels of the other color, so that the rows are relaxed concurrently. For the 5-point laplacian the
+  // convergence rate is the one of the lexicographic ordering, and the error is summed in the row order to keep the
+  // iteration count independent of the thread count.
+  const int    maxIteration = 1024;
+  const double maxError     = 0.00001;
+#if defined( ENABLE_TBB )
+  tbb::parallel_for( 0, 3, [&]( const int cc ) {
+#else
   for ( int cc = 0; cc < 3; cc++ ) {
-    int it = 0;
-    for ( ; it < maxIteration; it++ ) {
-      int    idxSparse = 0;
-      double error     = 0;
-      for ( int centerIdx = 0; centerIdx < numElem; centerIdx++ ) {
-        // add the b result
-        double val = b[cc][centerIdx];
-        while ( ( idxSparse < numSparseElem ) && ( iSparse[idxSparse] == centerIdx ) ) {
-          if ( valSparse[idxSparse] < 0 ) {
-            val += x[cc][jSparse[idxSparse]];
-            idxSparse++;
-          } else {
-            // final value
-            val /= valSparse[idxSparse];
-            // accumulate the error
-            error += ( val - x[cc][centerIdx] ) * ( val - x[cc][centerIdx] );
-            // update the value
-            x[cc][centerIdx] = val;
-            idxSparse++;
-          }
-        }
+#endif
+    auto&               value = x[cc];
+    std::vector<double> rowErrors( height );
+    // relaxes the pixels of a row having the given color
+    auto relax = [&]( const int row, const int color ) {
+      double error = 0;
+      for ( int column = ( row + color ) & 1; column < width; column += 2 ) {
+        const int pos = column + stride * row;
+        if ( occupancyMap[pos] != 0 ) { continue; }
+        double val   = 0;
+        int    count = 0;
+        if ( row > 0 ) {
+          val += value[pos - stride];
+          count++;
+        }
+        if ( column > 0 ) {
+          val += value[pos - 1];
+          count++;
+        }
+        if ( column < width - 1 ) {
+          val += value[pos + 1];
+          count++;
+        }
+        if ( row < height - 1 ) {
+          val += value[pos + stride];
+          count++;
+        }
+        val /= count;
+        error += ( val - value[pos] ) * ( val - value[pos] );
+        value[pos] = val;
+      }
+      rowErrors[row] += error;
+    };
+    for ( int it = 0; it < maxIteration; it++ ) {
+      std::fill( rowErrors.begin(), rowErrors.end(), 0.0 );
+      for ( int color = 0; color < 2; color++ ) {
+#if defined( ENABLE_TBB )
+        tbb::parallel_for( 0, height, [&]( const int row ) { relax( row, color ); } );
+#else
+        for ( int row = 0; row < height; row++ ) { relax( row, color ); }
+#endif
       }
+      double error = 0;
+      for ( int row = 0; row < height; row++ ) { error += rowErrors[row]; }
       error = error / numElem;
       if ( error < maxError ) { break; }
     }
+#if defined( ENABLE_TBB )
+  } );
+#else
   }
+#endif
   // put the value back in the image
-  idx = 0;
-  for ( int row = 0; row < image.getHeight(); row++ ) {
-    for ( int column = 0; column < image.getWidth(); column++ ) {
-      if ( occupancyMap[column + stride * row] == 0 ) {
-        image.setValue( 0, column, row, x[0][idx] );
-        image.setValue( 1, column, row, x[1][idx] );
-        image.setValue( 2, column, row, x[2][idx] );
-        idx++;
+  for ( int row = 0; row < height; row++ ) {
+    for ( int column = 0; column < width; column++ ) {
+      const int pos = column + stride * row;
+      if ( occupancyMap[pos] == 0 ) {
+        for ( int cc = 0; cc < 3; cc++ ) { image.setValue( cc, column, row, x[cc][pos] ); }
       }
     }
   }
@@ -6374,70 +6422,50 @@ void PCCEncoder::pushPullMip( const PCCImage<T, 3>&        image,
                               PCCImage<T, 3>&              mip,
                               const std::vector<uint32_t>& occupancyMap,
                               std::vector<uint32_t>&       mipOccupancyMap ) {
-  unsigned char w1;
-  unsigned char w2;
-  unsigned char w3;
-  unsigned char w4;
-  unsigned char val1;
-  unsigned char val2;
-  unsigned char val3;
-  unsigned char val4;
-  const size_t  width     = image.getWidth();
-  const size_t  height    = image.getHeight();
-  const size_t  newWidth  = ( ( width + 1 ) >> 1 );
-  const size_t  newHeight = ( ( height + 1 ) >> 1 );
+  const size_t width     = image.getWidth();
+  const size_t height    = image.getHeight();
+  const size_t newWidth  = ( ( width + 1 ) >> 1 );
+  const size_t newHeight = ( ( height + 1 ) >> 1 );
+  assert( image.getColorFormat() != PCCCOLORFORMAT::YUV420 );
   // allocate the mipmap with half the resolution
   mip.resize( newWidth, newHeight, PCCCOLORFORMAT::YUV444 );
   mipOccupancyMap.resize( newWidth * newHeight, 0 );
+  // the rows of the mipmap are independent: the values are read as 8-bit samples, and a missing sample has no weight
+#if defined( ENABLE_TBB )
+  tbb::parallel_for( size_t( 0 ), newHeight, [&]( const size_t y ) {
+#else
   for ( size_t y = 0; y < newHeight; ++y ) {
-    const size_t yUp = y << 1;
+#endif
+    const size_t    yUp        = y << 1;
+    const size_t    yDown      = ( std::min )( yUp + 1, height - 1 );
+    const bool      hasDown    = yUp + 1 < height;
+    const uint32_t* occupancy  = occupancyMap.data() + width * yUp;
+    const uint32_t* occupancy2 = occupancyMap.data() + width * yDown;
     for ( size_t x = 0; x < newWidth; ++x ) {
-      const size_t xUp = x << 1;
-      if ( occupancyMap[xUp + width * yUp] == 0 ) {
-        w1 = 0;
-      } else {
-        w1 = 255;
-      }
-      if ( ( xUp + 1 >= width ) || ( occupancyMap[xUp + 1 + width * yUp] == 0 ) ) {
-        w2 = 0;
-      } else {
-        w2 = 255;
-      }
-      if ( ( yUp + 1 >= height ) || ( occupancyMap[xUp + width * ( yUp + 1 )] == 0 ) ) {
-        w3 = 0;
-      } else {
-        w3 = 255;
-      }
-      if ( ( xUp + 1 >= width ) || ( yUp + 1 >= height ) || ( occupancyMap[xUp + 1 + width * ( yUp + 1 )] == 0 ) ) {
-        w4 = 0;
-      } else {
-        w4 = 255;
-      }
+      const size_t        xUp      = x << 1;
+      const bool          hasRight = xUp + 1 < width;
+      const unsigned char w1       = occupancy[xUp] == 0 ? 0 : 255;
+      const unsigned char w2       = hasRight && occupancy[xUp + 1] != 0 ? 255 : 0;
+      const unsigned char w3       = hasDown && occupancy2[xUp] != 0 ? 255 : 0;
+      const unsigned char w4       = hasRight && hasDown && occupancy2[xUp + 1] != 0 ? 255 : 0;
       if ( w1 + w2 + w3 + w4 > 0 ) {
         for ( int cc = 0; cc < 3; cc++ ) {
-          val1 = image.getValue( cc, xUp, yUp );
-          if ( xUp + 1 >= width ) {
-            val2 = 0;
-          } else {
-            val2 = image.getValue( cc, xUp + 1, yUp );
-          }
-          if ( yUp + 1 >= height ) {
-            val3 = 0;
-          } else {
-            val3 = image.getValue( cc, xUp, yUp + 1 );
-          }
-          if ( ( xUp + 1 >= width ) || ( yUp + 1 >= height ) ) {
-            val4 = 0;
-          } else {
-            val4 = image.getValue( cc, xUp + 1, yUp + 1 );
-          }
-          T newVal = mean4w( val1, w1, val2, w2, val3, w3, val4, w4 );
-          mip.setValue( cc, x, y, newVal );
+          const T*            row  = image.getChannel( cc ).data() + width * yUp;
+          const T*            row2 = image.getChannel( cc ).data() + width * yDown;
+          const unsigned char val1 = row[xUp];
+          const unsigned char val2 = hasRight ? row[xUp + 1] : 0;
+          const unsigned char val3 = hasDown ? row2[xUp] : 0;
+          const unsigned char val4 = hasRight && hasDown ? row2[xUp + 1] : 0;
+          mip.getChannel( cc )[x + newWidth * y] = T( mean4w( val1, w1, val2, w2, val3, w3, val4, w4 ) );
         }
         mipOccupancyMap[x + newWidth * y] = 1;
       }
     }
+#if defined( ENABLE_TBB )
+  } );
+#else
   }
+#endif
 }
 
 // interpolate using mipmap
@@ -6452,89 +6480,76 @@ void PCCEncoder::pushPullFill( PCCImage<T, 3>&              image,
   const size_t heightUp = image.getHeight();
   assert( ( ( widthUp + 1 ) >> 1 ) == width );
   assert( ( ( heightUp + 1 ) >> 1 ) == height );
-  unsigned char w1;
-  unsigned char w2;
-  unsigned char w3;
-  unsigned char w4;
-  for ( int yUp = 0; yUp < heightUp; ++yUp ) {
-    int y = yUp >> 1;
-    for ( int xUp = 0; xUp < widthUp; ++xUp ) {
-      int x = xUp >> 1;
-      if ( occupancyMap[xUp + widthUp * yUp] == 0 ) {
-        if ( ( xUp % 2 == 0 ) && ( yUp % 2 == 0 ) ) {
-          w1 = 144;
-          w2 = ( x > 0 ? static_cast<unsigned char>( 48 ) : 0 );
-          w3 = ( y > 0 ? static_cast<unsigned char>( 48 ) : 0 );
-          w4 = ( ( ( x > 0 ) && ( y > 0 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
-          for ( int cc = 0; cc < 3; cc++ ) {
-            T val       = mip.getValue( cc, x, y );
-            T valLeft   = ( x > 0 ? mip.getValue( cc, x - 1, y ) : 0 );
-            T valUp     = ( y > 0 ? mip.getValue( cc, x, y - 1 ) : 0 );
-            T valUpLeft = ( ( x > 0 && y > 0 ) ? mip.getValue( cc, x - 1, y - 1 ) : 0 );
-            T newVal    = mean4w( val, w1, valLeft, w2, valUp, w3, valUpLeft, w4 );
-            image.setValue( cc, xUp, yUp, newVal );
-          }
-        } else if ( ( xUp % 2 == 1 ) && ( yUp % 2 == 0 ) ) {
-          w1 = 144;
-          w2 = ( x < width - 1 ? static_cast<unsigned char>( 48 ) : 0 );
-          w3 = ( y > 0 ? static_cast<unsigned char>( 48 ) : 0 );
-          w4 = ( ( ( x < width - 1 ) && ( y > 0 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
-          for ( int cc = 0; cc < 3; cc++ ) {
-            T val        = mip.getValue( cc, x, y );
-            T valRight   = ( x < width - 1 ? mip.getValue( cc, x + 1, y ) : 0 );
-            T valUp      = ( y > 0 ? mip.getValue( cc, x, y - 1 ) : 0 );
-            T valUpRight = ( ( ( x < width - 1 ) && ( y > 0 ) ) ? mip.getValue( cc, x + 1, y - 1 ) : 0 );
-            T newVal     = mean4w( val, w1, valRight, w2, valUp, w3, valUpRight, w4 );
-            image.setValue( cc, xUp, yUp, newVal );
-          }
-        } else if ( ( xUp % 2 == 0 ) && ( yUp % 2 == 1 ) ) {
-          w1 = 144;
-          w2 = ( x > 0 ? static_cast<unsigned char>( 48 ) : 0 );
-          w3 = ( y < height - 1 ? static_cast<unsigned char>( 48 ) : 0 );
-          w4 = ( ( ( x > 0 ) && ( y < height - 1 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
-          for ( int cc = 0; cc < 3; cc++ ) {
-            T val         = mip.getValue( cc, x, y );
-            T valLeft     = ( x > 0 ? mip.getValue( cc, x - 1, y ) : 0 );
-            T valDown     = ( ( y < height - 1 ) ? mip.getValue( cc, x, y + 1 ) : 0 );
-            T valDownLeft = ( ( x > 0 && ( y < height - 1 ) ) ? mip.getValue( cc, x - 1, y + 1 ) : 0 );
-            T newVal      = mean4w( val, w1, valLeft, w2, valDown, w3, valDownLeft, w4 );
-            image.setValue( cc, xUp, yUp, newVal );
-          }
-        } else {
-          w1 = 144;
-          w2 = ( x < width - 1 ? static_cast<unsigned char>( 48 ) : 0 );
-          w3 = ( y < height - 1 ? static_cast<unsigned char>( 48 ) : 0 );
-          w4 = ( ( ( x < width - 1 ) && ( y < height - 1 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
-          for ( int cc = 0; cc < 3; cc++ ) {
-            T val          = mip.getValue( cc, x, y );
-            T valRight     = ( x < width - 1 ? mip.getValue( cc, x + 1, y ) : 0 );
-            T valDown      = ( ( y < height - 1 ) ? mip.getValue( cc, x, y + 1 ) : 0 );
-            T valDownRight = ( ( ( x < width - 1 ) && ( y < height - 1 ) ) ? mip.getValue( cc, x + 1, y + 1 ) : 0 );
-            T newVal       = mean4w( val, w1, valRight, w2, valDown, w3, valDownRight, w4 );
-            image.setValue( cc, xUp, yUp, newVal );
-          }
-        }
+  assert( image.getColorFormat() != PCCCOLORFORMAT::YUV420 );
+  // each empty pixel interpolates the mipmap sample covering it and the three closest ones on the side of the pixel:
+  // the rows are filled concurrently
+#if defined( ENABLE_TBB )
+  tbb::parallel_for( size_t( 0 ), heightUp, [&]( const size_t yUp ) {
+#else
+  for ( size_t yUp = 0; yUp < heightUp; ++yUp ) {
+#endif
+    const size_t        y         = yUp >> 1;
+    const size_t        yNext     = ( yUp % 2 == 0 ) ? y - 1 : y + 1;
+    const bool          hasNextY  = ( yUp % 2 == 0 ) ? y > 0 : y < height - 1;
+    const unsigned char w3        = hasNextY ? 48 : 0;
+    const uint32_t*     occupancy = occupancyMap.data() + widthUp * yUp;
+    for ( int cc = 0; cc < 3; cc++ ) {
+      T*       row     = image.getChannel( cc ).data() + widthUp * yUp;
+      const T* mipRow  = mip.getChannel( cc ).data() + width * y;
+      const T* mipRow2 = mip.getChannel( cc ).data() + width * ( hasNextY ? yNext : y );
+      for ( size_t xUp = 0; xUp < widthUp; ++xUp ) {
+        if ( occupancy[xUp] != 0 ) { continue; }
+        const size_t        x        = xUp >> 1;
+        const size_t        xNext    = ( xUp % 2 == 0 ) ? x - 1 : x + 1;
+        const bool          hasNextX = ( xUp % 2 == 0 ) ? x > 0 : x < width - 1;
+        const unsigned char w2       = hasNextX ? 48 : 0;
+        const unsigned char w4       = hasNextX && hasNextY ? 16 : 0;
+        const T             val      = mipRow[x];
+        const T             valX     = hasNextX ? mipRow[xNext] : 0;
+        const T             valY     = hasNextY ? mipRow2[x] : 0;
+        const T             valXY    = hasNextX && hasNextY ? mipRow2[xNext] : 0;
+        row[xUp]                     = T( mean4w( val, 144, valX, w2, valY, w3, valXY, w4 ) );
       }
     }
+#if defined( ENABLE_TBB )
+  } );
+#else
   }
+#endif
+  // smooth the empty pixels with the mean of their 8 neighbors: the rows are independent and the occupied pixels are
+  // copied unchanged, so that the inner loops have no branch
   auto tmpImage( image );
   for ( size_t n = 0; n < numIters; n++ ) {
-    for ( int y = 0; y < heightUp; y++ ) {
-      for ( int x = 0; x < widthUp; x++ ) {
-        if ( occupancyMap[x + widthUp * y] == 0 ) {
-          int x1 = ( x > 0 ) ? x - 1 : x;
-          int y1 = ( y > 0 ) ? y - 1 : y;
-          int x2 = ( x < widthUp - 1 ) ? x + 1 : x;
-          int y2 = ( y < heightUp - 1 ) ? y + 1 : y;
-          for ( size_t c = 0; c < 3; c++ ) {
-            int val = image.getValue( c, x1, y1 ) + image.getValue( c, x2, y1 ) + image.getValue( c, x1, y2 ) +
-                      image.getValue( c, x2, y2 ) + image.getValue( c, x1, y ) + image.getValue( c, x2, y ) +
-                      image.getValue( c, x, y1 ) + image.getValue( c, x, y2 );
-            tmpImage.setValue( c, x, y, ( val + 4 ) >> 3 );
-          }
-        }
+#if defined( ENABLE_TBB )
+    tbb::parallel_for( size_t( 0 ), heightUp, [&]( const size_t y ) {
+#else
+    for ( size_t y = 0; y < heightUp; y++ ) {
+#endif
+      const size_t    y1        = ( y > 0 ) ? y - 1 : y;
+      const size_t    y2        = ( y < heightUp - 1 ) ? y + 1 : y;
+      const uint32_t* occupancy = occupancyMap.data() + widthUp * y;
+      for ( size_t c = 0; c < 3; c++ ) {
+        const T* up   = image.getChannel( c ).data() + widthUp * y1;
+        const T* row  = image.getChannel( c ).data() + widthUp * y;
+        const T* down = image.getChannel( c ).data() + widthUp * y2;
+        T*       dst  = tmpImage.getChannel( c ).data() + widthUp * y;
+        // the first and last columns repeat their own samples
+        auto smooth = [&]( const size_t x, const size_t x1, const size_t x2 ) {
+          const int val = up[x1] + up[x2] + down[x1] + down[x2] + row[x1] + row[x2] + up[x] + down[x];
+          dst[x]        = occupancy[x] == 0 ? T( ( val + 4 ) >> 3 ) : row[x];
+        };
+        smooth( 0, 0, widthUp > 1 ? 1 : 0 );
+        for ( size_t x = 1; x + 1 < widthUp; x++ ) {
+          const int val = up[x - 1] + up[x + 1] + down[x - 1] + down[x + 1] + row[x - 1] + row[x + 1] + up[x] + down[x];
+          dst[x]        = occupancy[x] == 0 ? T( ( val + 4 ) >> 3 ) : row[x];
+        }
+        if ( widthUp > 1 ) { smooth( widthUp - 1, widthUp - 2, widthUp - 1 ); }
       }
+#if defined( ENABLE_TBB )
+    } );
+#else
     }
+#endif
     swap( image, tmpImage );
   }
 }
@@ -6590,9 +6605,11 @@ void PCCEncoder::dilateSmoothedPushPull( PCCFrameContext& frame, PCCImage<T, 3>&
 #endif
 }
 
-void PCCEncoder::presmoothPointCloudColor( PCCPointSet3& reconstruct, const PCCEncoderParameters params ) {
+void PCCEncoder::presmoothPointCloudColor( PCCPointSet3&              reconstruct,
+                                           PCCSharedKdTree&           reconstructKdTree,
+                                           const PCCEncoderParameters params ) {
   const size_t            pointCount = reconstruct.getPointCount();
-  PCCKdTree               kdtree( reconstruct );
+  const PCCKdTree&        kdtree     = reconstructKdTree.get( reconstruct );
   PCCNNResult             result;
   std::vector<PCCColor3B> temp;
   temp.resize( pointCount );
@@ -6693,10 +6710,17 @@ bool PCCEncoder::generateAttributeVideo( const PCCGroupOfFrames&     sources,
           params_.maxColorDist2Fwd_,                         // maxColorDist2Fwd
           params_.maxColorDist2Bwd_,                         // maxColorDist2Bwd
           params_.excludeColorOutlier_,                      // excludeColorOutlier
-          params_.thresholdColorOutlierDist_                 // thresholdColorOutlierDist
+          params_.thresholdColorOutlierDist_,                // thresholdColorOutlierDist
+          &context[i].getSourceKdTree(),                     // sourceKdTree
+          &context[i].getReconstructKdTree()                 // targetKdTree
       );
       // color pre-smoothing
-      if ( params_.flagColorPreSmoothing_ ) { presmoothPointCloudColor( reconstructs[i], params ); }
+      if ( params_.flagColorPreSmoothing_ ) {
+        presmoothPointCloudColor( reconstructs[i], context[i].getReconstructKdTree(), params );
+      }
+      // the indices are not searched after the attribute transfer
+      context[i].getSourceKdTree().clear();
+      context[i].getReconstructKdTree().clear();
       size_t imageWidth  = frame.getWidth();
       size_t imageHeight = frame.getHeight();
       if ( params_.multipleStreams_ ) {
@@ -7136,12 +7160,12 @@ size_t PCCEncoder::unionPatchGenerationAndPacking( const GlobalPatches& globalPa
     occupancySizeU            = std::max<size_t>( occupancySizeU, curPatchUnion.getSizeU0() + 1 );
     occupancySizeV            = std::max<size_t>( occupancySizeV, curPatchUnion.getSizeV0() + 1 );
   }
-  size_t            width           = occupancySizeU * params_.occupancyResolution_;
-  size_t            height          = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
-  int               numOrientations = params_.packingStrategy_ == 0 ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
-  occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+  size_t             width           = occupancySizeU * params_.occupancyResolution_;
+  size_t             height          = occupancySizeV * params_.occupancyResolution_;
+  size_t             maxOccupancyRow = 0;
+  PCCOccupancyCanvas occupancyMap;
+  int                numOrientations = params_.packingStrategy_ == 0 ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
+  occupancyMap.resize( occupancySizeU * occupancySizeV );
   for ( auto& iter : unionPatchTemp ) {
     auto& curPatchUnion = iter.second;  // [u0, v0] may be modified;
     assert( curPatchUnion.getSizeU0() < occupancySizeU );
@@ -7149,49 +7173,19 @@ size_t PCCEncoder::unionPatchGenerationAndPacking( const GlobalPatches& globalPa
     bool  locationFound = false;
     auto& occupancy     = curPatchUnion.getOccupancy();
     while ( !locationFound ) {
-      for ( size_t v = 0; v < occupancySizeV && !locationFound; ++v ) {
-        for ( size_t u = 0; u < occupancySizeU && !locationFound; ++u ) {
-          curPatchUnion.setU0( u );
-          curPatchUnion.setV0( v );
-          if ( params_.packingStrategy_ == 0 ) {
-            curPatchUnion.setPatchOrientation( PATCH_ORIENTATION_DEFAULT );
-            if ( curPatchUnion.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV,
-                                                    params_.lowDelayEncoding_, safeguard ) ) {
-              locationFound = true;
-              if ( g_printDetailedInfo ) {
-                std::cout << "Orientation " << curPatchUnion.getPatchOrientation() << " selected for unionPatch "
-                          << curPatchUnion.getIndex() << " (" << u << "," << v << ")" << std::endl;
-              }
-            }
-          } else {
-            if ( useRefFrame && ( curPatchUnion.getPatchOrientation() != -1 ) ) {
-              // already knonw Patch Orientation. just try.
-              if ( curPatchUnion.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV,
-                                                      params_.lowDelayEncoding_, safeguard ) ) {
-                locationFound = true;
-                if ( g_printDetailedInfo ) {
-                  std::cout << "location u0,v0 selected for unionPatch " << curPatchUnion.getIndex() << " (" << u << ","
-                            << v << ")" << std::endl;
-                }
-              }
-            } else {
-              for ( size_t orientationIdx = 0; orientationIdx < numOrientations && !locationFound; orientationIdx++ ) {
-                if ( curPatchUnion.getSizeU0() > curPatchUnion.getSizeV0() ) {
-                  curPatchUnion.setPatchOrientation( g_orientationHorizontal[orientationIdx] );
-                } else {
-                  curPatchUnion.setPatchOrientation( g_orientationVertical[orientationIdx] );
-                }
-                if ( curPatchUnion.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV,
-                                                        params_.lowDelayEncoding_, safeguard ) ) {
-                  locationFound = true;
-                  if ( g_printDetailedInfo ) {
-                    std::cout << "Orientation " << curPatchUnion.getPatchOrientation() << " selected for unionPatch "
-                              << curPatchUnion.getIndex() << " (" << u << "," << v << ")" << std::endl;
-                  }
-                }
-              }
-            }
-          }
+      // with a reference frame, a known orientation is kept and only the location is searched
+      const bool knownOrientation =
+          params_.packingStrategy_ != 0 && useRefFrame && ( curPatchUnion.getPatchOrientation() != -1 );
+      const auto orientations =
+          knownOrientation ? std::vector<size_t>{curPatchUnion.getPatchOrientation()}
+                           : getPackingOrientations( curPatchUnion, params_.packingStrategy_ == 0, numOrientations );
+      if ( curPatchUnion.findFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
+                                             orientations, safeguard, Tile(), params_.nbThread_ ) ) {
+        locationFound = true;
+        if ( g_printDetailedInfo ) {
+          std::cout << "Orientation " << curPatchUnion.getPatchOrientation() << " selected for unionPatch "
+                    << curPatchUnion.getIndex() << " (" << curPatchUnion.getU0() << "," << curPatchUnion.getV0()
+                    << ")" << std::endl;
         }
       }
       if ( !locationFound ) {
@@ -7203,9 +7197,9 @@ size_t PCCEncoder::unionPatchGenerationAndPacking( const GlobalPatches& globalPa
       for ( size_t u0 = 0; u0 < curPatchUnion.getSizeU0(); ++u0 ) {
         int coord = curPatchUnion.patchBlock2CanvasBlock( u0, v0, occupancySizeU, occupancySizeV );
         if ( params_.lowDelayEncoding_ ) {
-          occupancyMap[coord] = true;
-        } else {
-          occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * curPatchUnion.getSizeU0() + u0];
+          occupancyMap.set( coord );
+        } else if ( occupancy[v0 * curPatchUnion.getSizeU0() + u0] ) {
+          occupancyMap.set( coord );
         }
       }
     }
@@ -7245,8 +7239,9 @@ void PCCEncoder::packingFirstFrame( PCCContext& context,
   heithGPA                          = occupancySizeV * params_.occupancyResolution_;
   size_t            maxOccupancyRow = 0;
   int               numOrientations = ( params_.packingStrategy_ == 0 ) ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
-  std::vector<bool> occupancyMap;
-  occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+
+  PCCOccupancyCanvas occupancyMap;
+  occupancyMap.resize( occupancySizeU * occupancySizeV );
   for ( auto& patch : patches ) {
     assert( patch.getSizeU0() <= occupancySizeU );
     assert( patch.getSizeV0() <= occupancySizeV );
@@ -7326,9 +7321,9 @@ void PCCEncoder::packingFirstFrame( PCCContext& context,
       for ( size_t u0 = 0; u0 < curGPAPatchData.sizeU0_; ++u0 ) {
         int coord = patch.patchBlock2CanvasBlockForGPA( u0, v0, occupancySizeU, occupancySizeV );
         if ( params_.lowDelayEncoding_ ) {
-          occupancyMap[coord] = true;
-        } else {
-          occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * patch.getSizeU0() + u0];
+          occupancyMap.set( coord );
+        } else if ( occupancy[v0 * patch.getSizeU0() + u0] ) {
+          occupancyMap.set( coord );
         }
       }
     }
@@ -7553,11 +7548,11 @@ void PCCEncoder::performGPAPacking( const SubContext& subContext,
     for ( auto& patch : patches ) {
       occupancySizeU = (std::max)( occupancySizeU, patch.getCurGPAPatchData().sizeU0_ + 1 );
     }
-    widthGPA                          = occupancySizeU * params_.occupancyResolution_;
-    heightGPA                         = occupancySizeV * params_.occupancyResolution_;
-    size_t            maxOccupancyRow = 0;
-    std::vector<bool> occupancyMap;
-    occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+    widthGPA                           = occupancySizeU * params_.occupancyResolution_;
+    heightGPA                          = occupancySizeV * params_.occupancyResolution_;
+    size_t             maxOccupancyRow = 0;
+    PCCOccupancyCanvas occupancyMap;
+    occupancyMap.resize( occupancySizeU * occupancySizeV );
     // !!!packing global matched patch;
     for ( auto& patch : patches ) {
       GPAPatchData& curGPAPatchData = patch.getCurGPAPatchData();
@@ -7579,10 +7574,9 @@ void PCCEncoder::performGPAPacking( const SubContext& subContext,
           for ( size_t u0 = 0; u0 < curGPAPatchData.sizeU0_; ++u0 ) {
             int coord = patch.patchBlock2CanvasBlockForGPA( u0, v0, occupancySizeU, occupancySizeV );
             if ( params_.lowDelayEncoding_ ) {
-              occupancyMap[coord] = true;
-            } else {
-              occupancyMap[coord] =
-                  occupancyMap[coord] || curGPAPatchData.occupancy_[v0 * curGPAPatchData.sizeU0_ + u0];
+              occupancyMap.set( coord );
+            } else if ( curGPAPatchData.occupancy_[v0 * curGPAPatchData.sizeU0_ + u0] ) {
+              occupancyMap.set( coord );
             }
           }
         }
@@ -7649,16 +7643,16 @@ void PCCEncoder::performGPAPacking( const SubContext& subContext,
   if ( exceedMinimumImageHeight || badCondition > BAD_CONDITION_THRESHOLD ) { badGPAPacking = true; }
 }
 
-void PCCEncoder::packingWithoutRefForFirstFrameNoglobalPatch( PCCPatch&          patch,
-                                                              size_t             ii,
-                                                              size_t             icount,
-                                                              size_t&            occupancySizeU,
-                                                              size_t&            occupancySizeV,
-                                                              const size_t       safeguard,
-                                                              std::vector<bool>& occupancyMap,
-                                                              size_t&            heightGPA,
-                                                              size_t&            widthGPA,
-                                                              size_t&            maxOccupancyRow ) {
+void PCCEncoder::packingWithoutRefForFirstFrameNoglobalPatch( PCCPatch&           patch,
+                                                              size_t              ii,
+                                                              size_t              icount,
+                                                              size_t&             occupancySizeU,
+                                                              size_t&             occupancySizeV,
+                                                              const size_t        safeguard,
+                                                              PCCOccupancyCanvas& occupancyMap,
+                                                              size_t&             heightGPA,
+                                                              size_t&             widthGPA,
+                                                              size_t&             maxOccupancyRow ) {
   int           numOrientations = ( params_.packingStrategy_ == 0 ) ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
   GPAPatchData& curGPAPatchData = patch.getCurGPAPatchData();
   assert( curGPAPatchData.sizeU0_ <= occupancySizeU );
@@ -7715,9 +7709,9 @@ void PCCEncoder::packingWithoutRefForFirstFrameNoglobalPatch( PCCPatch&
     for ( size_t u0 = 0; u0 < curGPAPatchData.sizeU0_; ++u0 ) {
       int coord = patch.patchBlock2CanvasBlockForGPA( u0, v0, occupancySizeU, occupancySizeV );
       if ( params_.lowDelayEncoding_ ) {
-        occupancyMap[coord] = true;
-      } else {
-        occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * patch.getSizeU0() + u0];
+        occupancyMap.set( coord );
+      } else if ( occupancy[v0 * patch.getSizeU0() + u0] ) {
+        occupancyMap.set( coord );
       }
     }
   }
@@ -7743,7 +7737,7 @@ void PCCEncoder::packingWithRefForFirstFrameNoglobalPatch( PCCPatch&
                                                            size_t&                      occupancySizeU,
                                                            size_t&                      occupancySizeV,
                                                            const size_t                 safeguard,
-                                                           std::vector<bool>&           occupancyMap,
+                                                           PCCOccupancyCanvas&          occupancyMap,
                                                            size_t&                      heightGPA,
                                                            size_t&                      widthGPA,
                                                            size_t&                      maxOccupancyRow ) {
@@ -7836,9 +7830,9 @@ void PCCEncoder::packingWithRefForFirstFrameNoglobalPatch( PCCPatch&
     for ( size_t u0 = 0; u0 < curGPAPatchData.sizeU0_; ++u0 ) {
       int coord = patch.patchBlock2CanvasBlockForGPA( u0, v0, occupancySizeU, occupancySizeV );
       if ( params_.lowDelayEncoding_ ) {
-        occupancyMap[coord] = true;
-      } else {
-        occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * curGPAPatchData.sizeU0_ + u0];
+        occupancyMap.set( coord );
+      } else if ( occupancy[v0 * curGPAPatchData.sizeU0_ + u0] ) {
+        occupancyMap.set( coord );
       }
     }
   }
@@ -8878,8 +8872,9 @@ void PCCEncoder::segmentationPartiallyAddtinalProjectionPlane( const PCCPointSet
     Orthogonal.reserve( 256 );
     float distanceSrcRecA;
     segmenter.setNbThread( params_.nbThread_ );
+    PCCSharedKdTree kdtree;
     segmenter.compute( source, frame.getFrameIndex(), local, Orthogonal, frame.getSrcPointCloudByPatch(),
-                       distanceSrcRecA );
+                       distanceSrcRecA, kdtree );
     distanceSrcRec                  = distanceSrcRecA;
     frame.getSrcPointCloudByPatch() = tmp;
   }
@@ -8895,8 +8890,9 @@ void PCCEncoder::segmentationPartiallyAddtinalProjectionPlane( const PCCPointSet
     Additional.reserve( 256 );
     float distanceSrcRecA;
     segmenter.setNbThread( params_.nbThread_ );
+    PCCSharedKdTree kdtree;
     segmenter.compute( partial, frame.getFrameIndex(), local, Additional, frame.getSrcPointCloudByPatch(),
-                       distanceSrcRecA );
+                       distanceSrcRecA, kdtree );
     distanceSrcRec                  = distanceSrcRecA;
     frame.getSrcPointCloudByPatch() = tmp;
 
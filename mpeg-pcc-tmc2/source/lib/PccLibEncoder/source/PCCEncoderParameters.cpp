@@ -59,6 +59,7 @@ PCCEncoderParameters::PCCEncoderParameters() {
   inverseColorSpaceConversionConfig_   = {};
   nnNormalEstimation_                  = 16;
   normalOrientation_                   = 1;
+  normalEigenSolver_                   = 0;
   forcedSsvhUnitSizePrecisionBytes_    = 0;
   gridBasedRefineSegmentation_         = true;
   maxNNCountRefineSegmentation_        = gridBasedRefineSegmentation_ ? ( gridBasedSegmentation_ ? 384 : 1024 ) : 256;
@@ -135,6 +136,8 @@ PCCEncoderParameters::PCCEncoderParameters() {
   geometryAuxVideoConfig_                  = {};
   attributeAuxVideoConfig_                 = {};
   nbThread_                                = 1;
+  concurrentGofCount_                      = 1;
+  spatialIndexType_                        = 0;
   keepIntermediateFiles_                   = false;
   absoluteD1_                              = false;
   absoluteT1_                              = false;
@@ -335,6 +338,8 @@ void PCCEncoderParameters::print() {
   std::cout << "\t groupOfFramesSize                          " << groupOfFramesSize_ << std::endl;
   std::cout << "\t colorTransform                             " << colorTransform_ << std::endl;
   std::cout << "\t nbThread                                   " << nbThread_ << std::endl;
+  std::cout << "\t concurrentGofCount                         " << concurrentGofCount_ << std::endl;
+  std::cout << "\t spatialIndexType                           " << spatialIndexType_ << std::endl;
   std::cout << "\t keepIntermediateFiles                      " << keepIntermediateFiles_ << std::endl;
   std::cout << "\t multipleStreams                            " << multipleStreams_ << std::endl;
   std::cout << "\t multipleStreams                            " << multipleStreams_ << std::endl;
@@ -356,6 +361,7 @@ void PCCEncoderParameters::print() {
   std::cout << "\t   voxelDimensionGridBasedSegmentation      " << voxelDimensionGridBasedSegmentation_ << std::endl;
   std::cout << "\t   nnNormalEstimation                       " << nnNormalEstimation_ << std::endl;
   std::cout << "\t   normalOrientation                        " << normalOrientation_ << std::endl;
+  std::cout << "\t   normalEigenSolver                        " << normalEigenSolver_ << std::endl;
   std::cout << "\t   gridBasedRefineSegmentation              " << gridBasedRefineSegmentation_ << std::endl;
   std::cout << "\t   maxNNCountRefineSegmentation             " << maxNNCountRefineSegmentation_ << std::endl;
   std::cout << "\t   iterationCountRefineSegmentation         " << iterationCountRefineSegmentation_ << std::endl;
@@ -851,6 +857,11 @@ bool PCCEncoderParameters::check() {
     colorSpaceConversionConfig_        = "";
   }
 
+  if ( spatialIndexType_ > 1 ) {
+    ret = false;
+    std::cerr << "spatialIndexType must be 0 (kd-tree) or 1 (voxel grid)\n";
+  }
+
   if ( compressedStreamPath_.empty() ) {
     ret = false;
     std::cerr << "compressedStreamPath not set\n";
@@ -922,6 +933,10 @@ bool PCCEncoderParameters::check() {
     std::cerr << "WARNING: the normal orientation is out of the possible range [0;3]\n";
     normalOrientation_ = 1;
   }
+  if ( normalEigenSolver_ > 1 ) {
+    std::cerr << "WARNING: the normal eigen solver is out of the possible range [0;1]\n";
+    normalEigenSolver_ = 0;
+  }
   if ( !absoluteT1_ && absoluteD1_ ) {
     std::cerr << "absoluteT1 should be true when absoluteD1 is true\n";
     absoluteT1_ = 1;
@@ -68,91 +68,208 @@ void PCCNormalsGenerator3::compute( const PCCPointSet3&                   pointC
   if ( params.numberOfIterationsInNormalSmoothing_ != 0u ) { smoothNormals( pointCloud, kdtree, params ); }
   orientNormals( pointCloud, kdtree, params );
 }
-void PCCNormalsGenerator3::computeNormal( const size_t                          index,
-                                          const PCCPointSet3&                   pointCloud,
-                                          const PCCKdTree&                      kdtree,
-                                          const PCCNormalsGenerator3Parameters& params,
-                                          PCCNNResult&                          nNResult ) {
-  PCCVector3D bary( pointCloud[index][0], pointCloud[index][1], pointCloud[index][2] );
-  PCCVector3D normal( 0.0 );
-  PCCVector3D eigenval( 0.0 );
-  PCCMatrix3D covMat;
-  PCCMatrix3D Q;
-  PCCMatrix3D D;
-  kdtree.search( pointCloud[index], params.numberOfNearestNeighborsInNormalEstimation_, nNResult );
-  if ( nNResult.count() > 1 ) {
-    bary = 0.0;
-    for ( size_t i = 0; i < nNResult.count(); ++i ) { bary += pointCloud[nNResult.indices( i )]; }
-    bary /= double( nNResult.count() );
-    covMat = 0.0;
-    PCCVector3D pt;
-    for ( size_t i = 0; i < nNResult.count(); ++i ) {
-      pt = pointCloud[nNResult.indices( i )] - bary;
-      covMat[0][0] += pt[0] * pt[0];
-      covMat[1][1] += pt[1] * pt[1];
-      covMat[2][2] += pt[2] * pt[2];
-      covMat[0][1] += pt[0] * pt[1];
-      covMat[0][2] += pt[0] * pt[2];
-      covMat[1][2] += pt[1] * pt[2];
+// neighbourhoods of a batch of consecutive points, stored coefficient by coefficient with the points of the batch
+// as the innermost dimension so that the covariance accumulation and the closed-form solver run across the batch.
+// Neighbor j of point i is at [j * maxSize_ + i]; the slots past the neighbor count of a point have a zero weight.
+struct PCCNormalsGenerator3::PCCNormalsBatch {
+  static const size_t maxSize_ = 16;
+  void                init( const size_t neighborCount ) {
+    x_.resize( neighborCount * maxSize_ );
+    y_.resize( neighborCount * maxSize_ );
+    z_.resize( neighborCount * maxSize_ );
+    w_.resize( neighborCount * maxSize_ );
+  }
+  std::vector<double> x_;
+  std::vector<double> y_;
+  std::vector<double> z_;
+  std::vector<double> w_;
+  size_t              count_[maxSize_];
+  double              bary_[3][maxSize_];
+  double              cov_[6][maxSize_];  // xx, yy, zz, xy, xz, yz
+  double              normal_[3][maxSize_];
+  double              eigenval_[3][maxSize_];
+  bool                solved_[maxSize_];
+};
+
+void PCCNormalsGenerator3::computeNormalBatch( const size_t                          start,
+                                               const size_t                          end,
+                                               const PCCPointSet3&                   pointCloud,
+                                               const PCCKdTree&                      kdtree,
+                                               const PCCNormalsGenerator3Parameters& params,
+                                               PCCNNResult&                          nNResult,
+                                               PCCNormalsBatch&                      batch ) {
+  const size_t B         = PCCNormalsBatch::maxSize_;
+  const size_t batchSize = end - start;
+  size_t       maxCount  = 0;
+  double*      x         = batch.x_.data();
+  double*      y         = batch.y_.data();
+  double*      z         = batch.z_.data();
+  double*      w         = batch.w_.data();
+  auto&        bary      = batch.bary_;
+  auto&        cov       = batch.cov_;
+  auto&        normal    = batch.normal_;
+  auto&        eigenval  = batch.eigenval_;
+  assert( batchSize <= B );
+  for ( size_t i = 0; i < B; ++i ) {
+    batch.count_[i] = 0;
+    if ( i < batchSize ) {
+      kdtree.search( pointCloud[start + i], params.numberOfNearestNeighborsInNormalEstimation_, nNResult );
+      batch.count_[i] = nNResult.count();
+      maxCount        = ( std::max )( maxCount, nNResult.count() );
+    }
+    for ( size_t j = 0; j < batch.w_.size() / B; ++j ) {
+      if ( j < batch.count_[i] ) {
+        const auto& point = pointCloud[nNResult.indices( j )];
+        x[j * B + i]      = point[0];
+        y[j * B + i]      = point[1];
+        z[j * B + i]      = point[2];
+        w[j * B + i]      = 1.0;
+      } else {
+        x[j * B + i] = y[j * B + i] = z[j * B + i] = w[j * B + i] = 0.0;
+      }
+    }
+  }
+
+  // the sums run over the neighbors in search order for every point, as the zero-weight slots add exact zeros
+  for ( size_t k = 0; k < 3; ++k ) { std::fill( bary[k], bary[k] + B, 0.0 ); }
+  for ( size_t k = 0; k < 6; ++k ) { std::fill( cov[k], cov[k] + B, 0.0 ); }
+  for ( size_t j = 0; j < maxCount; ++j ) {
+    for ( size_t i = 0; i < B; ++i ) {
+      bary[0][i] += x[j * B + i];
+      bary[1][i] += y[j * B + i];
+      bary[2][i] += z[j * B + i];
+    }
+  }
+  for ( size_t i = 0; i < B; ++i ) {
+    const double count = double( ( std::max )( batch.count_[i], size_t( 1 ) ) );
+    bary[0][i] /= count;
+    bary[1][i] /= count;
+    bary[2][i] /= count;
+  }
+  for ( size_t j = 0; j < maxCount; ++j ) {
+    for ( size_t i = 0; i < B; ++i ) {
+      const double dx = ( x[j * B + i] - bary[0][i] ) * w[j * B + i];
+      const double dy = ( y[j * B + i] - bary[1][i] ) * w[j * B + i];
+      const double dz = ( z[j * B + i] - bary[2][i] ) * w[j * B + i];
+      cov[0][i] += dx * dx;
+      cov[1][i] += dy * dy;
+      cov[2][i] += dz * dz;
+      cov[3][i] += dx * dy;
+      cov[4][i] += dx * dz;
+      cov[5][i] += dy * dz;
+    }
+  }
+  for ( size_t i = 0; i < B; ++i ) {
+    const double count = ( std::max )( double( batch.count_[i] ), 2.0 ) - 1.0;
+    for ( size_t k = 0; k < 6; ++k ) { cov[k][i] /= count; }
+    batch.solved_[i] = false;
+  }
+
+  if ( params.eigenSolver_ == PCC_NORMALS_GENERATOR_EIGEN_SOLVER_CLOSED_FORM ) {
+    // eigenvalues from the trigonometric solution of the characteristic polynomial, eigenvector of the smallest
+    // one from the largest cross product of two rows of (A - lambda I)
+    const double twoThirdPi = 2.0 * std::acos( -1.0 ) / 3.0;
+    for ( size_t i = 0; i < B; ++i ) {
+      const double  a00    = cov[0][i];
+      const double  a11    = cov[1][i];
+      const double  a22    = cov[2][i];
+      const double  a01    = cov[3][i];
+      const double  a02    = cov[4][i];
+      const double  a12    = cov[5][i];
+      const double  q      = ( a00 + a11 + a22 ) / 3.0;
+      const double  b00    = a00 - q;
+      const double  b11    = a11 - q;
+      const double  b22    = a22 - q;
+      const double  p2     = b00 * b00 + b11 * b11 + b22 * b22 + 2.0 * ( a01 * a01 + a02 * a02 + a12 * a12 );
+      const double  p      = std::sqrt( p2 / 6.0 );
+      const double  invP   = p > 0.0 ? 1.0 / p : 0.0;
+      const double  det    = b00 * ( b11 * b22 - a12 * a12 ) - a01 * ( a01 * b22 - a12 * a02 ) +
+                             a02 * ( a01 * a12 - b11 * a02 );
+      const double  r      = ( std::min )( ( std::max )( 0.5 * det * invP * invP * invP, -1.0 ), 1.0 );
+      const double  phi    = std::acos( r ) / 3.0;
+      const double  l0     = q + 2.0 * p * std::cos( phi );
+      const double  l2     = q + 2.0 * p * std::cos( phi + twoThirdPi );
+      const double  l1     = 3.0 * q - l0 - l2;
+      const double  r0[3]  = {a00 - l2, a01, a02};
+      const double  r1[3]  = {a01, a11 - l2, a12};
+      const double  r2[3]  = {a02, a12, a22 - l2};
+      const double  c01[3] = {r0[1] * r1[2] - r0[2] * r1[1], r0[2] * r1[0] - r0[0] * r1[2],
+                             r0[0] * r1[1] - r0[1] * r1[0]};
+      const double  c02[3] = {r0[1] * r2[2] - r0[2] * r2[1], r0[2] * r2[0] - r0[0] * r2[2],
+                             r0[0] * r2[1] - r0[1] * r2[0]};
+      const double  c12[3] = {r1[1] * r2[2] - r1[2] * r2[1], r1[2] * r2[0] - r1[0] * r2[2],
+                             r1[0] * r2[1] - r1[1] * r2[0]};
+      const double  n01    = c01[0] * c01[0] + c01[1] * c01[1] + c01[2] * c01[2];
+      const double  n02    = c02[0] * c02[0] + c02[1] * c02[1] + c02[2] * c02[2];
+      const double  n12    = c12[0] * c12[0] + c12[1] * c12[1] + c12[2] * c12[2];
+      const double* c      = n01 >= n02 && n01 >= n12 ? c01 : n02 >= n12 ? c02 : c12;
+      const double  n      = ( std::max )( ( std::max )( n01, n02 ), n12 );
+      const double  invN   = n > 0.0 ? 1.0 / std::sqrt( n ) : 0.0;
+      normal[0][i]         = c[0] * invN;
+      normal[1][i]         = c[1] * invN;
+      normal[2][i]         = c[2] * invN;
+      eigenval[0][i]       = std::fabs( l2 );
+      eigenval[1][i]       = std::fabs( l1 );
+      eigenval[2][i]       = std::fabs( l0 );
+      // the eigenvector is well conditioned when the smallest eigenvalue is separated from the others
+      batch.solved_[i] = l1 - l2 > 1e-6 * p;
     }
-    covMat[1][0] = covMat[0][1];
-    covMat[2][0] = covMat[0][2];
-    covMat[2][1] = covMat[1][2];
-    covMat /= ( nNResult.count() - 1.0 );
+  }
 
-    PCCDiagonalize( covMat, Q, D );
+  for ( size_t i = 0; i < batchSize; ++i ) {
+    const size_t index = start + i;
+    if ( batch.count_[i] <= 1 ) {
+      normal[0][i] = normal[1][i] = normal[2][i] = 0.0;
+      eigenval[0][i] = eigenval[1][i] = eigenval[2][i] = 0.0;
+      bary[0][i]                                       = pointCloud[index][0];
+      bary[1][i]                                       = pointCloud[index][1];
+      bary[2][i]                                       = pointCloud[index][2];
+    } else if ( !batch.solved_[i] ) {
+      PCCMatrix3D covMat;
+      PCCMatrix3D Q;
+      PCCMatrix3D D;
+      covMat[0][0] = cov[0][i];
+      covMat[1][1] = cov[1][i];
+      covMat[2][2] = cov[2][i];
+      covMat[0][1] = covMat[1][0] = cov[3][i];
+      covMat[0][2] = covMat[2][0] = cov[4][i];
+      covMat[1][2] = covMat[2][1] = cov[5][i];
 
-    D[0][0] = fabs( D[0][0] );
-    D[1][1] = fabs( D[1][1] );
-    D[2][2] = fabs( D[2][2] );
+      PCCDiagonalize( covMat, Q, D );
 
-    if ( D[0][0] < D[1][1] && D[0][0] < D[2][2] ) {
-      normal[0]   = Q[0][0];
-      normal[1]   = Q[1][0];
-      normal[2]   = Q[2][0];
-      eigenval[0] = D[0][0];
-      if ( D[1][1] < D[2][2] ) {
-        eigenval[1] = D[1][1];
-        eigenval[2] = D[2][2];
-      } else {
-        eigenval[2] = D[1][1];
-        eigenval[1] = D[2][2];
-      }
-    } else if ( D[1][1] < D[2][2] ) {
-      normal[0]   = Q[0][1];
-      normal[1]   = Q[1][1];
-      normal[2]   = Q[2][1];
-      eigenval[0] = D[1][1];
-      if ( D[0][0] < D[2][2] ) {
-        eigenval[1] = D[0][0];
-        eigenval[2] = D[2][2];
+      D[0][0] = fabs( D[0][0] );
+      D[1][1] = fabs( D[1][1] );
+      D[2][2] = fabs( D[2][2] );
+
+      // the eigenvector of the smallest eigenvalue is the normal
+      const size_t n = ( D[0][0] < D[1][1] && D[0][0] < D[2][2] ) ? 0 : ( D[1][1] < D[2][2] ) ? 1 : 2;
+      const size_t u = n == 0 ? 1 : 0;
+      const size_t v = n == 2 ? 1 : 2;
+      normal[0][i]   = Q[0][n];
+      normal[1][i]   = Q[1][n];
+      normal[2][i]   = Q[2][n];
+      eigenval[0][i] = D[n][n];
+      if ( D[u][u] < D[v][v] ) {
+        eigenval[1][i] = D[u][u];
+        eigenval[2][i] = D[v][v];
       } else {
-        eigenval[2] = D[0][0];
-        eigenval[1] = D[2][2];
+        eigenval[2][i] = D[u][u];
+        eigenval[1][i] = D[v][v];
       }
+    }
+    const PCCVector3D normalI( normal[0][i], normal[1][i], normal[2][i] );
+    if ( normalI * ( params.viewPoint_ - pointCloud[index] ) < 0.0 ) {
+      normals_[index] = -normalI;
     } else {
-      normal[0]   = Q[0][2];
-      normal[1]   = Q[1][2];
-      normal[2]   = Q[2][2];
-      eigenval[0] = D[2][2];
-      if ( D[0][0] < D[1][1] ) {
-        eigenval[1] = D[0][0];
-        eigenval[2] = D[1][1];
-      } else {
-        eigenval[2] = D[0][0];
-        eigenval[1] = D[1][1];
-      }
+      normals_[index] = normalI;
+    }
+    if ( params.storeEigenvalues_ ) {
+      eigenvalues_[index] = PCCVector3D( eigenval[0][i], eigenval[1][i], eigenval[2][i] );
+    }
+    if ( params.storeCentroids_ ) { barycenters_[index] = PCCVector3D( bary[0][i], bary[1][i], bary[2][i] ); }
+    if ( params.storeNumberOfNearestNeighborsInNormalEstimation_ ) {
+      numberOfNearestNeighborsInNormalEstimation_[index] = uint32_t( batch.count_[i] );
     }
-  }
-  if ( normal * ( params.viewPoint_ - pointCloud[index] ) < 0.0 ) {
-    normals_[index] = -normal;
-  } else {
-    normals_[index] = normal;
-  }
-  if ( params.storeEigenvalues_ ) { eigenvalues_[index] = eigenval; }
-  if ( params.storeCentroids_ ) { barycenters_[index] = bary; }
-  if ( params.storeNumberOfNearestNeighborsInNormalEstimation_ ) {
-    numberOfNearestNeighborsInNormalEstimation_[index] = uint32_t( nNResult.count() );
   }
 }
 void PCCNormalsGenerator3::computeNormals( const PCCPointSet3&                   pointCloud,
@@ -170,11 +287,14 @@ void PCCNormalsGenerator3::computeNormals( const PCCPointSet3&
 #else
   for ( size_t i = 0; i < subRanges.size() - 1; i++ ) {
 #endif
-      const size_t start = subRanges[i];
-      const size_t end   = subRanges[i + 1];
-      PCCNNResult  nNResult;
-      for ( size_t ptIndex = start; ptIndex < end; ++ptIndex ) {
-        computeNormal( ptIndex, pointCloud, kdtree, params, nNResult );
+      const size_t    start = subRanges[i];
+      const size_t    end   = subRanges[i + 1];
+      PCCNNResult     nNResult;
+      PCCNormalsBatch batch;
+      batch.init( params.numberOfNearestNeighborsInNormalEstimation_ );
+      for ( size_t ptIndex = start; ptIndex < end; ptIndex += PCCNormalsBatch::maxSize_ ) {
+        computeNormalBatch( ptIndex, ( std::min )( ptIndex + PCCNormalsBatch::maxSize_, end ), pointCloud, kdtree,
+                            params, nNResult, batch );
       }
 #if defined( ENABLE_TBB )
     } );
@@ -205,12 +325,21 @@ void PCCNormalsGenerator3::orientNormals( const PCCPointSet3&
                            params.numberOfNearestNeighborsInNormalOrientation_};
     PCCNNQuery3 nNQuery2 = {PCCPoint3D( 0.0 ), ( std::numeric_limits<float>::max )(),
                             params.numberOfNearestNeighborsInNormalOrientation_};
+    // the seeds of the spanning trees search their neighbors without radius, which is the same query when the
+    // radius does not limit the search
+    const bool       sameQuery = nNQuery.radius > 32768.0;
+    PCCNeighborCache neighborCache;
+    PCCNeighborCache seedNeighborCache;
+    initNeighborCache( neighborCache, nNQuery, pointCount );
+    initNeighborCache( seedNeighborCache, nNQuery2, sameQuery ? 0 : pointCount );
+    fillNeighborCache( neighborCache, pointCloud, kdtree, 0 );
+    auto& seedCache = sameQuery ? neighborCache : seedNeighborCache;
     for ( size_t ptIndex = 0; ptIndex < pointCount; ++ptIndex ) {
       if ( visited_[ptIndex] == 0u ) {
         visited_[ptIndex] = 1;
         size_t      numberOfNormals;
         PCCVector3D accumulatedNormals;
-        addNeighbors( uint32_t( ptIndex ), pointCloud, kdtree, nNQuery2, nNResult, accumulatedNormals,
+        addNeighbors( uint32_t( ptIndex ), pointCloud, kdtree, seedCache, nNResult, accumulatedNormals,
                       numberOfNormals );
         if ( numberOfNormals == 0u ) {
           if ( ptIndex != 0u ) {
@@ -227,7 +356,8 @@ void PCCNormalsGenerator3::orientNormals( const PCCPointSet3&
           if ( visited_[current] == 0u ) {
             visited_[current] = 1;
             if ( normals_[edge.start_] * normals_[current] < 0.0 ) { normals_[current] = -normals_[current]; }
-            addNeighbors( current, pointCloud, kdtree, nNQuery, nNResult, accumulatedNormals, numberOfNormals );
+            addNeighbors( current, pointCloud, kdtree, neighborCache, nNResult, accumulatedNormals,
+                          numberOfNormals );
           }
         }
       }
@@ -454,12 +584,21 @@ void PCCNormalsGenerator3::orientNormals( const PCCPointSet3&
                            params.numberOfNearestNeighborsInNormalOrientation_};
     PCCNNQuery3 nNQuery2 = {PCCPoint3D( 0.0 ), ( std::numeric_limits<float>::max )(),
                             params.numberOfNearestNeighborsInNormalOrientation_};
+    // the projected points and the seeds of the spanning trees search their neighbors without radius, the other
+    // points with nNQuery, which is the same query when the radius does not limit the search
+    const bool       sameQuery = nNQuery.radius > 32768.0;
+    PCCNeighborCache seedCache;
+    PCCNeighborCache propagationCache;
+    initNeighborCache( seedCache, nNQuery2, pointCount );
+    initNeighborCache( propagationCache, nNQuery, sameQuery ? 0 : pointCount );
+    auto& neighborCache = sameQuery ? seedCache : propagationCache;
+    fillNeighborCache( seedCache, pointCloud, kdtree, 1 );
 
     for ( size_t ptIndex = 0; ptIndex < pointCount; ++ptIndex ) {
       if ( visited_[ptIndex] == 1u ) {
         size_t      numberOfNormals;
         PCCVector3D accumulatedNormals;
-        addNeighbors( uint32_t( ptIndex ), pointCloud, kdtree, nNQuery2, nNResult, accumulatedNormals,
+        addNeighbors( uint32_t( ptIndex ), pointCloud, kdtree, seedCache, nNResult, accumulatedNormals,
                       numberOfNormals );
         if ( numberOfNormals == 0u ) {
           if ( ptIndex != 0u ) {
@@ -480,12 +619,13 @@ void PCCNormalsGenerator3::orientNormals( const PCCPointSet3&
     }
     saveNormal3.write( "normal_projection_orientation_smoothed.ply" );
 #endif
+    fillNeighborCache( neighborCache, pointCloud, kdtree, 0 );
     for ( size_t ptIndex = 0; ptIndex < pointCount; ++ptIndex ) {
       if ( visited_[ptIndex] == 0u ) {
         visited_[ptIndex] = 1;
         size_t      numberOfNormals;
         PCCVector3D accumulatedNormals;
-        addNeighbors( uint32_t( ptIndex ), pointCloud, kdtree, nNQuery2, nNResult, accumulatedNormals,
+        addNeighbors( uint32_t( ptIndex ), pointCloud, kdtree, seedCache, nNResult, accumulatedNormals,
                       numberOfNormals );
         if ( numberOfNormals == 0u ) {
           if ( ptIndex != 0u ) {
@@ -502,7 +642,8 @@ void PCCNormalsGenerator3::orientNormals( const PCCPointSet3&
           if ( visited_[current] == 0u ) {
             visited_[current] = 1;
             if ( normals_[edge.start_] * normals_[current] < 0.0 ) { normals_[current] = -normals_[current]; }
-            addNeighbors( current, pointCloud, kdtree, nNQuery, nNResult, accumulatedNormals, numberOfNormals );
+            addNeighbors( current, pointCloud, kdtree, neighborCache, nNResult, accumulatedNormals,
+                          numberOfNormals );
           }
         }
       }
@@ -521,20 +662,19 @@ void PCCNormalsGenerator3::orientNormals( const PCCPointSet3&
 void PCCNormalsGenerator3::addNeighbors( const uint32_t      current,
                                          const PCCPointSet3& pointCloud,
                                          const PCCKdTree&    kdtree,
-                                         PCCNNQuery3&        nNQuery,
+                                         PCCNeighborCache&   cache,
                                          PCCNNResult&        nNResult,
                                          PCCVector3D&        accumulatedNormals,
                                          size_t&             numberOfNormals ) {
   accumulatedNormals = 0.0;
   numberOfNormals    = 0;
-  if ( nNQuery.radius > 32768.0 ) {
-    kdtree.search( pointCloud[current], nNQuery.nearestNeighborCount, nNResult );
-  } else {
-    kdtree.searchRadius( pointCloud[current], nNQuery.nearestNeighborCount, nNQuery.radius, nNResult );
+  if ( cache.counts_[current] == ( std::numeric_limits<uint32_t>::max )() ) {
+    searchNeighbors( current, pointCloud, kdtree, cache, nNResult );
   }
+  const uint32_t* neighbors = cache.indices_.data() + current * cache.query_.nearestNeighborCount;
   PCCWeightedEdge newEdge;
-  for ( size_t i = 0; i < nNResult.count(); ++i ) {
-    uint32_t index = static_cast<uint32_t>( nNResult.indices( i ) );
+  for ( size_t i = 0; i < cache.counts_[current]; ++i ) {
+    uint32_t index = neighbors[i];
     if ( visited_[index] == 0u ) {
       newEdge.weight_ = fabs( normals_[current] * normals_[index] );
       newEdge.end_    = index;
@@ -546,6 +686,59 @@ void PCCNormalsGenerator3::addNeighbors( const uint32_t      current,
     }
   }
 }
+void PCCNormalsGenerator3::initNeighborCache( PCCNeighborCache&  cache,
+                                              const PCCNNQuery3& nNQuery,
+                                              const size_t       pointCount ) {
+  cache.query_ = nNQuery;
+  cache.counts_.assign( pointCount, ( std::numeric_limits<uint32_t>::max )() );
+  cache.indices_.resize( pointCount * nNQuery.nearestNeighborCount );
+}
+void PCCNormalsGenerator3::fillNeighborCache( PCCNeighborCache&   cache,
+                                              const PCCPointSet3& pointCloud,
+                                              const PCCKdTree&    kdtree,
+                                              const uint32_t      visitedFlag ) {
+  const size_t        pointCount = pointCloud.getPointCount();
+  std::vector<size_t> subRanges;
+  const size_t        chunckCount = 64;
+  PCCDivideRange( 0, pointCount, chunckCount, subRanges );
+#if defined( ENABLE_TBB )
+  tbb::task_arena limited( static_cast<int>( nbThread_ ) );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), subRanges.size() - 1, [&]( const size_t i ) {
+#else
+  for ( size_t i = 0; i < subRanges.size() - 1; i++ ) {
+#endif
+      PCCNNResult nNResult;
+      for ( size_t ptIndex = subRanges[i]; ptIndex < subRanges[i + 1]; ++ptIndex ) {
+        if ( visited_[ptIndex] == visitedFlag ) {
+          searchNeighbors( uint32_t( ptIndex ), pointCloud, kdtree, cache, nNResult );
+        }
+      }
+#if defined( ENABLE_TBB )
+    } );
+  } );
+#else
+  }
+#endif
+}
+void PCCNormalsGenerator3::searchNeighbors( const uint32_t      current,
+                                            const PCCPointSet3& pointCloud,
+                                            const PCCKdTree&    kdtree,
+                                            PCCNeighborCache&   cache,
+                                            PCCNNResult&        nNResult ) {
+  const auto& nNQuery = cache.query_;
+  if ( nNQuery.radius > 32768.0 ) {
+    kdtree.search( pointCloud[current], nNQuery.nearestNeighborCount, nNResult );
+  } else {
+    // searchRadius() appends to the result
+    nNResult.resize( 0 );
+    kdtree.searchRadius( pointCloud[current], nNQuery.nearestNeighborCount, nNQuery.radius, nNResult );
+  }
+  assert( nNResult.count() <= nNQuery.nearestNeighborCount );
+  uint32_t* neighbors = cache.indices_.data() + current * nNQuery.nearestNeighborCount;
+  for ( size_t i = 0; i < nNResult.count(); ++i ) { neighbors[i] = static_cast<uint32_t>( nNResult.indices( i ) ); }
+  cache.counts_[current] = static_cast<uint32_t>( nNResult.count() );
+}
 void PCCNormalsGenerator3::smoothNormals( const PCCPointSet3&                   pointCloud,
                                           const PCCKdTree&                      kdtree,
                                           const PCCNormalsGenerator3Parameters& params ) {
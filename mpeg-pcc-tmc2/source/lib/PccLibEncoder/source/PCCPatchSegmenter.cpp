@@ -55,7 +55,8 @@ void PCCPatchSegmenter3::compute( const PCCPointSet3&                 geometry,
                                   const PCCPatchSegmenter3Parameters& params,
                                   std::vector<PCCPatch>&              patches,
                                   std::vector<PCCPointSet3>&          subPointCloud,
-                                  float&                              distanceSrcRec ) {
+                                  float&                              distanceSrcRec,
+                                  PCCSharedKdTree&                    kdtree ) {
   PCCVector3D* orientations     = nullptr;
   size_t       orientationCount = 0;
   if ( params.additionalProjectionPlaneMode_ == 0 ) {
@@ -75,21 +76,24 @@ void PCCPatchSegmenter3::compute( const PCCPointSet3&                 geometry,
     orientationCount = 18;
   }
   std::cout << std::endl << "============= FRAME " << frameIndex << " ============= " << std::endl;
-  PCCPointSet3 geometryVox;
-  Voxels       voxels;
+  PCCPointSet3 voxelized;
+  PCCGridCells voxels;
   if ( params.gridBasedSegmentation_ ) {
     std::cout << "  Converting points to voxels... ";
     convertPointsToVoxels( geometry, params.geometryBitDepth3D_, params.voxelDimensionGridBasedSegmentation_,
-                           geometryVox, voxels );
+                           voxelized, voxels );
     std::cout << "[done]" << std::endl;
-  } else {
-    geometryVox = geometry;
   }
+  // the index of the frame is shared with the later stages, the voxelized cloud gets its own
+  const PCCPointSet3& geometryVox = params.gridBasedSegmentation_ ? voxelized : geometry;
   std::cout << "  Computing normals for original point cloud... ";
-  PCCKdTree            kdtree( geometryVox );
+  PCCKdTree kdtreeVox;
+  if ( params.gridBasedSegmentation_ ) { kdtreeVox.init( geometryVox ); }
+  const PCCKdTree&     kdtreeSegmentation = params.gridBasedSegmentation_ ? kdtreeVox : kdtree.get( geometry );
   PCCNNResult          result;
   PCCNormalsGenerator3 normalsGen;
   auto                 normalsOrientation = static_cast<PCCNormalsGeneratorOrientation>( params.normalOrientation_ );
+  auto                 normalsEigenSolver = static_cast<PCCNormalsGeneratorEigenSolver>( params.normalEigenSolver_ );
   const PCCNormalsGenerator3Parameters normalsGenParams = {PCCVector3D( 0.0 ),
                                                            ( std::numeric_limits<double>::max )(),
                                                            ( std::numeric_limits<double>::max )(),
@@ -102,9 +106,10 @@ void PCCPatchSegmenter3::compute( const PCCPointSet3&                 geometry,
                                                            normalsOrientation,
                                                            false,
                                                            false,
-                                                           false};
+                                                           false,
+                                                           normalsEigenSolver};
   // PCC_NORMALS_GENERATOR_ORIENTATION_SPANNING_TREE,
-  normalsGen.compute( geometryVox, kdtree, normalsGenParams, nbThread_ );
+  normalsGen.compute( geometryVox, kdtreeSegmentation, normalsGenParams, nbThread_ );
   std::cout << "[done]" << std::endl;
 
   std::cout << "  Computing initial segmentation... ";
@@ -125,7 +130,7 @@ void PCCPatchSegmenter3::compute( const PCCPointSet3&                 geometry,
                                  params.searchRadiusRefineSegmentation_, partition );
   } else {
     std::cout << "  Refining segmentation... ";
-    refineSegmentation( geometryVox, kdtree, normalsGen, orientations, orientationCount,
+    refineSegmentation( geometryVox, kdtreeSegmentation, normalsGen, orientations, orientationCount,
                         params.maxNNCountRefineSegmentation_, params.lambdaRefineSegmentation_,
                         params.iterationCountRefineSegmentation_, partition );
   }
@@ -133,10 +138,8 @@ void PCCPatchSegmenter3::compute( const PCCPointSet3&                 geometry,
 
   if ( params.gridBasedSegmentation_ ) {
     std::cout << "  Applying voxels' data to points... ";
-    applyVoxelsDataToPoints( geometry.getPointCount(), params.geometryBitDepth3D_,
-                             params.voxelDimensionGridBasedSegmentation_, voxels, geometryVox, normalsGen, partition );
+    applyVoxelsDataToPoints( geometry.getPointCount(), voxels, normalsGen, partition );
     std::cout << "[done]" << std::endl;
-    kdtree.init( geometry );
   }
   std::cout << "  Patch segmentation... ";
   PCCPointSet3        resampled;
@@ -144,8 +147,9 @@ void PCCPatchSegmenter3::compute( const PCCPointSet3&                 geometry,
   std::vector<size_t> resampledPatchPartition;
   std::vector<size_t> rawPoints;
 
-  segmentPatches( geometry, frameIndex, kdtree, params, partition, patches, patchPartition, resampledPatchPartition,
-                  rawPoints, resampled, subPointCloud, distanceSrcRec, normalsGen, orientations, orientationCount );
+  segmentPatches( geometry, frameIndex, kdtree.get( geometry ), params, partition, patches, patchPartition,
+                  resampledPatchPartition, rawPoints, resampled, subPointCloud, distanceSrcRec, normalsGen,
+                  orientations, orientationCount );
   std::cout << "[done]" << std::endl;
 }
 
@@ -153,61 +157,49 @@ void PCCPatchSegmenter3::convertPointsToVoxels( const PCCPointSet3& source,
                                                 size_t              geoBits,
                                                 size_t              voxDim,
                                                 PCCPointSet3&       sourceVox,
-                                                Voxels&             voxels ) {
+                                                PCCGridCells&       voxels ) {
 #define ADD_COLOR 0
   const size_t geoBits2    = geoBits << 1;
   size_t       voxDimShift = 0;
   for ( size_t i = voxDim; i > 1; ++voxDimShift, i >>= 1 ) { ; }
   const size_t voxDimHalf = voxDim >> 1;
 
-  auto subToInd = [&]( uint64_t x, uint64_t y, uint64_t z ) { return x + ( y << geoBits ) + ( z << geoBits2 ); };
-
-  for ( size_t i = 0; i < source.getPointCount(); ++i ) {
-    const auto& pos = source[i];
-    const auto  x0  = ( static_cast<uint64_t>( pos[0] ) + voxDimHalf ) >> voxDimShift;
-    const auto  y0  = ( static_cast<uint64_t>( pos[1] ) + voxDimHalf ) >> voxDimShift;
-    const auto  z0  = ( static_cast<uint64_t>( pos[2] ) + voxDimHalf ) >> voxDimShift;
-    const auto  p   = subToInd( x0, y0, z0 );
-    if ( voxels.count( p ) == 0u ) {
-      voxels[p].reserve( voxDim * voxDim << 1 );
-      const size_t j = sourceVox.addPoint( PCCPoint3D( x0, y0, z0 ) );
+  auto toVoxel = [&]( const PCCPoint3D& pos ) {
+    return PCCPoint3D( ( static_cast<uint64_t>( pos[0] ) + voxDimHalf ) >> voxDimShift,
+                       ( static_cast<uint64_t>( pos[1] ) + voxDimHalf ) >> voxDimShift,
+                       ( static_cast<uint64_t>( pos[2] ) + voxDimHalf ) >> voxDimShift );
+  };
+  auto subToInd = [&]( const PCCPoint3D& point ) {
+    return (uint64_t)point[0] + ( (uint64_t)point[1] << geoBits ) + ( (uint64_t)point[2] << geoBits2 );
+  };
+
+  std::vector<uint64_t> keys( source.getPointCount() );
+  for ( size_t i = 0; i < source.getPointCount(); ++i ) { keys[i] = subToInd( toVoxel( source[i] ) ); }
+  voxels.init( keys );
+  sourceVox.reserve( voxels.size() );
+  for ( size_t c = 0; c < voxels.size(); ++c ) {
+    const size_t i = voxels.getFirstPoint( c );
+    const size_t j = sourceVox.addPoint( toVoxel( source[i] ) );
 #if ADD_COLOR
-      sourceVox.addColors();
-      sourceVox.setColor( j, source.getColor( i ) );
+    sourceVox.addColors();
+    sourceVox.setColor( j, source.getColor( i ) );
 #endif
-    }
-    voxels[p].push_back( i );
   }
 }
 
 void PCCPatchSegmenter3::applyVoxelsDataToPoints( size_t                pointCount,
-                                                  size_t                geoBits,
-                                                  size_t                voxDim,
-                                                  Voxels&               voxels,  // const
-                                                  const PCCPointSet3&   sourceVox,
+                                                  const PCCGridCells&   voxels,
                                                   PCCNormalsGenerator3& normalsGen,
                                                   std::vector<size_t>&  partitions ) {
   std::vector<size_t>      partitionsTmp( pointCount );
   std::vector<PCCVector3D> normalsTmp( pointCount );
   auto&                    normals = normalsGen.getNormals();
-
-  const size_t geoBits2    = geoBits << 1;
-  size_t       voxDimShift = 0;
-  for ( size_t i = voxDim; i > 1; ++voxDimShift, i >>= 1 ) { ; }
-  const size_t voxDimHalf = voxDim >> 1;
-
-  auto subToInd = [&]( const PCCPoint3D& point ) {
-    return (uint64_t)point[0] + ( (uint64_t)point[1] << geoBits ) + ( (uint64_t)point[2] << geoBits2 );
-  };
-
-  for ( size_t i = 0; i < sourceVox.getPointCount(); i++ ) {
+  for ( size_t i = 0; i < voxels.size(); i++ ) {
     const auto& partition = partitions[i];
     const auto& normal    = normals[i];
-    const auto& pos       = sourceVox[i];
-    const auto& indices   = voxels[subToInd( pos )];
-    for ( const auto& index : indices ) {
-      partitionsTmp[index] = partition;
-      normalsTmp[index]    = normal;
+    for ( auto index = voxels.begin( i ); index != voxels.end( i ); ++index ) {
+      partitionsTmp[*index] = partition;
+      normalsTmp[*index]    = normal;
     }
   }
   swap( partitions, partitionsTmp );
@@ -264,12 +256,131 @@ void PCCPatchSegmenter3::initialSegmentation( const PCCPointSet3&         geomet
 #endif
 }
 
-void PCCPatchSegmenter3::computeAdjacencyInfo( const PCCPointSet3&               pointCloud,
-                                               const PCCKdTree&                  kdtree,
-                                               std::vector<std::vector<size_t>>& adj,
-                                               const size_t                      maxNNCount ) {
-  const size_t pointCount = pointCloud.getPointCount();
-  adj.resize( pointCount );
+void PCCGridCells::init( const std::vector<uint64_t>& keys ) {
+  const size_t   pointCount = keys.size();
+  const uint32_t invalid    = ( std::numeric_limits<uint32_t>::max )();
+  assert( pointCount < invalid );
+  uint64_t maxKey = 0;
+  for ( const auto key : keys ) { maxKey = ( std::max )( maxKey, key ); }
+
+  // stable LSD radix sort of the point indices on 16-bit digits of their keys: the points of a cell become
+  // contiguous and stay in increasing order
+  std::vector<uint32_t> order( pointCount );
+  std::vector<uint32_t> sorted( pointCount );
+  std::vector<uint32_t> histogram( size_t( 1 ) << 16 );
+  for ( size_t i = 0; i < pointCount; ++i ) { order[i] = static_cast<uint32_t>( i ); }
+  for ( size_t shift = 0; shift < 64 && ( maxKey >> shift ) != 0; shift += 16 ) {
+    std::fill( histogram.begin(), histogram.end(), 0 );
+    for ( const auto i : order ) { ++histogram[( keys[i] >> shift ) & 0xFFFF]; }
+    uint32_t position = 0;
+    for ( auto& count : histogram ) {
+      const uint32_t binCount = count;
+      count                   = position;
+      position += binCount;
+    }
+    for ( const auto i : order ) { sorted[histogram[( keys[i] >> shift ) & 0xFFFF]++] = i; }
+    std::swap( order, sorted );
+  }
+
+  // the runs of equal keys are the cells, renumbered in the order of their first point
+  std::vector<uint32_t> runStarts;
+  std::vector<uint32_t> runOfFirstPoint( pointCount, invalid );
+  for ( size_t i = 0; i < pointCount; ++i ) {
+    if ( i == 0 || keys[order[i]] != keys[order[i - 1]] ) {
+      runOfFirstPoint[order[i]] = static_cast<uint32_t>( runStarts.size() );
+      runStarts.push_back( static_cast<uint32_t>( i ) );
+    }
+  }
+  runStarts.push_back( static_cast<uint32_t>( pointCount ) );
+  offsets_.resize( runStarts.size() );
+  points_.resize( pointCount );
+  offsets_[0]  = 0;
+  size_t cell  = 0;
+  auto   point = points_.begin();
+  for ( size_t i = 0; i < pointCount; ++i ) {
+    const uint32_t run = runOfFirstPoint[i];
+    if ( run == invalid ) { continue; }
+    point            = std::copy( order.begin() + runStarts[run], order.begin() + runStarts[run + 1], point );
+    offsets_[++cell] = static_cast<uint32_t>( point - points_.begin() );
+  }
+}
+
+void PCCGridCellAttributes::init( const size_t cellCount, const size_t orientationCount ) {
+  orientationCount_ = orientationCount;
+  scoreSmooth_.assign( cellCount * orientationCount, 0 );
+  edge_.assign( cellCount, NO_EDGE );
+  updateFlag_.assign( cellCount, 1 );
+  totalPoints_.assign( cellCount, 0 );
+  ppi_.assign( cellCount, 0 );
+}
+
+void PCCGridCellAttributes::updateScores( const size_t               index,
+                                          const uint32_t*            begin,
+                                          const uint32_t*            end,
+                                          const std::vector<size_t>& partitions ) {
+  // clears the scores
+  uint16_t* scores    = scoreSmooth_.data() + index * orientationCount_;
+  uint16_t* scoresEnd = scores + orientationCount_;
+  std::fill( scores, scoresEnd, 0 );
+  for ( auto j = begin; j != end; ++j ) { ++scores[partitions[*j]]; }
+
+  // update voxel type (1st voxel classification)
+  if ( updateFlag_[index] == 0u ) { return; }
+  if ( edge_[index] != S_DIRECT_EDGE ) {
+    const size_t uniformityIdx = orientationCount_ - std::count( scores, scoresEnd, 0 );
+    edge_[index]               = ( uniformityIdx == 1 ) ? NO_EDGE : M_DIRECT_EDGE;
+  }
+  ppi_[index]        = static_cast<uint8_t>( std::distance( scores, std::max_element( scores, scoresEnd ) ) );
+  updateFlag_[index] = 0;
+}
+
+void PCCAdjacencyGraph::init( const std::vector<uint32_t>& counts,
+                              std::vector<uint32_t>&       neighbors,
+                              std::vector<float>&          dist ) {
+  offsets_.resize( counts.size() + 1 );
+  offsets_[0] = 0;
+  for ( size_t i = 0; i < counts.size(); ++i ) { offsets_[i + 1] = offsets_[i] + counts[i]; }
+  assert( offsets_.back() == neighbors.size() && ( dist.empty() || dist.size() == neighbors.size() ) );
+  neighbors_.swap( neighbors );
+  dist_.swap( dist );
+}
+
+void PCCAdjacencyGraph::init( const size_t nodeCount, const size_t neighborCount, const bool keepDistances ) {
+  assert( nodeCount * neighborCount <= ( std::numeric_limits<uint32_t>::max )() );
+  offsets_.resize( nodeCount + 1 );
+  for ( size_t i = 0; i <= nodeCount; ++i ) { offsets_[i] = static_cast<uint32_t>( i * neighborCount ); }
+  neighbors_.resize( nodeCount * neighborCount );
+  if ( keepDistances ) {
+    dist_.resize( nodeCount * neighborCount );
+  } else {
+    dist_.clear();
+  }
+}
+
+void PCCAdjacencyGraph::truncate( const std::vector<uint32_t>& counts ) {
+  uint32_t position = 0;
+  for ( size_t i = 0; i < counts.size(); ++i ) {
+    const uint32_t start = offsets_[i];
+    assert( counts[i] <= offsets_[i + 1] - start );
+    offsets_[i] = position;
+    for ( uint32_t j = start; j < start + counts[i]; ++j, ++position ) {
+      neighbors_[position] = neighbors_[j];
+      if ( !dist_.empty() ) { dist_[position] = dist_[j]; }
+    }
+  }
+  offsets_[counts.size()] = position;
+  neighbors_.resize( position );
+  if ( !dist_.empty() ) { dist_.resize( position ); }
+}
+
+void PCCPatchSegmenter3::computeAdjacencyInfo( const PCCPointSet3& pointCloud,
+                                               const PCCKdTree&    kdtree,
+                                               PCCAdjacencyGraph&  adj,
+                                               const size_t        maxNNCount ) {
+  const size_t pointCount    = pointCloud.getPointCount();
+  const size_t neighborCount = ( std::min )( maxNNCount, pointCount );
+  adj.init( pointCount, neighborCount, false );
+  auto& neighbors = adj.getNeighbors();
 #if defined( ENABLE_TBB )
   tbb::task_arena limited( static_cast<int>( nbThread_ ) );
   limited.execute( [&] {
@@ -278,10 +389,10 @@ void PCCPatchSegmenter3::computeAdjacencyInfo( const PCCPointSet3&
   for ( size_t i = 0; i < pointCount; i++ ) {
 #endif
       PCCNNResult result;
-      kdtree.search( pointCloud[i], maxNNCount, result );
-      std::vector<size_t>& neighbors = adj[i];
-      neighbors.resize( result.count() );
-      for ( size_t j = 0; j < result.count(); ++j ) { neighbors[j] = result.indices( j ); }
+      kdtree.search( pointCloud[i], neighborCount, result );
+      assert( result.count() == neighborCount );
+      uint32_t* neighborsOfI = neighbors.data() + i * neighborCount;
+      for ( size_t j = 0; j < neighborCount; ++j ) { neighborsOfI[j] = static_cast<uint32_t>( result.indices( j ) ); }
 #if defined( ENABLE_TBB )
       } );
     } );
@@ -290,41 +401,62 @@ void PCCPatchSegmenter3::computeAdjacencyInfo( const PCCPointSet3&
 #endif
 }
 
-void PCCPatchSegmenter3::computeAdjacencyInfoInRadius( const PCCPointSet3&                 pointCloud,
-                                                       const PCCKdTree&                    kdtree,
-                                                       std::vector<std::vector<uint32_t>>& adj,
-                                                       const size_t                        maxNNCount,
-                                                       const size_t                        radius ) {
-  const size_t pointCount = pointCloud.getPointCount();
-  adj.resize( pointCount );
+void PCCPatchSegmenter3::computeAdjacencyInfoInRadius( const PCCPointSet3& pointCloud,
+                                                       const PCCKdTree&    kdtree,
+                                                       PCCAdjacencyGraph&  adj,
+                                                       const size_t        maxNNCount,
+                                                       const size_t        radius ) {
+  // the neighbor counts vary: blocks of nodes are searched concurrently, then concatenated in node order
+  const size_t                       pointCount = pointCloud.getPointCount();
+  const size_t                       blockSize  = 1024;
+  const size_t                       blockCount = ( pointCount + blockSize - 1 ) / blockSize;
+  std::vector<std::vector<uint32_t>> blockNeighbors( blockCount );
+  std::vector<uint32_t>              counts( pointCount );
 #if defined( ENABLE_TBB )
   tbb::task_arena limited( static_cast<int>( nbThread_ ) );
   limited.execute( [&] {
-    tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
+    tbb::parallel_for( size_t( 0 ), blockCount, [&]( const size_t block ) {
 #else
-  for ( size_t i = 0; i < pointCount; i++ ) {
+  for ( size_t block = 0; block < blockCount; block++ ) {
 #endif
       PCCNNResult result;
-      kdtree.searchRadius( pointCloud[i], maxNNCount, radius, result );
-      std::vector<uint32_t>& neighbors = adj[i];
-      neighbors.resize( result.count() );
-      for ( size_t j = 0; j < result.count(); ++j ) { neighbors[j] = result.indices( j ); }
+      auto&       neighbors = blockNeighbors[block];
+      for ( size_t i = block * blockSize; i < ( std::min )( pointCount, ( block + 1 ) * blockSize ); ++i ) {
+        result.resize( 0 );
+        kdtree.searchRadius( pointCloud[i], maxNNCount, radius, result );
+        counts[i] = static_cast<uint32_t>( result.count() );
+        for ( size_t j = 0; j < result.count(); ++j ) {
+          neighbors.push_back( static_cast<uint32_t>( result.indices( j ) ) );
+        }
+      }
 #if defined( ENABLE_TBB )
       } );
     } );
 #else
   }
 #endif
+  size_t neighborCount = 0;
+  for ( const auto& neighbors : blockNeighbors ) { neighborCount += neighbors.size(); }
+  assert( neighborCount <= ( std::numeric_limits<uint32_t>::max )() );
+  std::vector<uint32_t> neighbors;
+  std::vector<float>    dist;
+  neighbors.reserve( neighborCount );
+  for ( auto& block : blockNeighbors ) {
+    neighbors.insert( neighbors.end(), block.begin(), block.end() );
+    std::vector<uint32_t>().swap( block );
+  }
+  adj.init( counts, neighbors, dist );
 }
 
-void PCCPatchSegmenter3::computeAdjacencyInfoDist( const PCCPointSet3&               pointCloud,
-                                                   const PCCKdTree&                  kdtree,
-                                                   std::vector<std::vector<size_t>>& adj,
-                                                   std::vector<std::vector<double>>& adjDist,
-                                                   const size_t                      maxNNCount ) {
-  const size_t pointCount = pointCloud.getPointCount();
-  adj.resize( pointCount );
-  adjDist.resize( pointCount );
+void PCCPatchSegmenter3::computeAdjacencyInfoDist( const PCCPointSet3& pointCloud,
+                                                   const PCCKdTree&    kdtree,
+                                                   PCCAdjacencyGraph&  adj,
+                                                   const size_t        maxNNCount ) {
+  const size_t pointCount    = pointCloud.getPointCount();
+  const size_t neighborCount = ( std::min )( maxNNCount, pointCount );
+  adj.init( pointCount, neighborCount, true );
+  auto& neighbors = adj.getNeighbors();
+  auto& dist      = adj.getDistances();
 #if defined( ENABLE_TBB )
   tbb::task_arena limited( static_cast<int>( nbThread_ ) );
   limited.execute( [&] {
@@ -333,14 +465,11 @@ void PCCPatchSegmenter3::computeAdjacencyInfoDist( const PCCPointSet3&
   for ( size_t i = 0; i < pointCount; i++ ) {
 #endif
       PCCNNResult result;
-      kdtree.search( pointCloud[i], maxNNCount, result );
-      std::vector<size_t>& neighbors     = adj[i];
-      std::vector<double>& neighborsDist = adjDist[i];
-      neighbors.resize( result.count() );
-      neighborsDist.resize( result.count() );
-      for ( size_t j = 0; j < result.count(); ++j ) {
-        neighbors[j]     = result.indices( j );
-        neighborsDist[j] = result.dist( j );
+      kdtree.search( pointCloud[i], neighborCount, result );
+      assert( result.count() == neighborCount );
+      for ( size_t j = 0; j < neighborCount; ++j ) {
+        neighbors[i * neighborCount + j] = static_cast<uint32_t>( result.indices( j ) );
+        dist[i * neighborCount + j]      = static_cast<float>( result.dist( j ) );
       }
 #if defined( ENABLE_TBB )
     } );
@@ -590,6 +719,7 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
   const size_t pointCount             = points.getPointCount();
   patchPartition.resize( pointCount, 0 );
   resampledPatchPartition.reserve( pointCount );
+  resampled.reserve( pointCount );
   PCCNNResult             result;
   std::vector<PCCColor3B> frame_pcc_color;
   frame_pcc_color.reserve( pointCount );
@@ -600,19 +730,18 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
   size_t numD1Points      = 0;
   size_t numEOMOnlyPoints = 0;
   std::cout << "\n\t Computing adjacency info... ";
-  std::vector<std::vector<size_t>>              adj;
-  std::vector<std::vector<double>>              adjDist;
-  std::vector<bool>                             flagExp;
-  int                                           numROIs;
-  int                                           numChunks;
-  std::vector<PCCPointSet3>                     pointsChunks;
-  std::vector<std::vector<size_t>>              pointsIndexChunks;
-  std::vector<size_t>                           pointCountChunks;
-  std::vector<PCCKdTree>                        kdtreeChunks;
-  std::vector<PCCBox3D>                         boundingBoxChunks;
-  std::vector<std::vector<std::vector<size_t>>> adjChunks;
+  PCCAdjacencyGraph                adj;
+  std::vector<bool>                flagExp;
+  int                              numROIs;
+  int                              numChunks;
+  std::vector<PCCPointSet3>        pointsChunks;
+  std::vector<std::vector<size_t>> pointsIndexChunks;
+  std::vector<size_t>              pointCountChunks;
+  std::vector<PCCKdTree>           kdtreeChunks;
+  std::vector<PCCBox3D>            boundingBoxChunks;
+  std::vector<PCCAdjacencyGraph>   adjChunks;
   if ( patchExpansionEnabled ) {
-    computeAdjacencyInfoDist( points, kdtree, adj, adjDist, maxNNCount );
+    computeAdjacencyInfoDist( points, kdtree, adj, maxNNCount );
     flagExp.resize( pointCount, false );
   } else {
     if ( !enablePointCloudPartitioning ) {
@@ -740,13 +869,11 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
       for ( size_t i = 0; i < pointCount; ++i ) {
         for ( size_t chunkIndex = 0; chunkIndex < numChunks; ++chunkIndex ) {
           const auto& boundingBox = boundingBoxChunks[chunkIndex];
-          if ( boundingBox.fullyContains( points[i] ) ) {
-            pointsChunks[chunkIndex].addPoint( points[i] );
-            pointsIndexChunks[chunkIndex].push_back( i );
-          }
+          if ( boundingBox.fullyContains( points[i] ) ) { pointsIndexChunks[chunkIndex].push_back( i ); }
         }
       }
       for ( size_t chunkIndex = 0; chunkIndex < numChunks; ++chunkIndex ) {
+        pointsChunks[chunkIndex].appendPoints( points, pointsIndexChunks[chunkIndex] );
         pointCountChunks[chunkIndex] = pointsChunks[chunkIndex].getPointCount();
       }
 
@@ -804,77 +931,122 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
   while ( !rawPoints.empty() ) {
     std::vector<std::vector<size_t>> connectedComponents;
     if ( !enablePointCloudPartitioning ) {
-      std::vector<size_t> fifo;
-      fifo.reserve( pointCount );
-      std::vector<bool> flags;
-      flags.resize( pointCount, false );
-      for ( const auto i : rawPoints ) { flags[i] = true; }
-      connectedComponents.reserve( 256 );
+      // a flood fill never leaves the cluster of its seed: the clusters are filled concurrently and their connected
+      // components are then merged in the order of their seeds in rawPoints
+      std::vector<uint8_t> flags( pointCount, 0 );
+      size_t               clusterCount = 0;
       for ( const auto i : rawPoints ) {
-        if ( flags[i] && rawPointsDistance[i] > maxAllowedDist2RawPointsDetection ) {
-          flags[i]                  = false;
-          const size_t indexCC      = connectedComponents.size();
-          const size_t clusterIndex = partition[i];
-          connectedComponents.resize( indexCC + 1 );
-          std::vector<size_t>& connectedComponent = connectedComponents[indexCC];
-          fifo.push_back( i );
-          connectedComponent.push_back( i );
-          while ( !fifo.empty() ) {
-            const size_t current = fifo.back();
-            fifo.pop_back();
-            for ( const auto n : adj[current] ) {
-              if ( clusterIndex == partition[n] && flags[n] ) {
-                flags[n] = false;
-                fifo.push_back( n );
-                connectedComponent.push_back( n );
+        flags[i]     = 1;
+        clusterCount = ( std::max )( clusterCount, partition[i] + 1 );
+      }
+      std::vector<std::vector<size_t>> seedsPerCluster( clusterCount );
+      for ( size_t r = 0; r < rawPoints.size(); ++r ) {
+        if ( rawPointsDistance[rawPoints[r]] > maxAllowedDist2RawPointsDetection ) {
+          seedsPerCluster[partition[rawPoints[r]]].push_back( r );
+        }
+      }
+      std::vector<std::vector<std::pair<size_t, std::vector<size_t>>>> componentsPerCluster( clusterCount );
+#if defined( ENABLE_TBB )
+      tbb::task_arena limited( static_cast<int>( nbThread_ ) );
+      limited.execute( [&] {
+        tbb::parallel_for( size_t( 0 ), clusterCount, [&]( const size_t clusterIndex ) {
+#else
+      for ( size_t clusterIndex = 0; clusterIndex < clusterCount; clusterIndex++ ) {
+#endif
+          std::vector<size_t> fifo;
+          for ( const auto r : seedsPerCluster[clusterIndex] ) {
+            const size_t i = rawPoints[r];
+            if ( flags[i] == 0 ) { continue; }
+            flags[i] = 0;
+            std::vector<size_t> connectedComponent( 1, i );
+            fifo.push_back( i );
+            while ( !fifo.empty() ) {
+              const size_t current = fifo.back();
+              fifo.pop_back();
+              for ( const auto n : adj[current] ) {
+                if ( clusterIndex == partition[n] && flags[n] != 0 ) {
+                  flags[n] = 0;
+                  fifo.push_back( n );
+                  connectedComponent.push_back( n );
+                }
               }
             }
+            if ( connectedComponent.size() >= minPointCountPerCC ) {
+              componentsPerCluster[clusterIndex].emplace_back( r, std::move( connectedComponent ) );
+            }
           }
-          if ( connectedComponent.size() < minPointCountPerCC ) {
-            connectedComponents.resize( indexCC );
-          } else {
-            std::cout << "\t\t CC " << indexCC << " -> " << connectedComponent.size() << std::endl;
-          }
-        }
+#if defined( ENABLE_TBB )
+        } );
+      } );
+#else
+      }
+#endif
+      std::vector<std::pair<size_t, std::vector<size_t>>> components;
+      for ( auto& clusterComponents : componentsPerCluster ) {
+        for ( auto& component : clusterComponents ) { components.push_back( std::move( component ) ); }
+      }
+      typedef std::pair<size_t, std::vector<size_t>> SeededComponent;
+      std::sort( components.begin(), components.end(),
+                 []( const SeededComponent& a, const SeededComponent& b ) { return a.first < b.first; } );
+      connectedComponents.reserve( components.size() );
+      for ( auto& component : components ) {
+        std::cout << "\t\t CC " << connectedComponents.size() << " -> " << component.second.size() << std::endl;
+        connectedComponents.push_back( std::move( component.second ) );
       }
 
       std::cout << " # CC " << connectedComponents.size() << std::endl;
     } else {
+      // the chunks are independent: their connected components are extracted concurrently and logged in order
       std::vector<std::vector<std::vector<size_t>>> connectedComponentsChunks( numChunks );
+#if defined( ENABLE_TBB )
+      tbb::task_arena limited( static_cast<int>( nbThread_ ) );
+      limited.execute( [&] {
+        tbb::parallel_for( size_t( 0 ), size_t( numChunks ), [&]( const size_t chunkIndex ) {
+#else
       for ( size_t chunkIndex = 0; chunkIndex < numChunks; ++chunkIndex ) {
-        std::cout << "\n\t Extracting connected components of chunk " << chunkIndex << "... ";
-        std::vector<size_t> fifo;
-        fifo.reserve( pointCountChunks[chunkIndex] );
-        std::vector<bool> flags;
-        flags.resize( pointCountChunks[chunkIndex], false );
-        for ( const auto i : rawPointsChunks[chunkIndex] ) { flags[i] = true; }
-        connectedComponentsChunks[chunkIndex].reserve( 256 );
-        for ( const auto i : rawPointsChunks[chunkIndex] ) {
-          if ( flags[i] && rawPointsDistanceChunks[chunkIndex][i] > maxAllowedDist2RawPointsDetection ) {
-            flags[i]                  = false;
-            const size_t indexCC      = connectedComponentsChunks[chunkIndex].size();
-            const size_t clusterIndex = partition[pointsIndexChunks[chunkIndex][i]];
-            connectedComponentsChunks[chunkIndex].resize( indexCC + 1 );
-            std::vector<size_t>& connectedComponentChunk = connectedComponentsChunks[chunkIndex][indexCC];
-            fifo.push_back( i );
-            connectedComponentChunk.push_back( i );
-            while ( !fifo.empty() ) {
-              const size_t current = fifo.back();
-              fifo.pop_back();
-              for ( const auto n : adjChunks[chunkIndex][current] ) {
-                if ( clusterIndex == partition[pointsIndexChunks[chunkIndex][n]] && flags[n] ) {
-                  flags[n] = false;
-                  fifo.push_back( n );
-                  connectedComponentChunk.push_back( n );
+#endif
+          std::vector<size_t> fifo;
+          fifo.reserve( pointCountChunks[chunkIndex] );
+          std::vector<bool> flags;
+          flags.resize( pointCountChunks[chunkIndex], false );
+          for ( const auto i : rawPointsChunks[chunkIndex] ) { flags[i] = true; }
+          connectedComponentsChunks[chunkIndex].reserve( 256 );
+          for ( const auto i : rawPointsChunks[chunkIndex] ) {
+            if ( flags[i] && rawPointsDistanceChunks[chunkIndex][i] > maxAllowedDist2RawPointsDetection ) {
+              flags[i]                  = false;
+              const size_t indexCC      = connectedComponentsChunks[chunkIndex].size();
+              const size_t clusterIndex = partition[pointsIndexChunks[chunkIndex][i]];
+              connectedComponentsChunks[chunkIndex].resize( indexCC + 1 );
+              std::vector<size_t>& connectedComponentChunk = connectedComponentsChunks[chunkIndex][indexCC];
+              fifo.push_back( i );
+              connectedComponentChunk.push_back( i );
+              while ( !fifo.empty() ) {
+                const size_t current = fifo.back();
+                fifo.pop_back();
+                for ( const auto n : adjChunks[chunkIndex][current] ) {
+                  if ( clusterIndex == partition[pointsIndexChunks[chunkIndex][n]] && flags[n] ) {
+                    flags[n] = false;
+                    fifo.push_back( n );
+                    connectedComponentChunk.push_back( n );
+                  }
                 }
               }
-            }
-            if ( connectedComponentChunk.size() < minPointCountPerCC ) {
-              connectedComponentsChunks[chunkIndex].resize( indexCC );
-            } else {
-              std::cout << "\t\t CC " << indexCC << " -> " << connectedComponentChunk.size() << std::endl;
+              if ( connectedComponentChunk.size() < minPointCountPerCC ) {
+                connectedComponentsChunks[chunkIndex].resize( indexCC );
+              }
             }
           }
+#if defined( ENABLE_TBB )
+        } );
+      } );
+#else
+      }
+#endif
+      for ( size_t chunkIndex = 0; chunkIndex < numChunks; ++chunkIndex ) {
+        std::cout << "\n\t Extracting connected components of chunk " << chunkIndex << "... ";
+        for ( size_t indexCC = 0; indexCC < connectedComponentsChunks[chunkIndex].size(); ++indexCC ) {
+          std::cout << "\t\t CC " << indexCC << " -> " << connectedComponentsChunks[chunkIndex][indexCC].size()
+                    << std::endl;
         }
         std::cout << "[done]" << std::endl;
       }
@@ -907,70 +1079,97 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
       std::sort( connectedComponents.begin(), connectedComponents.end(),
                  []( const std::vector<size_t>& a, const std::vector<size_t>& b ) { return a.size() >= b.size(); } );
     }
-    for ( auto& connectedComponent : connectedComponents ) {
-      const size_t patchIndex = patches.size();
-      patches.resize( patchIndex + 1 );
-      if ( createSubPointCloud ) { subPointCloud.resize( patchIndex + 1 ); }
-      PCCPatch& patch            = patches[patchIndex];
-      size_t    d0CountPerPatch  = 0;
-      size_t    d1CountPerPatch  = 0;
-      size_t    eomCountPerPatch = 0;
-      patch.setIndex( patchIndex );
-      patch.setEOMCount( 0 );
-      patch.setPatchType( static_cast<uint8_t>( P_INTRA ) );
-      size_t clusterIndex                 = partition[connectedComponent[0]];
-      bool   bIsAdditionalProjectionPlane = ( clusterIndex > 5 );  // false;
-      if ( bIsAdditionalProjectionPlane && ( additionalProjectionAxis == 2 ) ) clusterIndex += 4;
-      if ( bIsAdditionalProjectionPlane && ( additionalProjectionAxis == 3 ) ) clusterIndex += 8;
-      patch.setViewId( clusterIndex );
-      patch.setBestMatchIdx( g_invalidPatchIndex );
-      patch.getPreGPAPatchData().initialize();
-      patch.getCurGPAPatchData().initialize();
-      if ( params.enablePatchSplitting_ ) {
-        int16_t minU = ( std::numeric_limits<int16_t>::max )();
-        int16_t minV = ( std::numeric_limits<int16_t>::max )();
-        for ( const auto i : connectedComponent ) {
-          PCCPoint3D pointTmp = points[i];
-          if ( bIsAdditionalProjectionPlane ) {
-            auto& input = pointTmp;
-            convert( patch.getAxisOfAdditionalPlane(), geometryBitDepth3D, input, pointTmp );
+    // the patches are initialized and split concurrently, expanded in order, then their depth maps are computed
+    // concurrently; the resampled points, metrics and logs are finally gathered in patch order
+    const size_t                     firstPatchIndex = patches.size();
+    const size_t                     ccCount         = connectedComponents.size();
+    std::vector<size_t>              clusterIndices( ccCount );
+    std::vector<PCCPointSet3>        resampledPatches( ccCount );
+    std::vector<PCCPointSet3>        recPatches( ccCount );
+    std::vector<std::vector<size_t>> pointCountPatches( ccCount, std::vector<size_t>( 3, 0 ) );
+    patches.resize( firstPatchIndex + ccCount );
+    if ( createSubPointCloud ) { subPointCloud.resize( firstPatchIndex + ccCount ); }
+#if defined( ENABLE_TBB )
+    tbb::task_arena limited( static_cast<int>( nbThread_ ) );
+    limited.execute( [&] {
+      tbb::parallel_for( size_t( 0 ), ccCount, [&]( const size_t c ) {
+#else
+    for ( size_t c = 0; c < ccCount; c++ ) {
+#endif
+        auto&        connectedComponent = connectedComponents[c];
+        const size_t patchIndex         = firstPatchIndex + c;
+        PCCPatch&    patch              = patches[patchIndex];
+        patch.setIndex( patchIndex );
+        patch.setEOMCount( 0 );
+        patch.setPatchType( static_cast<uint8_t>( P_INTRA ) );
+        size_t clusterIndex                 = partition[connectedComponent[0]];
+        bool   bIsAdditionalProjectionPlane = ( clusterIndex > 5 );  // false;
+        if ( bIsAdditionalProjectionPlane && ( additionalProjectionAxis == 2 ) ) clusterIndex += 4;
+        if ( bIsAdditionalProjectionPlane && ( additionalProjectionAxis == 3 ) ) clusterIndex += 8;
+        clusterIndices[c] = clusterIndex;
+        patch.setViewId( clusterIndex );
+        patch.setBestMatchIdx( g_invalidPatchIndex );
+        patch.getPreGPAPatchData().initialize();
+        patch.getCurGPAPatchData().initialize();
+        if ( params.enablePatchSplitting_ ) {
+          int16_t minU = ( std::numeric_limits<int16_t>::max )();
+          int16_t minV = ( std::numeric_limits<int16_t>::max )();
+          for ( const auto i : connectedComponent ) {
+            PCCPoint3D pointTmp = points[i];
+            if ( bIsAdditionalProjectionPlane ) {
+              auto& input = pointTmp;
+              convert( patch.getAxisOfAdditionalPlane(), geometryBitDepth3D, input, pointTmp );
+            }
+            const auto& point = pointTmp;
+            minU              = ( std::min )( minU, int16_t( round( point[patch.getTangentAxis()] ) ) );
+            minV              = ( std::min )( minV, int16_t( round( point[patch.getBitangentAxis()] ) ) );
           }
-          const auto& point = pointTmp;
-          minU              = ( std::min )( minU, int16_t( round( point[patch.getTangentAxis()] ) ) );
-          minV              = ( std::min )( minV, int16_t( round( point[patch.getBitangentAxis()] ) ) );
-        }
-        std::vector<size_t> tempCC;
-        tempCC.resize( 0 );
-        for ( const auto i : connectedComponent ) {
-          PCCPoint3D pointTmp = points[i];
-          if ( bIsAdditionalProjectionPlane ) {
-            auto& input = pointTmp;
-            convert( patch.getAxisOfAdditionalPlane(), geometryBitDepth3D, input, pointTmp );
+          std::vector<size_t> tempCC;
+          tempCC.resize( 0 );
+          for ( const auto i : connectedComponent ) {
+            PCCPoint3D pointTmp = points[i];
+            if ( bIsAdditionalProjectionPlane ) {
+              auto& input = pointTmp;
+              convert( patch.getAxisOfAdditionalPlane(), geometryBitDepth3D, input, pointTmp );
+            }
+            const auto& point = pointTmp;
+            const auto  u     = int16_t( round( point[patch.getTangentAxis()] ) );
+            const auto  v     = int16_t( round( point[patch.getBitangentAxis()] ) );
+            if ( u - minU < params.maxPatchSize_ && v - minV < params.maxPatchSize_ ) { tempCC.push_back( i ); }
           }
-          const auto& point = pointTmp;
-          const auto  u     = int16_t( round( point[patch.getTangentAxis()] ) );
-          const auto  v     = int16_t( round( point[patch.getBitangentAxis()] ) );
-          if ( u - minU < params.maxPatchSize_ && v - minV < params.maxPatchSize_ ) { tempCC.push_back( i ); }
+          connectedComponent = tempCC;
         }
-        connectedComponent = tempCC;
-        if ( connectedComponent.empty() ) { continue; }
-      }
-
-      const int16_t projectionDirectionType = -2 * patch.getProjectionMode() + 1;
+#if defined( ENABLE_TBB )
+      } );
+    } );
+#else
+    }
+#endif
 
-      if ( patchExpansionEnabled ) {
+    // patches split to nothing are kept in the list but not filled
+    std::vector<size_t> validComponents;
+    validComponents.reserve( ccCount );
+    for ( size_t c = 0; c < ccCount; c++ ) {
+      if ( !connectedComponents[c].empty() ) { validComponents.push_back( c ); }
+    }
+    if ( patchExpansionEnabled ) {
+      for ( const auto c : validComponents ) {
+        auto&        connectedComponent = connectedComponents[c];
+        const size_t clusterIndex       = clusterIndices[c];
         for ( const auto i : connectedComponent ) { flagExp[i] = true; }
         std::vector<size_t> fifoa;
         fifoa.reserve( pointCount );
         for ( const auto i : connectedComponent ) {
-          for ( size_t ac = 0; ac < adj[i].size(); ++ac ) {
-            const size_t n = adj[i][ac];
+          const auto   neighbors     = adj[i];
+          const float* neighborsDist = adj.getDistances( i );
+          for ( size_t ac = 0; ac < neighbors.size(); ++ac ) {
+            const size_t n = neighbors[ac];
             if ( flagExp[n] ) { continue; }
             if ( ( clusterIndex == partition[n] ) ||  // same plane
                  ( clusterIndex + 3 == partition[n] ) || ( clusterIndex == partition[n] + 3 ) ) {
               continue;
             }
-            const double dist2 = adjDist[i][ac];  // sum of square
+            const double dist2 = neighborsDist[ac];  // sum of square
             if ( dist2 <= 2 ) {                   // <-- expansion distance
               fifoa.push_back( n );
               flagExp[n] = true;  // add point
@@ -979,245 +1178,276 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
         }
         if ( !fifoa.empty() ) { connectedComponent.insert( connectedComponent.end(), fifoa.begin(), fifoa.end() ); }
       }
+    }
 
-      PCCBox3D boundingBox;
-      for ( size_t k = 0; k < 3; ++k ) {
-        boundingBox.min_[k] = ( std::numeric_limits<double>::max )();
-        boundingBox.max_[k] = 0;
-      }
-      for ( const auto i : connectedComponent ) {
-        patchPartition[i]   = patchIndex + 1;
-        PCCPoint3D pointTmp = points[i];
-        if ( bIsAdditionalProjectionPlane ) {
-          auto& input = pointTmp;
-          convert( patch.getAxisOfAdditionalPlane(), geometryBitDepth3D, input, pointTmp );
-        }
-        const auto& point = pointTmp;
+#if defined( ENABLE_TBB )
+    limited.execute( [&] {
+      tbb::parallel_for( size_t( 0 ), validComponents.size(), [&]( const size_t k ) {
+#else
+    for ( size_t k = 0; k < validComponents.size(); k++ ) {
+#endif
+        const size_t c                            = validComponents[k];
+        auto&        connectedComponent           = connectedComponents[c];
+        const size_t patchIndex                   = firstPatchIndex + c;
+        PCCPatch&    patch                        = patches[patchIndex];
+        const bool   bIsAdditionalProjectionPlane = ( clusterIndices[c] > 5 );
+        const int16_t projectionDirectionType     = -2 * patch.getProjectionMode() + 1;
+
+        PCCBox3D boundingBox;
         for ( size_t k = 0; k < 3; ++k ) {
-          if ( point[k] < boundingBox.min_[k] ) { boundingBox.min_[k] = floor( point[k] ); }
-          if ( point[k] > boundingBox.max_[k] ) { boundingBox.max_[k] = ceil( point[k] ); }
-        }
-      }
-
-      if ( enablePointCloudPartitioning ) {
-        for ( int roiIndex = 0; roiIndex < numROIs; ++roiIndex ) {
-          PCCBox3D roiBB;
-          roiBB.min_[0] = roiBoundingBoxMinX[roiIndex];
-          roiBB.max_[0] = roiBoundingBoxMaxX[roiIndex];
-          roiBB.min_[1] = roiBoundingBoxMinY[roiIndex];
-          roiBB.max_[1] = roiBoundingBoxMaxY[roiIndex];
-          roiBB.min_[2] = roiBoundingBoxMinZ[roiIndex];
-          roiBB.max_[2] = roiBoundingBoxMaxZ[roiIndex];
-          if ( roiBB.fullyContains( boundingBox ) ) { patch.setRoiIndex( roiIndex ); }
+          boundingBox.min_[k] = ( std::numeric_limits<double>::max )();
+          boundingBox.max_[k] = 0;
         }
-      }
-      patch.setSizeU( 1 + size_t( round( boundingBox.max_[patch.getTangentAxis()] ) -
-                                  floor( boundingBox.min_[patch.getTangentAxis()] ) ) );
-      patch.setSizeV( 1 + size_t( round( boundingBox.max_[patch.getBitangentAxis()] ) -
-                                  floor( boundingBox.min_[patch.getBitangentAxis()] ) ) );
-      patch.setU1( size_t( boundingBox.min_[patch.getTangentAxis()] ) );
-      patch.setV1( size_t( boundingBox.min_[patch.getBitangentAxis()] ) );
-      patch.setD1( patch.getProjectionMode() == 0 ? g_infiniteDepth : 0 );
-      patch.allocDepth( 0, patch.getSizeU() * patch.getSizeV(), g_infiniteDepth );
-      patch.allocDepth0PccIdx( patch.getSizeU() * patch.getSizeV(), g_infinitenumber );
-      if ( useEnhancedOccupancyMapCode ) { patch.allocDepthEOM( patch.getSizeU() * patch.getSizeV(), 0 ); }
-      patch.setOccupancyResolution( occupancyResolution );
-      patch.setSizeU0( 0 );
-      patch.setSizeV0( 0 );
-      patch.setPatchSize2DXInPixel( 0 );
-      patch.setPatchSize2DYInPixel( 0 );
-      for ( const auto i : connectedComponent ) {
-        PCCPoint3D pointTmp = points[i];
-        if ( bIsAdditionalProjectionPlane ) {
-          auto& input = pointTmp;
-          convert( patch.getAxisOfAdditionalPlane(), geometryBitDepth3D, input, pointTmp );
+        for ( const auto i : connectedComponent ) {
+          PCCPoint3D pointTmp = points[i];
+          if ( bIsAdditionalProjectionPlane ) {
+            auto& input = pointTmp;
+            convert( patch.getAxisOfAdditionalPlane(), geometryBitDepth3D, input, pointTmp );
+          }
+          const auto& point = pointTmp;
+          for ( size_t k = 0; k < 3; ++k ) {
+            if ( point[k] < boundingBox.min_[k] ) { boundingBox.min_[k] = floor( point[k] ); }
+            if ( point[k] > boundingBox.max_[k] ) { boundingBox.max_[k] = ceil( point[k] ); }
+          }
         }
-        const auto& point = pointTmp;
-        const auto  d     = int16_t( round( point[patch.getNormalAxis()] ) );
-        const auto  u     = size_t( round( point[patch.getTangentAxis()] - patch.getU1() ) );
-        const auto  v     = size_t( round( point[patch.getBitangentAxis()] - patch.getV1() ) );
-        assert( u >= 0 && u < patch.getSizeU() );
-        assert( v >= 0 && v < patch.getSizeV() );
-        const size_t p           = v * patch.getSizeU() + u;
-        bool         bValidPoint = ( patch.getProjectionMode() == 0 )
-                               ? ( patch.getDepth( 0 )[p] > d )
-                               : ( ( patch.getDepth( 0 )[p] == g_infiniteDepth ) || ( patch.getDepth( 0 )[p] < d ) );
-        if ( bValidPoint ) {  // min
-          int16_t minD0 = patch.getD1();
-          int16_t maxD0 = patch.getD1();
-          patch.setDepth( 0, p, d );
-          patch.setDepth0PccIdx( p, i );
-          patch.setPatchSize2DXInPixel( ( std::max )( patch.getPatchSize2DXInPixel(), u ) );
-          patch.setPatchSize2DYInPixel( ( std::max )( patch.getPatchSize2DYInPixel(), v ) );
-          patch.setSizeU0( ( std::max )( patch.getSizeU0(), u / patch.getOccupancyResolution() ) );
-          patch.setSizeV0( ( std::max )( patch.getSizeV0(), v / patch.getOccupancyResolution() ) );
-          minD0 = ( std::min )( minD0, d );
-          maxD0 = ( std::max )( maxD0, d );
-          if ( patch.getProjectionMode() == 0 ) {
-            patch.setD1( ( minD0 / minLevel ) * minLevel );
-          } else {
-            patch.setD1( size_t( ceil( static_cast<double>( maxD0 ) / static_cast<double>( minLevel ) ) ) * minLevel );
+
+        if ( enablePointCloudPartitioning ) {
+          for ( int roiIndex = 0; roiIndex < numROIs; ++roiIndex ) {
+            PCCBox3D roiBB;
+            roiBB.min_[0] = roiBoundingBoxMinX[roiIndex];
+            roiBB.max_[0] = roiBoundingBoxMaxX[roiIndex];
+            roiBB.min_[1] = roiBoundingBoxMinY[roiIndex];
+            roiBB.max_[1] = roiBoundingBoxMaxY[roiIndex];
+            roiBB.min_[2] = roiBoundingBoxMinZ[roiIndex];
+            roiBB.max_[2] = roiBoundingBoxMaxZ[roiIndex];
+            if ( roiBB.fullyContains( boundingBox ) ) { patch.setRoiIndex( roiIndex ); }
           }
         }
-      }  // i
-
-      patch.setPatchSize2DXInPixel( ( patch.getPatchSize2DXInPixel() + 1 ) );
-      patch.setPatchSize2DYInPixel( ( patch.getPatchSize2DYInPixel() + 1 ) );
-      size_t noquantizedPatchSize2DX = ( patch.getPatchSize2DXInPixel() );
-      size_t noquantizedPatchSize2DY = ( patch.getPatchSize2DYInPixel() );
-      if ( quantizerSizeX != 0 ) {
-        patch.setPatchSize2DXInPixel(
-            ceil( static_cast<double>( noquantizedPatchSize2DX ) / static_cast<double>( quantizerSizeX ) ) *
-            quantizerSizeX );
-      }
-      if ( quantizerSizeY != 0 ) {
-        patch.setPatchSize2DYInPixel(
-            ceil( static_cast<double>( noquantizedPatchSize2DY ) / static_cast<double>( quantizerSizeY ) ) *
-            quantizerSizeY );
-      }
-      patch.setSizeU0( patch.getSizeU0() + 1 );
-      patch.setSizeV0( patch.getSizeV0() + 1 );
-      patch.allocOccupancy( patch.getSizeU0() * patch.getSizeV0(), false );
-
-      // filter depth
-      std::vector<int16_t> peakPerBlock;
-      peakPerBlock.resize( patch.getSizeU0() * patch.getSizeV0(),
-                           patch.getProjectionMode() == 0 ? g_infiniteDepth : 0 );
-      for ( int64_t v = 0; v < int64_t( patch.getSizeV() ); ++v ) {
-        for ( int64_t u = 0; u < int64_t( patch.getSizeU() ); ++u ) {
-          const size_t  p      = v * patch.getSizeU() + u;
-          const int16_t depth0 = patch.getDepth( 0 )[p];
-          if ( depth0 == g_infiniteDepth ) { continue; }
-          const size_t u0 = u / patch.getOccupancyResolution();
-          const size_t v0 = v / patch.getOccupancyResolution();
-          const size_t p0 = v0 * patch.getSizeU0() + u0;
-          if ( patch.getProjectionMode() == 0 ) {
-            peakPerBlock[p0] = ( std::min )( peakPerBlock[p0], depth0 );
-          } else {
-            peakPerBlock[p0] = ( std::max )( peakPerBlock[p0], depth0 );
+        patch.setSizeU( 1 + size_t( round( boundingBox.max_[patch.getTangentAxis()] ) -
+                                    floor( boundingBox.min_[patch.getTangentAxis()] ) ) );
+        patch.setSizeV( 1 + size_t( round( boundingBox.max_[patch.getBitangentAxis()] ) -
+                                    floor( boundingBox.min_[patch.getBitangentAxis()] ) ) );
+        patch.setU1( size_t( boundingBox.min_[patch.getTangentAxis()] ) );
+        patch.setV1( size_t( boundingBox.min_[patch.getBitangentAxis()] ) );
+        patch.setD1( patch.getProjectionMode() == 0 ? g_infiniteDepth : 0 );
+        patch.allocDepth( 0, patch.getSizeU() * patch.getSizeV(), g_infiniteDepth );
+        patch.allocDepth0PccIdx( patch.getSizeU() * patch.getSizeV(), g_infinitenumber );
+        if ( useEnhancedOccupancyMapCode ) { patch.allocDepthEOM( patch.getSizeU() * patch.getSizeV(), 0 ); }
+        patch.setOccupancyResolution( occupancyResolution );
+        patch.setSizeU0( 0 );
+        patch.setSizeV0( 0 );
+        patch.setPatchSize2DXInPixel( 0 );
+        patch.setPatchSize2DYInPixel( 0 );
+        for ( const auto i : connectedComponent ) {
+          PCCPoint3D pointTmp = points[i];
+          if ( bIsAdditionalProjectionPlane ) {
+            auto& input = pointTmp;
+            convert( patch.getAxisOfAdditionalPlane(), geometryBitDepth3D, input, pointTmp );
           }
-        }  // u
-      }    // v
-      for ( int64_t v = 0; v < int64_t( patch.getSizeV() ); ++v ) {
-        for ( int64_t u = 0; u < int64_t( patch.getSizeU() ); ++u ) {
-          const size_t  p      = v * patch.getSizeU() + u;
-          const int16_t depth0 = patch.getDepth( 0 )[p];
-          if ( depth0 == g_infiniteDepth ) { continue; }
-          const size_t u0    = u / patch.getOccupancyResolution();
-          const size_t v0    = v / patch.getOccupancyResolution();
-          const size_t p0    = v0 * patch.getSizeU0() + u0;
-          int16_t      tmp_a = std::abs( depth0 - peakPerBlock[p0] );
-          int16_t      tmp_b = int16_t( surfaceThickness ) + projectionDirectionType * depth0;
-          int16_t      tmp_c = projectionDirectionType * patch.getD1() + int16_t( maxAllowedDepth );
-          if ( depth0 != g_infiniteDepth ) {
-            if ( ( tmp_a > 32 ) || ( tmp_b > tmp_c ) ) {
-              patch.setDepth( 0, p, g_infiniteDepth );
-              patch.setDepth0PccIdx( p, g_infinitenumber );
+          const auto& point = pointTmp;
+          const auto  d     = int16_t( round( point[patch.getNormalAxis()] ) );
+          const auto  u     = size_t( round( point[patch.getTangentAxis()] - patch.getU1() ) );
+          const auto  v     = size_t( round( point[patch.getBitangentAxis()] - patch.getV1() ) );
+          assert( u >= 0 && u < patch.getSizeU() );
+          assert( v >= 0 && v < patch.getSizeV() );
+          const size_t p           = v * patch.getSizeU() + u;
+          bool         bValidPoint = ( patch.getProjectionMode() == 0 )
+                                 ? ( patch.getDepth( 0 )[p] > d )
+                                 : ( ( patch.getDepth( 0 )[p] == g_infiniteDepth ) || ( patch.getDepth( 0 )[p] < d ) );
+          if ( bValidPoint ) {  // min
+            int16_t minD0 = patch.getD1();
+            int16_t maxD0 = patch.getD1();
+            patch.setDepth( 0, p, d );
+            patch.setDepth0PccIdx( p, i );
+            patch.setPatchSize2DXInPixel( ( std::max )( patch.getPatchSize2DXInPixel(), u ) );
+            patch.setPatchSize2DYInPixel( ( std::max )( patch.getPatchSize2DYInPixel(), v ) );
+            patch.setSizeU0( ( std::max )( patch.getSizeU0(), u / patch.getOccupancyResolution() ) );
+            patch.setSizeV0( ( std::max )( patch.getSizeV0(), v / patch.getOccupancyResolution() ) );
+            minD0 = ( std::min )( minD0, d );
+            maxD0 = ( std::max )( maxD0, d );
+            if ( patch.getProjectionMode() == 0 ) {
+              patch.setD1( ( minD0 / minLevel ) * minLevel );
+            } else {
+              patch.setD1( size_t( ceil( static_cast<double>( maxD0 ) / static_cast<double>( minLevel ) ) ) *
+                           minLevel );
             }
           }
+        }  // i
+
+        patch.setPatchSize2DXInPixel( ( patch.getPatchSize2DXInPixel() + 1 ) );
+        patch.setPatchSize2DYInPixel( ( patch.getPatchSize2DYInPixel() + 1 ) );
+        size_t noquantizedPatchSize2DX = ( patch.getPatchSize2DXInPixel() );
+        size_t noquantizedPatchSize2DY = ( patch.getPatchSize2DYInPixel() );
+        if ( quantizerSizeX != 0 ) {
+          patch.setPatchSize2DXInPixel(
+              ceil( static_cast<double>( noquantizedPatchSize2DX ) / static_cast<double>( quantizerSizeX ) ) *
+              quantizerSizeX );
         }
-      }
-
-      if ( EOMSingleLayerMode ) {
-        int16_t patch_surfaceThickness =
-            useSurfaceSeparation ? getPatchSurfaceThickness(
-                                       points, patch, patchIndex, frame_pcc_color, connectedComponent, surfaceThickness,
-                                       patch.getProjectionMode(), bIsAdditionalProjectionPlane, geometryBitDepth3D )
-                                 : surfaceThickness;
-        if ( patch_surfaceThickness > 0 ) {
-          for ( const auto i : connectedComponent ) {
-            PCCPoint3D pointTmp = points[i];
-            if ( bIsAdditionalProjectionPlane ) {
-              auto& input = pointTmp;
-              convert( patch.getAxisOfAdditionalPlane(), geometryBitDepth3D, input, pointTmp );
+        if ( quantizerSizeY != 0 ) {
+          patch.setPatchSize2DYInPixel(
+              ceil( static_cast<double>( noquantizedPatchSize2DY ) / static_cast<double>( quantizerSizeY ) ) *
+              quantizerSizeY );
+        }
+        patch.setSizeU0( patch.getSizeU0() + 1 );
+        patch.setSizeV0( patch.getSizeV0() + 1 );
+        patch.allocOccupancy( patch.getSizeU0() * patch.getSizeV0(), false );
+
+        // filter depth
+        std::vector<int16_t> peakPerBlock;
+        peakPerBlock.resize( patch.getSizeU0() * patch.getSizeV0(),
+                             patch.getProjectionMode() == 0 ? g_infiniteDepth : 0 );
+        for ( int64_t v = 0; v < int64_t( patch.getSizeV() ); ++v ) {
+          for ( int64_t u = 0; u < int64_t( patch.getSizeU() ); ++u ) {
+            const size_t  p      = v * patch.getSizeU() + u;
+            const int16_t depth0 = patch.getDepth( 0 )[p];
+            if ( depth0 == g_infiniteDepth ) { continue; }
+            const size_t u0 = u / patch.getOccupancyResolution();
+            const size_t v0 = v / patch.getOccupancyResolution();
+            const size_t p0 = v0 * patch.getSizeU0() + u0;
+            if ( patch.getProjectionMode() == 0 ) {
+              peakPerBlock[p0] = ( std::min )( peakPerBlock[p0], depth0 );
+            } else {
+              peakPerBlock[p0] = ( std::max )( peakPerBlock[p0], depth0 );
             }
-            const auto& point = pointTmp;
-            const auto  d     = int16_t( round( point[patch.getNormalAxis()] ) );
-            const auto  u     = size_t( round( point[patch.getTangentAxis()] - patch.getU1() ) );
-            const auto  v     = size_t( round( point[patch.getBitangentAxis()] - patch.getV1() ) );
-            assert( u >= 0 && u < patch.getSizeU() );
-            assert( v >= 0 && v < patch.getSizeV() );
+          }  // u
+        }    // v
+        for ( int64_t v = 0; v < int64_t( patch.getSizeV() ); ++v ) {
+          for ( int64_t u = 0; u < int64_t( patch.getSizeU() ); ++u ) {
             const size_t  p      = v * patch.getSizeU() + u;
             const int16_t depth0 = patch.getDepth( 0 )[p];
-            const int16_t diff   = std::abs( depth0 - d );
-            int16_t       eomThickness =
-                useSurfaceSeparation ? ( patch_surfaceThickness + EOMFixBitCount - surfaceThickness ) : EOMFixBitCount;
-            if ( depth0 < g_infiniteDepth && ( projectionDirectionType * ( d - depth0 ) ) > 0 &&
-                 diff <= int16_t( eomThickness ) ) {
-              uint16_t deltaD = diff;
-              patch.setDepthEOM( p, patch.getDepthEOM( p ) | 1 << ( deltaD - 1 ) );
+            if ( depth0 == g_infiniteDepth ) { continue; }
+            const size_t u0    = u / patch.getOccupancyResolution();
+            const size_t v0    = v / patch.getOccupancyResolution();
+            const size_t p0    = v0 * patch.getSizeU0() + u0;
+            int16_t      tmp_a = std::abs( depth0 - peakPerBlock[p0] );
+            int16_t      tmp_b = int16_t( surfaceThickness ) + projectionDirectionType * depth0;
+            int16_t      tmp_c = projectionDirectionType * patch.getD1() + int16_t( maxAllowedDepth );
+            if ( depth0 != g_infiniteDepth ) {
+              if ( ( tmp_a > 32 ) || ( tmp_b > tmp_c ) ) {
+                patch.setDepth( 0, p, g_infiniteDepth );
+                patch.setDepth0PccIdx( p, g_infinitenumber );
+              }
             }
           }
         }
-      } else {
-        // compute d1 map
-        patch.setDepth( 1, patch.getDepth( 0 ) );
-        int16_t patch_surfaceThickness =
-            useSurfaceSeparation ? getPatchSurfaceThickness(
-                                       points, patch, patchIndex, frame_pcc_color, connectedComponent, surfaceThickness,
-                                       patch.getProjectionMode(), bIsAdditionalProjectionPlane, geometryBitDepth3D )
-                                 : surfaceThickness;
-
-        if ( patch_surfaceThickness > 0 ) {
-          for ( const auto i : connectedComponent ) {
-            PCCPoint3D pointTmp = points[i];
-            if ( bIsAdditionalProjectionPlane ) {
-              auto& input = pointTmp;
-              convert( patch.getAxisOfAdditionalPlane(), geometryBitDepth3D, input, pointTmp );
-            }
-            const auto& point = pointTmp;
-            const auto  d     = int16_t( round( point[patch.getNormalAxis()] ) );
-            const auto  u     = size_t( round( point[patch.getTangentAxis()] - patch.getU1() ) );
-            const auto  v     = size_t( round( point[patch.getBitangentAxis()] - patch.getV1() ) );
-            assert( u >= 0 && u < patch.getSizeU() );
-            assert( v >= 0 && v < patch.getSizeV() );
-            const size_t  p      = v * patch.getSizeU() + u;
-            const int16_t depth0 = patch.getDepth( 0 )[p];
-            const int16_t deltaD = projectionDirectionType * ( d - depth0 );
-            if ( !( depth0 < g_infiniteDepth ) ) { continue; }
-            bool bsimilar = colorSimilarity( frame_pcc_color[i], frame_pcc_color[patch.getDepth0PccIdx()[p]], 128 );
-            if ( depth0 < g_infiniteDepth && ( deltaD ) <= int16_t( patch_surfaceThickness ) && deltaD >= 0 &&
-                 bsimilar ) {
-              if ( projectionDirectionType * ( d - patch.getDepth( 1 )[p] ) > 0 ) { patch.setDepth( 1, p, d ); }
-              if ( useEnhancedOccupancyMapCode ) {
+
+        if ( EOMSingleLayerMode ) {
+          int16_t patch_surfaceThickness =
+              useSurfaceSeparation
+                  ? getPatchSurfaceThickness( points, patch, patchIndex, frame_pcc_color, connectedComponent,
+                                              surfaceThickness, patch.getProjectionMode(), bIsAdditionalProjectionPlane,
+                                              geometryBitDepth3D )
+                  : surfaceThickness;
+          if ( patch_surfaceThickness > 0 ) {
+            for ( const auto i : connectedComponent ) {
+              PCCPoint3D pointTmp = points[i];
+              if ( bIsAdditionalProjectionPlane ) {
+                auto& input = pointTmp;
+                convert( patch.getAxisOfAdditionalPlane(), geometryBitDepth3D, input, pointTmp );
+              }
+              const auto& point = pointTmp;
+              const auto  d     = int16_t( round( point[patch.getNormalAxis()] ) );
+              const auto  u     = size_t( round( point[patch.getTangentAxis()] - patch.getU1() ) );
+              const auto  v     = size_t( round( point[patch.getBitangentAxis()] - patch.getV1() ) );
+              assert( u >= 0 && u < patch.getSizeU() );
+              assert( v >= 0 && v < patch.getSizeV() );
+              const size_t  p      = v * patch.getSizeU() + u;
+              const int16_t depth0 = patch.getDepth( 0 )[p];
+              const int16_t diff   = std::abs( depth0 - d );
+              int16_t       eomThickness = useSurfaceSeparation
+                                               ? ( patch_surfaceThickness + EOMFixBitCount - surfaceThickness )
+                                               : EOMFixBitCount;
+              if ( depth0 < g_infiniteDepth && ( projectionDirectionType * ( d - depth0 ) ) > 0 &&
+                   diff <= int16_t( eomThickness ) ) {
+                uint16_t deltaD = diff;
                 patch.setDepthEOM( p, patch.getDepthEOM( p ) | 1 << ( deltaD - 1 ) );
               }
             }
-            if ( ( patch.getProjectionMode() == 0 && ( patch.getDepth( 1 )[p] < patch.getDepth( 0 )[p] ) ) ||
-                 ( patch.getProjectionMode() == 1 && ( patch.getDepth( 1 )[p] > patch.getDepth( 0 )[p] ) ) ) {
-              std::cout << "ERROR: d1(" << patch.getDepth( 1 )[p] << ") and d0(" << patch.getDepth( 0 )[p]
-                        << ") for projection mode[" << patch.getProjectionMode() << "]" << std::endl;
+          }
+        } else {
+          // compute d1 map
+          patch.setDepth( 1, patch.getDepth( 0 ) );
+          int16_t patch_surfaceThickness =
+              useSurfaceSeparation
+                  ? getPatchSurfaceThickness( points, patch, patchIndex, frame_pcc_color, connectedComponent,
+                                              surfaceThickness, patch.getProjectionMode(), bIsAdditionalProjectionPlane,
+                                              geometryBitDepth3D )
+                  : surfaceThickness;
+
+          if ( patch_surfaceThickness > 0 ) {
+            for ( const auto i : connectedComponent ) {
+              PCCPoint3D pointTmp = points[i];
+              if ( bIsAdditionalProjectionPlane ) {
+                auto& input = pointTmp;
+                convert( patch.getAxisOfAdditionalPlane(), geometryBitDepth3D, input, pointTmp );
+              }
+              const auto& point = pointTmp;
+              const auto  d     = int16_t( round( point[patch.getNormalAxis()] ) );
+              const auto  u     = size_t( round( point[patch.getTangentAxis()] - patch.getU1() ) );
+              const auto  v     = size_t( round( point[patch.getBitangentAxis()] - patch.getV1() ) );
+              assert( u >= 0 && u < patch.getSizeU() );
+              assert( v >= 0 && v < patch.getSizeV() );
+              const size_t  p      = v * patch.getSizeU() + u;
+              const int16_t depth0 = patch.getDepth( 0 )[p];
+              const int16_t deltaD = projectionDirectionType * ( d - depth0 );
+              if ( !( depth0 < g_infiniteDepth ) ) { continue; }
+              bool bsimilar = colorSimilarity( frame_pcc_color[i], frame_pcc_color[patch.getDepth0PccIdx()[p]], 128 );
+              if ( depth0 < g_infiniteDepth && ( deltaD ) <= int16_t( patch_surfaceThickness ) && deltaD >= 0 &&
+                   bsimilar ) {
+                if ( projectionDirectionType * ( d - patch.getDepth( 1 )[p] ) > 0 ) { patch.setDepth( 1, p, d ); }
+                if ( useEnhancedOccupancyMapCode ) {
+                  patch.setDepthEOM( p, patch.getDepthEOM( p ) | 1 << ( deltaD - 1 ) );
+                }
+              }
+              if ( ( patch.getProjectionMode() == 0 && ( patch.getDepth( 1 )[p] < patch.getDepth( 0 )[p] ) ) ||
+                   ( patch.getProjectionMode() == 1 && ( patch.getDepth( 1 )[p] > patch.getDepth( 0 )[p] ) ) ) {
+                std::cout << "ERROR: d1(" << patch.getDepth( 1 )[p] << ") and d0(" << patch.getDepth( 0 )[p]
+                          << ") for projection mode[" << patch.getProjectionMode() << "]" << std::endl;
+              }
             }
           }
         }
-      }
-      patch.setSizeD( 0 );
-      PCCPointSet3 rec;
-      rec.resize( 0 );
-      std::vector<size_t> pointCount;
-      pointCount.resize( 3 );
-      resampledPointcloud( pointCount, resampled, resampledPatchPartition, patch, patchIndex,
-                           params.mapCountMinus1_ > 0, surfaceThickness, EOMFixBitCount, bIsAdditionalProjectionPlane,
-                           useEnhancedOccupancyMapCode, geometryBitDepth3D, createSubPointCloud, rec );
-
-      d0CountPerPatch  = pointCount[0];
-      d1CountPerPatch  = pointCount[1];
-      eomCountPerPatch = pointCount[2];
-
-      // note: patch.getSizeD() cannot generate maximum depth(e.g. getSizeD=255, quantDD=3, quantDD needs to be limitted
-      // to satisfy the bitcount) max : (1<<std::min(geometryBitDepth3D, geometryBitDepth2D))
-      patch.setSizeDPixel( patch.getSizeD() );
-      patch.setSizeD(
-          std::min( ( size_t )( 1 << std::min( geometryBitDepth3D, geometryBitDepth2D ) ) - 1, patch.getSizeD() ) );
-      size_t bitdepthD  = std::min( geometryBitDepth3D, geometryBitDepth2D ) - std::log2( minLevel );
-      size_t maxDDplus1 = 1 << bitdepthD;  // e.g. 4
-      size_t quantDD    = patch.getSizeD() == 0 ? 0 : ( ( patch.getSizeD() - 1 ) / minLevel + 1 );
-      quantDD           = std::min( quantDD, maxDDplus1 - 1 );          // 1,2,3,3
-      patch.setSizeD( quantDD == 0 ? 0 : ( quantDD * minLevel - 1 ) );  // 63, 127, 191, 191
+        patch.setSizeD( 0 );
+        std::vector<size_t> resampledPatchPartitionTmp;
+        resampledPointcloud( pointCountPatches[c], resampledPatches[c], resampledPatchPartitionTmp, patch, patchIndex,
+                             params.mapCountMinus1_ > 0, surfaceThickness, EOMFixBitCount, bIsAdditionalProjectionPlane,
+                             useEnhancedOccupancyMapCode, geometryBitDepth3D, createSubPointCloud, recPatches[c] );
+
+        // note: patch.getSizeD() cannot generate maximum depth(e.g. getSizeD=255, quantDD=3, quantDD needs to be
+        // limitted to satisfy the bitcount) max : (1<<std::min(geometryBitDepth3D, geometryBitDepth2D))
+        patch.setSizeDPixel( patch.getSizeD() );
+        patch.setSizeD(
+            std::min( ( size_t )( 1 << std::min( geometryBitDepth3D, geometryBitDepth2D ) ) - 1, patch.getSizeD() ) );
+        size_t bitdepthD  = std::min( geometryBitDepth3D, geometryBitDepth2D ) - std::log2( minLevel );
+        size_t maxDDplus1 = 1 << bitdepthD;  // e.g. 4
+        size_t quantDD    = patch.getSizeD() == 0 ? 0 : ( ( patch.getSizeD() - 1 ) / minLevel + 1 );
+        quantDD           = std::min( quantDD, maxDDplus1 - 1 );          // 1,2,3,3
+        patch.setSizeD( quantDD == 0 ? 0 : ( quantDD * minLevel - 1 ) );  // 63, 127, 191, 191
+#if defined( ENABLE_TBB )
+      } );
+    } );
+#else
+    }
+#endif
+
+    for ( const auto c : validComponents ) {
+      auto&        connectedComponent           = connectedComponents[c];
+      const size_t patchIndex                   = firstPatchIndex + c;
+      PCCPatch&    patch                        = patches[patchIndex];
+      const bool   bIsAdditionalProjectionPlane = ( clusterIndices[c] > 5 );
+      auto&        rec                          = recPatches[c];
+      size_t       d0CountPerPatch              = pointCountPatches[c][0];
+      size_t       d1CountPerPatch              = pointCountPatches[c][1];
+      size_t       eomCountPerPatch             = pointCountPatches[c][2];
+      for ( const auto i : connectedComponent ) { patchPartition[i] = patchIndex + 1; }
+      resampled.appendPoints( resampledPatches[c].getPositions() );
+      resampledPatchPartition.resize( resampled.getPointCount(), patchIndex );
 
       if ( createSubPointCloud ) {
         PCCPointSet3 testSrc;
         PCCPointSet3 testRec;
+        testSrc.addColors();
+        testSrc.reserve( connectedComponent.size() );
         for ( const auto i : connectedComponent ) {
           if ( bIsAdditionalProjectionPlane ) {
             PCCVector3D input;
@@ -1231,7 +1461,7 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
             testSrc.addPoint( points[i], points.getColor( i ) );
           }
         }
-        for ( const auto& p : rec.getPositions() ) { testRec.addPoint( p ); }
+        testRec.appendPoints( rec.getPositions() );
         testSrc.transferColorSimple( testRec );
         float distPAB;
         float distPBA;
@@ -1254,7 +1484,7 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
         testSrcNum += testSrc.getPointCount();
         testRecNum += testRec.getPointCount();
 
-        auto& sub = subPointCloud[subPointCloud.size() - 1];
+        auto& sub = subPointCloud[patchIndex];
         sub.resize( 0 );
         PCCKdTree kdtreeRec( rec );
         for ( const auto i : connectedComponent ) {
@@ -1289,12 +1519,24 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
                 << " Direction: " << patch.getProjectionMode() << " EOM: " << patch.getEOMCount() << std::endl;
     }
     PCCKdTree kdtreeResampled( resampled );
+#if defined( ENABLE_TBB )
+    limited.execute( [&] {
+      tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
+#else
+    for ( size_t i = 0; i < pointCount; ++i ) {
+#endif
+        PCCNNResult resultResampled;
+        kdtreeResampled.search( points[i], 1, resultResampled );
+        rawPointsDistance[i] = resultResampled.dist( 0 );
+#if defined( ENABLE_TBB )
+      } );
+    } );
+#else
+    }
+#endif
     rawPoints.resize( 0 );
     for ( size_t i = 0; i < pointCount; ++i ) {
-      kdtreeResampled.search( points[i], 1, result );
-      const double dist2   = result.dist( 0 );
-      rawPointsDistance[i] = dist2;
-      if ( dist2 > maxAllowedDist2RawPointsSelection ) { rawPoints.push_back( i ); }
+      if ( rawPointsDistance[i] > maxAllowedDist2RawPointsSelection ) { rawPoints.push_back( i ); }
     }
     if ( enablePointCloudPartitioning ) {
       // update rawPointsChunks using rawPoints
@@ -1329,12 +1571,12 @@ void PCCPatchSegmenter3::refineSegmentation( const PCCPointSet3&         pointCl
                                              const size_t                iterationCount,
                                              std::vector<size_t>&        partition ) {
   assert( orientations );
-  std::vector<std::vector<size_t>> adj;
+  PCCAdjacencyGraph adj;
   computeAdjacencyInfo( pointCloud, kdtree, adj, maxNNCount );
-  const size_t                     pointCount = pointCloud.getPointCount();
-  const double                     weight     = lambda / maxNNCount;
-  std::vector<size_t>              tempPartition( pointCount );
-  std::vector<std::vector<size_t>> scoresSmooth( pointCount, std::vector<size_t>( orientationCount ) );
+  const size_t          pointCount = pointCloud.getPointCount();
+  const double          weight     = lambda / maxNNCount;
+  std::vector<size_t>   tempPartition( pointCount );
+  std::vector<uint32_t> scoresSmooth( pointCount * orientationCount );
   for ( size_t k = 0; k < iterationCount; ++k ) {
 #if defined( ENABLE_TBB )
     tbb::task_arena limited( static_cast<int>( nbThread_ ) );
@@ -1343,9 +1585,9 @@ void PCCPatchSegmenter3::refineSegmentation( const PCCPointSet3&         pointCl
 #else
     for ( size_t i = 0; i < pointCount; i++ ) {
 #endif
-        auto& scoreSmooth = scoresSmooth[i];
-        std::fill( scoreSmooth.begin(), scoreSmooth.end(), 0 );
-        for ( auto& neighbor : adj[i] ) { ++scoreSmooth[partition[neighbor]]; }
+        uint32_t* scoreSmooth = scoresSmooth.data() + i * orientationCount;
+        std::fill( scoreSmooth, scoreSmooth + orientationCount, 0 );
+        for ( const auto neighbor : adj[i] ) { ++scoreSmooth[partition[neighbor]]; }
 #if defined( ENABLE_TBB )
       } );
     } );
@@ -1361,7 +1603,7 @@ void PCCPatchSegmenter3::refineSegmentation( const PCCPointSet3&         pointCl
         const PCCVector3D normal       = normalsGen.getNormal( i );
         size_t            clusterIndex = partition[i];
         double            bestScore    = 0.0;
-        const auto&       scoreSmooth  = scoresSmooth[i];
+        const uint32_t*   scoreSmooth  = scoresSmooth.data() + i * orientationCount;
         for ( size_t j = 0; j < orientationCount; ++j ) {
           const double scoreNormal = normal * orientations[j];
           const double score       = scoreNormal + weight * scoreSmooth[j];
@@ -1379,8 +1621,6 @@ void PCCPatchSegmenter3::refineSegmentation( const PCCPointSet3&         pointCl
 #endif
     swap( tempPartition, partition );
   }
-  for ( auto& vector : scoresSmooth ) { vector.clear(); }
-  scoresSmooth.clear();
 }
 
 void PCCPatchSegmenter3::refineSegmentationGridBased( const PCCPointSet3&         pointCloud,
@@ -1413,61 +1653,51 @@ void PCCPatchSegmenter3::refineSegmentationGridBased( const PCCPointSet3&
   const size_t voxDimHalf      = voxDim >> 1;
 
   auto subToInd = [&]( size_t x, size_t y, size_t z ) { return x + ( y << gridDimShift ) + ( z << gridDimShiftSqr ); };
+  auto toVoxel  = [&]( const PCCPoint3D& pos ) {
+    return PCCVector3D( ( ( static_cast<size_t>( pos[0] ) + voxDimHalf ) ) >> voxDimShift,
+                        ( ( static_cast<size_t>( pos[1] ) + voxDimHalf ) ) >> voxDimShift,
+                        ( ( static_cast<size_t>( pos[2] ) + voxDimHalf ) ) >> voxDimShift );
+  };
 
-  PCCPointSet3                                                        gridCenters;
-  std::unordered_map<size_t, std::unique_ptr<PointIndicesOfGridCell>> gridWithPointIndices;
-  std::unordered_map<size_t, std::unique_ptr<AttributeOfGridCell>>    gridWithAttributes;
-
-  const uint32_t uiMaxNumPointsInOneVox = voxDim * voxDim * voxDim;
+  std::vector<uint64_t> keys( pointCount );
   for ( size_t i = 0; i < pointCount; ++i ) {
-    const auto&  pos = pointCloud[i];
-    const size_t x0  = ( ( static_cast<size_t>( pos[0] ) + voxDimHalf ) ) >> voxDimShift;
-    const size_t y0  = ( ( static_cast<size_t>( pos[1] ) + voxDimHalf ) ) >> voxDimShift;
-    const size_t z0  = ( ( static_cast<size_t>( pos[2] ) + voxDimHalf ) ) >> voxDimShift;
-    size_t       p   = subToInd( x0, y0, z0 );
-    if ( gridWithPointIndices.count( p ) == 0u ) {
-      gridCenters.addPoint( PCCVector3D( x0, y0, z0 ) );
-      gridWithPointIndices.emplace( p, std::make_unique<PointIndicesOfGridCell>( uiMaxNumPointsInOneVox ) );
-      gridWithAttributes.emplace( p, std::make_unique<AttributeOfGridCell>( orientationCount ) );
-    }
-    gridWithPointIndices[p]->addPointIndex( (uint32_t)i );
+    const auto voxel = toVoxel( pointCloud[i] );
+    keys[i]          = subToInd( size_t( voxel[0] ), size_t( voxel[1] ), size_t( voxel[2] ) );
+  }
+  PCCGridCells cells;
+  cells.init( keys );
+  const uint64_t uiTotalNumOfVoxs = cells.size();
+  PCCPointSet3   gridCenters;
+  gridCenters.reserve( uiTotalNumOfVoxs );
+  for ( size_t i = 0; i < uiTotalNumOfVoxs; ++i ) {
+    gridCenters.addPoint( toVoxel( pointCloud[cells.getFirstPoint( i )] ) );
   }
-
-  const uint64_t uiTotalNumOfVoxs = gridCenters.getPointCount();
 
   // pre-processing steps [m56635]
-  std::vector<PointIndicesOfGridCell*> pointIndicesOfVox;
-  pointIndicesOfVox.reserve( uiTotalNumOfVoxs );
-
-  std::vector<AttributeOfGridCell*> attributeOfVox;
-  attributeOfVox.reserve( uiTotalNumOfVoxs );
-
+  PCCGridCellAttributes attributeOfVox;
+  attributeOfVox.init( uiTotalNumOfVoxs, orientationCount );
   for ( size_t i = 0; i < uiTotalNumOfVoxs; ++i ) {
-    auto& p = gridCenters[i];
-
-    PointIndicesOfGridCell* pPI   = gridWithPointIndices[subToInd( p[0], p[1], p[2] )].get();
-    AttributeOfGridCell*    pAttr = gridWithAttributes[subToInd( p[0], p[1], p[2] )].get();
-
-    pAttr->setNumOfTotalPoints( pPI->getPointCount() );
+    attributeOfVox.setNumOfTotalPoints( i, static_cast<uint8_t>( cells.getPointCount( i ) ) );
 
     // 1st voxel classification [m56635]
-    pAttr->updateScores( *( pPI->getPointIndices() ), partition );
-
-    pointIndicesOfVox.push_back( pPI );
-    attributeOfVox.push_back( pAttr );
+    attributeOfVox.updateScores( i, cells.begin( i ), cells.end( i ), partition );
   }
 
   // a step for searching adjacents voxels of each voxel within the voxSearchRadius
-  PCCKdTree                          kdtree( gridCenters );
-  const size_t                       voxSearchRadius  = searchRadius >> voxDimShift;
-  const size_t                       maxNeighborCount = ( std::numeric_limits<int16_t>::max )();
-  std::vector<std::vector<uint32_t>> adj( gridCenters.getPointCount() );
+  PCCKdTree         kdtree( gridCenters );
+  const size_t      voxSearchRadius  = searchRadius >> voxDimShift;
+  const size_t      maxNeighborCount = ( std::numeric_limits<int16_t>::max )();
+  PCCAdjacencyGraph adj;
 
   computeAdjacencyInfoInRadius( gridCenters, kdtree, adj, maxNeighborCount, voxSearchRadius );
 
   // candidates for the indirect edge voxels from [m56635]
-  std::vector<std::vector<uint32_t>> adjDEV( uiTotalNumOfVoxs );
-  const size_t                       idvSearchRange = ( voxDim >= 4 ) ? 1 : 2;
+  PCCAdjacencyGraph     adjDEV;
+  std::vector<uint32_t> adjDEVCounts( uiTotalNumOfVoxs );
+  std::vector<uint32_t> adjDEVNeighbors;
+  std::vector<float>    adjDEVDist;
+  std::vector<uint32_t> adjCounts( uiTotalNumOfVoxs );
+  const size_t          idvSearchRange = ( voxDim >= 4 ) ? 1 : 2;
 
   // pre-processing steps from m55143
   std::vector<double> weights;
@@ -1476,11 +1706,10 @@ void PCCPatchSegmenter3::refineSegmentationGridBased( const PCCPointSet3&
   // for each cell of the grid
   for ( size_t i = 0; i < uiTotalNumOfVoxs; ++i ) {
     auto& p = gridCenters[i];
-    adjDEV[i].reserve( 128 );
 
-    size_t nnPointCount  = 0;
-    auto&  currentAdjOfI = adj[i];
-    auto   iter          = currentAdjOfI.begin();
+    size_t     nnPointCount  = 0;
+    const auto currentAdjOfI = adj[i];
+    auto       iter          = currentAdjOfI.begin();
     for ( ; iter != currentAdjOfI.end(); ++iter ) {
       // for the 2nd voxel classification [m56635]
       auto&  q    = gridCenters[*iter];
@@ -1488,9 +1717,10 @@ void PCCPatchSegmenter3::refineSegmentationGridBased( const PCCPointSet3&
       size_t yAbs = abs( p[1] - q[1] );
       size_t zAbs = abs( p[2] - q[2] );
       if ( xAbs <= idvSearchRange && yAbs <= idvSearchRange && zAbs <= idvSearchRange ) {
-        adjDEV[i].push_back( *iter );
+        adjDEVNeighbors.push_back( *iter );
+        adjDEVCounts[i]++;
       }
-      nnPointCount += pointIndicesOfVox[*iter]->getPointCount();
+      nnPointCount += static_cast<uint8_t>( cells.getPointCount( *iter ) );
       if ( nnPointCount >= maxNNCount ) { break; }
     }
 
@@ -1498,8 +1728,10 @@ void PCCPatchSegmenter3::refineSegmentationGridBased( const PCCPointSet3&
     weights.push_back( lambda / nnPointCount );
 
     // removing points from the adjacent list if there is more than maxNNCount
-    if ( iter != currentAdjOfI.end() ) { currentAdjOfI.erase( iter + 1, currentAdjOfI.end() ); }
+    adjCounts[i] = static_cast<uint32_t>( ( iter != currentAdjOfI.end() ? iter + 1 : iter ) - currentAdjOfI.begin() );
   }
+  adj.truncate( adjCounts );
+  adjDEV.init( adjDEVCounts, adjDEVNeighbors, adjDEVDist );
 
   std::vector<double> scores;
   scores.resize( orientationCount, 0.0 );
@@ -1510,39 +1742,37 @@ void PCCPatchSegmenter3::refineSegmentationGridBased( const PCCPointSet3&
   do {
     for ( size_t i = 0; i < uiTotalNumOfVoxs; ++i ) {
       // if the current voxel belongs to N-EV(No edge-voxel), then refining steps are skipped. [m56635]
-      uint8_t edgeOfI = attributeOfVox[i]->getEdge();
+      uint8_t edgeOfI = attributeOfVox.getEdge( i );
       if ( edgeOfI == NO_EDGE ) { continue; }
 
       std::fill( scoreSmooth.begin(), scoreSmooth.end(), 0 );
 
-      auto& currentAdjOfI = adj[i];
-      for ( const auto& j : currentAdjOfI ) {
-        ScoresVector_t* scoreSmoothOfAdj = attributeOfVox[j]->getScoreSmooth();
-        for ( size_t k = 0; k < orientationCount; ++k ) { scoreSmooth[k] += ( *scoreSmoothOfAdj )[k]; }
+      for ( const auto j : adj[i] ) {
+        const uint16_t* scoreSmoothOfAdj = attributeOfVox.getScoreSmooth( j );
+        for ( size_t k = 0; k < orientationCount; ++k ) { scoreSmooth[k] += scoreSmoothOfAdj[k]; }
       }
 
       // 2nd voxel classification (indirect edge-voxel)  [m56635]
       const auto& maxEleOfScoreSmooth = std::max_element( scoreSmooth.begin(), scoreSmooth.end() );
       size_t      ppiOfScoreSmooth    = std::distance( scoreSmooth.begin(), maxEleOfScoreSmooth );
 
-      for ( auto& j : adjDEV[i] ) {
-        uint8_t edgeOfAdj = attributeOfVox[j]->getEdge();
-        uint8_t ppi       = attributeOfVox[j]->getPPI();
-        if ( edgeOfAdj == NO_EDGE && ppi != ppiOfScoreSmooth ) { attributeOfVox[j]->updateEdge( INDIRECT_EDGE ); }
+      for ( const auto j : adjDEV[i] ) {
+        uint8_t edgeOfAdj = attributeOfVox.getEdge( j );
+        uint8_t ppi       = attributeOfVox.getPPI( j );
+        if ( edgeOfAdj == NO_EDGE && ppi != ppiOfScoreSmooth ) { attributeOfVox.updateEdge( j, INDIRECT_EDGE ); }
       }  // for (auto& j : adjDEV[i])
 
       if ( edgeOfI != M_DIRECT_EDGE ) {  // S_DIRECT_EDGE or INDIRECT_EDGE
         size_t validNumOfScores = orientationCount - std::count( scoreSmooth.begin(), scoreSmooth.end(), 0 );
-        size_t voxPPI           = attributeOfVox[i]->getPPI();
+        size_t voxPPI           = attributeOfVox.getPPI( i );
 
         if ( validNumOfScores == 1 && scoreSmooth[voxPPI] > 0 ) { continue; }
       }
 
-      const auto& pI = *( pointIndicesOfVox[i]->getPointIndices() );
-
       // for each point in a grid cell of i
-      for ( const auto& j : pI ) {
-        const auto& normal = normalsGen.getNormal( j );
+      for ( auto pI = cells.begin( i ); pI != cells.end( i ); ++pI ) {
+        const size_t j      = *pI;
+        const auto&  normal = normalsGen.getNormal( j );
         for ( size_t k = 0; k < orientationCount; ++k ) {
           scores[k] = normal * orientations[k] + weights[i] * scoreSmooth[k];
         }
@@ -1550,12 +1780,12 @@ void PCCPatchSegmenter3::refineSegmentationGridBased( const PCCPointSet3&
         partition[j]       = std::distance( scores.begin(), result );
       }
 
-      attributeOfVox[i]->setUpdatedFlag();
+      attributeOfVox.setUpdatedFlag( i );
     }  // for (size_t i = 0; i < uiTotalNumOfVoxs; ++i)
 
     // restarts the values of score smooth by checking to which partition points now is part of
     for ( size_t i = 0; i < uiTotalNumOfVoxs; ++i ) {
-      attributeOfVox[i]->updateScores( *( pointIndicesOfVox[i]->getPointIndices() ), partition );
+      attributeOfVox.updateScores( i, cells.begin( i ), cells.end( i ), partition );
     }
   } while ( ++iter < iterationCount );
 }
@@ -1580,7 +1810,7 @@ void PCCPatchSegmenter3::separateHighGradientPoints( const PCCPointSet3&
                                                      const double                      minGradient,
                                                      const size_t                      minNumHighGradientPoints,
                                                      std::vector<size_t>&              partition,
-                                                     std::vector<std::vector<size_t>>& adj,
+                                                     const PCCAdjacencyGraph&          adj,
                                                      std::vector<std::vector<size_t>>& connectedComponents ) {
   // detect and remove high gradient points
   std::vector<std::vector<size_t>> highGradientConnectedComponents;
@@ -1767,7 +1997,7 @@ void PCCPatchSegmenter3::calculateGradient( const PCCPointSet3&               po
                                             const double                      minGradient,
                                             const size_t                      minNumHighGradientPoints,
                                             PCCPatch&                         patch,
-                                            std::vector<std::vector<size_t>>& adj,
+                                            const PCCAdjacencyGraph&          adj,
                                             std::vector<std::vector<size_t>>& highGradientConnectedComponents,
                                             std::vector<bool>&                isRemoved ) {
   /* for the case that the xyz components of a normal are the same:
@@ -47,6 +47,8 @@
 
 using namespace pcc;
 
+std::mutex PCCVideoEncoder::libraryEncoderMutex_;
+
 PCCVideoEncoder::PCCVideoEncoder() = default;
 
 PCCVideoEncoder::~PCCVideoEncoder() = default;
@@ -384,7 +386,11 @@ bool PCCVideoEncoder::compress( PCCVideo<T, 3>&    video,
   fflush( stdout );
   PCCVideo<T, 3> videoRec;
   auto           encoder = PCCVirtualVideoEncoder<T>::create( codecId );
-  encoder->encode( video, params, bitstream, videoRec );
+  {
+    std::unique_lock<std::mutex> lock( libraryEncoderMutex_, std::defer_lock );
+    if ( !encoder->isReentrant() ) { lock.lock(); }
+    encoder->encode( video, params, bitstream, videoRec );
+  }
 
   size_t frameIndex = 0;
   for ( auto& image : videoRec ) {
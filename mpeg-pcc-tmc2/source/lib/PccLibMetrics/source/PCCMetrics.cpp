@@ -81,28 +81,39 @@ void QualityMetrics::compute( const PCCPointSet3& pointcloudA, const PCCPointSet
 
   psnr_ = params_.resolution_;
 
-  PCCKdTree    kdtree( pointcloudB );
-  PCCNNResult  result;
-  const size_t num_results_max  = 30;
-  const size_t num_results_incr = 5;
+  PCCKdTree        kdtree( pointcloudB );
+  PCCNNBatchResult result;
+  const size_t     num_results_max  = 30;
+  const size_t     num_results_incr = 5;
+  const size_t     blockSize        = 16384;
+  const size_t     pointCountA      = pointcloudA.getPointCount();
 
   auto& normalsB = pointcloudB.getNormals();
-  for ( size_t indexA = 0; indexA < pointcloudA.getPointCount(); indexA++ ) {
+  for ( size_t indexA = 0; indexA < pointCountA; indexA++ ) {
     // For point 'i' in A, find its nearest neighbor in B. store it in 'j'
-    size_t num_results = 0;
-    do {
+    // The neighbors are searched by blocks of points: the num_results_max nearest neighbors start with the ones of
+    // every smaller search, so the search growing by num_results_incr is replayed on them.
+    const size_t query = indexA % blockSize;
+    if ( query == 0 ) {
+      kdtree.search( &pointcloudA.getPositions()[indexA], ( std::min )( blockSize, pointCountA - indexA ),
+                     num_results_max, result, params_.nbThread_ );
+    }
+    const float*    dist        = result.dist( query );
+    const uint32_t* indices     = result.indices( query );
+    const size_t    resultCount = ( std::min )( num_results_max, result.count( query ) );
+    size_t          num_results = ( std::min )( num_results_incr, resultCount );
+    while ( dist[0] == dist[num_results - 1] && num_results + num_results_incr <= resultCount ) {
       num_results += num_results_incr;
-      kdtree.search( pointcloudA[indexA], num_results, result );
-    } while ( result.dist( 0 ) == result.dist( num_results - 1 ) && num_results + num_results_incr <= num_results_max );
+    }
 
     // Compute point-to-point, which should be equal to sqrt( dist[0] )
-    double distProjC2c = result.dist( 0 );
+    double distProjC2c = dist[0];
 
     // Build the list of all the points of same distances.
     std::vector<size_t> sameDistList;
     if ( params_.computeColor_ || params_.computeC2p_ ) {
-      for ( size_t j = 0; j < num_results && ( fabs( result.dist( 0 ) - result.dist( j ) ) < 1e-8 ); j++ ) {
-        sameDistList.push_back( result.indices( j ) );
+      for ( size_t j = 0; j < num_results && ( fabs( dist[0] - dist[j] ) < 1e-8 ); j++ ) {
+        sameDistList.push_back( indices[j] );
       }
     }
     std::sort( sameDistList.begin(), sameDistList.end() );
@@ -121,7 +132,7 @@ void QualityMetrics::compute( const PCCPointSet3& pointcloudA, const PCCPointSet
       distProjC2p /= sameDistList.size();
     }
 
-    size_t indexB = result.indices( 0 );
+    size_t indexB = indices[0];
     double distColor[3];
     distColor[0] = distColor[1] = distColor[2] = 0.0;
     if ( params_.computeColor_ && pointcloudA.hasColors() && pointcloudB.hasColors() ) {
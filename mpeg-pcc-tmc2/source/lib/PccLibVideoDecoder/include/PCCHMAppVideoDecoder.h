@@ -53,6 +53,10 @@ class PCCHMAppVideoDecoder : public PCCVirtualVideoDecoder<T> {
                size_t             outputBitDepth = 8,
                const std::string& decoderPath    = "",
                const std::string& parameters     = "" );
+
+  bool isReentrant() { return true; }
+
+  bool hasPictureOutput() { return true; }
 };
 
 };  // namespace pcc
@@ -52,6 +52,8 @@ class PCCJMAppVideoDecoder : public PCCVirtualVideoDecoder<T> {
                size_t             outputBitDepth = 8,
                const std::string& decoderPath    = "",
                const std::string& parameters     = "" );
+
+  bool isReentrant() { return true; }
 };
 
 };  // namespace pcc
@@ -22,6 +22,10 @@ class PCCSHMAppVideoDecoder : public PCCVirtualVideoDecoder<T> {
                const std::string& decoderPath    = "",
                const std::string& parameters     = "" );
 
+  bool isReentrant() { return true; }
+
+  bool hasPictureOutput() { return true; }
+
   void setLayerIndex( size_t index ) { layerIndex_ = index; }
 
  private:
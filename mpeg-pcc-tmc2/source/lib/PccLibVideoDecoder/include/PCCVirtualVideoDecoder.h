@@ -36,6 +36,7 @@
 #include "PCCCommon.h"
 #include "PCCVideo.h"
 #include "PCCVideoBitstream.h"
+#include <functional>
 
 namespace pcc {
 
@@ -53,7 +54,23 @@ class PCCVirtualVideoDecoder {
                        const std::string& decoderPath    = "",
                        const std::string& parameters     = "" ) = 0;
 
- public:
+  // HM, VTM and JM libraries share process-wide tables (initROM/destroyROM, globals): only the decoders running in
+  // a separate process can be used concurrently.
+  virtual bool isReentrant() { return false; }
+
+  // True for the decoders reading their output picture by picture, which honour the picture output below. The
+  // library decoders return the whole video: they hold the library lock while decoding, and a picture output
+  // pausing the decoding would block the other videos on that lock.
+  virtual bool hasPictureOutput() { return false; }
+
+  // When set, the decoders reading their output picture by picture hand each picture over as soon as it is decoded
+  // instead of storing it in the video. The other decoders ignore it and fill the video.
+  void setPictureOutput( std::function<void( PCCImage<T, 3>& picture )> pictureOutput ) {
+    pictureOutput_ = pictureOutput;
+  }
+
+ protected:
+  std::function<void( PCCImage<T, 3>& picture )> pictureOutput_;
 };
 
 };  // namespace pcc
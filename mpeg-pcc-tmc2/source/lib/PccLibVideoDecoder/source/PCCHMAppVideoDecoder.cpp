@@ -73,18 +73,31 @@ void PCCHMAppVideoDecoder<T>::decode( PCCVideoBitstream& bitstream,
     if ( outputBitDepth == 8 ) { cmd << " --OutputBitDepth=8 --OutputBitDepthC=8"; }
   }
   std::cout << cmd.str() << '\n';
-  if ( pcc::system( cmd.str().c_str() ) ) {
+  // the decoder seeks in its bitstream file, only the decoded frames are streamed back
+  PCCCOLORFORMAT format  = isRGB ? PCCCOLORFORMAT::RGB444 : PCCCOLORFORMAT::YUV420;
+  size_t         pictureCount = 0;
+  auto           readRec      = [&]( const std::string& path ) {
+    if ( !this->pictureOutput_ ) {
+      video.read( path, width, height, format, outputBitDepth == 8 ? 1 : 2 );
+      return;
+    }
+    // the pictures are handed over while the decoder is running
+    std::ifstream  infile( path, std::ios::binary );
+    PCCImage<T, 3> picture;
+    while ( picture.read( infile, width, height, format, outputBitDepth == 8 ? 1 : 2 ) ) {
+      this->pictureOutput_( picture );
+      pictureCount++;
+    }
+  };
+  video.clear();
+  if ( pcc::system( cmd.str().c_str(), {{reconFile, false, readRec}} ) ) {
     std::cout << "Error: can't run system command!" << std::endl;
     exit( -1 );
   }
-  PCCCOLORFORMAT format = isRGB ? PCCCOLORFORMAT::RGB444 : PCCCOLORFORMAT::YUV420;
-  video.clear();
-  video.read( reconFile, width, height, format, outputBitDepth == 8 ? 1 : 2 );
-  printf( "File read size = %zu x %zu frame count = %zu \n", video.getWidth(), video.getHeight(),
-          video.getFrameCount() );
+  printf( "File read size = %zu x %zu frame count = %zu \n", width, height,
+          this->pictureOutput_ ? pictureCount : video.getFrameCount() );
 
   removeFile( binFileName );
-  removeFile( reconFile );
 }
 
 template class pcc::PCCHMAppVideoDecoder<uint8_t>;
@@ -56,18 +56,10 @@ void PCCSHMAppVideoDecoder<T>::decode( PCCVideoBitstream& bitstream,
     }
   }
   std::cout << cmd.str() << '\n';
-  if ( pcc::system( cmd.str().c_str() ) ) {
-    std::cout << "Error: can't run system command!" << std::endl;
-    exit( -1 );
-  }
-  PCCCOLORFORMAT format = isRGB[layerIndex_] ? PCCCOLORFORMAT::RGB444 : PCCCOLORFORMAT::YUV420;
-  video.clear();
-  video.read( reconFile, width[layerIndex_], height[layerIndex_], format, outputBitDepth == 8 ? 1 : 2 );
-  printf( "File read size = %zu x %zu frame count = %zu \n", video.getWidth(), video.getHeight(),
-          video.getFrameCount() );
-
+  // the lower layers are upsampled to the size of the last layer
+  float rateX = 1.f;
   if ( layerIndex_ < width.size() - 1 ) {
-    float rateX = (float)width[width.size() - 1] / (float)width[layerIndex_];
+    rateX       = (float)width[width.size() - 1] / (float)width[layerIndex_];
     float rateY = (float)height[width.size() - 1] / (float)height[layerIndex_];
     if ( rateX != rateY ) {
       printf( "Error: SHVC upsampler only works with same rate for X and Y. ( %f and %f not supported \n", rateX,
@@ -78,13 +70,39 @@ void PCCSHMAppVideoDecoder<T>::decode( PCCVideoBitstream& bitstream,
       printf( "Error: SHVC upsampler only works with rate = 1 , 2, or 4. ( %f not supported \n", rateX );
       exit( -1 );
     }
+  }
+  // the decoder seeks in its bitstream file, only the decoded frames are streamed back
+  PCCCOLORFORMAT format       = isRGB[layerIndex_] ? PCCCOLORFORMAT::RGB444 : PCCCOLORFORMAT::YUV420;
+  size_t         pictureCount = 0;
+  auto           readRec      = [&]( const std::string& path ) {
+    if ( !this->pictureOutput_ ) {
+      video.read( path, width[layerIndex_], height[layerIndex_], format, outputBitDepth == 8 ? 1 : 2 );
+      return;
+    }
+    // the pictures are upsampled and handed over while the decoder is running
+    std::ifstream  infile( path, std::ios::binary );
+    PCCImage<T, 3> picture;
+    while ( picture.read( infile, width[layerIndex_], height[layerIndex_], format, outputBitDepth == 8 ? 1 : 2 ) ) {
+      if ( layerIndex_ < width.size() - 1 ) { picture.upsample( rateX ); }
+      this->pictureOutput_( picture );
+      pictureCount++;
+    }
+  };
+  video.clear();
+  if ( pcc::system( cmd.str().c_str(), {{reconFile, false, readRec}} ) ) {
+    std::cout << "Error: can't run system command!" << std::endl;
+    exit( -1 );
+  }
+  printf( "File read size = %zu x %zu frame count = %zu \n", width[layerIndex_], height[layerIndex_],
+          this->pictureOutput_ ? pictureCount : video.getFrameCount() );
+
+  if ( layerIndex_ < width.size() - 1 && !this->pictureOutput_ ) {
     video.upsample( rateX );
     printf( "Upsample video size = %zu x %zu frame count = %zu \n ", video.getWidth(), video.getHeight(),
             video.getFrameCount() );
     fflush( stdout );
   }
   removeFile( binFileName );
-  removeFile( reconFile );
 }
 
 template class pcc::PCCSHMAppVideoDecoder<uint8_t>;
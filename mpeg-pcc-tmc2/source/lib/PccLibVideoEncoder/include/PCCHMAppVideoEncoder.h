@@ -53,6 +53,8 @@ class PCCHMAppVideoEncoder : public PCCVirtualVideoEncoder<T> {
                PCCVideoBitstream&         bitstream,
                PCCVideo<T, 3>&            videoRec );
 
+  bool isReentrant() { return true; }
+
  private:
   PCCCOLORFORMAT getColorFormat( std::string& name );
 };
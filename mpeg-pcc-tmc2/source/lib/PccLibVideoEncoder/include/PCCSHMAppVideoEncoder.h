@@ -20,6 +20,8 @@ class PCCSHMAppVideoEncoder : public PCCVirtualVideoEncoder<T> {
                PCCVideoBitstream&         bitstream,
                PCCVideo<T, 3>&            videoRec );
 
+  bool isReentrant() { return true; }
+
  private:
   PCCCOLORFORMAT getColorFormat( std::string& name );
 };
@@ -77,6 +77,10 @@ class PCCVirtualVideoEncoder {
                        PCCVideoEncoderParameters& params,
                        PCCVideoBitstream&         bitstream,
                        PCCVideo<T, 3>&            videoRec ) = 0;
+
+  // HM, VTM and JM libraries share process-wide tables (initROM/destroyROM, globals): only the encoders running in
+  // a separate process can be used concurrently.
+  virtual bool isReentrant() { return false; }
 };
 
 };  // namespace pcc
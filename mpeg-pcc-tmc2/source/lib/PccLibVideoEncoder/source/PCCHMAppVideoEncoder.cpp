@@ -90,18 +90,19 @@ void PCCHMAppVideoEncoder<T>::encode( PCCVideo<T, 3>&            videoSrc,
 
   std::cout << cmd.str() << std::endl;
 
-  videoSrc.write( srcYuvFileName, params.inputBitDepth_ == 8 ? 1 : 2 );
-  if ( pcc::system( cmd.str().c_str() ) ) {
+  PCCCOLORFORMAT format   = getColorFormat( params.recYuvFileName_ );
+  const size_t   srcNbyte = params.inputBitDepth_ == 8 ? 1 : 2;
+  const size_t   recNbyte = params.outputBitDepth_ == 8 ? 1 : 2;
+  auto           writeSrc = [&]( const std::string& path ) { videoSrc.write( path, srcNbyte ); };
+  auto           readRec  = [&]( const std::string& path ) { videoRec.read( path, width, height, format, recNbyte ); };
+  auto           readBin  = [&]( const std::string& path ) { bitstream.read( path ); };
+  videoRec.clear();
+  // the raw frames and the bitstream are streamed to and from the encoder
+  if ( pcc::system( cmd.str().c_str(),
+                    {{srcYuvFileName, true, writeSrc}, {recYuvFileName, false, readRec}, {binFileName, false, readBin}} ) ) {
     std::cout << "Error: can't run system command!" << std::endl;
     exit( -1 );
   }
-  PCCCOLORFORMAT format = getColorFormat( params.recYuvFileName_ );
-  videoRec.clear();
-  videoRec.read( recYuvFileName, width, height, format, params.outputBitDepth_ == 8 ? 1 : 2 );
-  bitstream.read( binFileName );
-  removeFile( srcYuvFileName );
-  removeFile( recYuvFileName );
-  removeFile( binFileName );
 }
 
 template <typename T>
@@ -82,10 +82,8 @@ void PCCSHMAppVideoEncoder<T>::encode( PCCVideo<T, 3>&            videoSrc,
             }
           }
           videoSrcLayers.push_back( videoDst );
-          videoDst.write( srcYuvFileName[i], params.inputBitDepth_ == 8 ? 1 : 2 );
         } else {
           videoSrcLayers.push_back( videoSrc );
-          videoSrc.write( srcYuvFileName[i], params.inputBitDepth_ == 8 ? 1 : 2 );
         }
       }
     }
@@ -117,37 +115,38 @@ void PCCSHMAppVideoEncoder<T>::encode( PCCVideo<T, 3>&            videoSrc,
     cmd << " --FrameSkip=0";
     std::cout << cmd.str() << std::endl;
 
+    // every layer reconstruction is drained from the encoder, only the selected one is kept
+    PCCCOLORFORMAT               format   = getColorFormat( params.recYuvFileName_ );
+    const size_t                 srcNbyte = params.inputBitDepth_ == 8 ? 1 : 2;
+    const size_t                 recNbyte = params.outputBitDepth_ == 8 ? 1 : 2;
+    std::vector<PCCVideo<T, 3>>  videoRecLayers( numLayers );
+    std::vector<PCCSystemStream> streams;
     for ( size_t i = 0; i < numLayers; i++ ) {
       printf( "Write video src layer %zu / %d: size = %4zux%-4zu %s \n", i, numLayers, videoSrcLayers[i].getWidth(),
-              videoSrcLayers[i].getHeight(), recYuvFileName[i].c_str() );
-      videoSrcLayers[i].write( recYuvFileName[i], params.inputBitDepth_ == 8 ? 1 : 2 );
+              videoSrcLayers[i].getHeight(), srcYuvFileName[i].c_str() );
+      streams.push_back( {srcYuvFileName[i], true, [&, i]( const std::string& path ) {
+                            videoSrcLayers[i].write( path, srcNbyte );
+                          }} );
+      streams.push_back( {recYuvFileName[i], false, [&, i]( const std::string& path ) {
+                            videoRecLayers[i].read( path, widthLayers[i], heightLayers[i], format, recNbyte );
+                          }} );
     }
-    if ( pcc::system( cmd.str().c_str() ) ) {
+    streams.push_back( {binName, false, [&]( const std::string& path ) { bitstream.read( path ); }} );
+    if ( pcc::system( cmd.str().c_str(), streams ) ) {
       std::cout << "Error: can't run system command!" << std::endl;
       exit( -1 );
     }
-    PCCCOLORFORMAT format = getColorFormat( params.recYuvFileName_ );
+    int32_t index = ( std::min )( numLayers - 1, params.shvcLayerIndex_ );
     videoRec.clear();
+    std::swap( videoRec, videoRecLayers[index] );
     if ( params.shvcLayerIndex_ < numLayers - 1 ) {
-      int32_t index = ( std::min )( numLayers - 1, params.shvcLayerIndex_ );
       printf( "Num Layer = %d layerIndex = %d => layer index = %d \n", numLayers, params.shvcLayerIndex_, index );
-      videoRec.read( recYuvFileName[index], widthLayers[index], heightLayers[index], format,
-                     params.outputBitDepth_ == 8 ? 1 : 2 );
       float rateX = (float)widthLayers[numLayers - 1] / (float)widthLayers[index];
       videoRec.upsample( rateX );
       printf( "Upsample video size = % zu x % zu frame count = % zu \n ", videoRec.getWidth(), videoRec.getHeight(),
               videoRec.getFrameCount() );
       fflush( stdout );
-    } else {
-      videoRec.read( recYuvName, width, height, format, params.outputBitDepth_ == 8 ? 1 : 2 );
     }
-    bitstream.read( binName );
-
-    for ( size_t i = 0; i < numLayers; i++ ) {
-      removeFile( srcYuvFileName[i] );
-      removeFile( recYuvFileName[i] );
-    }
-    removeFile( binName );
   } else {
     std::stringstream cmd;
     cmd << params.encoderPath_;
@@ -181,18 +180,20 @@ void PCCSHMAppVideoEncoder<T>::encode( PCCVideo<T, 3>&            videoSrc,
     if ( params.inputColourSpaceConvert_ ) { cmd << " --InputColourSpaceConvert=RGBtoGBR"; }
 
     std::cout << cmd.str() << std::endl;
-    videoSrc.write( srcYuvName, params.inputBitDepth_ == 8 ? 1 : 2 );
-    if ( pcc::system( cmd.str().c_str() ) ) {
+    PCCCOLORFORMAT format   = getColorFormat( params.recYuvFileName_ );
+    const size_t   srcNbyte = params.inputBitDepth_ == 8 ? 1 : 2;
+    const size_t   recNbyte = params.outputBitDepth_ == 8 ? 1 : 2;
+    auto           writeSrc = [&]( const std::string& path ) { videoSrc.write( path, srcNbyte ); };
+    auto           readRec  = [&]( const std::string& path ) {
+      videoRec.read( path, width, height, format, recNbyte );
+    };
+    auto           readBin  = [&]( const std::string& path ) { bitstream.read( path ); };
+    videoRec.clear();
+    if ( pcc::system( cmd.str().c_str(),
+                      {{srcYuvName, true, writeSrc}, {recYuvName, false, readRec}, {binName, false, readBin}} ) ) {
       std::cout << "Error: can't run system command!" << std::endl;
       exit( -1 );
     }
-    PCCCOLORFORMAT format = getColorFormat( params.recYuvFileName_ );
-    videoRec.clear();
-    videoRec.read( recYuvName, width, height, format, params.outputBitDepth_ == 8 ? 1 : 2 );
-    bitstream.read( binName );
-    removeFile( srcYuvName );
-    removeFile( recYuvName );
-    removeFile( binName );
   }
 }
 